@@ -7,13 +7,10 @@ layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec3 in_normal;
 layout(location = 2) in vec2 in_uv;
 
-layout(push_constant) uniform PCO {
-    layout(offset = 64) vec3 cam_pos;
-    layout(offset = 80) int is_colliding;
-} pco;
-
 layout(set = 0, binding = 0) uniform UBO {
     layout(offset = 64) vec4 lights[NUM_LIGHTS];
+    vec4 cam_pos;
+    int is_colliding;
 } ubo;
 
 layout(set = 1, binding = 0) uniform sampler2D color_map;
@@ -23,12 +20,12 @@ layout(location = 0) out vec4 out_color;
 void main() {
     // read color from texure
     vec3 color = texture(color_map, in_uv).rgb;
-    if (pco.is_colliding > 0) {
+    if (ubo.is_colliding > 0) {
         color = vec3(1.0f, 0.0f, 0.0f);
     }
 
     vec3 N = normalize(in_normal);
-    vec3 V = normalize(pco.cam_pos.xyz - in_position);
+    vec3 V = normalize(ubo.cam_pos.xyz - in_position);
     vec3 light_contribtion = 0.15 * color; // ambient
     for (int i = 0; i < NUM_LIGHTS; i++) {
         vec3 L = normalize(ubo.lights[i].xyz - in_position);
@@ -1,24 +1,44 @@
 #version 450
 
-layout(binding = 0) uniform UBO {
+layout(set = 0, binding = 0) uniform UBO {
     mat4 proj_view;
 } ubo;
 
-layout(push_constant) uniform PCO {
+struct Instance {
     mat4 model;
-} pco;
+    mat4 normal;
+};
+
+// EVERY OBJECT DRAWN THIS FRAME, NOTE gl_InstanceIndex ALREADY INCLUDES THE DRAW'S FIRST INSTANCE
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    Instance instances[];
+};
 
 layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 normal;
+layout(location = 1) in vec2 normal;
 layout(location = 2) in vec2 uv;
 
 layout(location = 0) out vec3 out_position;
 layout(location = 1) out vec3 out_normal;
 layout(location = 2) out vec2 out_uv;
 
+// SO THE DEPTH IS THE SAME AS depth_prepass.vert WROTE
+invariant gl_Position;
+
+// THE NORMAL IS OCTAHEDRAL ENCODED, UNFOLD THE LOWER HALF OF THE OCTAHEDRON AND PROJECT BACK ONTO THE SPHERE
+vec3 decode_octahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
 void main() {
-    gl_Position = ubo.proj_view * pco.model * vec4(position, 1.0);
-    out_position = vec3(pco.model * vec4(position, 1.0));
-    out_normal = transpose(inverse(mat3(pco.model))) * normal;
+    Instance instance = instances[gl_InstanceIndex];
+    vec4 world_position = instance.model * vec4(position, 1.0);
+    gl_Position = ubo.proj_view * world_position;
+    out_position = vec3(world_position);
+    out_normal = mat3(instance.normal) * decode_octahedral(normal);
     out_uv = uv; 
 }
\ No newline at end of file
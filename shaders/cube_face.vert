@@ -0,0 +1,29 @@
+#version 450
+#extension GL_EXT_multiview : require
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 normal;
+layout(location = 2) in vec2 uv;
+
+// All six faces are drawn at once, each as one view of a multiview render pass, and
+// gl_ViewIndex is the face. These turn the box so the face's direction is straight ahead
+const mat3 FACE_ROTATIONS[6] = mat3[](
+    mat3(0.0, 0.0, -1.0, 0.0, -1.0, 0.0, -1.0, 0.0, 0.0),  // POSITIVE_X
+    mat3(0.0, 0.0, 1.0, 0.0, -1.0, 0.0, 1.0, 0.0, 0.0),    // NEGATIVE_X
+    mat3(1.0, 0.0, 0.0, 0.0, 0.0, -1.0, 0.0, 1.0, 0.0),    // POSITIVE_Y
+    mat3(1.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0, -1.0, 0.0),    // NEGATIVE_Y
+    mat3(1.0, 0.0, 0.0, 0.0, -1.0, 0.0, 0.0, 0.0, -1.0),   // POSITIVE_Z
+    mat3(-1.0, 0.0, 0.0, 0.0, -1.0, 0.0, 0.0, 0.0, 1.0)    // NEGATIVE_Z
+);
+
+layout(push_constant) uniform PCO {
+    layout (offset = 0) mat4 proj;
+} pco;
+
+layout(location = 0) out vec3 frag_uvw;
+
+
+void main() {
+    gl_Position = pco.proj * vec4(FACE_ROTATIONS[gl_ViewIndex] * position, 1.0);
+    frag_uvw = position;
+}
@@ -0,0 +1,26 @@
+#version 450
+
+// THE DEPTH PREPASS ONLY READS POSITIONS, FROM THE GEOMETRY ARENA'S POSITION BUFFERS, AND HAS
+// NO FRAGMENT SHADER. gl_Position IS WORKED OUT EXACTLY LIKE blinn_phong.vert DOES SO THE
+// SCENE'S eEqual DEPTH TEST PASSES WHERE IT SHOULD
+layout(set = 0, binding = 0) uniform UBO {
+    mat4 proj_view;
+} ubo;
+
+struct Instance {
+    mat4 model;
+    mat4 normal;
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(location = 0) in vec3 position;
+
+invariant gl_Position;
+
+void main() {
+    vec4 world_position = instances[gl_InstanceIndex].model * vec4(position, 1.0);
+    gl_Position = ubo.proj_view * world_position;
+}
\ No newline at end of file
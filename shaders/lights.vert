@@ -1,15 +1,21 @@
 #version 450
 
-layout(binding = 0) uniform UBO {
+layout(set = 0, binding = 0) uniform UBO {
     mat4 proj_view;
 } ubo;
 
-layout(push_constant) uniform PCO {
-    mat4 model; 
-} pco;
+struct Instance {
+    mat4 model;
+    mat4 normal;
+};
+
+// EVERY OBJECT DRAWN THIS FRAME, THE LIGHTS ARE THE FIRST ONES
+layout(std430, set = 0, binding = 1) readonly buffer Instances {
+    Instance instances[];
+};
 
 layout(location = 0) in vec3 position;
 
 void main() {
-    gl_Position = ubo.proj_view * pco.model * vec4(position, 1.0);
+    gl_Position = ubo.proj_view * instances[gl_InstanceIndex].model * vec4(position, 1.0);
 }
\ No newline at end of file
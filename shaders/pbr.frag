@@ -10,7 +10,9 @@ layout(set = 0, binding = 0) uniform UBO {
 } ubo;
 
 // global descriptors
-layout(set = 0, binding = 1) uniform samplerCube irradiance_sampler;
+layout(set = 0, binding = 1) uniform IrradianceSH {
+    vec4 coefficients[9];
+} sh;
 layout(set = 0, binding = 2) uniform samplerCube prefilter_sampler;
 layout(set = 0, binding = 3) uniform sampler2D brdf_sampler;
 
@@ -73,6 +75,19 @@ vec3 F_SchlickR(float cosTheta, vec3 F0, float roughness)
 	return F0 + (max(vec3(1.0 - roughness), F0) - F0) * pow(1.0 - cosTheta, 5.0);
 }
 
+// The irradiance around n from its 9 spherical harmonics coefficients
+vec3 evaluate_sh(vec3 n) {
+    return sh.coefficients[0].rgb * 0.282095
+        + sh.coefficients[1].rgb * 0.488603 * n.y
+        + sh.coefficients[2].rgb * 0.488603 * n.z
+        + sh.coefficients[3].rgb * 0.488603 * n.x
+        + sh.coefficients[4].rgb * 1.092548 * n.x * n.y
+        + sh.coefficients[5].rgb * 1.092548 * n.y * n.z
+        + sh.coefficients[6].rgb * 0.315392 * (3.0 * n.z * n.z - 1.0)
+        + sh.coefficients[7].rgb * 1.092548 * n.x * n.z
+        + sh.coefficients[8].rgb * 0.546274 * (n.x * n.x - n.y * n.y);
+}
+
 vec3 prefilter_reflection(vec3 R, float roughness) {
     const float MAX_REFLECTION_LOD = 9.0;
     float lod = roughness * MAX_REFLECTION_LOD;
@@ -129,7 +144,7 @@ void main() {
 
     vec2 brdf = texture(brdf_sampler, vec2(max(dot(N, V), 0.0), roughness)).rg;
     vec3 reflection = prefilter_reflection(R, roughness).rgb;
-    vec3 irradiance = texture(irradiance_sampler, N).rgb;
+    vec3 irradiance = max(evaluate_sh(N), vec3(0.0));
 
     vec3 diffuse = irradiance * texture(color_sampler, in_uv).rgb;
 
@@ -9,16 +9,25 @@ layout(push_constant) uniform PCO {
 } pco;
 
 layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 normal;
+layout(location = 1) in vec2 normal;
 layout(location = 2) in vec2 uv;
 
 layout(location = 0) out vec3 out_normal;
 layout(location = 1) out vec2 out_uv;
 layout(location = 2) out vec3 frag_uvw;
 
+// THE NORMAL IS OCTAHEDRAL ENCODED, UNFOLD THE LOWER HALF OF THE OCTAHEDRON AND PROJECT BACK ONTO THE SPHERE
+vec3 decode_octahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
 void main() {
     gl_Position = ubo.proj_view * pco.model * vec4(position, 1.0);
     frag_uvw = vec3(pco.model * vec4(position, 1.0));
-    out_normal = transpose(inverse(mat3(pco.model))) * normal;
+    out_normal = transpose(inverse(mat3(pco.model))) * decode_octahedral(normal);
     out_uv = uv;
 }
\ No newline at end of file
@@ -5,12 +5,13 @@ layout (location = 0) out vec4 out_color;
 
 layout (binding = 0) uniform samplerCube env_cube;
 
+// Smoother levels take fewer samples, see PBRBaker::get_prefilter_sample_counts
 layout(push_constant) uniform PCO {
 	layout (offset = 64) float roughness;
+	uint sample_count;
 } pco;
 
 const float PI = 3.1415926536;
-const uint NUM_SAMPLES = 32; 
 
 // Based omn http://byteblacksmith.com/improvements-to-the-canonical-one-liner-glsl-rand-for-opengl-es-2-0/
 float random(vec2 co)
@@ -72,13 +73,15 @@ vec3 prefilter_env_map(vec3 R, float roughness)
 	vec3 color = vec3(0.0);
 	float total_weight = 0.0;
 	float env_map_dim = float(textureSize(env_cube, 0).s);
-	for(uint i = 0u; i < NUM_SAMPLES; i++) {
-		vec2 Xi = hammersley2d(i, NUM_SAMPLES);
+	for(uint i = 0u; i < pco.sample_count; i++) {
+		vec2 Xi = hammersley2d(i, pco.sample_count);
 		vec3 H = importance_sample_GGX(Xi, roughness, N);
 		vec3 L = 2.0 * dot(V, H) * H - V;
 		float dotNL = clamp(dot(N, L), 0.0, 1.0);
 		if(dotNL > 0.0) {
-			// Filtering based on https://placeholderart.wordpress.com/2015/07/28/implementation-notes-runtime-environment-map-filtering-for-image-based-lighting/
+			// Filtered importance sampling, based on https://placeholderart.wordpress.com/2015/07/28/implementation-notes-runtime-environment-map-filtering-for-image-based-lighting/
+			// Each sample reads the level of the environment whose texels cover about the solid angle
+			// the sample stands for, so few samples still see all of the lobe rather than a few texels of it
 
 			float dotNH = clamp(dot(N, H), 0.0, 1.0);
 			float dotVH = clamp(dot(V, H), 0.0, 1.0);
@@ -86,7 +89,7 @@ vec3 prefilter_env_map(vec3 R, float roughness)
 			// Probability Distribution Function
 			float pdf = D_GGX(dotNH, roughness) * dotNH / (4.0 * dotVH) + 0.0001;
 			// Solid angle of current smple
-			float omegaS = 1.0 / (float(NUM_SAMPLES) * pdf);
+			float omegaS = 1.0 / (float(pco.sample_count) * pdf);
 			// Solid angle of 1 pixel across all cube faces
 			float omegaP = 4.0 * PI / (6.0 * env_map_dim * env_map_dim);
 			// Biased (+1.0) mip level for better result
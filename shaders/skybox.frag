@@ -2,13 +2,28 @@
 
 layout(location = 0) in vec3 frag_uvw;
 
-layout(set = 0, binding = 0) uniform samplerCube background_sampler; 
+// The irradiance as 9 spherical harmonics coefficients, baked by irradiance_sh.comp
+layout(set = 0, binding = 0) uniform IrradianceSH {
+    vec4 coefficients[9];
+} sh;
 
 layout(location = 0) out vec4 out_color;
 
+vec3 evaluate_sh(vec3 n) {
+    return sh.coefficients[0].rgb * 0.282095
+        + sh.coefficients[1].rgb * 0.488603 * n.y
+        + sh.coefficients[2].rgb * 0.488603 * n.z
+        + sh.coefficients[3].rgb * 0.488603 * n.x
+        + sh.coefficients[4].rgb * 1.092548 * n.x * n.y
+        + sh.coefficients[5].rgb * 1.092548 * n.y * n.z
+        + sh.coefficients[6].rgb * 0.315392 * (3.0 * n.z * n.z - 1.0)
+        + sh.coefficients[7].rgb * 1.092548 * n.x * n.z
+        + sh.coefficients[8].rgb * 0.546274 * (n.x * n.x - n.y * n.y);
+}
+
 void main() {
-    vec3 env_color = texture(background_sampler, frag_uvw).rgb;
+    vec3 env_color = max(evaluate_sh(normalize(frag_uvw)), vec3(0.0));
     env_color = env_color / (env_color + vec3(1.0));
     env_color = pow(env_color, vec3(1.0 / 2.2));
     out_color = vec4(env_color, 1.0);
-}
\ No newline at end of file
+}
@@ -1,7 +1,7 @@
 #version 450
 
 layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 normal;
+layout(location = 1) in vec2 normal;
 layout(location = 2) in vec2 uv;
 
 layout(push_constant) uniform PCO {
@@ -12,6 +12,7 @@ layout(push_constant) uniform PCO {
 layout(location = 0) out vec3 frag_uvw;
 
 void main() {
-    gl_Position = pco.proj * mat4(mat3(pco.view)) * vec4(position, 1.0);
+    // z = w PUTS THE SKY ON THE FAR PLANE, SO IT'S DRAWN LAST AND ONLY WHERE NOTHING ELSE WAS
+    gl_Position = (pco.proj * mat4(mat3(pco.view)) * vec4(position, 1.0)).xyww;
     frag_uvw = position;
 }
\ No newline at end of file
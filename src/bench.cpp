@@ -0,0 +1,260 @@
+// C/C++ LANGUAGE API TYPES
+#include <stdlib.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+// OUR OWN TYPES
+#include "common/frame_stats.hpp"
+#include "common/profiler.hpp"
+#include "core/renderer.hpp"
+#include "scene_graph/event.hpp"
+
+/*
+* bench.cpp - This is the entry point into the Wolfie3D benchmark. It renders the same
+* scene as the demo but instead of reading user input it flies the FreeCamera along a
+* scripted path for a fixed number of frames, advancing the scene by a fixed time step
+* each frame so every run renders exactly the same frames. When it's done it reports how
+* long the frames and each phase of them took on the CPU, and when the GPU supports
+* timestamps how long each pass took on the GPU, as JSON, along with how many objects
+* were drawn and culled. It takes these command line options:
+*	--frames <count>		NUMBER OF FRAMES TO MEASURE, 600 BY DEFAULT
+*	--warmup <count>		FRAMES TO RENDER BEFORE MEASURING, 60 BY DEFAULT
+*	--size <w> <h>			SIZE OF THE FRAMES
+*	--window				RENDER TO A WINDOW INSTEAD OF OFFSCREEN
+*	--no-culling			DRAW EVERYTHING, EVEN WHAT'S OFF-SCREEN
+*	--cpu-culling			CULL AND PICK THE SCENE'S DRAWS ON THE CPU EVEN IF THE GPU COULD
+*	--threads <count>		THREADS RECORDING COMMANDS, ALL HARDWARE THREADS BY DEFAULT
+*	--frames-in-flight <n>	FRAMES THE CPU MAY RUN AHEAD OF THE GPU, 1 TO 4, 2 BY DEFAULT
+*	--swapchain-images <n>	MINIMUM SWAPCHAIN IMAGES WITH --window, e.g. 3 FOR TRIPLE BUFFERING
+*	--no-mesh-optimization	UPLOAD THE SCENE'S MESHES AS AUTHORED, WITHOUT REORDERING THEM
+*	--no-lods				DRAW EVERY MESH AT FULL DETAIL, HOWEVER FAR AWAY IT IS
+*	--no-depth-prepass		SHADE THE SCENE WITHOUT LAYING DOWN ITS DEPTH FIRST
+*	--no-pipeline-cache		COMPILE EVERY PIPELINE FROM SCRATCH, NEITHER LOADING NOR SAVING THEM
+*	--no-bake-cache			BAKE THE LIGHTING FROM SCRATCH, NEITHER LOADING NOR SAVING IT
+*	--cpu-bake				BAKE THE LIGHTING ON THE CPU INSTEAD OF THE GPU
+*	--prefilter-samples <n>	SAMPLES PER TEXEL OF THE ROUGHEST BAKED REFLECTIONS, 64 BY DEFAULT
+*	--output <file.json>	WHERE TO WRITE THE RESULTS, STDOUT BY DEFAULT
+*	--trace <file.json>		SAVE THE PROFILED SCOPES AS A CHROME TRACE WHEN DONE
+*/
+
+// THE SCENE ADVANCES 1/60th OF A SECOND EVERY FRAME NO MATTER HOW LONG THE FRAME TOOK
+const double BENCH_DELTA_TIME = 1.0 / 60.0;
+
+// HOW FAR THE CURSOR MOVES EACH FRAME WHILE THE CAMERA IS LOOKING AROUND
+const float BENCH_MOUSE_STEP = 4.0f;
+
+/*
+* The camera path is split into equally long segments, in each one the camera either
+* holds down a movement key or drags the mouse to look around.
+*/
+struct CameraPathSegment
+{
+	W3D::KeyCode key;
+	bool         is_looking;
+};
+
+const CameraPathSegment CAMERA_PATH[] = {
+    {W3D::KeyCode::eW, false},
+    {W3D::KeyCode::eD, false},
+    {W3D::KeyCode::eUnknown, true},
+    {W3D::KeyCode::eS, false},
+    {W3D::KeyCode::eA, false},
+};
+
+/*
+* drive_camera - sends renderer the input events that move the camera along CAMERA_PATH,
+* frame being the index of the frame about to be rendered out of frame_count.
+*/
+void drive_camera(W3D::Renderer &renderer, uint32_t frame, uint32_t frame_count)
+{
+	const uint32_t NUM_SEGMENTS       = static_cast<uint32_t>(std::size(CAMERA_PATH));
+	const uint32_t FRAMES_PER_SEGMENT = std::max(frame_count / NUM_SEGMENTS, 1u);
+
+	uint32_t                 segment_idx      = std::min(frame / FRAMES_PER_SEGMENT, NUM_SEGMENTS - 1);
+	uint32_t                 frame_in_segment = frame - segment_idx * FRAMES_PER_SEGMENT;
+	const CameraPathSegment &segment          = CAMERA_PATH[segment_idx];
+
+	// AT THE START OF A SEGMENT LET GO OF WHATEVER THE PREVIOUS ONE WAS HOLDING
+	if (frame_in_segment == 0)
+	{
+		if (segment_idx > 0)
+		{
+			const CameraPathSegment &previous = CAMERA_PATH[segment_idx - 1];
+			if (previous.is_looking)
+			{
+				renderer.process_event(W3D::MouseButtonInputEvent(W3D::MouseButton::eLeft, W3D::MouseAction::eUp, 0.0f, 0.0f));
+			}
+			else
+			{
+				renderer.process_event(W3D::KeyInputEvent(previous.key, W3D::KeyAction::eUp));
+			}
+		}
+
+		// THE CURSOR STARTS WHERE THE CAMERA THINKS IT LAST WAS, SO THE FIRST MOVE DOESN'T JUMP
+		if (segment.is_looking)
+		{
+			renderer.process_event(W3D::MouseButtonInputEvent(W3D::MouseButton::eLeft, W3D::MouseAction::eDown, 0.0f, 0.0f));
+		}
+		else
+		{
+			renderer.process_event(W3D::KeyInputEvent(segment.key, W3D::KeyAction::eDown));
+		}
+	}
+
+	if (segment.is_looking)
+	{
+		float pos = BENCH_MOUSE_STEP * (frame_in_segment + 1);
+		renderer.process_event(W3D::MouseButtonInputEvent(W3D::MouseButton::eLeft, W3D::MouseAction::eMove, pos, 0.0f));
+	}
+}
+
+int main(int argc, char **argv)
+{
+	// READ THE COMMAND LINE OPTIONS
+	W3D::RendererSettings settings;
+	uint32_t              frame_count  = 600;
+	uint32_t              warmup_count = 60;
+	std::string           output_path;
+	std::string           trace_path;
+	settings.headless         = true;
+	settings.fixed_delta_time = BENCH_DELTA_TIME;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+		{
+			frame_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--warmup") && i + 1 < argc)
+		{
+			warmup_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--size") && i + 2 < argc)
+		{
+			settings.extent.width  = static_cast<uint32_t>(std::stoul(argv[++i]));
+			settings.extent.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--window"))
+		{
+			settings.headless = false;
+		}
+		else if (!strcmp(argv[i], "--no-culling"))
+		{
+			settings.frustum_culling = false;
+		}
+		else if (!strcmp(argv[i], "--cpu-culling"))
+		{
+			settings.gpu_culling = false;
+		}
+		else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+		{
+			settings.record_threads = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--frames-in-flight") && i + 1 < argc)
+		{
+			settings.frames_in_flight = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--swapchain-images") && i + 1 < argc)
+		{
+			settings.swapchain_images = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--no-mesh-optimization"))
+		{
+			settings.optimize_meshes = false;
+		}
+		else if (!strcmp(argv[i], "--no-lods"))
+		{
+			settings.mesh_lods = false;
+		}
+		else if (!strcmp(argv[i], "--no-depth-prepass"))
+		{
+			settings.depth_prepass = false;
+		}
+		else if (!strcmp(argv[i], "--no-pipeline-cache"))
+		{
+			settings.pipeline_cache.clear();
+		}
+		else if (!strcmp(argv[i], "--no-bake-cache"))
+		{
+			settings.bake_cache.clear();
+		}
+		else if (!strcmp(argv[i], "--cpu-bake"))
+		{
+			settings.cpu_bake = true;
+		}
+		else if (!strcmp(argv[i], "--prefilter-samples") && i + 1 < argc)
+		{
+			settings.prefilter_samples = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--output") && i + 1 < argc)
+		{
+			output_path = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+		{
+			trace_path = argv[++i];
+		}
+		else
+		{
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	settings.max_frames = warmup_count + frame_count;
+
+	W3D::FrameStats stats;
+	stats.reserve(frame_count);
+
+	try
+	{
+		W3D::Renderer renderer(settings);
+
+		// THE WARMUP FRAMES FLY THE PATH TOO, BUT ONLY THE MEASURED FRAMES ARE RECORDED
+		uint32_t frame = 0;
+		drive_camera(renderer, frame, settings.max_frames);
+		renderer.set_frame_callback([&](const W3D::FrameTimings &timings) {
+			if (frame >= warmup_count)
+			{
+				stats.push(timings);
+			}
+			frame++;
+			drive_camera(renderer, frame, settings.max_frames);
+		});
+
+		renderer.start();
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!trace_path.empty() && !W3D::Profiler::write_chrome_trace(trace_path))
+	{
+		std::cerr << "Unable to write " << trace_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// REPORT THE RESULTS
+	std::string json = stats.to_json();
+	if (output_path.empty())
+	{
+		std::cout << json;
+	}
+	else
+	{
+		std::ofstream file(output_path);
+		if (!file)
+		{
+			std::cerr << "Unable to write " << output_path << std::endl;
+			return EXIT_FAILURE;
+		}
+		file << json;
+	}
+
+	return EXIT_SUCCESS;
+};
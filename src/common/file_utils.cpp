@@ -2,6 +2,7 @@
 #include "file_utils.hpp"
 
 // C/C++ LANGUAGE API TYPES
+#include <filesystem>
 #include <fstream>
 #include <unordered_map>
 
@@ -41,6 +42,33 @@ std::vector<uint8_t> read_binary(const std::string &path)
 	return buffer;
 }
 
+bool write_binary(const std::string &path, const std::vector<uint8_t> &data)
+{
+	std::string tmp_path = path + ".tmp";
+	{
+		std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+		if (!file.is_open())
+		{
+			return false;
+		}
+		file.write(reinterpret_cast<const char *>(data.data()), data.size());
+		if (!file)
+		{
+			return false;
+		}
+	}
+
+	// A RENAME REPLACES THE OLD FILE ALL AT ONCE, SO READERS SEE EITHER IT OR THE NEW ONE
+	std::error_code error;
+	std::filesystem::rename(tmp_path, path, error);
+	if (error)
+	{
+		std::filesystem::remove(tmp_path, error);
+		return false;
+	}
+	return true;
+}
+
 std::string get_file_extension(const std::string &file_name)
 {
 	auto extension_pos = file_name.find_last_of(".");
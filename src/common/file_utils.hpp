@@ -29,6 +29,13 @@ std::vector<uint8_t> read_shader_binary(const std::string &filename);
  */
 std::vector<uint8_t> read_binary(const std::string &filename);
 
+/*
+ * This function writes data to the file at path, first to a temporary file next to
+ * it that is then renamed over it, so the file is never left half written. It returns
+ * false if the file couldn't be written.
+ */
+bool write_binary(const std::string &path, const std::vector<uint8_t> &data);
+
 /*
  * This function gets and returns the file extension
  * of the file_name argument.
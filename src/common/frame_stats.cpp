@@ -0,0 +1,140 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "frame_stats.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <utility>
+
+namespace W3D
+{
+
+// NEAREST RANK PERCENTILE OF ALREADY SORTED VALUES
+static double percentile(const std::vector<double> &sorted, double p)
+{
+	size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void FrameStats::reserve(size_t count)
+{
+	samples_.reserve(count);
+}
+
+void FrameStats::push(const FrameTimings &timings)
+{
+	samples_.push_back(timings);
+}
+
+void FrameStats::clear()
+{
+	samples_.clear();
+}
+
+size_t FrameStats::size() const
+{
+	return samples_.size();
+}
+
+PhaseSummary FrameStats::summarize_values(std::vector<double> &values)
+{
+	PhaseSummary summary;
+	if (values.empty())
+	{
+		return summary;
+	}
+	std::sort(values.begin(), values.end());
+
+	summary.mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+	summary.p50  = percentile(values, 50.0);
+	summary.p95  = percentile(values, 95.0);
+	summary.p99  = percentile(values, 99.0);
+	summary.min  = values.front();
+	summary.max  = values.back();
+	return summary;
+}
+
+PhaseSummary FrameStats::summarize(double FrameTimings::*phase) const
+{
+	std::vector<double> values;
+	values.reserve(samples_.size());
+	for (const FrameTimings &timings : samples_)
+	{
+		values.push_back(timings.*phase);
+	}
+	return summarize_values(values);
+}
+
+PhaseSummary FrameStats::summarize(uint32_t FrameTimings::*count) const
+{
+	std::vector<double> values;
+	values.reserve(samples_.size());
+	for (const FrameTimings &timings : samples_)
+	{
+		values.push_back(timings.*count);
+	}
+	return summarize_values(values);
+}
+
+// WRITES summary AS A JSON OBJECT
+static void write_summary(std::stringstream &ss, const PhaseSummary &summary)
+{
+	ss << "{"
+	   << "\"mean\": " << summary.mean << ", "
+	   << "\"p50\": " << summary.p50 << ", "
+	   << "\"p95\": " << summary.p95 << ", "
+	   << "\"p99\": " << summary.p99 << ", "
+	   << "\"min\": " << summary.min << ", "
+	   << "\"max\": " << summary.max << "}";
+}
+
+std::string FrameStats::to_json() const
+{
+	const std::pair<const char *, double FrameTimings::*> PHASES[] = {
+	    {"frame", &FrameTimings::frame},
+	    {"acquire", &FrameTimings::acquire},
+	    {"fence_wait", &FrameTimings::fence_wait},
+	    {"update", &FrameTimings::update},
+	    {"record_draw_commands", &FrameTimings::record},
+	    {"sync_submit_commands", &FrameTimings::submit},
+	    {"sync_present", &FrameTimings::present},
+	    {"gpu_cull", &FrameTimings::gpu_cull},
+	    {"gpu_depth_prepass", &FrameTimings::gpu_depth_prepass},
+	    {"gpu_skybox", &FrameTimings::gpu_skybox},
+	    {"gpu_lights", &FrameTimings::gpu_lights},
+	    {"gpu_scene", &FrameTimings::gpu_scene},
+	    {"gpu_total", &FrameTimings::gpu_total},
+	};
+	const std::pair<const char *, uint32_t FrameTimings::*> COUNTS[] = {
+	    {"visible", &FrameTimings::visible},
+	    {"culled", &FrameTimings::culled},
+	};
+
+	std::stringstream ss;
+	ss << "{\n";
+	ss << "  \"frames\": " << samples_.size() << ",\n";
+	ss << "  \"unit\": \"ms\",\n";
+	ss << "  \"phases\": {\n";
+	for (size_t i = 0; i < std::size(PHASES); i++)
+	{
+		ss << "    \"" << PHASES[i].first << "\": ";
+		write_summary(ss, summarize(PHASES[i].second));
+		ss << (i + 1 < std::size(PHASES) ? ",\n" : "\n");
+	}
+	ss << "  },\n";
+	ss << "  \"counts\": {\n";
+	for (size_t i = 0; i < std::size(COUNTS); i++)
+	{
+		ss << "    \"" << COUNTS[i].first << "\": ";
+		write_summary(ss, summarize(COUNTS[i].second));
+		ss << (i + 1 < std::size(COUNTS) ? ",\n" : "\n");
+	}
+	ss << "  }\n";
+	ss << "}\n";
+	return ss.str();
+}
+
+}        // namespace W3D
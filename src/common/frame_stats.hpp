@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace W3D
+{
+
+/*
+* FrameTimings - how long, in milliseconds, one frame took on the CPU, along with how
+* that time was split between the phases of the main loop. The gpu_ times come from
+* timestamp queries, which can only be read once the GPU has finished with a frame, so
+* they belong to an earlier frame, gpu_frame, and stay 0 if the GPU can't time itself.
+* The frame also counts how many objects it drew and how many it culled as off-screen.
+*/
+struct FrameTimings
+{
+	double   frame             = 0.0;        // WHOLE main_loop ITERATION
+	double   acquire           = 0.0;        // sync_acquire_next_image, INCLUDES WAITING ON THE FENCE
+	double   fence_wait        = 0.0;        // WAITING ON THE FENCE OF THE FRAME IN FLIGHT WHOSE RESOURCES WE REUSE
+	double   record            = 0.0;        // record_draw_commands
+	double   submit            = 0.0;        // sync_submit_commands
+	double   present           = 0.0;        // sync_present
+	double   update            = 0.0;        // update
+	double   gpu_cull          = 0.0;        // CULLING AND BUILDING THE SCENE'S DRAWS ON THE GPU, 0 WHEN THE CPU CULLS
+	double   gpu_depth_prepass = 0.0;        // THE SCENE'S DEPTH PREPASS ON THE GPU, 0 WITHOUT ONE
+	double   gpu_skybox        = 0.0;        // draw_skybox ON THE GPU, AFTER THE SCENE
+	double   gpu_lights        = 0.0;        // draw_lights ON THE GPU
+	double   gpu_scene         = 0.0;        // draw_scene ON THE GPU
+	double   gpu_total         = 0.0;        // THE WHOLE RENDER PASS ON THE GPU
+	uint64_t gpu_frame         = 0;          // THE FRAME THE gpu_ TIMES WERE MEASURED ON
+	uint32_t visible           = 0;          // OBJECTS, INCLUDING LIGHTS, THAT PASSED FRUSTUM CULLING
+	uint32_t culled            = 0;          // OBJECTS, INCLUDING LIGHTS, THAT FRUSTUM CULLING SKIPPED
+};
+
+/*
+* PhaseSummary - the statistics we report for one phase over all the recorded frames.
+*/
+struct PhaseSummary
+{
+	double mean = 0.0;
+	double p50  = 0.0;
+	double p95  = 0.0;
+	double p99  = 0.0;
+	double min  = 0.0;
+	double max  = 0.0;
+};
+
+/*
+* FrameStats - collects the FrameTimings of many frames so we can summarize them, which is
+* what the benchmark uses to produce numbers that can be compared across runs. Note the
+* percentiles use the nearest rank method so they are always one of the recorded samples.
+*/
+class FrameStats
+{
+  private:
+	std::vector<FrameTimings> samples_;
+
+	/*
+	* Computes the summary of values, sorting them in the process.
+	*/
+	static PhaseSummary summarize_values(std::vector<double> &values);
+
+  public:
+	/*
+	* Makes room for count frames so recording does not allocate inside the main loop.
+	*/
+	void reserve(size_t count);
+
+	/*
+	* Records the timings of one frame.
+	*/
+	void push(const FrameTimings &timings);
+
+	/*
+	* Forgets all recorded frames.
+	*/
+	void clear();
+
+	/*
+	* Accessor method for getting the number of recorded frames.
+	*/
+	size_t size() const;
+
+	/*
+	* Computes the summary of the phase member of FrameTimings over all recorded frames,
+	* for example summarize(&FrameTimings::record).
+	*/
+	PhaseSummary summarize(double FrameTimings::*phase) const;
+
+	/*
+	* Computes the summary of the count member of FrameTimings over all recorded frames,
+	* for example summarize(&FrameTimings::culled).
+	*/
+	PhaseSummary summarize(uint32_t FrameTimings::*count) const;
+
+	/*
+	* Builds a JSON object with the frame count, the summary of every phase and the
+	* summary of every count.
+	*/
+	std::string to_json() const;
+};
+
+}        // namespace W3D
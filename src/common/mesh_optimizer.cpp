@@ -0,0 +1,649 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "mesh_optimizer.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+// OUR OWN TYPES
+#include "glm_common.hpp"
+
+namespace W3D
+{
+
+float VertexCacheStats::get_acmr() const
+{
+	return triangle_count ? static_cast<float>(cache_misses) / triangle_count : 0.0f;
+}
+
+float VertexCacheStats::get_atvr() const
+{
+	return vertex_count ? static_cast<float>(cache_misses) / vertex_count : 0.0f;
+}
+
+VertexCacheStats &VertexCacheStats::operator+=(const VertexCacheStats &other)
+{
+	triangle_count += other.triangle_count;
+	vertex_count += other.vertex_count;
+	cache_misses += other.cache_misses;
+	return *this;
+}
+
+namespace mesh_optimizer
+{
+
+const uint32_t ANALYZE_CACHE_SIZE = 16;
+
+// THE CONSTANTS OF FORSYTH'S SCORING, AS HIS ARTICLE SUGGESTS THEM
+static const uint32_t FORSYTH_CACHE_SIZE  = 32;
+static const float    CACHE_DECAY_POWER   = 1.5f;
+static const float    LAST_TRI_SCORE      = 0.75f;
+static const float    VALENCE_BOOST_SCALE = 2.0f;
+static const float    VALENCE_BOOST_POWER = 0.5f;
+static const uint32_t NO_TRIANGLE         = std::numeric_limits<uint32_t>::max();
+
+// HOW MUCH EMITTING A TRIANGLE THAT USES A VERTEX IS WORTH, VERTICES STILL IN THE CACHE ARE
+// WORTH MORE THE MORE RECENTLY THEY WERE USED, AND ONES WITH FEW TRIANGLES LEFT GET A BOOST
+// SO THEY ARE FINISHED OFF INSTEAD OF LEFT AS LONELY TRIANGLES FOR LATER
+static float forsyth_vertex_score(int32_t cache_pos, uint32_t remaining_triangles)
+{
+	if (!remaining_triangles)
+	{
+		return -1.0f;
+	}
+	float score = 0.0f;
+	if (cache_pos >= 0)
+	{
+		if (cache_pos < 3)
+		{
+			// THE LAST TRIANGLE'S VERTICES, WHICH ARE DELIBERATELY LESS ATTRACTIVE THAN THE NEXT
+			// FEW SO WE DON'T KEEP GOING BACK OVER THE SAME EDGE
+			score = LAST_TRI_SCORE;
+		}
+		else
+		{
+			float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+			score        = std::pow(1.0f - (cache_pos - 3) * scaler, CACHE_DECAY_POWER);
+		}
+	}
+	return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remaining_triangles), -VALENCE_BOOST_POWER);
+}
+
+// THE SYMMETRIC 4x4 MATRIX THAT SUMS THE SQUARED DISTANCES TO A SET OF PLANES, STORED AS ITS
+// UPPER TRIANGLE. DOUBLES BECAUSE THE SUMS CANCEL OUT A LOT
+struct Quadric
+{
+	double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+	double a11 = 0, a12 = 0, a13 = 0;
+	double a22 = 0, a23 = 0;
+	double a33 = 0;
+
+	static Quadric from_plane(const glm::dvec3 &n, double d)
+	{
+		return {n.x * n.x, n.x * n.y, n.x * n.z, n.x * d,
+		        n.y * n.y, n.y * n.z, n.y * d,
+		        n.z * n.z, n.z * d,
+		        d * d};
+	}
+
+	Quadric &operator+=(const Quadric &q)
+	{
+		a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+		a11 += q.a11, a12 += q.a12, a13 += q.a13;
+		a22 += q.a22, a23 += q.a23;
+		a33 += q.a33;
+		return *this;
+	}
+
+	// THE SUM OF THE SQUARED DISTANCES FROM p TO THE PLANES
+	double evaluate(const glm::dvec3 &p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+		       a11 * y * y + 2 * a12 * y * z + 2 * a13 * y +
+		       a22 * z * z + 2 * a23 * z +
+		       a33;
+	}
+};
+
+static glm::vec3 get_position(const std::vector<uint8_t> &vertices, uint32_t stride, uint32_t vertex)
+{
+	glm::vec3 pos;
+	std::memcpy(&pos, &vertices[static_cast<size_t>(vertex) * stride], sizeof(pos));
+	return pos;
+}
+
+VertexCacheStats analyze_vertex_cache(const std::vector<uint32_t> &indices, uint32_t vertex_count, uint32_t cache_size)
+{
+	VertexCacheStats stats;
+	stats.triangle_count = indices.size() / 3;
+
+	// A VERTEX IS IN THE FIFO IF FEWER THAN cache_size MISSES HAPPENED SINCE IT WAS LAST SHADED
+	std::vector<size_t> shaded_at(vertex_count, 0);
+	std::vector<bool>   is_used(vertex_count, false);
+	size_t              time = cache_size + 1;
+	for (uint32_t idx : indices)
+	{
+		if (time - shaded_at[idx] > cache_size)
+		{
+			shaded_at[idx] = time++;
+			stats.cache_misses++;
+		}
+		if (!is_used[idx])
+		{
+			is_used[idx] = true;
+			stats.vertex_count++;
+		}
+	}
+	return stats;
+}
+
+uint32_t weld_vertices(std::vector<uint8_t> &vertices, uint32_t stride, std::vector<uint32_t> &indices)
+{
+	uint32_t vertex_count = static_cast<uint32_t>(vertices.size() / stride);
+
+	// THE MAP IS KEYED BY THE INDEX OF A KEPT VERTEX BUT HASHES AND COMPARES ITS BYTES
+	const uint8_t *p_data = vertices.data();
+	auto hash = [&](uint32_t vertex) {
+		// FNV-1a
+		size_t         h      = 14695981039346656037ull;
+		const uint8_t *p_byte = p_data + static_cast<size_t>(vertex) * stride;
+		for (uint32_t i = 0; i < stride; i++)
+		{
+			h = (h ^ p_byte[i]) * 1099511628211ull;
+		}
+		return h;
+	};
+	auto is_equal = [&](uint32_t lhs, uint32_t rhs) {
+		return !std::memcmp(p_data + static_cast<size_t>(lhs) * stride, p_data + static_cast<size_t>(rhs) * stride, stride);
+	};
+	std::unordered_map<uint32_t, uint32_t, decltype(hash), decltype(is_equal)> welded(vertex_count, hash, is_equal);
+
+	// EVERY VERTEX IS MAPPED TO THE FIRST ONE WITH THE SAME BYTES, WHICH KEEP THEIR ORDER
+	std::vector<uint32_t> remap(vertex_count);
+	uint32_t              kept_count = 0;
+	for (uint32_t i = 0; i < vertex_count; i++)
+	{
+		auto it = welded.find(i);
+		if (it != welded.end())
+		{
+			remap[i] = it->second;
+			continue;
+		}
+		welded.emplace(i, kept_count);
+		remap[i] = kept_count++;
+	}
+
+	std::vector<uint8_t> kept(static_cast<size_t>(kept_count) * stride);
+	for (uint32_t i = 0; i < vertex_count; i++)
+	{
+		std::memcpy(&kept[static_cast<size_t>(remap[i]) * stride], &vertices[static_cast<size_t>(i) * stride], stride);
+	}
+	vertices = std::move(kept);
+
+	for (uint32_t &idx : indices)
+	{
+		idx = remap[idx];
+	}
+	return kept_count;
+}
+
+void optimize_vertex_cache(std::vector<uint32_t> &indices, uint32_t vertex_count)
+{
+	uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+	if (!triangle_count)
+	{
+		return;
+	}
+
+	// EVERY VERTEX'S TRIANGLES, THE ONES NOT EMITTED YET ARE KEPT AT THE FRONT OF ITS RANGE
+	std::vector<uint32_t> remaining(vertex_count, 0);
+	for (uint32_t idx : indices)
+	{
+		remaining[idx]++;
+	}
+	std::vector<uint32_t> first_adjacent(vertex_count + 1, 0);
+	for (uint32_t v = 0; v < vertex_count; v++)
+	{
+		first_adjacent[v + 1] = first_adjacent[v] + remaining[v];
+	}
+	std::vector<uint32_t> adjacent(indices.size());
+	std::vector<uint32_t> fill(first_adjacent.begin(), first_adjacent.end() - 1);
+	for (uint32_t i = 0; i < indices.size(); i++)
+	{
+		adjacent[fill[indices[i]]++] = i / 3;
+	}
+
+	std::vector<int32_t> cache_pos(vertex_count, -1);
+	std::vector<float>   vertex_scores(vertex_count);
+	std::vector<float>   triangle_scores(triangle_count, 0.0f);
+	std::vector<bool>    is_emitted(triangle_count, false);
+	for (uint32_t v = 0; v < vertex_count; v++)
+	{
+		vertex_scores[v] = forsyth_vertex_score(-1, remaining[v]);
+	}
+	for (uint32_t i = 0; i < indices.size(); i++)
+	{
+		triangle_scores[i / 3] += vertex_scores[indices[i]];
+	}
+
+	uint32_t best_triangle = static_cast<uint32_t>(std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin());
+	uint32_t scan_cursor   = 0;
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> new_cache;
+	std::vector<uint32_t> optimized;
+	cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	new_cache.reserve(FORSYTH_CACHE_SIZE + 3);
+	optimized.reserve(indices.size());
+	for (uint32_t emitted = 0; emitted < triangle_count; emitted++)
+	{
+		// NOTHING IN THE CACHE HAS TRIANGLES LEFT, SO START OVER WITH THE NEXT ONE NOT EMITTED
+		// YET INSTEAD OF SEARCHING ALL OF THEM FOR THE BEST, WHICH WOULD TAKE QUADRATIC TIME
+		if (best_triangle == NO_TRIANGLE)
+		{
+			while (is_emitted[scan_cursor])
+			{
+				scan_cursor++;
+			}
+			best_triangle = scan_cursor;
+		}
+
+		const uint32_t *p_triangle = &indices[best_triangle * 3];
+		is_emitted[best_triangle]  = true;
+		new_cache.clear();
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			uint32_t v = p_triangle[i];
+			optimized.push_back(v);
+
+			// TAKE THE TRIANGLE OUT OF ITS VERTICES' RANGES
+			uint32_t *p_first = &adjacent[first_adjacent[v]];
+			uint32_t *p_found = std::find(p_first, p_first + remaining[v], best_triangle);
+			std::swap(*p_found, p_first[--remaining[v]]);
+
+			if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end())
+			{
+				new_cache.push_back(v);
+			}
+		}
+
+		// THE TRIANGLE'S VERTICES MOVE TO THE FRONT OF THE LRU CACHE, PUSHING THE OLDEST OUT
+		for (uint32_t v : cache)
+		{
+			if (std::find(new_cache.begin(), new_cache.end(), v) == new_cache.end())
+			{
+				new_cache.push_back(v);
+			}
+		}
+		std::swap(cache, new_cache);
+
+		// THE SCORES OF EVERY VERTEX WHOSE PLACE CHANGED, AND OF THEIR TRIANGLES, CHANGE WITH IT
+		for (uint32_t i = 0; i < cache.size(); i++)
+		{
+			uint32_t v       = cache[i];
+			cache_pos[v]     = i < FORSYTH_CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+			float score      = forsyth_vertex_score(cache_pos[v], remaining[v]);
+			float delta      = score - vertex_scores[v];
+			vertex_scores[v] = score;
+			for (uint32_t j = first_adjacent[v]; j < first_adjacent[v] + remaining[v]; j++)
+			{
+				triangle_scores[adjacent[j]] += delta;
+			}
+		}
+		if (cache.size() > FORSYTH_CACHE_SIZE)
+		{
+			cache.resize(FORSYTH_CACHE_SIZE);
+		}
+
+		// THE NEXT TRIANGLE IS THE BEST ONE THAT USES SOMETHING IN THE CACHE
+		best_triangle    = NO_TRIANGLE;
+		float best_score = -std::numeric_limits<float>::max();
+		for (uint32_t v : cache)
+		{
+			for (uint32_t j = first_adjacent[v]; j < first_adjacent[v] + remaining[v]; j++)
+			{
+				uint32_t triangle = adjacent[j];
+				if (triangle_scores[triangle] > best_score)
+				{
+					best_score    = triangle_scores[triangle];
+					best_triangle = triangle;
+				}
+			}
+		}
+	}
+
+	indices = std::move(optimized);
+}
+
+void optimize_overdraw(std::vector<uint32_t> &indices, const std::vector<uint8_t> &vertices, uint32_t stride)
+{
+	uint32_t triangle_count = static_cast<uint32_t>(indices.size() / 3);
+	uint32_t vertex_count   = static_cast<uint32_t>(vertices.size() / stride);
+	if (triangle_count < 2)
+	{
+		return;
+	}
+
+	// A NEW RUN STARTS WHEREVER A TRIANGLE MISSES THE FIFO CACHE WITH ALL OF ITS VERTICES, SO
+	// MOVING RUNS AROUND ONLY COSTS THE MISSES THAT WERE GOING TO HAPPEN ANYWAY
+	std::vector<uint32_t> run_starts;
+	std::vector<size_t>   shaded_at(vertex_count, 0);
+	size_t                time = ANALYZE_CACHE_SIZE + 1;
+	for (uint32_t t = 0; t < triangle_count; t++)
+	{
+		uint32_t misses = 0;
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			uint32_t v = indices[t * 3 + i];
+			if (time - shaded_at[v] > ANALYZE_CACHE_SIZE)
+			{
+				shaded_at[v] = time++;
+				misses++;
+			}
+		}
+		if (t == 0 || misses == 3)
+		{
+			run_starts.push_back(t);
+		}
+	}
+	run_starts.push_back(triangle_count);
+	if (run_starts.size() < 3)
+	{
+		return;
+	}
+
+	// EVERY RUN'S AREA WEIGHTED CENTRE AND NORMAL, AND THE WHOLE MESH'S CENTRE
+	struct Run
+	{
+		uint32_t  first_triangle;
+		uint32_t  triangle_count;
+		glm::vec3 centroid;
+		glm::vec3 normal;
+		float     sort_key;
+	};
+	std::vector<Run> runs(run_starts.size() - 1);
+	glm::vec3        mesh_centroid(0.0f);
+	float            mesh_area = 0.0f;
+	for (size_t r = 0; r < runs.size(); r++)
+	{
+		Run &run           = runs[r];
+		run.first_triangle = run_starts[r];
+		run.triangle_count = run_starts[r + 1] - run_starts[r];
+		run.centroid       = glm::vec3(0.0f);
+		run.normal         = glm::vec3(0.0f);
+		float run_area     = 0.0f;
+		for (uint32_t t = run.first_triangle; t < run.first_triangle + run.triangle_count; t++)
+		{
+			glm::vec3 p0     = get_position(vertices, stride, indices[t * 3]);
+			glm::vec3 p1     = get_position(vertices, stride, indices[t * 3 + 1]);
+			glm::vec3 p2     = get_position(vertices, stride, indices[t * 3 + 2]);
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float     area   = glm::length(normal);
+			run.centroid += (p0 + p1 + p2) * (area / 3.0f);
+			run.normal += normal;
+			run_area += area;
+		}
+		mesh_centroid += run.centroid;
+		mesh_area += run_area;
+		run.centroid = run_area > 0.0f ? run.centroid / run_area : glm::vec3(0.0f);
+	}
+	mesh_centroid = mesh_area > 0.0f ? mesh_centroid / mesh_area : glm::vec3(0.0f);
+
+	// RUNS FACING OUTWARD FROM FURTHEST AWAY GO FIRST
+	for (Run &run : runs)
+	{
+		float length = glm::length(run.normal);
+		run.sort_key = length > 0.0f ? glm::dot(run.centroid - mesh_centroid, run.normal / length) : 0.0f;
+	}
+	std::stable_sort(runs.begin(), runs.end(), [](const Run &lhs, const Run &rhs) {
+		return lhs.sort_key > rhs.sort_key;
+	});
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indices.size());
+	for (const Run &run : runs)
+	{
+		auto first = indices.begin() + run.first_triangle * 3;
+		sorted.insert(sorted.end(), first, first + run.triangle_count * 3);
+	}
+	indices = std::move(sorted);
+}
+
+uint32_t optimize_vertex_fetch(std::vector<uint8_t> &vertices, uint32_t stride, std::vector<uint32_t> &indices)
+{
+	const uint32_t UNUSED       = std::numeric_limits<uint32_t>::max();
+	uint32_t       vertex_count = static_cast<uint32_t>(vertices.size() / stride);
+
+	std::vector<uint32_t> remap(vertex_count, UNUSED);
+	std::vector<uint8_t>  fetch_ordered;
+	fetch_ordered.reserve(vertices.size());
+	uint32_t used_count = 0;
+	for (uint32_t &idx : indices)
+	{
+		if (remap[idx] == UNUSED)
+		{
+			remap[idx] = used_count++;
+			fetch_ordered.insert(fetch_ordered.end(), vertices.begin() + static_cast<size_t>(idx) * stride, vertices.begin() + static_cast<size_t>(idx + 1) * stride);
+		}
+		idx = remap[idx];
+	}
+	vertices = std::move(fetch_ordered);
+	return used_count;
+}
+
+std::vector<uint32_t> simplify(const std::vector<uint32_t> &indices, const std::vector<uint8_t> &vertices, uint32_t stride, size_t target_idx_count, float max_error)
+{
+	uint32_t              vertex_count = static_cast<uint32_t>(vertices.size() / stride);
+	std::vector<uint32_t> result       = indices;
+	if (result.size() <= target_idx_count || !vertex_count)
+	{
+		return result;
+	}
+
+	std::vector<glm::vec3> positions(vertex_count);
+	glm::vec3              bounds_min(std::numeric_limits<float>::max());
+	glm::vec3              bounds_max(std::numeric_limits<float>::lowest());
+	for (uint32_t v = 0; v < vertex_count; v++)
+	{
+		positions[v] = get_position(vertices, stride, v);
+		bounds_min   = glm::min(bounds_min, positions[v]);
+		bounds_max   = glm::max(bounds_max, positions[v]);
+	}
+	double max_cost = glm::length(bounds_max - bounds_min) * max_error;
+	max_cost *= max_cost;
+
+	// EVERY VERTEX STARTS WITH THE PLANES OF ITS TRIANGLES, COLLAPSING A VERTEX INTO ANOTHER
+	// HANDS ITS PLANES OVER SO THE ERROR KEEPS ADDING UP
+	std::vector<Quadric> quadrics(vertex_count);
+	for (size_t i = 0; i + 2 < result.size(); i += 3)
+	{
+		glm::dvec3 p0     = positions[result[i]];
+		glm::dvec3 p1     = positions[result[i + 1]];
+		glm::dvec3 p2     = positions[result[i + 2]];
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double     length = glm::length(normal);
+		if (length <= 0.0)
+		{
+			continue;
+		}
+		normal /= length;
+		Quadric quadric = Quadric::from_plane(normal, -glm::dot(normal, p0));
+		for (size_t j = 0; j < 3; j++)
+		{
+			quadrics[result[i + j]] += quadric;
+		}
+	}
+
+	// AN EDGE ONLY ONE TRIANGLE HAS IS ON A BORDER, ITS VERTICES ARE LOCKED
+	std::vector<bool>                      is_locked(vertex_count, false);
+	std::unordered_map<uint64_t, uint32_t> edge_counts;
+	auto edge_key = [](uint32_t a, uint32_t b) {
+		return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b);
+	};
+	for (size_t i = 0; i + 2 < result.size(); i += 3)
+	{
+		for (size_t j = 0; j < 3; j++)
+		{
+			edge_counts[edge_key(result[i + j], result[i + (j + 1) % 3])]++;
+		}
+	}
+	for (const auto &[key, count] : edge_counts)
+	{
+		if (count == 1)
+		{
+			is_locked[key >> 32]        = true;
+			is_locked[key & 0xFFFFFFFF] = true;
+		}
+	}
+
+	struct Collapse
+	{
+		uint32_t from;
+		uint32_t to;
+		double   cost;
+	};
+	std::vector<Collapse> collapses;
+	std::vector<uint32_t> first_adjacent(vertex_count + 1);
+	std::vector<uint32_t> adjacent;
+	std::vector<uint32_t> collapse_to(vertex_count);
+	std::vector<bool>     is_touched(vertex_count);
+
+	// EVERY PASS COLLAPSES AS MANY EDGES AS IT CAN WITHOUT ANY TWO OF THEM SHARING A TRIANGLE,
+	// SO EACH COLLAPSE ONLY HAS TO BE CHECKED AGAINST THE MESH AS IT WAS AT THE START OF THE PASS
+	size_t triangle_count = result.size() / 3;
+	size_t target_count   = target_idx_count / 3;
+	while (triangle_count > target_count)
+	{
+		// WHICH TRIANGLES EVERY VERTEX IS IN
+		std::fill(first_adjacent.begin(), first_adjacent.end(), 0);
+		for (uint32_t idx : result)
+		{
+			first_adjacent[idx + 1]++;
+		}
+		for (uint32_t v = 0; v < vertex_count; v++)
+		{
+			first_adjacent[v + 1] += first_adjacent[v];
+		}
+		adjacent.resize(result.size());
+		std::vector<uint32_t> fill(first_adjacent.begin(), first_adjacent.end() - 1);
+		for (size_t i = 0; i < result.size(); i++)
+		{
+			adjacent[fill[result[i]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		// EVERY EDGE CAN COLLAPSE EITHER WAY, THE VERTEX THAT STAYS KEEPS ITS POSITION SO THE
+		// LODS CAN SHARE THE VERTICES
+		collapses.clear();
+		for (size_t i = 0; i + 2 < result.size(); i += 3)
+		{
+			for (size_t j = 0; j < 3; j++)
+			{
+				uint32_t a = result[i + j];
+				uint32_t b = result[i + (j + 1) % 3];
+				if (a == b)
+				{
+					continue;
+				}
+				Quadric quadric = quadrics[a];
+				quadric += quadrics[b];
+				if (!is_locked[a])
+				{
+					collapses.push_back({a, b, quadric.evaluate(positions[b])});
+				}
+				if (!is_locked[b])
+				{
+					collapses.push_back({b, a, quadric.evaluate(positions[a])});
+				}
+			}
+		}
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse &lhs, const Collapse &rhs) {
+			return lhs.cost < rhs.cost;
+		});
+
+		std::iota(collapse_to.begin(), collapse_to.end(), 0u);
+		std::fill(is_touched.begin(), is_touched.end(), false);
+		size_t removed_count = 0;
+		for (const Collapse &collapse : collapses)
+		{
+			if (collapse.cost > max_cost || triangle_count - removed_count <= target_count)
+			{
+				break;
+			}
+			if (is_touched[collapse.from] || is_touched[collapse.to])
+			{
+				continue;
+			}
+
+			// THE TRIANGLES THAT MOVE WITH from MUST NOT FLIP OVER OR COLLAPSE TO NOTHING
+			bool   is_valid = true;
+			size_t removed  = 0;
+			for (uint32_t j = first_adjacent[collapse.from]; j < first_adjacent[collapse.from + 1] && is_valid; j++)
+			{
+				const uint32_t *p_triangle = &result[adjacent[j] * 3];
+				if (p_triangle[0] == collapse.to || p_triangle[1] == collapse.to || p_triangle[2] == collapse.to)
+				{
+					removed++;
+					continue;
+				}
+				glm::vec3 old_p[3];
+				glm::vec3 new_p[3];
+				for (size_t k = 0; k < 3; k++)
+				{
+					old_p[k] = positions[p_triangle[k]];
+					new_p[k] = p_triangle[k] == collapse.from ? positions[collapse.to] : old_p[k];
+				}
+				glm::vec3 old_normal = glm::cross(old_p[1] - old_p[0], old_p[2] - old_p[0]);
+				glm::vec3 new_normal = glm::cross(new_p[1] - new_p[0], new_p[2] - new_p[0]);
+				is_valid             = glm::dot(old_normal, new_normal) > 0.0f;
+			}
+			if (!is_valid)
+			{
+				continue;
+			}
+
+			collapse_to[collapse.from] = collapse.to;
+			quadrics[collapse.to] += quadrics[collapse.from];
+			removed_count += removed;
+			for (uint32_t j = first_adjacent[collapse.from]; j < first_adjacent[collapse.from + 1]; j++)
+			{
+				const uint32_t *p_triangle = &result[adjacent[j] * 3];
+				for (size_t k = 0; k < 3; k++)
+				{
+					is_touched[p_triangle[k]] = true;
+				}
+			}
+		}
+		if (!removed_count)
+		{
+			break;
+		}
+
+		// MOVE THE COLLAPSED VERTICES AND DROP THE TRIANGLES THAT LOST AN EDGE
+		size_t kept = 0;
+		for (size_t i = 0; i + 2 < result.size(); i += 3)
+		{
+			uint32_t a = collapse_to[result[i]];
+			uint32_t b = collapse_to[result[i + 1]];
+			uint32_t c = collapse_to[result[i + 2]];
+			if (a != b && b != c && c != a)
+			{
+				result[kept++] = a;
+				result[kept++] = b;
+				result[kept++] = c;
+			}
+		}
+		result.resize(kept);
+		triangle_count = kept / 3;
+	}
+
+	return result;
+}
+
+}        // namespace mesh_optimizer
+
+}        // namespace W3D
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace W3D
+{
+
+/*
+* VertexCacheStats - how well an index list uses the GPU's post-transform vertex cache,
+* measured by running it through a FIFO cache of a typical size. ACMR is the vertices
+* shaded per triangle, from 3 down to about 0.5 for a regular grid, and ATVR is the
+* vertices shaded per vertex of the mesh, where 1 means each was shaded only once.
+*/
+struct VertexCacheStats
+{
+	size_t triangle_count = 0;
+	size_t vertex_count   = 0;        // VERTICES THE INDICES ACTUALLY REFERENCE
+	size_t cache_misses   = 0;        // VERTICES THE GPU HAD TO SHADE
+
+	float get_acmr() const;
+	float get_atvr() const;
+
+	/*
+	* Adds other's counts to these, so the stats of many meshes can be summed up.
+	*/
+	VertexCacheStats &operator+=(const VertexCacheStats &other);
+};
+
+/*
+* The helpers below make up the load time optimization of a triangle list, they are meant
+* to be run in the order they are declared in, simplify's results can go through
+* optimize_vertex_cache again as they share the vertices. Vertices are opaque blobs of
+* stride bytes, except for optimize_overdraw and simplify which need every vertex to start
+* with its position as three floats, as all of sg::VertexFormat's do.
+*/
+namespace mesh_optimizer
+{
+
+// THE FIFO CACHE SIZE analyze_vertex_cache MEASURES WITH, ABOUT WHAT CURRENT GPUS HAVE
+extern const uint32_t ANALYZE_CACHE_SIZE;
+
+/*
+* Runs indices through a FIFO cache of cache_size vertices and counts what it would shade.
+*/
+VertexCacheStats analyze_vertex_cache(const std::vector<uint32_t> &indices, uint32_t vertex_count, uint32_t cache_size = ANALYZE_CACHE_SIZE);
+
+/*
+* Merges vertices that are the same byte for byte, which glTF exporters leave behind a lot,
+* and points indices at the ones that are kept. Returns the new vertex count, vertices is
+* shrunk to match.
+*/
+uint32_t weld_vertices(std::vector<uint8_t> &vertices, uint32_t stride, std::vector<uint32_t> &indices);
+
+/*
+* Reorders the triangles of indices so the vertices they share are still in the cache when
+* they're used again, with Tom Forsyth's linear speed vertex cache optimisation.
+*/
+void optimize_vertex_cache(std::vector<uint32_t> &indices, uint32_t vertex_count);
+
+/*
+* Reorders the runs of triangles optimize_vertex_cache left behind so the ones facing away
+* from the centre of the mesh come first, they are the most likely to hide the rest, which
+* then fails the depth test instead of being shaded. The runs are split where the cache is
+* cold anyway, so the vertex cache doesn't get much worse.
+*/
+void optimize_overdraw(std::vector<uint32_t> &indices, const std::vector<uint8_t> &vertices, uint32_t stride);
+
+/*
+* Reorders vertices into the order indices first use them in, so the vertex fetches walk
+* through memory, and drops the ones no index uses. Returns the new vertex count.
+*/
+uint32_t optimize_vertex_fetch(std::vector<uint8_t> &vertices, uint32_t stride, std::vector<uint32_t> &indices);
+
+/*
+* Returns a coarser version of the triangle list indices that uses the same vertices, made
+* by collapsing edges, cheapest first by their quadric error, until it has no more than
+* target_idx_count indices or every collapse left would move the surface further than
+* max_error, which is relative to the diagonal of the mesh's bounding box. Vertices on
+* borders, which includes the seams where welding kept vertices apart, never move so the
+* outline and the seams stay where they were.
+*/
+std::vector<uint32_t> simplify(const std::vector<uint32_t> &indices, const std::vector<uint8_t> &vertices, uint32_t stride, size_t target_idx_count, float max_error);
+
+}        // namespace mesh_optimizer
+
+}        // namespace W3D
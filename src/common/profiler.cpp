@@ -0,0 +1,95 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "profiler.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// OUR OWN TYPES
+#include "logging.hpp"
+
+namespace W3D
+{
+
+// ALL TIMES ARE RELATIVE TO WHEN THE PROGRAM STARTED
+static const Timer::Clock::time_point PROFILER_EPOCH = Timer::Clock::now();
+
+// EVERY RING EVER MADE, THEY OUTLIVE THEIR THREADS SO THEIR SCOPES CAN STILL BE SAVED. THE
+// MUTEX IS ONLY TAKEN WHEN A THREAD RECORDS ITS FIRST SCOPE AND WHEN SAVING
+static std::mutex                                  rings_mutex;
+static std::vector<std::unique_ptr<Profiler::Ring>> rings;
+
+static uint64_t to_profiler_ns(Timer::Clock::time_point time)
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time - PROFILER_EPOCH).count());
+}
+
+Profiler::Ring &Profiler::get_thread_ring()
+{
+	thread_local Ring *p_ring = nullptr;
+	if (!p_ring)
+	{
+		std::lock_guard<std::mutex> lock(rings_mutex);
+		rings.push_back(std::make_unique<Ring>());
+		p_ring            = rings.back().get();
+		p_ring->thread_id = static_cast<uint32_t>(rings.size() - 1);
+	}
+	return *p_ring;
+}
+
+void Profiler::record(const char *name, Timer::Clock::time_point begin, Timer::Clock::time_point end)
+{
+	Ring    &ring = get_thread_ring();
+	uint64_t head = ring.head.load(std::memory_order_relaxed);
+
+	ring.events[head % RING_CAPACITY] = {
+	    .name  = name,
+	    .begin = to_profiler_ns(begin),
+	    .end   = to_profiler_ns(end),
+	};
+
+	// PUBLISH THE EVENT ONLY ONCE IT HAS BEEN WRITTEN
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+bool Profiler::write_chrome_trace(const std::string &path)
+{
+#if !W3D_PROFILING
+	LOGW("Profiling was compiled out of this build, {} will have no scopes", path);
+#endif
+
+	std::ofstream file(path);
+	if (!file)
+	{
+		return false;
+	}
+
+	// chrome://tracing WANTS MICROSECONDS
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool is_first = true;
+
+	std::lock_guard<std::mutex> lock(rings_mutex);
+	for (const std::unique_ptr<Ring> &p_ring : rings)
+	{
+		uint64_t head  = p_ring->head.load(std::memory_order_acquire);
+		uint64_t count = std::min<uint64_t>(head, RING_CAPACITY);
+		for (uint64_t i = head - count; i < head; i++)
+		{
+			const Event &event = p_ring->events[i % RING_CAPACITY];
+			file << (is_first ? "\n" : ",\n")
+			     << "{\"name\":\"" << event.name << "\",\"cat\":\"w3d\",\"ph\":\"X\""
+			     << ",\"ts\":" << event.begin / 1000.0
+			     << ",\"dur\":" << (event.end - event.begin) / 1000.0
+			     << ",\"pid\":0,\"tid\":" << p_ring->thread_id << "}";
+			is_first = false;
+		}
+	}
+	file << "\n]}\n";
+
+	return static_cast<bool>(file);
+}
+
+}        // namespace W3D
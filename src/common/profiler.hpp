@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "timer.hpp"
+
+/*
+* W3D_PROFILING turns the profiling macros below on or off. Unless the build says otherwise
+* it is on in debug builds and off in release builds, where the macros expand to nothing so
+* the hot path pays nothing for being instrumented.
+*/
+#ifndef W3D_PROFILING
+#	ifdef NDEBUG
+#		define W3D_PROFILING 0
+#	else
+#		define W3D_PROFILING 1
+#	endif
+#endif
+
+#define W3D_PROFILE_CONCAT_INNER(a, b) a##b
+#define W3D_PROFILE_CONCAT(a, b) W3D_PROFILE_CONCAT_INNER(a, b)
+
+#if W3D_PROFILING
+// TIMES EVERYTHING FROM HERE TO THE END OF THE ENCLOSING SCOPE, name MUST BE A STRING LITERAL
+#	define W3D_PROFILE_SCOPE(name) ::W3D::ProfileScope W3D_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+// TIMES THE REST OF THE ENCLOSING FUNCTION, NAMED AFTER IT
+#	define W3D_PROFILE_FUNCTION() W3D_PROFILE_SCOPE(__func__)
+#else
+#	define W3D_PROFILE_SCOPE(name)
+#	define W3D_PROFILE_FUNCTION()
+#endif
+
+namespace W3D
+{
+
+/*
+* Profiler - collects the scopes timed by the W3D_PROFILE_ macros so they can be saved as a
+* Chrome trace, which can be opened in chrome://tracing or https://ui.perfetto.dev. Every
+* thread records into its own fixed size ring buffer, so recording takes no locks, and once
+* a ring is full the oldest scopes are overwritten.
+*/
+class Profiler
+{
+  public:
+	// NUMBER OF SCOPES EACH THREAD REMEMBERS
+	static const uint32_t RING_CAPACITY = 1u << 16;
+
+	// ONE TIMED SCOPE, THE TIMES ARE NANOSECONDS SINCE THE PROFILER STARTED
+	struct Event
+	{
+		const char *name;
+		uint64_t    begin;
+		uint64_t    end;
+	};
+
+	/*
+	* A ring of events only ever written by the thread that owns it, head counts every event
+	* that was ever written so readers can tell which slots hold valid events.
+	*/
+	struct Ring
+	{
+		Event                 events[RING_CAPACITY];
+		std::atomic<uint64_t> head{0};
+		uint32_t              thread_id = 0;
+	};
+
+	/*
+	* Records a scope named name that ran from begin to end on the calling thread.
+	*/
+	static void record(const char *name, Timer::Clock::time_point begin, Timer::Clock::time_point end);
+
+	/*
+	* Saves everything recorded so far, on all threads, to path as Chrome trace JSON. Note
+	* threads should be done recording, i.e. call this at shutdown, or scopes recorded while
+	* saving may be torn. Returns false if the file couldn't be written.
+	*/
+	static bool write_chrome_trace(const std::string &path);
+
+  private:
+	/*
+	* Gets the calling thread's ring, making and registering it the first time.
+	*/
+	static Ring &get_thread_ring();
+};
+
+/*
+* ProfileScope - the RAII helper behind W3D_PROFILE_SCOPE, it takes the time when it's
+* constructed and records the scope when it's destroyed.
+*/
+class ProfileScope
+{
+  private:
+	const char              *name_;
+	Timer::Clock::time_point begin_;
+
+  public:
+	ProfileScope(const char *name) :
+	    name_(name),
+	    begin_(Timer::Clock::now())
+	{
+	}
+
+	~ProfileScope()
+	{
+		Profiler::record(name_, begin_, Timer::Clock::now());
+	}
+
+	// THESE ARE DEACTIVATED
+	ProfileScope(const ProfileScope &)            = delete;
+	ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+}        // namespace W3D
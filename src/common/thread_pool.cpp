@@ -0,0 +1,115 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "thread_pool.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+
+namespace W3D
+{
+
+ThreadPool::ThreadPool(uint32_t thread_count)
+{
+	if (thread_count == 0)
+	{
+		thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	workers_.reserve(thread_count - 1);
+	for (uint32_t i = 1; i < thread_count; i++)
+	{
+		workers_.emplace_back(&ThreadPool::worker_main, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		is_stopping_ = true;
+	}
+	work_cv_.notify_all();
+	for (std::thread &worker : workers_)
+	{
+		worker.join();
+	}
+}
+
+uint32_t ThreadPool::get_thread_count() const
+{
+	return static_cast<uint32_t>(workers_.size()) + 1;
+}
+
+void ThreadPool::run_tasks(const std::function<void(uint32_t)> &task, uint32_t task_count)
+{
+	// EVERY THREAD GRABS THE NEXT INDEX NOBODY HAS TAKEN YET, SO FAST THREADS DO MORE
+	for (uint32_t idx = next_task_.fetch_add(1); idx < task_count; idx = next_task_.fetch_add(1))
+	{
+		task(idx);
+	}
+}
+
+void ThreadPool::worker_main()
+{
+	uint64_t last_generation = 0;
+	while (true)
+	{
+		const std::function<void(uint32_t)> *p_task;
+		uint32_t                             task_count;
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			work_cv_.wait(lock, [&] { return is_stopping_ || generation_ != last_generation; });
+			if (is_stopping_)
+			{
+				return;
+			}
+			last_generation = generation_;
+			p_task          = p_task_;
+			task_count      = task_count_;
+		}
+
+		run_tasks(*p_task, task_count);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			finished_workers_++;
+		}
+		done_cv_.notify_one();
+	}
+}
+
+void ThreadPool::parallel_for(uint32_t count, const std::function<void(uint32_t idx)> &task)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	// NOT WORTH WAKING ANYONE UP FOR
+	if (workers_.empty() || count == 1)
+	{
+		for (uint32_t idx = 0; idx < count; idx++)
+		{
+			task(idx);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		p_task_           = &task;
+		task_count_       = count;
+		finished_workers_ = 0;
+		next_task_.store(0);
+		generation_++;
+	}
+	work_cv_.notify_all();
+
+	run_tasks(task, count);
+
+	// EVERY WORKER TAKES PART IN EVERY LOOP, EVEN IF IT WAKES UP TOO LATE TO FIND ANY WORK,
+	// SO WAITING FOR ALL OF THEM MEANS NONE CAN STILL BE LOOKING AT task
+	std::unique_lock<std::mutex> lock(mutex_);
+	done_cv_.wait(lock, [&] { return finished_workers_ == workers_.size(); });
+}
+
+}        // namespace W3D
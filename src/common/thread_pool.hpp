@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace W3D
+{
+
+/*
+* ThreadPool - a fixed set of worker threads that split up the iterations of a loop, which
+* is how we spread work like recording command buffers over all the CPU's cores. The thread
+* that runs the loop works on it too, so a pool with a thread count of 1 has no workers and
+* simply runs the loop itself.
+*/
+class ThreadPool
+{
+  private:
+	std::vector<std::thread>             workers_;
+	std::mutex                           mutex_;
+	std::condition_variable              work_cv_;        // WAKES THE WORKERS WHEN A LOOP STARTS
+	std::condition_variable              done_cv_;        // WAKES THE CALLER WHEN A LOOP IS FINISHED
+	const std::function<void(uint32_t)> *p_task_          = nullptr;
+	uint32_t                             task_count_      = 0;
+	std::atomic<uint32_t>                next_task_{0};
+	uint32_t                             finished_workers_ = 0;        // WORKERS DONE WITH THE CURRENT LOOP
+	uint64_t                             generation_       = 0;        // COUNTS LOOPS SO WORKERS RUN EACH ONE ONCE
+	bool                                 is_stopping_      = false;
+
+	/*
+	* Runs iterations of the loop of task_count calls to task until there are none left.
+	*/
+	void run_tasks(const std::function<void(uint32_t)> &task, uint32_t task_count);
+
+	/*
+	* What every worker thread runs, it sleeps until there is a loop to help with.
+	*/
+	void worker_main();
+
+  public:
+	/*
+	* Starts thread_count - 1 workers, a thread_count of 0 uses every hardware thread.
+	*/
+	ThreadPool(uint32_t thread_count = 0);
+
+	/*
+	* Stops and joins all the workers.
+	*/
+	~ThreadPool();
+
+	// THESE ARE DEACTIVATED
+	ThreadPool(const ThreadPool &)            = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/*
+	* Accessor method for getting how many threads, including the caller's, run loops.
+	*/
+	uint32_t get_thread_count() const;
+
+	/*
+	* Calls task once for every index from 0 to count - 1, spread over all the threads,
+	* and returns when every call has finished. Note the order of the calls, and which
+	* thread makes each, is unspecified, and only one thread may run a loop at a time.
+	*/
+	void parallel_for(uint32_t count, const std::function<void(uint32_t idx)> &task);
+};
+
+}        // namespace W3D
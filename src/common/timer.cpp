@@ -9,6 +9,7 @@ void Timer::start() {
     if (!running_) {
         running_ = true;
         start_time_ = Clock::now();
+        previous_tick_ = start_time_;
     }
 }
 
@@ -41,7 +41,8 @@ class Timer {
 	bool is_running() const;
 
     /*
-    * Starts this timer, getting the latest time and setting it to running.
+    * Starts this timer, getting the latest time and setting it to running, the next
+    * tick will measure from this moment.
     */
     void start();
 
@@ -40,6 +40,13 @@ inline uint32_t to_u32(T value)
 	return static_cast<uint32_t>(value);
 }
 
+// ROUNDS size UP TO A MULTIPLE OF alignment, WHICH MUST BE A POWER OF TWO
+template <typename T>
+inline T align_up(T size, T alignment)
+{
+	return (size + alignment - 1) & ~(alignment - 1);
+}
+
 template <typename T>
 inline uint8_t *to_ubyte_ptr(T *value)
 {
@@ -65,6 +72,17 @@ constexpr uint32_t fnv1a_32(const char *s, std::size_t len)
 	return ((len ? fnv1a_32(s, len - 1) : 2166136261u) ^ s[len]) * 16777619u;
 }
 
+// FNV-1a 64bit hashing of size bytes, hash CARRIES ON FROM AN EARLIER CALL WHEN GIVEN
+inline uint64_t fnv1a_64(const void *p_data, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+	const uint8_t *p_bytes = static_cast<const uint8_t *>(p_data);
+	for (size_t i = 0; i < size; i++)
+	{
+		hash = (hash ^ p_bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
 constexpr size_t const_strlen(const char *s)
 {
 	size_t len = 0;
@@ -1,9 +1,12 @@
 // IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
 #include "controller.hpp"
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <string>
 
 // OUR OWN TYPES
+#include "scene_graph/bvh.hpp"
 #include "scene_graph/components/aabb.hpp"
 #include "scene_graph/components/mesh.hpp"
 #include "scene_graph/event.hpp"
@@ -175,107 +178,66 @@ void Controller::deliver_event(const Event &event)
 	p_script->process_event(event);
 }
 
-bool Controller::are_players_colliding()
+void Controller::set_spatial_index(const sg::BVH &bvh)
 {
-	glm::mat4 p1_M              = player_1.get_transform().get_world_M();
-	glm::mat4 p2_M              = player_2.get_transform().get_world_M();
-	glm::mat4 p3_M              = player_3.get_transform().get_world_M();
-	glm::mat4 p4_M              = player_4.get_transform().get_world_M();
-	glm::mat4 p5_M              = player_5.get_transform().get_world_M();
-	sg::AABB  p1_transformed_bd = player_1.get_component<sg::Mesh>().get_bounds().transform(p1_M);
-	sg::AABB  p2_transformed_bd = player_2.get_component<sg::Mesh>().get_bounds().transform(p2_M);
-	sg::AABB  p3_transformed_bd = player_3.get_component<sg::Mesh>().get_bounds().transform(p3_M);
-	sg::AABB  p4_transformed_bd = player_4.get_component<sg::Mesh>().get_bounds().transform(p4_M);
-	sg::AABB  p5_transformed_bd = player_5.get_component<sg::Mesh>().get_bounds().transform(p5_M);
+	p_bvh_ = &bvh;
+}
 
-	if (p1_transformed_bd.collides_with(p2_transformed_bd))
-	{
-		return p1_transformed_bd.collides_with(p2_transformed_bd);
-	}
-	else if (p1_transformed_bd.collides_with(p3_transformed_bd))
-	{
-		return p1_transformed_bd.collides_with(p3_transformed_bd);
-	}
-	else if (p1_transformed_bd.collides_with(p4_transformed_bd))
-	{
-		return p1_transformed_bd.collides_with(p4_transformed_bd);
-	}
-	else if (p1_transformed_bd.collides_with(p5_transformed_bd))
-	{
-		return p1_transformed_bd.collides_with(p5_transformed_bd);
-	}
-	else if (p2_transformed_bd.collides_with(p3_transformed_bd))
-	{
-		return p2_transformed_bd.collides_with(p3_transformed_bd);
-	}
-	else if (p2_transformed_bd.collides_with(p4_transformed_bd))
-	{
-		return p2_transformed_bd.collides_with(p4_transformed_bd);
-	}
-	else if (p2_transformed_bd.collides_with(p5_transformed_bd))
-	{
-		return p2_transformed_bd.collides_with(p5_transformed_bd);
-	}
-	else if (p3_transformed_bd.collides_with(p4_transformed_bd))
-	{
-		return p3_transformed_bd.collides_with(p4_transformed_bd);
-	}
-	else if (p3_transformed_bd.collides_with(p5_transformed_bd))
-	{
-		return p3_transformed_bd.collides_with(p5_transformed_bd);
-	}
-	else if (p4_transformed_bd.collides_with(p5_transformed_bd))
+bool Controller::are_players_colliding()
+{
+	if (!p_bvh_)
 	{
-		return p4_transformed_bd.collides_with(p5_transformed_bd);
+		return false;
 	}
-	else
+
+	sg::Node *p_players[] = {&player_1, &player_2, &player_3, &player_4, &player_5};
+	for (sg::Node *p_player : p_players)
 	{
-		return p1_transformed_bd.collides_with(p2_transformed_bd);
-	}
+		glm::mat4 player_M              = p_player->get_transform().get_world_M();
+		sg::AABB  player_transformed_bd = p_player->get_component<sg::Mesh>().get_bounds().transform(player_M);
 
-	// NOTE THIS AABB FUNCTION DOES THE ACTUAL COLLISION TEST
-	
+		// NOTE THE BVH DOES THE ACTUAL COLLISION TEST, EVERY PLAYER OVERLAPS ITSELF SO THAT
+		// HIT DOESN'T COUNT
+		hits_.clear();
+		p_bvh_->query(player_transformed_bd, hits_);
+		for (uint32_t proxy : hits_)
+		{
+			sg::Node *p_hit = p_bvh_->get_node(proxy);
+			if (p_hit != p_player && std::find(std::begin(p_players), std::end(p_players), p_hit) != std::end(p_players))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
 }
 
 std::string Controller::is_projectile_colliding()
 {
-	glm::mat4 p1_M              = player_1.get_transform().get_world_M();
-	glm::mat4 p2_M              = player_2.get_transform().get_world_M();
-	glm::mat4 p3_M              = player_3.get_transform().get_world_M();
-	glm::mat4 p4_M              = player_4.get_transform().get_world_M();
-	glm::mat4 p5_M              = player_5.get_transform().get_world_M();
-	glm::mat4 proj_M            = projectile.get_transform().get_world_M();
-	sg::AABB  p1_transformed_bd = player_1.get_component<sg::Mesh>().get_bounds().transform(p1_M);
-	sg::AABB  p2_transformed_bd = player_2.get_component<sg::Mesh>().get_bounds().transform(p2_M);
-	sg::AABB  p3_transformed_bd = player_3.get_component<sg::Mesh>().get_bounds().transform(p3_M);
-	sg::AABB  p4_transformed_bd = player_4.get_component<sg::Mesh>().get_bounds().transform(p4_M);
-	sg::AABB  p5_transformed_bd = player_5.get_component<sg::Mesh>().get_bounds().transform(p5_M);
-	sg::AABB  proj_transformed_bd = player_5.get_component<sg::Mesh>().get_bounds().transform(proj_M);
-
-	if (proj_transformed_bd.collides_with(p1_transformed_bd))
-	{
-		return "player_1";
-	}
-	else if (proj_transformed_bd.collides_with(p2_transformed_bd))
-	{
-		return "player_2";
-	}
-	else if (proj_transformed_bd.collides_with(p3_transformed_bd))
-	{
-		return "player_3";
-	}
-	else if (proj_transformed_bd.collides_with(p4_transformed_bd))
-	{
-		return "player_4";
-	}
-	else if (proj_transformed_bd.collides_with(p5_transformed_bd))
+	if (!p_bvh_)
 	{
-		return "player_5";
+		return "";
 	}
-	else
+
+	glm::mat4 proj_M              = projectile.get_transform().get_world_M();
+	sg::AABB  proj_transformed_bd = player_5.get_component<sg::Mesh>().get_bounds().transform(proj_M);
+
+	hits_.clear();
+	p_bvh_->query(proj_transformed_bd, hits_);
+
+	// WHEN THE PROJECTILE HITS SEVERAL PLAYERS THE LOWEST NUMBERED ONE IS REPORTED
+	sg::Node *p_players[] = {&player_1, &player_2, &player_3, &player_4, &player_5};
+	for (sg::Node *p_player : p_players)
 	{
-		return "";
+		for (uint32_t proxy : hits_)
+		{
+			if (p_bvh_->get_node(proxy) == p_player)
+			{
+				return p_player->get_name();
+			}
+		}
 	}
+	return "";
 }
 
-}        // namespace W3D
\ No newline at end of file
+}        // namespace W3D
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <vector>
 
 namespace W3D
 {
@@ -7,6 +8,7 @@ struct Event;
 enum class KeyCode;
 namespace sg
 {
+class BVH;
 class Node;
 class Script;
 }
@@ -54,7 +56,12 @@ class Controller
 
 	// THIS KEEPS TRACK OF WHICH GAME OBJECT WE ARE CURRENTLY CONTROLLING
 	// WITH THIS OBJECT
-	ControllerMode mode_;
+	ControllerMode mode_ = ControllerMode::eCamera;
+
+	// COLLISIONS ARE FOUND BY ASKING THIS WHAT OVERLAPS EACH PLAYER, RATHER THAN TESTING
+	// EVERY PAIR OF PLAYERS, hits_ IS KEPT AROUND SO QUERIES DON'T ALLOCATE
+	const sg::BVH        *p_bvh_ = nullptr;
+	std::vector<uint32_t> hits_;
 
   public:
 	/*
@@ -81,6 +88,12 @@ class Controller
 	*/
 	void deliver_event(const Event &event);
 
+	/*
+	* Mutator method for setting the BVH collisions are looked up in, it must hold the
+	* world space boxes of the players and be kept up to date as they move.
+	*/
+	void set_spatial_index(const sg::BVH &bvh);
+
 	/*
 	* This function tests to see if the two player (i.e. cube) objects are currently
 	* overlapping and returns true if they are, false otherwise.
@@ -34,10 +34,11 @@ CommandBuffer::~CommandBuffer()
 	}
 }
 
-void CommandBuffer::begin(vk::CommandBufferUsageFlags flag)
+void CommandBuffer::begin(vk::CommandBufferUsageFlags flag, const vk::CommandBufferInheritanceInfo *p_inheritance_info)
 {
 	vk::CommandBufferBeginInfo cmd_buf_binfo{
-	    .flags = flag,
+	    .flags            = flag,
+	    .pInheritanceInfo = p_inheritance_info,
 	};
 	handle_.begin(cmd_buf_binfo);
 }
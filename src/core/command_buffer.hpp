@@ -48,9 +48,10 @@ class CommandBuffer : public VulkanObject<vk::CommandBuffer>
 	CommandBuffer &operator=(CommandBuffer &&)      = delete;
 
 	/*
-	* A wrapper function for the vk::CommandBuffer begin function
+	* A wrapper function for the vk::CommandBuffer begin function, secondary command buffers
+	* also have to be told what they inherit from the primary one that will execute them.
 	*/
-	void begin(vk::CommandBufferUsageFlags flag = {});
+	void begin(vk::CommandBufferUsageFlags flag = {}, const vk::CommandBufferInheritanceInfo *p_inheritance_info = nullptr);
 
 	/*
 	* A function for submitting all queued commands to the command pool
@@ -0,0 +1,46 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "compute_pipeline.hpp"
+
+// OUR OWN TYPES
+#include "device.hpp"
+#include "pipeline_cache.hpp"
+#include "shader_module_cache.hpp"
+
+namespace W3D
+{
+
+ComputePipeline::ComputePipeline(Device &device, const char *shader_name, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo) :
+    device_(device)
+{
+	// GET THE COMPUTE SHADER, WHICH IS ONLY LOADED THE FIRST TIME A PIPELINE USES IT
+	vk::ShaderModule shader_module = device_.get_shader_module_cache().get_shader_module(shader_name);
+
+	// CREATE THE PIPELINE LAYOUT AND THE PIPELINE ITSELF
+	pl_layout_ = device_.get_handle().createPipelineLayout(pl_layout_cinfo);
+	vk::ComputePipelineCreateInfo compute_pipeline_cinfo{
+	    .stage = {
+	        .stage  = vk::ShaderStageFlagBits::eCompute,
+	        .module = shader_module,
+	        .pName  = "main",
+	    },
+	    .layout = pl_layout_,
+	};
+	handle_ = device_.get_handle().createComputePipeline(device_.get_pipeline_cache().get_handle(), compute_pipeline_cinfo).value;
+}
+
+ComputePipeline::~ComputePipeline()
+{
+	if (handle_)
+	{
+		// DESTROY THE PIPELINE AND ITS LAYOUT
+		device_.get_handle().destroyPipelineLayout(pl_layout_);
+		device_.get_handle().destroyPipeline(handle_);
+	}
+}
+
+vk::PipelineLayout ComputePipeline::get_pipeline_layout()
+{
+	return pl_layout_;
+}
+
+}	// namespace W3D
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "common/vk_common.hpp"
+#include "core/vulkan_object.hpp"
+
+namespace W3D
+{
+class Device;
+
+/*
+* Wrapper class for a Vulkan compute pipeline, i.e. vk::Pipeline. Compute pipelines are a
+* lot simpler than graphics ones, all they need is a single compute shader and a layout.
+*/
+class ComputePipeline : public VulkanObject<vk::Pipeline>
+{
+  private:
+	Device            &device_;
+	vk::PipelineLayout pl_layout_;
+
+  public:
+	/*
+	* The constructor gets the module of the compiled compute shader named shader_name from
+	* the device's shader module cache and creates the pipeline, along with its layout, from it.
+	*/
+	ComputePipeline(Device &device, const char *shader_name, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo);
+	ComputePipeline(ComputePipeline &&) = default;
+	~ComputePipeline() override;
+
+	/*
+	 * Accessor method for getting this pipeline's layout.
+	 */
+	vk::PipelineLayout get_pipeline_layout();
+};
+
+}        // namespace W3D
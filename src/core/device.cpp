@@ -2,15 +2,20 @@
 #include "device.hpp"
 
 // C/C++ LANGUAGE API TYPES
+#include <cstring>
 #include <set>
 
 // OUR OWN TYPES
 #include "command_buffer.hpp"
 #include "command_pool.hpp"
 #include "common/common.hpp"
+#include "common/profiler.hpp"
 #include "common/utils.hpp"
+#include "geometry_arena.hpp"
 #include "instance.hpp"
 #include "physical_device.hpp"
+#include "pipeline_cache.hpp"
+#include "shader_module_cache.hpp"
 
 namespace W3D
 {
@@ -21,10 +26,24 @@ const std::vector<const char *> Device::REQUIRED_EXTENSIONS = {
 #endif
 };
 
-Device::Device(Instance &instance, PhysicalDevice &physical_device) :
+std::vector<const char *> Device::get_required_extensions(const Instance &instance)
+{
+	std::vector<const char *> extensions = REQUIRED_EXTENSIONS;
+	if (instance.is_headless())
+	{
+		std::erase_if(extensions, [](const char *extension) {
+			return !strcmp(extension, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+		});
+	}
+	return extensions;
+}
+
+Device::Device(Instance &instance, PhysicalDevice &physical_device, const std::string &pipeline_cache_path) :
     instance_(instance),
     physical_device_(physical_device)
 {
+	W3D_PROFILE_SCOPE("Device::Device");
+
 	// NOTE, THE PHYSICAL DEVICE ALREADY EXISTS SO THROUGH IT WE CAN
 	// GET THE QUEUE FAMILY INCIDES
 	QueueFamilyIndices indices        = physical_device.get_queue_family_indices();
@@ -43,19 +62,57 @@ Device::Device(Instance &instance, PhysicalDevice &physical_device) :
 		queue_cinfos.push_back(queue_cinfo);
 	}
 
+	std::vector<const char *> extensions = get_required_extensions(instance_);
+
 	vk::PhysicalDeviceFeatures required_features;
 	required_features.samplerAnisotropy = true;
 	required_features.sampleRateShading = true;
 
+	// GPU DRIVEN DRAWING NEEDS MULTI DRAW INDIRECT WITH THE DRAW COUNT IN A BUFFER, WHICH ISN'T
+	// EVERYWHERE, SO IT'S ONLY TURNED ON WHEN THE DEVICE HAS IT. MULTIVIEW, WHICH DRAWS ALL THE
+	// FACES OF A CUBE AT ONCE, IS EVERYWHERE FROM VULKAN 1.1 ON. NOTE THE VULKAN 1.1 AND 1.2
+	// FEATURES CAN ONLY BE ASKED ABOUT ON A DEVICE OF THAT VERSION
+	uint32_t                            api_version = physical_device.get_handle().getProperties().apiVersion;
+	vk::PhysicalDeviceMultiviewFeatures multiview_features;
+	vk::PhysicalDeviceVulkan12Features  vulkan12_features;
+	if (api_version >= VK_API_VERSION_1_1)
+	{
+		vk::PhysicalDeviceFeatures2 supported_features{
+		    .pNext = &multiview_features,
+		};
+		multiview_features.pNext = api_version >= VK_API_VERSION_1_2 ? &vulkan12_features : nullptr;
+		physical_device.get_handle().getFeatures2(&supported_features);
+		is_multiview_supported_           = multiview_features.multiview;
+		is_draw_indirect_count_supported_ = api_version >= VK_API_VERSION_1_2 && vulkan12_features.drawIndirectCount && supported_features.features.multiDrawIndirect;
+	}
+	multiview_features                  = vk::PhysicalDeviceMultiviewFeatures{};
+	multiview_features.multiview        = is_multiview_supported_;
+	vulkan12_features                   = vk::PhysicalDeviceVulkan12Features{};
+	vulkan12_features.drawIndirectCount = is_draw_indirect_count_supported_;
+	required_features.multiDrawIndirect = is_draw_indirect_count_supported_;
+
+	// ONLY THE FEATURES THAT ARE TURNED ON ARE CHAINED
+	void *p_features = nullptr;
+	if (is_draw_indirect_count_supported_)
+	{
+		p_features = &vulkan12_features;
+	}
+	if (is_multiview_supported_)
+	{
+		multiview_features.pNext = p_features;
+		p_features               = &multiview_features;
+	}
+
 	// HERE ARE THE SETTINGS FOR OUR LOGICAL DEVICE
 	vk::DeviceCreateInfo device_cinfo{
+	    .pNext                   = p_features,
 	    .flags                   = {},
 	    .queueCreateInfoCount    = to_u32(queue_cinfos.size()),
 	    .pQueueCreateInfos       = queue_cinfos.data(),
 	    .enabledLayerCount       = to_u32(instance_.VALIDATION_LAYERS.size()),
 	    .ppEnabledLayerNames     = instance_.VALIDATION_LAYERS.data(),
-	    .enabledExtensionCount   = to_u32(REQUIRED_EXTENSIONS.size()),
-	    .ppEnabledExtensionNames = REQUIRED_EXTENSIONS.data(),
+	    .enabledExtensionCount   = to_u32(extensions.size()),
+	    .ppEnabledExtensionNames = extensions.data(),
 	    .pEnabledFeatures        = &required_features,
 	};
 
@@ -72,11 +129,24 @@ Device::Device(Instance &instance, PhysicalDevice &physical_device) :
 
 	// AND MAKE A COMMAND POOL, THROUGH WHICH WE WILL MAKE COMMAND BUFFERS FOR THIS DEVICE
 	p_one_time_buf_pool_       = std::make_unique<CommandPool>(*this, graphics_queue_, indices.graphics_index.value(), CommandPoolResetStrategy::eIndividual, vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient);
+
+	// AND THE ARENA ALL OUR MESHES' GEOMETRY GOES INTO, WHICH UPLOADS THROUGH THAT POOL
+	p_geometry_arena_ = std::make_unique<GeometryArena>(*this);
+
+	// AND THE CACHE OF COMPILED PIPELINES, WHICH STARTS WITH WHAT THE LAST RUN COMPILED
+	p_pipeline_cache_      = std::make_unique<PipelineCache>(*this, pipeline_cache_path);
+	p_shader_module_cache_ = std::make_unique<ShaderModuleCache>(*this);
 }
 
 Device::~Device()
 {
+	// THE PIPELINES ARE ALL MADE BY NOW, SO SAVE THEM FOR THE NEXT RUN
+	p_pipeline_cache_->save();
+
 	// RESET AND DESTROY SINCE THIS OBJECT IS BEING DESTRUCTED
+	p_shader_module_cache_.reset();
+	p_pipeline_cache_.reset();
+	p_geometry_arena_.reset();
 	p_one_time_buf_pool_.reset();
 	p_device_memory_allocator_.reset();
 	handle_.destroy();
@@ -107,11 +177,36 @@ const vk::Queue &Device::get_compute_queue() const
 	return compute_queue_;
 }
 
+bool Device::is_draw_indirect_count_supported() const
+{
+	return is_draw_indirect_count_supported_;
+}
+
+bool Device::is_multiview_supported() const
+{
+	return is_multiview_supported_;
+}
+
 const DeviceMemoryAllocator &Device::get_device_memory_allocator() const
 {
 	return *p_device_memory_allocator_;
 }
 
+GeometryArena &Device::get_geometry_arena() const
+{
+	return *p_geometry_arena_;
+}
+
+const PipelineCache &Device::get_pipeline_cache() const
+{
+	return *p_pipeline_cache_;
+}
+
+ShaderModuleCache &Device::get_shader_module_cache() const
+{
+	return *p_shader_module_cache_;
+}
+
 CommandBuffer Device::begin_one_time_buf() const
 {
 	CommandBuffer cmd_buf = p_one_time_buf_pool_->allocate_command_buffer();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 
 #include "common/vk_common.hpp"
 #include "device_memory/allocator.hpp"
@@ -13,6 +14,9 @@ class PhysicalDevice;
 class DeviceMemoryAllocator;
 class CommandPool;
 class CommandBuffer;
+class GeometryArena;
+class PipelineCache;
+class ShaderModuleCache;
 
 /*
 * A wrapper class for a Vulkan logical device. Note, the handle will
@@ -28,18 +32,30 @@ class Device : public VulkanObject<typename vk::Device>
 	vk::Queue                              present_queue_  = nullptr;
 	vk::Queue                              compute_queue_  = nullptr;
 	std::unique_ptr<CommandPool>           p_one_time_buf_pool_;
+	std::unique_ptr<GeometryArena>         p_geometry_arena_;
+	std::unique_ptr<PipelineCache>         p_pipeline_cache_;
+	std::unique_ptr<ShaderModuleCache>     p_shader_module_cache_;
+	bool                                   is_draw_indirect_count_supported_ = false;
+	bool                                   is_multiview_supported_           = false;
 
   public:
 	static const std::vector<const char *> REQUIRED_EXTENSIONS;
 
+	/*
+	* Static helper for getting the device extensions required for the instance argument. Note
+	* that a headless instance never presents, so it doesn't need the swapchain extension.
+	*/
+	static std::vector<const char *> get_required_extensions(const Instance &instance);
+
 	/*
 	* Constructor will fully initialize this object, creating the logical device and
-	* through that device creating the memory allocator and the command queues.
+	* through that device creating the memory allocator and the command queues. The
+	* pipeline cache is loaded from pipeline_cache_path, when it isn't empty.
 	*/
-	Device(Instance &instance, PhysicalDevice &physical_device);
+	Device(Instance &instance, PhysicalDevice &physical_device, const std::string &pipeline_cache_path = "");
 
 	/*
-	* Destructor cleans up.
+	* Destructor saves the pipeline cache and cleans up.
 	*/
 	~Device() override;
 
@@ -68,11 +84,41 @@ class Device : public VulkanObject<typename vk::Device>
 	 */
 	const vk::Queue &get_compute_queue() const;
 
+	/*
+	 * Tests whether this device can take the number of draws of a multi draw indirect
+	 * command from a buffer, i.e. vkCmdDrawIndexedIndirectCount, which is what lets the GPU
+	 * decide what to draw. If it can, that feature was turned on when the device was made.
+	 */
+	bool is_draw_indirect_count_supported() const;
+
+	/*
+	 * Tests whether this device can draw to several layers of an image at once, as the views
+	 * of a multiview render pass. If it can, that feature was turned on when the device was made.
+	 */
+	bool is_multiview_supported() const;
+
 	/*
 	 * Accessor method for getting the VMA wrapper (memory allocator) associated with this device.
 	 */
 	const DeviceMemoryAllocator &get_device_memory_allocator() const;
 
+	/*
+	 * Accessor method for getting the arena every SubMesh's vertices and indices live in. Note
+	 * loaders only get a const device, but they still need to put geometry in the arena.
+	 */
+	GeometryArena &get_geometry_arena() const;
+
+	/*
+	 * Accessor method for getting the cache every pipeline on this device is created through.
+	 */
+	const PipelineCache &get_pipeline_cache() const;
+
+	/*
+	 * Accessor method for getting the cache of shader modules every pipeline on this device
+	 * is created from. Note loading a module changes it, but pipelines only get a const device.
+	 */
+	ShaderModuleCache &get_shader_module_cache() const;
+
 	/*
 	* Function for activating the sending of commands to the device.
 	*/
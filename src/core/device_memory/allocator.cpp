@@ -2,6 +2,7 @@
 #include "allocator.hpp"
 
 // OUR OWN TYPES
+#include "common/error.hpp"
 #include "common/utils.hpp"
 #include "core/device.hpp"
 #include "core/instance.hpp"
@@ -53,7 +54,7 @@ Buffer DeviceMemoryAllocator::allocate_vertex_buffer(size_t size) const
 {
 	vk::BufferCreateInfo buffer_cinfo{};
 	buffer_cinfo.size  = size;
-	buffer_cinfo.usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc;
 	VmaAllocationCreateInfo allocation_cinfo{};
 	allocation_cinfo.flags = 0;
 	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO;
@@ -64,7 +65,7 @@ Buffer DeviceMemoryAllocator::allocate_index_buffer(size_t size) const
 {
 	vk::BufferCreateInfo buffer_cinfo{};
 	buffer_cinfo.size  = size;
-	buffer_cinfo.usage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eIndexBuffer | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc;
 	VmaAllocationCreateInfo allocation_cinfo{};
 	allocation_cinfo.flags = 0;
 	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO;
@@ -83,6 +84,49 @@ Buffer DeviceMemoryAllocator::allocate_uniform_buffer(size_t size) const
 	return allocate_buffer(buffer_cinfo, allocation_cinfo);
 }
 
+Buffer DeviceMemoryAllocator::allocate_storage_buffer(size_t size) const
+{
+	vk::BufferCreateInfo buffer_cinfo{};
+	buffer_cinfo.size  = size;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO;
+	return allocate_buffer(buffer_cinfo, allocation_cinfo);
+}
+
+Buffer DeviceMemoryAllocator::allocate_indirect_buffer(size_t size) const
+{
+	vk::BufferCreateInfo buffer_cinfo{};
+	buffer_cinfo.size  = size;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer;
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags = 0;
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+	return allocate_buffer(buffer_cinfo, allocation_cinfo);
+}
+
+Buffer DeviceMemoryAllocator::allocate_counter_buffer(size_t size) const
+{
+	vk::BufferCreateInfo buffer_cinfo{};
+	buffer_cinfo.size  = size;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eStorageBuffer | vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eTransferDst;
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO;
+	return allocate_buffer(buffer_cinfo, allocation_cinfo);
+}
+
+Buffer DeviceMemoryAllocator::allocate_readback_buffer(size_t size) const
+{
+	vk::BufferCreateInfo buffer_cinfo{};
+	buffer_cinfo.size  = size;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eTransferDst;
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO;
+	return allocate_buffer(buffer_cinfo, allocation_cinfo);
+}
 
 Buffer DeviceMemoryAllocator::allocate_null_buffer() const
 {
@@ -108,4 +152,42 @@ Image DeviceMemoryAllocator::allocate_null_image() const
 	return Image(Key<DeviceMemoryAllocator>{}, handle_, nullptr);
 };
 
+bool DeviceMemoryAllocator::is_lazily_allocatable(vk::ImageCreateInfo &image_cinfo) const
+{
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+	uint32_t memory_type_idx;
+	return vmaFindMemoryTypeIndexForImageInfo(handle_, reinterpret_cast<VkImageCreateInfo *>(&image_cinfo), &allocation_cinfo, &memory_type_idx) == VK_SUCCESS;
+}
+
+Image DeviceMemoryAllocator::allocate_lazily_allocated_image(vk::ImageCreateInfo &image_cinfo) const
+{
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+	return allocate_image(image_cinfo, allocation_cinfo);
+}
+
+VmaAllocation DeviceMemoryAllocator::allocate_aliasable_memory(const vk::MemoryRequirements &requirements) const
+{
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags         = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+	allocation_cinfo.requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+	allocation_cinfo.priority      = 1.0f;
+
+	VmaAllocation allocation;
+	VK_CHECK(vmaAllocateMemory(handle_, reinterpret_cast<const VkMemoryRequirements *>(&requirements), &allocation_cinfo, &allocation, nullptr));
+	return allocation;
+}
+
+Image DeviceMemoryAllocator::allocate_aliasing_image(vk::ImageCreateInfo &image_cinfo, VmaAllocation allocation) const
+{
+	return Image(Key<DeviceMemoryAllocator>{}, handle_, image_cinfo, allocation);
+}
+
+void DeviceMemoryAllocator::free_memory(VmaAllocation allocation) const
+{
+	vmaFreeMemory(handle_, allocation);
+}
+
 }        // namespace W3D
\ No newline at end of file
@@ -51,14 +51,16 @@ class DeviceMemoryAllocator : public VulkanObject<VmaAllocator>
 
 	/*
 	 * This function is for allocating memory for a vertex buffer on the device. Notice we have
-	 * specified the usage as a transfer destination (eTransferDst).
+	 * specified the usage as a transfer destination (eTransferDst), and source (eTransferSrc) so
+	 * the geometry arena can copy it into a bigger buffer when it grows.
 	 */
 	Buffer allocate_vertex_buffer(size_t size) const;
 
 	/*
 	 * This function is for allocating memory for an index buffer, which associates vertices
 	 * with the primitives (like triangles, points, lines, or quads) to be drawn. Note, this
-	 * allocation will happen on the device as we specify usage to be as a transfer destination.
+	 * allocation will happen on the device as we specify usage to be as a transfer destination,
+	 * and source for the same reason as vertex buffers.
 	 */
 	Buffer allocate_index_buffer(size_t size) const;
 
@@ -67,6 +69,31 @@ class DeviceMemoryAllocator : public VulkanObject<VmaAllocator>
 	 */
 	Buffer allocate_uniform_buffer(size_t size) const;
 
+	/*
+	 * This function is for allocating a persistently mapped buffer that the device copies
+	 * into and the host reads from, like when reading rendered frames back from the GPU.
+	 */
+	Buffer allocate_readback_buffer(size_t size) const;
+
+	/*
+	 * This function is for allocating a storage buffer the CPU rewrites every frame, like
+	 * per instance data. It stays mapped so updating it never has to remap.
+	 */
+	Buffer allocate_storage_buffer(size_t size) const;
+
+	/*
+	 * This function is for allocating a storage buffer only the device reads and writes that
+	 * indirect draws can also take their parameters from, like draws built by a compute shader.
+	 */
+	Buffer allocate_indirect_buffer(size_t size) const;
+
+	/*
+	 * This function is for allocating a storage buffer the device counts into, which indirect
+	 * draws can take their draw count from. It stays mapped so the host can read the counts
+	 * back once the device is done with them.
+	 */
+	Buffer allocate_counter_buffer(size_t size) const;
+
 	/*
 	 * This function is for allocating an empty buffer, which is sometimes useful as a placeholder.
 	 */
@@ -88,6 +115,38 @@ class DeviceMemoryAllocator : public VulkanObject<VmaAllocator>
 	 * This function is for allocating a placeholder null image.
 	 */
 	Image allocate_null_image() const;
+
+	/*
+	 * Tests whether an image like image_cinfo describes can live in lazily allocated memory,
+	 * which tiled GPUs only back with real memory if the image ever leaves their tile memory.
+	 */
+	bool is_lazily_allocatable(vk::ImageCreateInfo &image_cinfo) const;
+
+	/*
+	 * This function is for allocating an attachment that is never stored, its usage must
+	 * include eTransientAttachment and is_lazily_allocatable must have said yes.
+	 */
+	Image allocate_lazily_allocated_image(vk::ImageCreateInfo &image_cinfo) const;
+
+	// MEMORY SHARED BY SEVERAL RESOURCES
+
+	/*
+	 * This function is for allocating device memory that meets requirements without a
+	 * resource of its own, images that are never in use at the same time can then be
+	 * created in it with allocate_aliasing_image. It must be given back with free_memory.
+	 */
+	VmaAllocation allocate_aliasable_memory(const vk::MemoryRequirements &requirements) const;
+
+	/*
+	 * This function is for creating an image at the start of memory from
+	 * allocate_aliasable_memory, the image doesn't own the memory so it can go before it does.
+	 */
+	Image allocate_aliasing_image(vk::ImageCreateInfo &image_cinfo, VmaAllocation allocation) const;
+
+	/*
+	 * This function gives back memory from allocate_aliasable_memory.
+	 */
+	void free_memory(VmaAllocation allocation) const;
 };
 
 }        // namespace W3D
\ No newline at end of file
@@ -59,7 +59,10 @@ void Buffer::update(const uint8_t *p_data, size_t size, size_t offset)
 	if (is_persistent_)
 	{
 		// COPY THE CONTENTS OF p_data OVER TO OUR BUFFER AS UNSIGNED BYTES
-		std::copy(p_data, p_data + size, to_ubyte_ptr(details_.allocation_info.pMappedData));
+		std::copy(p_data, p_data + size, to_ubyte_ptr(details_.allocation_info.pMappedData) + offset);
+
+		// AND FLUSH WHAT WE WROTE IN CASE THE MEMORY ISN'T HOST COHERENT
+		vmaFlushAllocation(details_.allocator, details_.allocation, offset, size);
 	}
 	else
 	{
@@ -67,7 +70,7 @@ void Buffer::update(const uint8_t *p_data, size_t size, size_t offset)
 		map();
 
 		// THEN COPY DATA OVER TO THE BUFFER
-		std::copy(p_data, p_data + size, to_ubyte_ptr(p_mapped_data_));
+		std::copy(p_data, p_data + size, to_ubyte_ptr(p_mapped_data_) + offset);
 
 		// FLUSH THE BUFFER'S CACHE
 		flush();
@@ -82,7 +85,7 @@ void Buffer::map()
 {
 	// ONLY IF DATA CAN BE MAPPED
 	assert(is_mappable());
-	if (p_mapped_data_)
+	if (!p_mapped_data_)
 	{
 		// USE THE VMA API TO MAP THE BUFFER, i.e. GET A POINTER
 		vmaMapMemory(details_.allocator, details_.allocation, &p_mapped_data_);
@@ -110,4 +113,23 @@ void Buffer::flush()
 	}
 }
 
+void Buffer::invalidate()
+{
+	// ONLY PERSISTENT BUFFERS STAY MAPPED FOR THE HOST TO READ
+	if (is_persistent_)
+	{
+		// USE THE VMA API TO INVALIDATE THE CACHED DATA
+		vmaInvalidateAllocation(details_.allocator, details_.allocation, 0, details_.allocation_info.size);
+	}
+}
+
+const uint8_t *Buffer::get_mapped_data() const
+{
+	if (!is_persistent_)
+	{
+		return nullptr;
+	}
+	return static_cast<const uint8_t *>(details_.allocation_info.pMappedData);
+}
+
 } // namespace W3D
\ No newline at end of file
@@ -16,7 +16,7 @@ class Key;
 class Buffer : public DeviceMemoryObject<vk::Buffer>
 {
   private:
-	bool  is_persistent_;
+	bool  is_persistent_ = false;
 	void *p_mapped_data_ = nullptr;
 
   public:
@@ -80,6 +80,18 @@ class Buffer : public DeviceMemoryObject<vk::Buffer>
 	 */
 	void flush();
 
+	/*
+	 * This function invalidates the cache for persistently mapped data so that writes made
+	 * by the device become visible to the host before we read them.
+	 */
+	void invalidate();
+
+	/*
+	 * Accessor method for getting the CPU pointer of a persistently mapped buffer, note it
+	 * will be nullptr if this buffer is not persistently mapped.
+	 */
+	const uint8_t *get_mapped_data() const;
+
 }; // class Buffer
 
 }  // namespace W3D
\ No newline at end of file
@@ -25,6 +25,19 @@ Image::Image(Key<DeviceMemoryAllocator> key, VmaAllocator allocator, vk::ImageCr
 	handle_ = c_image_handle;
 }
 
+Image::Image(Key<DeviceMemoryAllocator> key, VmaAllocator allocator, vk::ImageCreateInfo &image_cinfo, VmaAllocation shared_allocation) :
+    DeviceMemoryObject(allocator, key),
+    base_extent_(image_cinfo.extent),
+    format_(image_cinfo.format)
+{
+	// WITHOUT AN ALLOCATION OF ITS OWN vmaDestroyImage ONLY DESTROYS THE IMAGE
+	details_.allocation = nullptr;
+	VkImage c_image_handle;
+	VK_CHECK(vmaCreateAliasingImage(details_.allocator, shared_allocation, reinterpret_cast<VkImageCreateInfo *>(&image_cinfo), &c_image_handle));
+	vmaGetAllocationInfo(details_.allocator, shared_allocation, &details_.allocation_info);
+	handle_ = c_image_handle;
+}
+
 Image::Image(Image &&rhs) :
     DeviceMemoryObject(std::move(rhs)),
     base_extent_(rhs.base_extent_),
@@ -43,6 +43,12 @@ class Image : public DeviceMemoryObject<vk::Image>
 	*/
 	Image(Key<DeviceMemoryAllocator> key, VmaAllocator allocator, vk::ImageCreateInfo &image_cinfo, VmaAllocationCreateInfo &allocation_cinfo);
 
+	/*
+	* This constructor creates the image in memory it doesn't own, which other images may
+	* share, so destroying it leaves the memory alone.
+	*/
+	Image(Key<DeviceMemoryAllocator> key, VmaAllocator allocator, vk::ImageCreateInfo &image_cinfo, VmaAllocation shared_allocation);
+
 	/*
 	* Accessor method for getting the extents of this image. Note, it returns
 	* a Vulkan API Extent3D object.
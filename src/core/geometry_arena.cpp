@@ -0,0 +1,233 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "geometry_arena.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// OUR OWN TYPES
+#include "command_buffer.hpp"
+#include "common/logging.hpp"
+#include "device.hpp"
+#include "device_memory/buffer.hpp"
+#include "scene_graph/components/submesh.hpp"
+
+namespace W3D
+{
+
+const uint32_t GeometryArena::INITIAL_VERTEX_CAPACITY         = 1u << 16;
+const uint32_t GeometryArena::INITIAL_SKINNED_VERTEX_CAPACITY = 1u << 12;
+const uint32_t GeometryArena::INITIAL_INDEX_CAPACITY          = 1u << 18;
+const uint32_t GeometryArena::POSITION_SIZE                   = sizeof(glm::vec3);
+
+GeometryArena::FreeList::FreeList(uint32_t capacity)
+{
+	grow(capacity);
+}
+
+bool GeometryArena::FreeList::allocate(uint32_t count, uint32_t &offset)
+{
+	for (auto it = free_ranges_.begin(); it != free_ranges_.end(); it++)
+	{
+		if (it->second >= count)
+		{
+			// TAKE THE START OF THE RANGE AND LEAVE THE REST FREE
+			offset            = it->first;
+			uint32_t leftover = it->second - count;
+			free_ranges_.erase(it);
+			if (leftover)
+			{
+				free_ranges_[offset + count] = leftover;
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+void GeometryArena::FreeList::free(uint32_t offset, uint32_t count)
+{
+	if (!count)
+	{
+		return;
+	}
+
+	// MERGE WITH THE FREE RANGES RIGHT AFTER AND RIGHT BEFORE, IF THERE ARE ANY
+	auto next = free_ranges_.find(offset + count);
+	if (next != free_ranges_.end())
+	{
+		count += next->second;
+		free_ranges_.erase(next);
+	}
+	auto it = free_ranges_.lower_bound(offset);
+	if (it != free_ranges_.begin())
+	{
+		auto previous = std::prev(it);
+		if (previous->first + previous->second == offset)
+		{
+			previous->second += count;
+			return;
+		}
+	}
+	free_ranges_[offset] = count;
+}
+
+void GeometryArena::FreeList::grow(uint32_t capacity)
+{
+	uint32_t old_capacity = capacity_;
+	capacity_             = capacity;
+	free(old_capacity, capacity - old_capacity);
+}
+
+uint32_t GeometryArena::FreeList::get_capacity() const
+{
+	return capacity_;
+}
+
+GeometryArena::GeometryArena(Device &device) :
+    device_(device),
+    vertex_ranges_{FreeList(INITIAL_VERTEX_CAPACITY), FreeList(INITIAL_SKINNED_VERTEX_CAPACITY)},
+    idx_ranges_(INITIAL_INDEX_CAPACITY)
+{
+	const DeviceMemoryAllocator &allocator = device_.get_device_memory_allocator();
+	for (size_t i = 0; i < p_vertex_bufs_.size(); i++)
+	{
+		vk::DeviceSize size = vertex_ranges_[i].get_capacity() * sg::get_vertex_stride(static_cast<sg::VertexFormat>(i));
+		p_vertex_bufs_[i]   = std::make_unique<Buffer>(allocator.allocate_vertex_buffer(size));
+		p_position_bufs_[i] = std::make_unique<Buffer>(allocator.allocate_vertex_buffer(vertex_ranges_[i].get_capacity() * POSITION_SIZE));
+	}
+	p_idx_buf_ = std::make_unique<Buffer>(allocator.allocate_index_buffer(INITIAL_INDEX_CAPACITY * sizeof(uint32_t)));
+}
+
+GeometryArena::~GeometryArena()
+{
+}
+
+GeometryArena::Allocation GeometryArena::allocate(sg::VertexFormat vertex_format, const void *p_vertices, uint32_t vertex_count, const void *p_indices, uint32_t idx_count, vk::IndexType idx_type)
+{
+	size_t         format_idx    = static_cast<size_t>(vertex_format);
+	vk::DeviceSize vertex_stride = sg::get_vertex_stride(vertex_format);
+	uint32_t       idx_size      = get_index_size(idx_type);
+	Allocation     allocation{
+	    .vertex_format = vertex_format,
+	    .vertex_offset = reserve(vertex_ranges_[format_idx], p_vertex_bufs_[format_idx], &DeviceMemoryAllocator::allocate_vertex_buffer, vertex_stride, vertex_count, &p_position_bufs_[format_idx]),
+	    .vertex_count  = vertex_count,
+	    .first_index   = reserve(idx_ranges_, p_idx_buf_, &DeviceMemoryAllocator::allocate_index_buffer, sizeof(uint32_t), get_index_words(idx_count, idx_type)) * (4 / idx_size),
+	    .idx_count     = idx_count,
+	    .idx_type      = idx_type,
+	};
+
+	// ALL OF THEM GO THROUGH ONE STAGING BUFFER AND ONE SUBMISSION, THE POSITIONS AFTER THE
+	// VERTICES AND THE INDICES AFTER THOSE. EVERY VERTEX FORMAT STARTS WITH ITS POSITION
+	size_t vertex_bytes   = vertex_count * vertex_stride;
+	size_t position_bytes = static_cast<size_t>(vertex_count) * POSITION_SIZE;
+	size_t idx_bytes      = static_cast<size_t>(idx_count) * idx_size;
+	if (!vertex_bytes && !idx_bytes)
+	{
+		return allocation;
+	}
+	Buffer staging_buf = device_.get_device_memory_allocator().allocate_staging_buffer(vertex_bytes + position_bytes + idx_bytes);
+	if (vertex_bytes)
+	{
+		std::vector<uint8_t> positions(position_bytes);
+		const uint8_t       *p_vertex_bytes = reinterpret_cast<const uint8_t *>(p_vertices);
+		for (uint32_t i = 0; i < vertex_count; i++)
+		{
+			std::memcpy(positions.data() + i * POSITION_SIZE, p_vertex_bytes + i * vertex_stride, POSITION_SIZE);
+		}
+		staging_buf.update(p_vertex_bytes, vertex_bytes, 0);
+		staging_buf.update(positions.data(), position_bytes, vertex_bytes);
+	}
+	if (idx_bytes)
+	{
+		staging_buf.update(reinterpret_cast<const uint8_t *>(p_indices), idx_bytes, vertex_bytes + position_bytes);
+	}
+
+	CommandBuffer cmd_buf = device_.begin_one_time_buf();
+	if (vertex_bytes)
+	{
+		cmd_buf.copy_buffer(staging_buf, *p_vertex_bufs_[format_idx], vk::BufferCopy{0, allocation.vertex_offset * vertex_stride, vertex_bytes});
+		cmd_buf.copy_buffer(staging_buf, *p_position_bufs_[format_idx], vk::BufferCopy{vertex_bytes, static_cast<vk::DeviceSize>(allocation.vertex_offset) * POSITION_SIZE, position_bytes});
+	}
+	if (idx_bytes)
+	{
+		cmd_buf.copy_buffer(staging_buf, *p_idx_buf_, vk::BufferCopy{vertex_bytes + position_bytes, static_cast<vk::DeviceSize>(allocation.first_index) * idx_size, idx_bytes});
+	}
+	device_.end_one_time_buf(cmd_buf);
+
+	return allocation;
+}
+
+void GeometryArena::free(const Allocation &allocation)
+{
+	uint32_t first_word = allocation.first_index / (4 / get_index_size(allocation.idx_type));
+	vertex_ranges_[static_cast<size_t>(allocation.vertex_format)].free(allocation.vertex_offset, allocation.vertex_count);
+	idx_ranges_.free(first_word, get_index_words(allocation.idx_count, allocation.idx_type));
+}
+
+uint32_t GeometryArena::get_index_size(vk::IndexType idx_type)
+{
+	return idx_type == vk::IndexType::eUint16 ? 2 : 4;
+}
+
+uint32_t GeometryArena::get_index_words(uint32_t idx_count, vk::IndexType idx_type)
+{
+	return (idx_count * get_index_size(idx_type) + 3) / 4;
+}
+
+uint32_t GeometryArena::reserve(FreeList &ranges, std::unique_ptr<Buffer> &p_buf, AllocateFunction allocate, vk::DeviceSize element_size, uint32_t count, std::unique_ptr<Buffer> *p_position_buf)
+{
+	uint32_t offset = 0;
+	if (!count)
+	{
+		return offset;
+	}
+	if (!ranges.allocate(count, offset))
+	{
+		// AFTER GROWING THERE IS ALWAYS A FREE RANGE AT THE END THAT'S BIG ENOUGH
+		grow(ranges, p_buf, allocate, element_size, std::max(2 * ranges.get_capacity(), ranges.get_capacity() + count), p_position_buf);
+		ranges.allocate(count, offset);
+	}
+	return offset;
+}
+
+void GeometryArena::grow(FreeList &ranges, std::unique_ptr<Buffer> &p_buf, AllocateFunction allocate, vk::DeviceSize element_size, uint32_t capacity, std::unique_ptr<Buffer> *p_position_buf)
+{
+	LOGI("Growing the geometry arena from {} to {} elements of {} bytes", ranges.get_capacity(), capacity, element_size);
+
+	// FRAMES IN FLIGHT MAY STILL BE DRAWING FROM THE OLD BUFFERS, SO WE WAIT FOR THEM BEFORE THEY GO
+	device_.get_handle().waitIdle();
+	replace_buffer(p_buf, allocate, ranges.get_capacity() * element_size, capacity * element_size);
+	if (p_position_buf)
+	{
+		replace_buffer(*p_position_buf, allocate, ranges.get_capacity() * POSITION_SIZE, capacity * POSITION_SIZE);
+	}
+	ranges.grow(capacity);
+}
+
+void GeometryArena::replace_buffer(std::unique_ptr<Buffer> &p_buf, AllocateFunction allocate, vk::DeviceSize old_size, vk::DeviceSize size)
+{
+	std::unique_ptr<Buffer> p_new_buf = std::make_unique<Buffer>((device_.get_device_memory_allocator().*allocate)(size));
+	CommandBuffer           cmd_buf   = device_.begin_one_time_buf();
+	cmd_buf.copy_buffer(*p_buf, *p_new_buf, old_size);
+	device_.end_one_time_buf(cmd_buf);
+	p_buf = std::move(p_new_buf);
+}
+
+const Buffer &GeometryArena::get_vertex_buffer(sg::VertexFormat vertex_format) const
+{
+	return *p_vertex_bufs_[static_cast<size_t>(vertex_format)];
+}
+
+const Buffer &GeometryArena::get_position_buffer(sg::VertexFormat vertex_format) const
+{
+	return *p_position_bufs_[static_cast<size_t>(vertex_format)];
+}
+
+const Buffer &GeometryArena::get_index_buffer() const
+{
+	return *p_idx_buf_;
+}
+
+}        // namespace W3D
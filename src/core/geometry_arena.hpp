@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+
+#include "common/vk_common.hpp"
+#include "scene_graph/components/submesh.hpp"
+
+namespace W3D
+{
+class Device;
+class Buffer;
+class DeviceMemoryAllocator;
+
+/*
+* GeometryArena - one big device local vertex buffer per vertex format and one big index
+* buffer that every SubMesh's geometry is suballocated from, so draws of the same format only
+* have to bind them once and can be told apart by their vertexOffset and firstIndex alone,
+* which is what lets many of them be made by one indirect draw. Each buffer has a free list
+* of the ranges not in use, ranges are taken first fit and merged with their free
+* neighbours when given back. When a buffer runs out of room it is replaced by one twice
+* the size and the old contents are copied over. Every vertex buffer also has a position
+* buffer next to it, holding only the vertices' positions at the same offsets, which is
+* all a depth only pass has to read.
+*/
+class GeometryArena
+{
+  public:
+	// ELEMENTS THE BUFFERS START WITH ROOM FOR, FEW MESHES ARE SKINNED
+	static const uint32_t INITIAL_VERTEX_CAPACITY;
+	static const uint32_t INITIAL_SKINNED_VERTEX_CAPACITY;
+	static const uint32_t INITIAL_INDEX_CAPACITY;
+	static const uint32_t POSITION_SIZE;        // BYTES PER VERTEX OF THE POSITION BUFFERS
+
+	// WHERE ONE SUBMESH'S GEOMETRY IS, IN VERTICES AND INDICES RATHER THAN BYTES. 16 AND 32 BIT
+	// INDICES SHARE THE INDEX BUFFER, first_index COUNTS IN WHICHEVER idx_type IS
+	struct Allocation
+	{
+		sg::VertexFormat vertex_format = sg::VertexFormat::eStatic;        // WHICH VERTEX BUFFER
+		uint32_t         vertex_offset = 0;
+		uint32_t         vertex_count  = 0;
+		uint32_t         first_index   = 0;
+		uint32_t         idx_count     = 0;
+		vk::IndexType    idx_type      = vk::IndexType::eUint32;
+	};
+
+  private:
+	/*
+	* The ranges of a buffer that aren't in use, keyed by where they start.
+	*/
+	class FreeList
+	{
+	  private:
+		std::map<uint32_t, uint32_t> free_ranges_;        // FIRST ELEMENT TO ELEMENT COUNT
+		uint32_t                     capacity_ = 0;
+
+	  public:
+		FreeList(uint32_t capacity);
+
+		/*
+		* Takes count elements from the first free range big enough, returns false if there
+		* isn't one.
+		*/
+		bool allocate(uint32_t count, uint32_t &offset);
+
+		/*
+		* Gives back the count elements starting at offset.
+		*/
+		void free(uint32_t offset, uint32_t count);
+
+		/*
+		* Makes the elements from the old capacity up to capacity free.
+		*/
+		void grow(uint32_t capacity);
+
+		uint32_t get_capacity() const;
+	};
+
+	// ONE VERTEX BUFFER PER sg::VertexFormat, AND ONE OF THEIR POSITIONS THAT SHARES ITS FREE
+	// LIST. INDICES ARE THE SAME FOR ALL OF THEM SO THEY SHARE ONE, WHOSE FREE LIST COUNTS 32
+	// BIT WORDS SO 16 BIT INDICES TAKE THEM TWO AT A TIME
+	static const size_t VERTEX_FORMAT_COUNT = static_cast<size_t>(sg::VertexFormat::eCount);
+
+	Device                                                  &device_;
+	std::array<std::unique_ptr<Buffer>, VERTEX_FORMAT_COUNT> p_vertex_bufs_;
+	std::array<std::unique_ptr<Buffer>, VERTEX_FORMAT_COUNT> p_position_bufs_;
+	std::array<FreeList, VERTEX_FORMAT_COUNT>                vertex_ranges_;
+	std::unique_ptr<Buffer>                                  p_idx_buf_;
+	FreeList                                                 idx_ranges_;
+
+	// WHICH DeviceMemoryAllocator FUNCTION MAKES A BUFFER WHEN IT GROWS
+	using AllocateFunction = Buffer (DeviceMemoryAllocator::*)(size_t) const;
+
+	// BYTES PER INDEX, AND THE 32 BIT WORDS OF THE INDEX BUFFER idx_count OF THEM TAKE UP
+	static uint32_t get_index_size(vk::IndexType idx_type);
+	static uint32_t get_index_words(uint32_t idx_count, vk::IndexType idx_type);
+
+	// p_position_buf, WHEN GIVEN, GROWS ALONG WITH p_buf
+	uint32_t reserve(FreeList &ranges, std::unique_ptr<Buffer> &p_buf, AllocateFunction allocate, vk::DeviceSize element_size, uint32_t count, std::unique_ptr<Buffer> *p_position_buf = nullptr);
+	void     grow(FreeList &ranges, std::unique_ptr<Buffer> &p_buf, AllocateFunction allocate, vk::DeviceSize element_size, uint32_t capacity, std::unique_ptr<Buffer> *p_position_buf);
+	void     replace_buffer(std::unique_ptr<Buffer> &p_buf, AllocateFunction allocate, vk::DeviceSize old_size, vk::DeviceSize size);
+
+  public:
+	/*
+	* The constructor makes the buffers with their initial capacity.
+	*/
+	GeometryArena(Device &device);
+
+	/*
+	* The destructor lets the buffers go, every SubMesh should have freed its geometry by now.
+	*/
+	~GeometryArena();
+
+	// THESE ARE DEACTIVATED, SUBMESHES POINT AT THEIR ARENA
+	GeometryArena(const GeometryArena &)            = delete;
+	GeometryArena &operator=(const GeometryArena &) = delete;
+
+	/*
+	* Finds room for vertex_count vertices laid out as vertex_format and idx_count indices of
+	* idx_type and uploads them there, and the vertices' positions to the position buffer.
+	* Note the indices stay relative to the first vertex, draws add vertex_offset to them.
+	*/
+	Allocation allocate(sg::VertexFormat vertex_format, const void *p_vertices, uint32_t vertex_count, const void *p_indices, uint32_t idx_count, vk::IndexType idx_type);
+
+	/*
+	* Gives back the room allocation took, the GPU must be done drawing it.
+	*/
+	void free(const Allocation &allocation);
+
+	/*
+	* Accessor methods for getting the buffers, which change when they grow.
+	*/
+	const Buffer &get_vertex_buffer(sg::VertexFormat vertex_format) const;
+	const Buffer &get_position_buffer(sg::VertexFormat vertex_format) const;
+	const Buffer &get_index_buffer() const;
+};
+
+}        // namespace W3D
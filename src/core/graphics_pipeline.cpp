@@ -2,28 +2,30 @@
 #include "graphics_pipeline.hpp"
 
 // OUR OWN TYPES
-#include "common/file_utils.hpp"
 #include "common/utils.hpp"
 #include "device.hpp"
+#include "pipeline_cache.hpp"
 #include "pipeline_layout.hpp"
 #include "render_pass.hpp"
+#include "shader_module_cache.hpp"
 
 namespace W3D
 {
 
-GraphicsPipeline::GraphicsPipeline(Device &device, RenderPass &render_pass, GraphicsPipelineState &state, vk::PipelineLayoutCreateInfo &pl_layout_cinfo) :
+GraphicsPipeline::GraphicsPipeline(Device &device, RenderPass &render_pass, const GraphicsPipelineState &state, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo, uint32_t subpass) :
     device_(device)
 {
-	// LOAD AND CREATE THE VERTEX SHADER
-	vk::ShaderModule vert_shader_module = create_shader_module(state.vert_shader_name);
+	// GET THE VERTEX SHADER, WHICH IS ONLY LOADED THE FIRST TIME A PIPELINE USES IT
+	ShaderModuleCache &shader_module_cache = device_.get_shader_module_cache();
+	vk::ShaderModule   vert_shader_module  = shader_module_cache.get_shader_module(state.vert_shader_name);
 	vk::PipelineShaderStageCreateInfo vert_stage_cinfo{
 	    .stage  = vk::ShaderStageFlagBits::eVertex,
 	    .module = vert_shader_module,
 	    .pName  = "main",
 	};
 
-	// LOAD AND CREATE THE FRAGMENT SHADER
-	vk::ShaderModule frag_shader_module = create_shader_module(state.frag_shader_name);
+	// AND THE FRAGMENT SHADER, A PIPELINE THAT ONLY WRITES DEPTH DOESN'T NEED ONE
+	vk::ShaderModule frag_shader_module = state.frag_shader_name ? shader_module_cache.get_shader_module(state.frag_shader_name) : vk::ShaderModule();
 	vk::PipelineShaderStageCreateInfo frag_stage_cinfo{
 	    .stage  = vk::ShaderStageFlagBits::eFragment,
 	    .module = frag_shader_module,
@@ -35,6 +37,7 @@ GraphicsPipeline::GraphicsPipeline(Device &device, RenderPass &render_pass, Grap
 
 	// OUR SHADERS COVER TWO STAGES IN RENDERING, VERTEX AND FRAGMENT SHADING
 	std::array<vk::PipelineShaderStageCreateInfo, 2> shader_stages{vert_stage_cinfo, frag_stage_cinfo};
+	uint32_t                                         stage_count = frag_shader_module ? 2 : 1;
 
 	// SPECIFY THE ATTRIBUTE DATA FORMATS WE PLAN TO USE
 	vk::PipelineVertexInputStateCreateInfo vertex_input_cinfo{
@@ -108,7 +111,7 @@ GraphicsPipeline::GraphicsPipeline(Device &device, RenderPass &render_pass, Grap
 	// AND NOW USE ALL OF THE ABOVE SETTINGS STRUCTS TO CREATE THE PIPELINE. FIRST
 	// WE LOAD ALL THE SETTINGS INTO THIS OBJECT, WHICH WE'LL THEN USE
 	vk::GraphicsPipelineCreateInfo graphics_pipeline_cinfo{
-	    .stageCount          = to_u32(shader_stages.size()),
+	    .stageCount          = stage_count,
 	    .pStages             = shader_stages.data(),
 	    .pVertexInputState   = &vertex_input_cinfo,
 	    .pInputAssemblyState = &input_assembly_cinfo,
@@ -120,16 +123,12 @@ GraphicsPipeline::GraphicsPipeline(Device &device, RenderPass &render_pass, Grap
 	    .pDynamicState       = &dynamic_state_cinfo,
 	    .layout              = pl_layout_,
 	    .renderPass          = render_pass.get_handle(),
-	    .subpass             = 0,
+	    .subpass             = subpass,
 	};
 
 	// NOW THAT WE HAVE PROVIDED ALL THE APPROPRIATE RENDERING SETTINGS
 	// WE WISH TO USE IT'S TIME TO CREATE THE GRAPHIC PIPELINE FOR THIS DEVICE
-	handle_ = device_.get_handle().createGraphicsPipeline(nullptr, graphics_pipeline_cinfo).value;
-
-	// WE CAN NOW THROW AWAY THE SHADER MODULES AS THEY HAVE BEEN INCORPORATED INTO THE PIPELINE
-	device_.get_handle().destroyShaderModule(vert_shader_module);
-	device_.get_handle().destroyShaderModule(frag_shader_module);
+	handle_ = device_.get_handle().createGraphicsPipeline(device_.get_pipeline_cache().get_handle(), graphics_pipeline_cinfo).value;
 }
 
 GraphicsPipeline::~GraphicsPipeline()
@@ -147,19 +146,4 @@ vk::PipelineLayout GraphicsPipeline::get_pipeline_layout()
 	return pl_layout_;
 }
 
-vk::ShaderModule GraphicsPipeline::create_shader_module(const std::string &name)
-{
-	// LOAD ALL BYTES FROM THE SHADER FILE, WHICH SHOULD BE COMPILED BYTECODE
-	std::vector<uint8_t>       binary = fu::read_shader_binary(name);
-
-	// ASSIGN THE LOADED DATA TO OUR INFO OBJECT WHICH WE'LL USE NEXT TO CREATE THE SHADER
-	vk::ShaderModuleCreateInfo shader_module_cinfo{
-	    .codeSize = to_u32(binary.size()),
-	    .pCode    = reinterpret_cast<const uint32_t *>(binary.data()),
-	};
-
-	// HAVE THE LOGIGAL DEVICE CREATE THE SHADER MODULE AND RETURN
-	return device_.get_handle().createShaderModule(shader_module_cinfo);
-}
-
 }	// namespace W3D
\ No newline at end of file
@@ -81,7 +81,8 @@ struct ColorBlendState
 * This struct specifies all the details regarding the pipeline to be created,
 * including the names of the vertex and shader files. One of these must be
 * filled in before constructing the pipeline as it is to be provided to the
-* pipeline constructor.
+* pipeline constructor. A pipeline that only writes depth can leave the
+* fragment shader's name nullptr.
 */
 struct GraphicsPipelineState
 {
@@ -107,10 +108,11 @@ class GraphicsPipeline : public VulkanObject<vk::Pipeline>
 
   public:
 	/*
-	* The constructor does a complete will create the shader module to be associated with this pipeline so
-	* keep in mind that it will
+	* The constructor creates the pipeline, along with its layout, from the shader modules the
+	* device's shader module cache has for the state's shaders. The pipeline draws in the
+	* subpass of render_pass numbered subpass.
 	*/
-	GraphicsPipeline(Device &device, RenderPass &render_pass, GraphicsPipelineState &state, vk::PipelineLayoutCreateInfo &pl_layout_cinfo);
+	GraphicsPipeline(Device &device, RenderPass &render_pass, const GraphicsPipelineState &state, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo, uint32_t subpass = 0);
 	GraphicsPipeline(GraphicsPipeline &&) = default;
 	~GraphicsPipeline() override;
 
@@ -118,11 +120,6 @@ class GraphicsPipeline : public VulkanObject<vk::Pipeline>
 	 * Accessor method for getting this pipeline's layout.
 	 */
 	vk::PipelineLayout get_pipeline_layout();
-
-	/*
-	* This function creates a shader module
-	*/
-	vk::ShaderModule create_shader_module(const std::string &name);
 };
 
 }        // namespace W3D
\ No newline at end of file
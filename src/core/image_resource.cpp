@@ -1,6 +1,10 @@
 // IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
 #include "image_resource.hpp"
 
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cstring>
+
 #include <gli/gli.hpp>
 #include <stb_image.h>
 
@@ -13,11 +17,24 @@
 namespace W3D
 {
 
+// WE WANT IT FORMATTED FOR USE WITH VULKAN, NOT OpenGL
+static const std::unordered_map<gli::format, vk::Format> gli_to_vk_format_map = {
+    {gli::FORMAT_RGBA8_UNORM_PACK8, vk::Format::eR8G8B8A8Unorm},
+    {gli::FORMAT_RGBA32_SFLOAT_PACK32, vk::Format::eR32G32B32A32Sfloat},
+    {gli::FORMAT_RGBA16_SFLOAT_PACK16, vk::Format::eR16G16B16A16Sfloat},
+    {gli::FORMAT_RGBA_DXT5_UNORM_BLOCK16, vk::Format::eBc3UnormBlock},
+    {gli::FORMAT_RG32_SFLOAT_PACK32, vk::Format::eR32G32Sfloat},
+    {gli::FORMAT_RG16_SFLOAT_PACK16, vk::Format::eR16G16Sfloat},
+    {gli::FORMAT_RGB8_UNORM_PACK8, vk::Format::eR8G8B8Unorm},
+};
+
 uint8_t ImageResource::format_to_bytes_per_pixel(vk::Format format)
 {
 	// NOTE, WE COULD AND SHOULD ADD MORE FORMATS OVER TIME
 	static std::unordered_map<vk::Format, uint32_t> conversion_map{
 	    {vk::Format::eR32G32B32A32Sfloat, 16},
+	    {vk::Format::eR16G16B16A16Sfloat, 8},
+	    {vk::Format::eR16G16Sfloat, 4},
 	    {vk::Format::eR8G8B8A8Srgb, 4},
 	};
 
@@ -122,15 +139,6 @@ ImageResource ImageResource::create_empty_cubic_img_resrc(const Device &device,
 
 ImageTransferInfo gli_load(const std::string &path)
 {
-	// WE WANT IT FORMATTED FOR USE WITH VULKAN, NOT OpenGL
-	static const std::unordered_map<gli::format, vk::Format> gli_to_vk_format_map = {
-	    {gli::FORMAT_RGBA8_UNORM_PACK8, vk::Format::eR8G8B8A8Unorm},
-	    {gli::FORMAT_RGBA32_SFLOAT_PACK32, vk::Format::eR32G32B32A32Sfloat},
-	    {gli::FORMAT_RGBA_DXT5_UNORM_BLOCK16, vk::Format::eBc3UnormBlock},
-	    {gli::FORMAT_RG32_SFLOAT_PACK32, vk::Format::eR32G32Sfloat},
-	    {gli::FORMAT_RGB8_UNORM_PACK8, vk::Format::eR8G8B8Unorm},
-	};
-
 	std::string extension = fu::get_file_extension(path);
 	if (extension != "dds")
 	{
@@ -163,6 +171,51 @@ ImageTransferInfo gli_load(const std::string &path)
 	};
 }
 
+bool gli_save(const std::string &path, const ImageTransferInfo &img_tinfo, uint32_t layers)
+{
+	auto format_it = std::find_if(gli_to_vk_format_map.begin(), gli_to_vk_format_map.end(), [&](const auto &formats) {
+		return formats.second == img_tinfo.meta.format;
+	});
+	if (format_it == gli_to_vk_format_map.end())
+	{
+		return false;
+	}
+
+	// GLI KEEPS THE LEVELS OF EACH FACE TOGETHER TOO, SO THE BINARY CAN BE COPIED AS IS
+	gli::extent2d extent(img_tinfo.meta.extent.width, img_tinfo.meta.extent.height);
+	gli::texture  texture = layers == 6 ? gli::texture(gli::texture_cube(format_it->first, extent, img_tinfo.meta.levels)) : gli::texture(gli::texture2d(format_it->first, extent, img_tinfo.meta.levels));
+	if (texture.size() != img_tinfo.binary.size())
+	{
+		return false;
+	}
+	std::memcpy(texture.data(), img_tinfo.binary.data(), img_tinfo.binary.size());
+
+	std::vector<char> memory;
+	if (!gli::save_dds(texture, memory))
+	{
+		return false;
+	}
+	return fu::write_binary(path, std::vector<uint8_t>(memory.begin(), memory.end()));
+}
+
+bool gli_load_matching(const std::string &path, const ImageMetaInfo &meta, uint32_t layers, std::vector<uint8_t> &binary)
+{
+	gli::texture texture = gli::load(path);
+	if (texture.empty() || texture.layers() != 1 || texture.faces() != layers || texture.levels() != meta.levels ||
+	    to_u32(texture.extent().x) != meta.extent.width || to_u32(texture.extent().y) != meta.extent.height)
+	{
+		return false;
+	}
+	auto format_it = gli_to_vk_format_map.find(texture.format());
+	if (format_it == gli_to_vk_format_map.end() || format_it->second != meta.format)
+	{
+		return false;
+	}
+
+	binary.assign(texture.data<uint8_t>(), texture.data<uint8_t>() + texture.size());
+	return true;
+}
+
 ImageResource::ImageResource(const Device &device, std::nullptr_t nptr) :
     image_(device.get_device_memory_allocator().allocate_null_image()),
     view_(device, nptr)
@@ -34,6 +34,19 @@ struct ImageTransferInfo
 ImageTransferInfo stb_load(const std::string &path);
 ImageTransferInfo gli_load(const std::string &path);
 
+/*
+* Saves img_tinfo as a .dds file at path, a cube if layers is 6 and a two dimensional
+* image otherwise. Its binary holds every level of every layer one after the other, the
+* way CommandBuffer::update_image expects them. Returns false if it couldn't be saved.
+*/
+bool gli_save(const std::string &path, const ImageTransferInfo &img_tinfo, uint32_t layers);
+
+/*
+* Loads the .dds file at path into binary, laid out like gli_save's, if it is exactly the
+* image meta and layers describe. Unlike gli_load, a file that isn't returns false.
+*/
+bool gli_load_matching(const std::string &path, const ImageMetaInfo &meta, uint32_t layers, std::vector<uint8_t> &binary);
+
 class ImageView;
 
 /*
@@ -4,6 +4,7 @@
 // OUR OWN TYPES
 #include "common/common.hpp"
 #include "common/logging.hpp"
+#include "common/profiler.hpp"
 #include "common/utils.hpp"
 
 #include "device.hpp"
@@ -45,18 +46,28 @@ Instance::Instance(const std::string &app_name, Window &window)
 	surface_ = window.create_surface(*this);
 }
 
+Instance::Instance(const std::string &app_name) :
+    is_headless_(true)
+{
+	create_instance(app_name);
+}
+
 Instance::~Instance()
 {
 	if (ENABLE_VALIDATION_LAYERS)
 	{
 		handle_.destroyDebugUtilsMessengerEXT(debug_messenger_);
 	}
-	handle_.destroySurfaceKHR(surface_);
+	if (surface_)
+	{
+		handle_.destroySurfaceKHR(surface_);
+	}
 	handle_.destroy();
 }
 
 void Instance::create_instance(const std::string &app_name)
 {
+	W3D_PROFILE_SCOPE("Instance::create_instance");
 	if (ENABLE_VALIDATION_LAYERS && !is_validation_layer_supported())
 	{
 		throw std::runtime_error("validation layers requested, but not avaliable!");
@@ -112,7 +123,11 @@ std::vector<const char *> Instance::get_required_extensions()
 		extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
 	}
 
-	Window::push_required_extensions(extensions);
+	// A HEADLESS INSTANCE HAS NO WINDOW, SO IT DOESN'T NEED THE WINDOW SYSTEM EXTENSIONS
+	if (!is_headless_)
+	{
+		Window::push_required_extensions(extensions);
+	}
 
 	return extensions;
 }
@@ -211,6 +226,7 @@ inline VKAPI_ATTR VkBool32 VKAPI_CALL Instance::debug_callback(
 
 std::unique_ptr<PhysicalDevice> Instance::pick_physical_device()
 {
+	W3D_PROFILE_SCOPE("Instance::pick_physical_device");
 	auto physical_device_handles = handle_.enumeratePhysicalDevices();
 	if (!physical_device_handles.size())
 	{
@@ -233,9 +249,9 @@ std::unique_ptr<PhysicalDevice> Instance::pick_physical_device()
 bool Instance::is_physical_device_suitable(const PhysicalDevice &physical_device)
 {
 	const auto &indices                 = physical_device.get_queue_family_indices();
-	bool        is_extensions_supported = physical_device.is_all_extensions_supported(Device::REQUIRED_EXTENSIONS);
-	bool        is_swap_chain_supported = false;
-	if (is_extensions_supported)
+	bool        is_extensions_supported = physical_device.is_all_extensions_supported(Device::get_required_extensions(*this));
+	bool        is_swap_chain_supported = is_headless_;
+	if (is_extensions_supported && !is_headless_)
 	{
 		const auto &details     = physical_device.get_swapchain_support_details();
 		is_swap_chain_supported = !details.formats.empty() && !details.present_modes.empty();
@@ -251,4 +267,9 @@ const vk::SurfaceKHR &Instance::get_surface() const
 	return surface_;
 }
 
+bool Instance::is_headless() const
+{
+	return is_headless_;
+}
+
 }        // namespace W3D
@@ -21,15 +21,23 @@ class Instance : public VulkanObject<vk::Instance>
   private:
 	vk::SurfaceKHR             surface_         = nullptr;
 	vk::DebugUtilsMessengerEXT debug_messenger_ = nullptr;
+	bool                       is_headless_     = false;	// NO WINDOW, SO NO SURFACE OR PRESENTATION
 
   public:
 	static const std::vector<const char *> VALIDATION_LAYERS;
 
 	/*
-	* 
+	* Constructor creates the Vulkan instance along with the surface of the window
+	* argument, which is where we'll present our rendered frames.
 	*/
 	Instance(const std::string &app_name, Window &window);
 
+	/*
+	* Constructor for headless rendering, it creates the Vulkan instance without any
+	* window system extensions and without a surface, so nothing will be presented.
+	*/
+	Instance(const std::string &app_name);
+
 	/*
 	* Destructor destroys both the surface and the instance.
 	*/
@@ -46,6 +54,12 @@ class Instance : public VulkanObject<vk::Instance>
 	*/
 	const vk::SurfaceKHR           &get_surface() const;
 
+	/*
+	* Accessor method for testing if this instance was created without a window, in which
+	* case there is no surface and devices don't need presentation support.
+	*/
+	bool is_headless() const;
+
 	/*
 	* Accessor method for getting a vector of the required extensions for the Vulkan instance.
 	*/
@@ -0,0 +1,66 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "offscreen_target.hpp"
+
+// OUR OWN TYPES
+#include "device.hpp"
+#include "image_resource.hpp"
+#include "image_view.hpp"
+
+namespace W3D
+{
+
+OffscreenTarget::OffscreenTarget(Device &device, vk::Extent2D extent, uint32_t image_count, vk::Format color_format) :
+    device_(device),
+    extent_(extent),
+    color_format_(color_format)
+{
+	const DeviceMemoryAllocator &allocator = device_.get_device_memory_allocator();
+
+	vk::ImageCreateInfo image_cinfo{
+	    .imageType = vk::ImageType::e2D,
+	    .format    = color_format_,
+	    .extent    = vk::Extent3D{
+	           .width  = extent_.width,
+	           .height = extent_.height,
+	           .depth  = 1,
+        },
+	    .mipLevels     = 1,
+	    .arrayLayers   = 1,
+	    .samples       = vk::SampleCountFlagBits::e1,
+	    .tiling        = vk::ImageTiling::eOptimal,
+	    .usage         = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+	    .sharingMode   = vk::SharingMode::eExclusive,
+	    .initialLayout = vk::ImageLayout::eUndefined,
+	};
+
+	// EACH FRAME IN FLIGHT GETS ITS OWN COLOR IMAGE SO A FRAME BEING READ BACK
+	// IS NEVER OVERWRITTEN BY THE NEXT ONE
+	color_resources_.reserve(image_count);
+	for (uint32_t i = 0; i < image_count; i++)
+	{
+		Image                   img        = allocator.allocate_device_only_image(image_cinfo);
+		vk::ImageViewCreateInfo view_cinfo = ImageView::two_dim_view_cinfo(img.get_handle(), color_format_, vk::ImageAspectFlagBits::eColor, 1);
+		color_resources_.emplace_back(std::move(img), ImageView(device_, view_cinfo));
+	}
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+}
+
+vk::Extent2D OffscreenTarget::get_extent() const
+{
+	return extent_;
+}
+
+vk::Format OffscreenTarget::get_color_format() const
+{
+	return color_format_;
+}
+
+ImageResource &OffscreenTarget::get_color_resource(uint32_t idx)
+{
+	return color_resources_[idx];
+}
+
+}	// namespace W3D
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "common/vk_common.hpp"
+#include <memory>
+
+namespace W3D
+{
+class Device;
+class ImageResource;
+
+/*
+* OffscreenTarget - this class stands in for the Swapchain when we render headless, i.e.
+* without a window. It owns one color image per frame in flight, so frames can be rendered,
+* and optionally copied back to the host, without ever being presented. Like the swapchain's
+* images they are imported into the frame's RenderGraph, which makes the depth image and the
+* framebuffers.
+*/
+class OffscreenTarget
+{
+  private:
+	Device                    &device_;				// LOGICAL DEVICE
+	vk::Extent2D               extent_;				// SIZE OF ALL OUR IMAGES
+	vk::Format                 color_format_;		// FORMAT OF THE COLOR IMAGES
+	std::vector<ImageResource> color_resources_;	// ONE COLOR IMAGE PER FRAME IN FLIGHT
+
+  public:
+	/*
+	* Constructor creates image_count color images of extent size. Note the color images can
+	* be used as transfer sources so they can be read back.
+	*/
+	OffscreenTarget(Device &device, vk::Extent2D extent, uint32_t image_count, vk::Format color_format = vk::Format::eR8G8B8A8Unorm);
+
+	/*
+	* Nothing for this destructor to destroy, the images clean themselves up.
+	*/
+	~OffscreenTarget();
+
+	// THESE ARE DEACTIVATED
+	OffscreenTarget(const OffscreenTarget &)            = delete;
+	OffscreenTarget &operator=(const OffscreenTarget &) = delete;
+	OffscreenTarget(OffscreenTarget &&)                 = delete;
+	OffscreenTarget &operator=(OffscreenTarget &&)      = delete;
+
+	/*
+	* Accessor method for getting the size of the images we render to.
+	*/
+	vk::Extent2D get_extent() const;
+
+	/*
+	* Accessor method for getting the format of the color images.
+	*/
+	vk::Format get_color_format() const;
+
+	/*
+	* Accessor method for getting the color image associated with idx.
+	*/
+	ImageResource &get_color_resource(uint32_t idx);
+
+};	// class OffscreenTarget
+
+}	// namespace W3D
@@ -57,9 +57,12 @@ void PhysicalDevice::find_queue_familiy_indices()
 			indices.compute_index = i;
 		}
 
-		bool is_present_supported = handle_.getSurfaceSupportKHR(i, surface);
-
-		if (is_present_supported)
+		// WITHOUT A SURFACE NOTHING IS PRESENTED, SO THE GRAPHICS QUEUE STANDS IN FOR PRESENTATION
+		if (!surface)
+		{
+			indices.present_index = indices.graphics_index;
+		}
+		else if (handle_.getSurfaceSupportKHR(i, surface))
 		{
 			indices.present_index = i;
 		}
@@ -0,0 +1,63 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "pipeline_builder.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <exception>
+
+// OUR OWN TYPES
+#include "common/profiler.hpp"
+#include "common/thread_pool.hpp"
+#include "common/utils.hpp"
+#include "compute_pipeline.hpp"
+#include "device.hpp"
+
+namespace W3D
+{
+
+PipelineBuilder::PipelineBuilder(Device &device) :
+    device_(device)
+{
+}
+
+void PipelineBuilder::add_graphics_pipeline(std::unique_ptr<GraphicsPipeline> &p_pl, RenderPass &render_pass, const GraphicsPipelineState &state, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo, uint32_t subpass)
+{
+	jobs_.push_back([this, &p_pl, &render_pass, state, pl_layout_cinfo, subpass]() {
+		p_pl = std::make_unique<GraphicsPipeline>(device_, render_pass, state, pl_layout_cinfo, subpass);
+	});
+}
+
+void PipelineBuilder::add_compute_pipeline(std::unique_ptr<ComputePipeline> &p_pl, const char *shader_name, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo)
+{
+	jobs_.push_back([this, &p_pl, shader_name, pl_layout_cinfo]() {
+		p_pl = std::make_unique<ComputePipeline>(device_, shader_name, pl_layout_cinfo);
+	});
+}
+
+void PipelineBuilder::build(ThreadPool &thread_pool)
+{
+	W3D_PROFILE_SCOPE("PipelineBuilder::build");
+
+	// AN EXCEPTION CAN'T LEAVE A WORKER THREAD, SO EACH JOB KEEPS ITS OWN FOR THE CALLER
+	std::vector<std::exception_ptr> errors(jobs_.size());
+	thread_pool.parallel_for(to_u32(jobs_.size()), [&](uint32_t idx) {
+		try
+		{
+			jobs_[idx]();
+		}
+		catch (...)
+		{
+			errors[idx] = std::current_exception();
+		}
+	});
+	jobs_.clear();
+
+	for (const std::exception_ptr &error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+}        // namespace W3D
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "common/vk_common.hpp"
+#include "graphics_pipeline.hpp"
+
+namespace W3D
+{
+class Device;
+class RenderPass;
+class ComputePipeline;
+class ThreadPool;
+
+/*
+* PipelineBuilder - collects the pipelines that are needed at the same time and then
+* creates all of them at once, spread over the threads of a ThreadPool, instead of one after
+* the other on one thread. They all go through the device's pipeline cache and shader
+* module cache. Note the states and create infos are copied when a pipeline is added, but
+* whatever they point to, like vertex descriptions and set layouts, only has to outlive
+* build, which is when the pipelines are created.
+*/
+class PipelineBuilder
+{
+  private:
+	Device                            &device_;
+	std::vector<std::function<void()>> jobs_;        // EACH ONE CREATES ONE PIPELINE
+
+  public:
+	/*
+	* The constructor makes a builder with nothing to build yet.
+	*/
+	PipelineBuilder(Device &device);
+
+	/*
+	* Adds a graphics pipeline, which build will put in p_pl. The pipeline draws in the
+	* subpass of render_pass numbered subpass.
+	*/
+	void add_graphics_pipeline(std::unique_ptr<GraphicsPipeline> &p_pl, RenderPass &render_pass, const GraphicsPipelineState &state, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo, uint32_t subpass = 0);
+
+	/*
+	* Adds a compute pipeline running the compiled compute shader named shader_name, which
+	* build will put in p_pl.
+	*/
+	void add_compute_pipeline(std::unique_ptr<ComputePipeline> &p_pl, const char *shader_name, const vk::PipelineLayoutCreateInfo &pl_layout_cinfo);
+
+	/*
+	* Creates every pipeline that was added on the threads of thread_pool and returns when
+	* they're all done. If creating any of them threw, the first exception is thrown again
+	* here once the others are finished.
+	*/
+	void build(ThreadPool &thread_pool);
+};
+
+}        // namespace W3D
@@ -0,0 +1,102 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "pipeline_cache.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <cstring>
+#include <filesystem>
+
+// OUR OWN TYPES
+#include "common/file_utils.hpp"
+#include "common/logging.hpp"
+#include "device.hpp"
+#include "physical_device.hpp"
+
+namespace W3D
+{
+
+// THE HEADER IS FOUR 32 BIT WORDS, LENGTH, VERSION, VENDOR AND DEVICE, FOLLOWED BY THE UUID
+static const size_t PIPELINE_CACHE_HEADER_SIZE = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+
+/*
+* read_u32 - reads the header word at offset, which the spec always stores least
+* significant byte first whatever the host's byte order.
+*/
+static uint32_t read_u32(const std::vector<uint8_t> &data, size_t offset)
+{
+	return static_cast<uint32_t>(data[offset]) |
+	       static_cast<uint32_t>(data[offset + 1]) << 8 |
+	       static_cast<uint32_t>(data[offset + 2]) << 16 |
+	       static_cast<uint32_t>(data[offset + 3]) << 24;
+}
+
+PipelineCache::PipelineCache(Device &device, const std::string &path) :
+    device_(device),
+    path_(path)
+{
+	std::vector<uint8_t> data;
+	if (!path_.empty() && std::filesystem::exists(path_))
+	{
+		data = fu::read_binary(path_);
+		if (is_compatible(data))
+		{
+			LOGI("Loaded {} bytes of pipeline cache from {}", data.size(), path_);
+		}
+		else
+		{
+			LOGW("{} was made by another driver or GPU, starting with an empty pipeline cache", path_);
+			data.clear();
+		}
+	}
+
+	vk::PipelineCacheCreateInfo pipeline_cache_cinfo{
+	    .initialDataSize = data.size(),
+	    .pInitialData    = data.data(),
+	};
+	handle_ = device_.get_handle().createPipelineCache(pipeline_cache_cinfo);
+}
+
+PipelineCache::~PipelineCache()
+{
+	if (handle_)
+	{
+		device_.get_handle().destroyPipelineCache(handle_);
+	}
+}
+
+bool PipelineCache::is_compatible(const std::vector<uint8_t> &data) const
+{
+	if (data.size() < PIPELINE_CACHE_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	uint32_t header_size    = read_u32(data, 0);
+	uint32_t header_version = read_u32(data, 4);
+	uint32_t vendor_id      = read_u32(data, 8);
+	uint32_t device_id      = read_u32(data, 12);
+
+	vk::PhysicalDeviceProperties properties = device_.get_physical_device().get_handle().getProperties();
+	return header_size >= PIPELINE_CACHE_HEADER_SIZE && header_size <= data.size() &&
+	       header_version == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+	       vendor_id == properties.vendorID && device_id == properties.deviceID &&
+	       !std::memcmp(data.data() + 16, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+}
+
+bool PipelineCache::save() const
+{
+	if (path_.empty())
+	{
+		return true;
+	}
+
+	std::vector<uint8_t> data = device_.get_handle().getPipelineCacheData(handle_);
+	if (!fu::write_binary(path_, data))
+	{
+		LOGW("Unable to save the pipeline cache to {}", path_);
+		return false;
+	}
+	LOGI("Saved {} bytes of pipeline cache to {}", data.size(), path_);
+	return true;
+}
+
+}        // namespace W3D
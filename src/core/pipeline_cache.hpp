@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "common/vk_common.hpp"
+#include "core/vulkan_object.hpp"
+
+namespace W3D
+{
+class Device;
+
+/*
+* Serves as a wrapper class for a Vulkan API PipelineCache object, which every pipeline of
+* a device is created through so the driver only has to compile a pipeline it has seen
+* before once. The cache is loaded from a file when it's made and saved back to it when
+* asked, so that holds from one run to the next too. What's in the file is only handed to
+* the driver if its header says it was made by the same driver for the same GPU, anything
+* else is thrown away and the cache starts out empty.
+*/
+class PipelineCache : public VulkanObject<vk::PipelineCache>
+{
+  private:
+	Device     &device_;        // LOGICAL DEVICE FOR THIS PIPELINE CACHE
+	std::string path_;          // WHERE IT'S LOADED FROM AND SAVED TO, EMPTY FOR NEITHER
+
+	/*
+	* Tests whether data starts with a pipeline cache header this device's driver wrote.
+	*/
+	bool is_compatible(const std::vector<uint8_t> &data) const;
+
+  public:
+	/*
+	* Constructor creates the Vulkan pipeline cache, starting it with what's in the file at
+	* path if there is one this device can use.
+	*/
+	PipelineCache(Device &device, const std::string &path);
+
+	/*
+	* Since the constructor creates the handle, this destructor has to destroy the
+	* Vulkan API object. Note it doesn't save the cache.
+	*/
+	~PipelineCache() override;
+
+	/*
+	* Writes everything in the cache to its file, returning false if that failed. The old
+	* file is only replaced once the new one has been written in full.
+	*/
+	bool save() const;
+
+};        // class PipelineCache
+
+}        // namespace W3D
@@ -0,0 +1,46 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "query_pool.hpp"
+
+// OUR OWN TYPES
+#include "device.hpp"
+
+namespace W3D
+{
+
+QueryPool::QueryPool(const Device &device, std::nullptr_t nptr) :
+    device_(device)
+{
+}
+
+QueryPool::QueryPool(const Device &device, vk::QueryType type, uint32_t count) :
+    device_(device),
+    count_(count)
+{
+	vk::QueryPoolCreateInfo query_pool_cinfo{
+	    .queryType  = type,
+	    .queryCount = count_,
+	};
+	handle_ = device_.get_handle().createQueryPool(query_pool_cinfo);
+}
+
+QueryPool::QueryPool(QueryPool &&rhs) :
+    VulkanObject<vk::QueryPool>(std::move(rhs)),
+    device_(rhs.device_),
+    count_(rhs.count_)
+{
+}
+
+QueryPool::~QueryPool()
+{
+	if (handle_)
+	{
+		device_.get_handle().destroyQueryPool(handle_);
+	}
+}
+
+uint32_t QueryPool::get_count() const
+{
+	return count_;
+}
+
+}        // namespace W3D
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "common/vk_common.hpp"
+#include "core/vulkan_object.hpp"
+
+namespace W3D
+{
+class Device;
+
+/*
+* A wrapper class for a Vulkan API query pool, i.e. vk::QueryPool, which we use to have the
+* GPU write timestamps into so we can see how long it spends on each part of a frame.
+*/
+class QueryPool : public VulkanObject<vk::QueryPool>
+{
+  private:
+	const Device &device_;
+	uint32_t      count_ = 0;        // NUMBER OF QUERIES IN THE POOL
+
+  public:
+	QueryPool(const Device &device, std::nullptr_t nptr);
+	QueryPool(const Device &device, vk::QueryType type, uint32_t count);
+	QueryPool(QueryPool &&rhs);
+	~QueryPool() override;
+
+	/*
+	* Accessor method for getting the number of queries in this pool.
+	*/
+	uint32_t get_count() const;
+};
+}        // namespace W3D
@@ -0,0 +1,1078 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "render_graph.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cstdlib>
+
+// OUR OWN TYPES
+#include "command_buffer.hpp"
+#include "common/error.hpp"
+#include "common/logging.hpp"
+#include "common/utils.hpp"
+#include "device.hpp"
+#include "device_memory/image.hpp"
+#include "framebuffer.hpp"
+#include "image_resource.hpp"
+#include "image_view.hpp"
+#include "render_pass.hpp"
+
+namespace W3D
+{
+
+const vk::ImageSubresourceRange RenderGraph::WHOLE_IMAGE = {
+    .aspectMask     = {},
+    .baseMipLevel   = 0,
+    .levelCount     = VK_REMAINING_MIP_LEVELS,
+    .baseArrayLayer = 0,
+    .layerCount     = VK_REMAINING_ARRAY_LAYERS,
+};
+
+// THE LAYOUT AN IMAGE MUST BE IN FOR ONE KIND OF USE, AND THE STAGES AND ACCESSES OF IT
+struct AccessInfo
+{
+	vk::ImageLayout        layout;
+	vk::PipelineStageFlags stages;
+	vk::AccessFlags        access;
+};
+
+static AccessInfo get_access_info(RenderGraph::Access access, RenderGraph::PassType type)
+{
+	vk::PipelineStageFlags shader_stages = type == RenderGraph::PassType::eCompute ? vk::PipelineStageFlagBits::eComputeShader : vk::PipelineStageFlagBits::eFragmentShader;
+	switch (access)
+	{
+		case RenderGraph::Access::eColorAttachment:
+			return {vk::ImageLayout::eColorAttachmentOptimal, vk::PipelineStageFlagBits::eColorAttachmentOutput,
+			        vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite};
+		case RenderGraph::Access::eDepthAttachment:
+			return {vk::ImageLayout::eDepthStencilAttachmentOptimal, vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+			        vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite};
+		case RenderGraph::Access::eSampled:
+			return {vk::ImageLayout::eShaderReadOnlyOptimal, shader_stages, vk::AccessFlagBits::eShaderRead};
+		case RenderGraph::Access::eStorage:
+			return {vk::ImageLayout::eGeneral, shader_stages, vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite};
+		case RenderGraph::Access::eTransferSrc:
+			return {vk::ImageLayout::eTransferSrcOptimal, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead};
+		case RenderGraph::Access::eTransferDst:
+			return {vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite};
+	}
+	return {};
+}
+
+// WHAT WHOEVER USES AN IMAGE AFTER THE GRAPH MOST LIKELY DOES WITH IT, GOING BY ITS FINAL LAYOUT
+static AccessInfo get_final_access_info(vk::ImageLayout layout)
+{
+	switch (layout)
+	{
+		case vk::ImageLayout::eShaderReadOnlyOptimal:
+			return {layout, vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eComputeShader, vk::AccessFlagBits::eShaderRead};
+		case vk::ImageLayout::eTransferSrcOptimal:
+			return {layout, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead};
+		case vk::ImageLayout::ePresentSrcKHR:
+			return {layout, vk::PipelineStageFlagBits::eBottomOfPipe, {}};
+		default:
+			return {layout, vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite};
+	}
+}
+
+static vk::AccessFlags get_write_access(vk::AccessFlags access)
+{
+	return access & (vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite | vk::AccessFlagBits::eShaderWrite |
+	                 vk::AccessFlagBits::eTransferWrite | vk::AccessFlagBits::eMemoryWrite);
+}
+
+static vk::ImageUsageFlags get_usage(RenderGraph::Access access)
+{
+	switch (access)
+	{
+		case RenderGraph::Access::eColorAttachment:
+			return vk::ImageUsageFlagBits::eColorAttachment;
+		case RenderGraph::Access::eDepthAttachment:
+			return vk::ImageUsageFlagBits::eDepthStencilAttachment;
+		case RenderGraph::Access::eSampled:
+			return vk::ImageUsageFlagBits::eSampled;
+		case RenderGraph::Access::eStorage:
+			return vk::ImageUsageFlagBits::eStorage;
+		case RenderGraph::Access::eTransferSrc:
+			return vk::ImageUsageFlagBits::eTransferSrc;
+		case RenderGraph::Access::eTransferDst:
+			return vk::ImageUsageFlagBits::eTransferDst;
+	}
+	return {};
+}
+
+static bool is_attachment(RenderGraph::Access access)
+{
+	return access == RenderGraph::Access::eColorAttachment || access == RenderGraph::Access::eDepthAttachment;
+}
+
+static vk::ImageAspectFlags get_aspect(vk::Format format)
+{
+	switch (format)
+	{
+		case vk::Format::eD16Unorm:
+		case vk::Format::eX8D24UnormPack32:
+		case vk::Format::eD32Sfloat:
+			return vk::ImageAspectFlagBits::eDepth;
+		case vk::Format::eD16UnormS8Uint:
+		case vk::Format::eD24UnormS8Uint:
+		case vk::Format::eD32SfloatS8Uint:
+			return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+		case vk::Format::eS8Uint:
+			return vk::ImageAspectFlagBits::eStencil;
+		default:
+			return vk::ImageAspectFlagBits::eColor;
+	}
+}
+
+static bool overlaps(const vk::ImageSubresourceRange &a, const vk::ImageSubresourceRange &b)
+{
+	return a.baseMipLevel < b.baseMipLevel + b.levelCount && b.baseMipLevel < a.baseMipLevel + a.levelCount &&
+	       a.baseArrayLayer < b.baseArrayLayer + b.layerCount && b.baseArrayLayer < a.baseArrayLayer + a.layerCount;
+}
+
+static vk::Extent2D get_level_extent(vk::Extent2D extent, uint32_t level)
+{
+	return {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u)};
+}
+
+RenderGraph::RenderGraph(Device &device) :
+    device_(device)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+	release();
+}
+
+RenderGraph::ImageHandle RenderGraph::add_image(const std::string &name, const ImageDesc &desc)
+{
+	ImageHandle handle = to_u32(images_.size());
+	images_.emplace_back();
+	GraphImage &image    = images_.back();
+	image.name           = name;
+	image.desc           = desc;
+	image.aspect         = get_aspect(desc.format);
+	image.alias_previous = handle;
+	return handle;
+}
+
+RenderGraph::ImageHandle RenderGraph::create_image(const std::string &name, const ImageDesc &desc)
+{
+	return add_image(name, desc);
+}
+
+RenderGraph::ImageHandle RenderGraph::import_image(const std::string &name, const ImageDesc &desc, vk::ImageLayout final_layout, vk::ImageLayout initial_layout, vk::PipelineStageFlags initial_stages)
+{
+	ImageHandle handle   = add_image(name, desc);
+	GraphImage &image    = images_[handle];
+	image.is_imported    = true;
+	image.initial_layout = initial_layout;
+	image.initial_stages = initial_stages;
+	image.final_layout   = final_layout;
+	return handle;
+}
+
+RenderGraph::ImageHandle RenderGraph::import_image(const std::string &name, ImageResource &resource, vk::ImageLayout final_layout, vk::ImageLayout initial_layout)
+{
+	Image                           &image = resource.get_image();
+	const vk::ImageSubresourceRange &range = resource.get_view().get_subresource_range();
+	vk::Extent3D                     extent = image.get_base_extent();
+	ImageDesc                        desc{
+	                           .format = image.get_format(),
+	                           .extent = {extent.width, extent.height},
+	                           .levels = range.levelCount,
+	                           .layers = range.layerCount,
+    };
+	ImageHandle handle = import_image(name, desc, final_layout, initial_layout);
+	set_imported_image(handle, image.get_handle(), resource.get_view().get_handle());
+	return handle;
+}
+
+void RenderGraph::set_imported_image(ImageHandle image, vk::Image image_h, vk::ImageView view)
+{
+	images_[image].image = image_h;
+	images_[image].view  = view;
+}
+
+RenderGraph::PassHandle RenderGraph::add_pass(const std::string &name, PassType type, RecordFunction record, vk::SubpassContents contents)
+{
+	passes_.push_back(Pass{
+	    .name     = name,
+	    .type     = type,
+	    .record   = std::move(record),
+	    .contents = contents,
+	});
+	return to_u32(passes_.size() - 1);
+}
+
+void RenderGraph::add_use(PassHandle pass, ImageHandle image, Access access, bool is_write, const vk::ImageSubresourceRange &range, std::optional<vk::ClearValue> clear)
+{
+	// THE REMAINING LEVELS AND LAYERS ARE COUNTED NOW SO RANGES CAN BE COMPARED
+	const GraphImage         &graph_image = images_[image];
+	vk::ImageSubresourceRange resolved    = range;
+	resolved.aspectMask                   = graph_image.aspect;
+	if (range.levelCount == VK_REMAINING_MIP_LEVELS)
+	{
+		resolved.levelCount = graph_image.desc.levels - range.baseMipLevel;
+	}
+	if (range.layerCount == VK_REMAINING_ARRAY_LAYERS)
+	{
+		resolved.layerCount = graph_image.desc.layers - range.baseArrayLayer;
+	}
+	if (is_attachment(access) && resolved.levelCount != 1)
+	{
+		LOGE("Pass {} draws to {} levels of {} at once, attachments are one level", passes_[pass].name, resolved.levelCount, graph_image.name);
+		abort();
+	}
+	if (is_attachment(access) && resolved.layerCount > 1 && !device_.is_multiview_supported())
+	{
+		LOGE("Pass {} draws to {} layers of {} at once, which needs multiview and the device doesn't support it", passes_[pass].name,
+		     resolved.layerCount, graph_image.name);
+		abort();
+	}
+	passes_[pass].uses.push_back(ImageUse{image, access, is_write, resolved, clear});
+}
+
+void RenderGraph::write_color(PassHandle pass, ImageHandle image, std::optional<vk::ClearValue> clear, const vk::ImageSubresourceRange &range)
+{
+	add_use(pass, image, Access::eColorAttachment, true, range, clear);
+}
+
+void RenderGraph::write_depth(PassHandle pass, ImageHandle image, std::optional<vk::ClearValue> clear, const vk::ImageSubresourceRange &range)
+{
+	add_use(pass, image, Access::eDepthAttachment, true, range, clear);
+}
+
+void RenderGraph::read_image(PassHandle pass, ImageHandle image, Access access, const vk::ImageSubresourceRange &range)
+{
+	if (is_attachment(access))
+	{
+		LOGE("Pass {} reads {} as an attachment, use write_color or write_depth", passes_[pass].name, images_[image].name);
+		abort();
+	}
+	add_use(pass, image, access, access == Access::eStorage, range, std::nullopt);
+}
+
+void RenderGraph::write_image(PassHandle pass, ImageHandle image, Access access, const vk::ImageSubresourceRange &range)
+{
+	if (is_attachment(access))
+	{
+		LOGE("Pass {} writes {} as an attachment, use write_color or write_depth", passes_[pass].name, images_[image].name);
+		abort();
+	}
+	add_use(pass, image, access, true, range, std::nullopt);
+}
+
+void RenderGraph::set_side_effects(PassHandle pass)
+{
+	passes_[pass].has_side_effects = true;
+}
+
+void RenderGraph::release()
+{
+	// THE FRAMEBUFFERS GO BEFORE THE VIEWS THEY WERE MADE WITH
+	groups_.clear();
+	range_views_.clear();
+	for (GraphImage &image : images_)
+	{
+		image.state = ImageState{};
+		if (!image.is_imported)
+		{
+			image.p_resource.reset();
+			image.image = nullptr;
+			image.view  = nullptr;
+		}
+	}
+	for (VmaAllocation allocation : memory_blocks_)
+	{
+		device_.get_device_memory_allocator().free_memory(allocation);
+	}
+	memory_blocks_.clear();
+	final_barriers_ = BarrierBatch{};
+	is_compiled_    = false;
+}
+
+void RenderGraph::compile()
+{
+	release();
+	cull_passes();
+	group_passes();
+	allocate_images();
+
+	// THE FIRST RUN THROUGH ONLY FINDS OUT WHAT AN EXECUTION LEAVES THE TRANSIENT IMAGES DOING,
+	// SO THE SECOND ONE KNOWS WHAT THE PREVIOUS EXECUTION MAY STILL BE DOING WITH THEIR MEMORY
+	derive_synchronization(false);
+	derive_synchronization(true);
+	is_compiled_ = true;
+
+	uint32_t culled_count = to_u32(std::count_if(passes_.begin(), passes_.end(), [](const Pass &pass) { return pass.is_culled; }));
+	uint32_t render_pass_count =
+	    to_u32(std::count_if(groups_.begin(), groups_.end(), [](const PassGroup &group) { return group.p_render_pass != nullptr; }));
+	LOGI("Compiled a render graph of {} passes, {} culled, into {} render passes and {} other passes", passes_.size(), culled_count,
+	     render_pass_count, groups_.size() - render_pass_count);
+}
+
+void RenderGraph::cull_passes()
+{
+	// GOING BACKWARDS A PASS IS KEPT IF IT HAS SIDE EFFECTS OR WRITES AN IMPORTED IMAGE OR AN
+	// IMAGE A KEPT PASS AFTER IT USES. AN ATTACHMENT THAT'S CLEARED DOESN'T USE WHAT IT HELD
+	std::vector<bool> is_needed(images_.size(), false);
+	for (size_t i = passes_.size(); i-- > 0;)
+	{
+		Pass &pass     = passes_[i];
+		pass.is_culled = !pass.has_side_effects;
+		for (const ImageUse &use : pass.uses)
+		{
+			if (use.is_write && (images_[use.image].is_imported || is_needed[use.image]))
+			{
+				pass.is_culled = false;
+			}
+		}
+		if (pass.is_culled)
+		{
+			LOGD("Culled the render graph pass {}", pass.name);
+			continue;
+		}
+		for (const ImageUse &use : pass.uses)
+		{
+			is_needed[use.image] = !use.clear.has_value();
+		}
+	}
+}
+
+void RenderGraph::group_passes()
+{
+	// WHICH IMAGES THE LAST GROUP USES AS ATTACHMENTS, AND WHICH PART OF THEM, AND WHICH IN
+	// OTHER WAYS, A RENDER PASS CAN'T SAMPLE WHAT ONE OF ITS SUBPASSES DRAWS
+	std::vector<bool>                      is_attachment_use(images_.size(), false);
+	std::vector<vk::ImageSubresourceRange> attachment_ranges(images_.size());
+	std::vector<bool>                      is_other_use(images_.size(), false);
+	for (PassHandle i = 0; i < to_u32(passes_.size()); i++)
+	{
+		Pass &pass = passes_[i];
+		if (pass.is_culled)
+		{
+			continue;
+		}
+
+		// GRAPHICS PASSES DRAW AT THE SIZE OF THE LEVEL OF THEIR ATTACHMENTS, TO AS MANY LAYERS AS
+		// THEY HAVE, THE OTHERS ARE GIVEN THEIR FIRST IMAGE'S SIZE
+		vk::Extent2D extent;
+		uint32_t     view_count     = 1;
+		bool         has_attachment = false;
+		for (const ImageUse &use : pass.uses)
+		{
+			if (!has_attachment && is_attachment(use.access))
+			{
+				extent         = get_level_extent(images_[use.image].desc.extent, use.range.baseMipLevel);
+				view_count     = use.range.layerCount;
+				has_attachment = true;
+			}
+			else if (!has_attachment && pass.type != PassType::eGraphics)
+			{
+				extent         = images_[use.image].desc.extent;
+				has_attachment = true;
+			}
+		}
+		if (pass.type == PassType::eGraphics && !has_attachment)
+		{
+			LOGE("The graphics pass {} has nothing to draw to", pass.name);
+			abort();
+		}
+
+		bool can_merge = pass.type == PassType::eGraphics && !groups_.empty() && groups_.back().extent == extent &&
+		                 groups_.back().view_count == view_count && passes_[groups_.back().passes[0]].type == PassType::eGraphics;
+		for (const ImageUse &use : pass.uses)
+		{
+			can_merge = can_merge && (is_attachment(use.access) ? !is_other_use[use.image] && (!is_attachment_use[use.image] || attachment_ranges[use.image] == use.range) :
+			                                                      !is_attachment_use[use.image]);
+		}
+		if (!can_merge)
+		{
+			groups_.emplace_back();
+			groups_.back().extent     = extent;
+			groups_.back().view_count = view_count;
+			std::fill(is_attachment_use.begin(), is_attachment_use.end(), false);
+			std::fill(is_other_use.begin(), is_other_use.end(), false);
+		}
+		for (const ImageUse &use : pass.uses)
+		{
+			(is_attachment(use.access) ? is_attachment_use : is_other_use)[use.image] = true;
+			if (is_attachment(use.access))
+			{
+				attachment_ranges[use.image] = use.range;
+			}
+		}
+		pass.group   = to_u32(groups_.size() - 1);
+		pass.subpass = to_u32(groups_.back().passes.size());
+		groups_.back().passes.push_back(i);
+	}
+}
+
+void RenderGraph::allocate_images()
+{
+	const DeviceMemoryAllocator &allocator = device_.get_device_memory_allocator();
+
+	// AN IMAGE LIVES FROM THE FIRST GROUP THAT USES IT TO THE LAST, AND IS MADE FOR ALL ITS USES
+	std::vector<bool> is_used(images_.size(), false);
+	std::vector<bool> is_attachment_only(images_.size(), true);
+	for (GraphImage &image : images_)
+	{
+		image.usage = {};
+	}
+	for (const Pass &pass : passes_)
+	{
+		if (pass.is_culled)
+		{
+			continue;
+		}
+		for (const ImageUse &use : pass.uses)
+		{
+			GraphImage &image = images_[use.image];
+			if (!is_used[use.image])
+			{
+				image.first_group   = pass.group;
+				is_used[use.image] = true;
+			}
+			image.last_group = pass.group;
+			image.usage |= get_usage(use.access);
+			is_attachment_only[use.image] = is_attachment_only[use.image] && is_attachment(use.access);
+		}
+	}
+
+	// TRANSIENT IMAGES ONLY EVER USED AS ATTACHMENTS OF ONE RENDER PASS NEVER HAVE TO BE IN
+	// MEMORY AT ALL ON TILED GPUS, THE REST FIND OUT HOW MUCH MEMORY THEY'D NEED
+	std::vector<vk::ImageCreateInfo>    image_cinfos(images_.size());
+	std::vector<vk::MemoryRequirements> requirements(images_.size());
+	std::vector<ImageHandle>            aliased;
+	vk::DeviceSize                      unaliased_size = 0;
+	uint32_t                            lazy_count     = 0;
+	for (ImageHandle i = 0; i < to_u32(images_.size()); i++)
+	{
+		GraphImage &image = images_[i];
+		if (image.is_imported || !is_used[i])
+		{
+			continue;
+		}
+		image_cinfos[i] = vk::ImageCreateInfo{
+		    .imageType     = vk::ImageType::e2D,
+		    .format        = image.desc.format,
+		    .extent        = {image.desc.extent.width, image.desc.extent.height, 1},
+		    .mipLevels     = image.desc.levels,
+		    .arrayLayers   = image.desc.layers,
+		    .samples       = vk::SampleCountFlagBits::e1,
+		    .tiling        = vk::ImageTiling::eOptimal,
+		    .usage         = image.usage | vk::ImageUsageFlagBits::eTransientAttachment,
+		    .sharingMode   = vk::SharingMode::eExclusive,
+		    .initialLayout = vk::ImageLayout::eUndefined,
+		};
+		image.is_lazy = is_attachment_only[i] && image.first_group == image.last_group && allocator.is_lazily_allocatable(image_cinfos[i]);
+		if (image.is_lazy)
+		{
+			lazy_count++;
+			continue;
+		}
+		image_cinfos[i].usage = image.usage;
+		vk::Image probe       = device_.get_handle().createImage(image_cinfos[i]);
+		requirements[i]       = device_.get_handle().getImageMemoryRequirements(probe);
+		device_.get_handle().destroyImage(probe);
+		unaliased_size += requirements[i].size;
+		aliased.push_back(i);
+	}
+
+	// BIGGEST FIRST, EACH GOES INTO THE FIRST BLOCK OF MEMORY WHOSE IMAGES ARE ALL DEAD BEFORE
+	// IT'S BORN OR BORN AFTER IT DIES, AND WHOSE MEMORY TYPES IT CAN LIVE IN
+	struct MemoryBlock
+	{
+		vk::MemoryRequirements   requirements;
+		std::vector<ImageHandle> images;
+	};
+	std::vector<MemoryBlock> blocks;
+	std::sort(aliased.begin(), aliased.end(), [&](ImageHandle a, ImageHandle b) { return requirements[a].size > requirements[b].size; });
+	for (ImageHandle i : aliased)
+	{
+		const GraphImage &image   = images_[i];
+		auto              p_block = std::find_if(blocks.begin(), blocks.end(), [&](const MemoryBlock &block) {
+			return (block.requirements.memoryTypeBits & requirements[i].memoryTypeBits) &&
+			       std::none_of(block.images.begin(), block.images.end(), [&](ImageHandle other) {
+				       return images_[other].first_group <= image.last_group && image.first_group <= images_[other].last_group;
+			       });
+		});
+		if (p_block == blocks.end())
+		{
+			blocks.push_back(MemoryBlock{requirements[i], {i}});
+			continue;
+		}
+		p_block->requirements.size = std::max(p_block->requirements.size, requirements[i].size);
+		p_block->requirements.alignment = std::max(p_block->requirements.alignment, requirements[i].alignment);
+		p_block->requirements.memoryTypeBits &= requirements[i].memoryTypeBits;
+		p_block->images.push_back(i);
+	}
+
+	// EVERY TRANSIENT IMAGE GETS A VIEW OF ALL OF IT, AS LONG AS IT ISN'T AN ARRAY
+	auto make_resource = [&](ImageHandle i, Image &&image_memory) {
+		GraphImage &image = images_[i];
+		image.image       = image_memory.get_handle();
+		ImageView view(device_, nullptr);
+		if (image.desc.layers == 1)
+		{
+			vk::ImageViewCreateInfo view_cinfo = ImageView::two_dim_view_cinfo(image.image, image.desc.format, image.aspect, image.desc.levels);
+			view                               = ImageView(device_, view_cinfo);
+			image.view                         = view.get_handle();
+		}
+		image.p_resource = std::make_unique<ImageResource>(std::move(image_memory), std::move(view));
+	};
+
+	// IN A BLOCK EACH IMAGE'S FIRST USE WAITS FOR THE IMAGE BEFORE IT, AND THE FIRST ONE FOR THE
+	// LAST ONE, WHICH MAY STILL BE IN USE BY THE PREVIOUS EXECUTION
+	vk::DeviceSize aliased_size = 0;
+	for (MemoryBlock &block : blocks)
+	{
+		VmaAllocation allocation = allocator.allocate_aliasable_memory(block.requirements);
+		memory_blocks_.push_back(allocation);
+		aliased_size += block.requirements.size;
+		std::sort(block.images.begin(), block.images.end(), [&](ImageHandle a, ImageHandle b) { return images_[a].first_group < images_[b].first_group; });
+		for (size_t k = 0; k < block.images.size(); k++)
+		{
+			images_[block.images[k]].alias_previous = block.images[(k + block.images.size() - 1) % block.images.size()];
+			make_resource(block.images[k], allocator.allocate_aliasing_image(image_cinfos[block.images[k]], allocation));
+		}
+	}
+	for (ImageHandle i = 0; i < to_u32(images_.size()); i++)
+	{
+		if (is_used[i] && images_[i].is_lazy)
+		{
+			make_resource(i, allocator.allocate_lazily_allocated_image(image_cinfos[i]));
+		}
+	}
+
+	LOGI("The render graph's transient images take {} KB instead of {} KB by sharing memory, {} more are lazily allocated", aliased_size / 1024,
+	     unaliased_size / 1024, lazy_count);
+}
+
+void RenderGraph::begin_use(ImageHandle image)
+{
+	// WHAT A TRANSIENT IMAGE HELD IS GONE AT ITS FIRST USE, BUT THE IMAGE THAT USED ITS MEMORY
+	// LAST, WHICH MAY BE ITSELF IN THE PREVIOUS EXECUTION, MAY STILL BE USING IT
+	GraphImage       &graph_image = images_[image];
+	const ImageState &previous    = images_[graph_image.alias_previous].state;
+	ImageState        state{
+	           .layout       = vk::ImageLayout::eUndefined,
+	           .write_stages = previous.write_stages | previous.read_stages,
+	           .write_access = previous.write_access,
+    };
+	graph_image.state = std::move(state);
+}
+
+void RenderGraph::derive_synchronization(bool is_recording)
+{
+	for (GraphImage &image : images_)
+	{
+		if (image.is_imported)
+		{
+			image.state = ImageState{
+			    .layout       = image.initial_layout,
+			    .write_stages = image.initial_stages,
+			};
+		}
+	}
+
+	std::vector<bool> is_begun(images_.size(), false);
+	for (uint32_t g = 0; g < to_u32(groups_.size()); g++)
+	{
+		PassGroup   &group = groups_[g];
+		BarrierBatch batch;
+		for (PassHandle p : group.passes)
+		{
+			for (const ImageUse &use : passes_[p].uses)
+			{
+				if (!images_[use.image].is_imported && !is_begun[use.image])
+				{
+					begin_use(use.image);
+					is_begun[use.image] = true;
+				}
+			}
+		}
+
+		// A RENDER PASS SYNCHRONIZES ITS ATTACHMENTS ITSELF, UNLESS THEY'RE ONLY PART OF THEIR
+		// IMAGE, WHOSE STATE IS TRACKED FOR ALL OF IT. EVERYTHING ELSE IS DONE BEFORE IT
+		const Pass &first_pass = passes_[group.passes[0]];
+		for (PassHandle p : group.passes)
+		{
+			for (const ImageUse &use : passes_[p].uses)
+			{
+				if (first_pass.type != PassType::eGraphics || !is_attachment(use.access) || !is_whole_image(use))
+				{
+					synchronize_use(batch, use.image, use, passes_[p].type);
+				}
+			}
+		}
+		if (first_pass.type == PassType::eGraphics)
+		{
+			create_render_pass(group, g, is_recording);
+		}
+		if (is_recording)
+		{
+			group.barriers = std::move(batch);
+		}
+	}
+
+	// THE IMPORTED IMAGES END UP IN THEIR FINAL LAYOUTS WITH THEIR WRITES VISIBLE
+	BarrierBatch final_batch;
+	for (ImageHandle i = 0; i < to_u32(images_.size()); i++)
+	{
+		GraphImage &image = images_[i];
+		ImageState &state = image.state;
+		if (!image.is_imported || image.final_layout == vk::ImageLayout::eUndefined ||
+		    (state.layout == image.final_layout && !state.write_access))
+		{
+			continue;
+		}
+		AccessInfo             info       = get_final_access_info(image.final_layout);
+		vk::PipelineStageFlags src_stages = state.write_stages | state.read_stages;
+		final_batch.src_stages |= src_stages ? src_stages : vk::PipelineStageFlagBits::eTopOfPipe;
+		final_batch.dst_stages |= info.stages;
+		final_batch.barriers.push_back(vk::ImageMemoryBarrier{
+		    .srcAccessMask       = state.write_access,
+		    .dstAccessMask       = info.access,
+		    .oldLayout           = state.layout,
+		    .newLayout           = image.final_layout,
+		    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .subresourceRange    = {image.aspect, 0, image.desc.levels, 0, image.desc.layers},
+		});
+		final_batch.images.push_back(i);
+		state = ImageState{
+		    .layout       = image.final_layout,
+		    .write_stages = info.stages,
+		};
+	}
+	if (is_recording)
+	{
+		final_barriers_ = std::move(final_batch);
+	}
+}
+
+void RenderGraph::synchronize_use(BarrierBatch &batch, ImageHandle image, const ImageUse &use, PassType type)
+{
+	GraphImage     &graph_image  = images_[image];
+	ImageState     &state        = graph_image.state;
+	AccessInfo      info         = get_access_info(use.access, type);
+	vk::AccessFlags write_access = get_write_access(info.access);
+
+	// A WRITE ONLY WAITS FOR EARLIER WRITES LIKE IT IF THEY TOUCHED THE SAME LEVELS AND LAYERS, SO
+	// e.g. COPIES INTO EACH FACE OF A CUBE DON'T WAIT FOR EACH OTHER
+	bool is_barrier_needed = state.layout != info.layout;
+	if (!is_barrier_needed && use.is_write)
+	{
+		bool is_overlapping = std::any_of(state.written_ranges.begin(), state.written_ranges.end(),
+		                                  [&](const vk::ImageSubresourceRange &range) { return overlaps(range, use.range); });
+		is_barrier_needed   = state.read_stages || (state.write_access && (state.write_access != write_access || is_overlapping));
+	}
+	else if (!is_barrier_needed)
+	{
+		is_barrier_needed = state.write_access && (state.visible_stages & info.stages) != info.stages;
+	}
+
+	if (is_barrier_needed)
+	{
+		vk::PipelineStageFlags src_stages = state.write_stages | state.read_stages;
+		batch.src_stages |= src_stages ? src_stages : vk::PipelineStageFlagBits::eTopOfPipe;
+		batch.dst_stages |= info.stages;
+		batch.barriers.push_back(vk::ImageMemoryBarrier{
+		    .srcAccessMask       = state.write_access,
+		    .dstAccessMask       = info.access,
+		    .oldLayout           = state.layout,
+		    .newLayout           = info.layout,
+		    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .subresourceRange    = {graph_image.aspect, 0, graph_image.desc.levels, 0, graph_image.desc.layers},
+		});
+		batch.images.push_back(image);
+		state.layout         = info.layout;
+		state.visible_stages = info.stages;
+		state.written_ranges.clear();
+	}
+
+	if (use.is_write)
+	{
+		state.write_stages   = is_barrier_needed ? info.stages : state.write_stages | info.stages;
+		state.write_access   = write_access;
+		state.read_stages    = {};
+		state.visible_stages = {};
+		state.written_ranges.push_back(use.range);
+	}
+	else
+	{
+		state.read_stages |= info.stages;
+		state.visible_stages |= info.stages;
+	}
+}
+
+const RenderGraph::ImageUse *RenderGraph::find_next_use(ImageHandle image, uint32_t group_idx, PassType &type) const
+{
+	for (const Pass &pass : passes_)
+	{
+		if (pass.is_culled || pass.group <= group_idx)
+		{
+			continue;
+		}
+		for (const ImageUse &use : pass.uses)
+		{
+			if (use.image == image)
+			{
+				type = pass.type;
+				return &use;
+			}
+		}
+	}
+	return nullptr;
+}
+
+void RenderGraph::create_render_pass(PassGroup &group, uint32_t group_idx, bool is_recording)
+{
+	uint32_t                                        subpass_count = to_u32(group.passes.size());
+	std::vector<ImageHandle>                        attachments;
+	std::vector<vk::ImageSubresourceRange>          attachment_ranges;
+	std::vector<bool>                               is_whole;        // PER ATTACHMENT, THE OTHERS WERE SYNCHRONIZED BEFORE
+	std::vector<vk::AttachmentDescription>          descriptions;
+	std::vector<vk::ClearValue>                     clear_values;
+	std::vector<uint32_t>                           last_subpasses;        // PER ATTACHMENT
+	std::vector<AccessInfo>                         last_infos;
+	std::vector<std::vector<vk::AttachmentReference>> color_refs(subpass_count);
+	std::vector<vk::AttachmentReference>            depth_refs(subpass_count, vk::AttachmentReference{VK_ATTACHMENT_UNUSED});
+	std::vector<std::vector<uint32_t>>              preserves(subpass_count);
+	std::vector<vk::SubpassDependency>              dependencies;
+
+	// DEPENDENCIES BETWEEN THE SAME TWO SUBPASSES ARE MERGED
+	auto add_dependency = [&](uint32_t src, uint32_t dst, vk::PipelineStageFlags src_stages, vk::PipelineStageFlags dst_stages, vk::AccessFlags src_access, vk::AccessFlags dst_access) {
+		auto p_dependency = std::find_if(dependencies.begin(), dependencies.end(),
+		                                 [&](const vk::SubpassDependency &dependency) { return dependency.srcSubpass == src && dependency.dstSubpass == dst; });
+		if (p_dependency == dependencies.end())
+		{
+			bool is_internal = src != VK_SUBPASS_EXTERNAL && dst != VK_SUBPASS_EXTERNAL;
+			dependencies.push_back(vk::SubpassDependency{
+			    .srcSubpass      = src,
+			    .dstSubpass      = dst,
+			    .dependencyFlags = is_internal ? vk::DependencyFlags(vk::DependencyFlagBits::eByRegion) : vk::DependencyFlags(),
+			});
+			p_dependency = std::prev(dependencies.end());
+		}
+		p_dependency->srcStageMask |= src_stages;
+		p_dependency->dstStageMask |= dst_stages;
+		p_dependency->srcAccessMask |= src_access;
+		p_dependency->dstAccessMask |= dst_access;
+	};
+
+	// THE ATTACHMENTS ARE IN THE ORDER THE SUBPASSES FIRST USE THEM, WHICH LOADS OR CLEARS THEM
+	for (uint32_t s = 0; s < subpass_count; s++)
+	{
+		const Pass &pass = passes_[group.passes[s]];
+		for (const ImageUse &use : pass.uses)
+		{
+			if (!is_attachment(use.access))
+			{
+				continue;
+			}
+			AccessInfo info = get_access_info(use.access, pass.type);
+			uint32_t   a    = to_u32(std::find(attachments.begin(), attachments.end(), use.image) - attachments.begin());
+			if (a == attachments.size())
+			{
+				const GraphImage    &image   = images_[use.image];
+				const ImageState    &state   = image.state;
+				vk::AttachmentLoadOp load_op = use.clear ? vk::AttachmentLoadOp::eClear :
+				                               state.layout != vk::ImageLayout::eUndefined ? vk::AttachmentLoadOp::eLoad :
+				                                                                            vk::AttachmentLoadOp::eDontCare;
+
+				// A BARRIER BEFORE THE PASS ALREADY MOVED A PART OF AN IMAGE TO THE LAYOUT IT'S DRAWN IN,
+				// SO THE RENDER PASS MUST NOT TRANSITION IT AGAIN, EVEN WHEN IT CLEARS IT
+				bool whole = is_whole_image(use);
+				descriptions.push_back(vk::AttachmentDescription{
+				    .format         = image.desc.format,
+				    .samples        = vk::SampleCountFlagBits::e1,
+				    .loadOp         = load_op,
+				    .stencilLoadOp  = image.aspect & vk::ImageAspectFlagBits::eStencil ? load_op : vk::AttachmentLoadOp::eDontCare,
+				    .initialLayout  = !whole || load_op == vk::AttachmentLoadOp::eLoad ? state.layout : vk::ImageLayout::eUndefined,
+				});
+				attachments.push_back(use.image);
+				attachment_ranges.push_back(use.range);
+				is_whole.push_back(whole);
+				clear_values.push_back(use.clear.value_or(vk::ClearValue{}));
+				last_subpasses.push_back(s);
+				last_infos.push_back(info);
+				if (is_whole.back())
+				{
+					vk::PipelineStageFlags src_stages = state.write_stages | state.read_stages;
+					add_dependency(VK_SUBPASS_EXTERNAL, s, src_stages ? src_stages : vk::PipelineStageFlagBits::eTopOfPipe, info.stages, state.write_access, info.access);
+				}
+			}
+			else
+			{
+				// A LATER SUBPASS WAITS FOR THE LAST ONE THAT USED IT, THE ONES BETWEEN KEEP IT
+				add_dependency(last_subpasses[a], s, last_infos[a].stages, info.stages, get_write_access(last_infos[a].access), info.access);
+				for (uint32_t k = last_subpasses[a] + 1; k < s; k++)
+				{
+					preserves[k].push_back(a);
+				}
+				last_subpasses[a] = s;
+				last_infos[a]     = info;
+			}
+			if (use.access == Access::eColorAttachment)
+			{
+				color_refs[s].push_back(vk::AttachmentReference{a, info.layout});
+			}
+			else
+			{
+				depth_refs[s] = vk::AttachmentReference{a, info.layout};
+			}
+		}
+	}
+
+	// WHAT COMES AFTERWARDS DECIDES WHETHER EACH ATTACHMENT IS STORED AND THE LAYOUT IT'S LEFT IN
+	for (uint32_t a = 0; a < to_u32(attachments.size()); a++)
+	{
+		GraphImage               &image       = images_[attachments[a]];
+		vk::AttachmentDescription &description = descriptions[a];
+		PassType                  next_type   = PassType::eGraphics;
+		const ImageUse           *p_next_use  = find_next_use(attachments[a], group_idx, next_type);
+		vk::AttachmentStoreOp     store_op    = p_next_use || image.is_imported ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare;
+		description.storeOp                   = store_op;
+		description.stencilStoreOp            = image.aspect & vk::ImageAspectFlagBits::eStencil ? store_op : vk::AttachmentStoreOp::eDontCare;
+
+		// THE REST OF A PART OF AN IMAGE IS IN THE LAYOUT IT WAS DRAWN IN, SO IT'S LEFT IN THAT TOO
+		// AND THE NEXT USE'S BARRIER MOVES ALL OF IT ON
+		const AccessInfo &last = last_infos[a];
+		if (!is_whole[a])
+		{
+			description.finalLayout = last.layout;
+		}
+		else if (p_next_use || (image.is_imported && image.final_layout != vk::ImageLayout::eUndefined))
+		{
+			// THE RENDER PASS MOVES IT TO WHERE IT'S NEEDED NEXT AND MAKES ITS WRITES VISIBLE THERE
+			AccessInfo next         = p_next_use ? get_access_info(p_next_use->access, next_type) : get_final_access_info(image.final_layout);
+			description.finalLayout = next.layout;
+			add_dependency(last_subpasses[a], VK_SUBPASS_EXTERNAL, last.stages, next.stages, get_write_access(last.access), next.access);
+			image.state = ImageState{
+			    .layout         = next.layout,
+			    .write_stages   = next.stages,
+			    .visible_stages = next.stages,
+			};
+		}
+		else
+		{
+			description.finalLayout = last.layout;
+			image.state             = ImageState{
+			                .layout       = last.layout,
+			                .write_stages = last.stages,
+			                .write_access = get_write_access(last.access),
+            };
+		}
+	}
+
+	if (!is_recording)
+	{
+		return;
+	}
+
+	std::vector<vk::SubpassDescription> subpasses(subpass_count);
+	for (uint32_t s = 0; s < subpass_count; s++)
+	{
+		subpasses[s] = vk::SubpassDescription{
+		    .pipelineBindPoint       = vk::PipelineBindPoint::eGraphics,
+		    .colorAttachmentCount    = to_u32(color_refs[s].size()),
+		    .pColorAttachments       = color_refs[s].data(),
+		    .pDepthStencilAttachment = depth_refs[s].attachment != VK_ATTACHMENT_UNUSED ? &depth_refs[s] : nullptr,
+		    .preserveAttachmentCount = to_u32(preserves[s].size()),
+		    .pPreserveAttachments    = preserves[s].data(),
+		};
+	}
+	// EVERY SUBPASS DRAWS ALL THE LAYERS OF ITS ATTACHMENTS, WHICH ARE DRAWN ALIKE
+	std::vector<uint32_t>             view_masks(subpass_count, (1u << group.view_count) - 1);
+	vk::RenderPassMultiviewCreateInfo multiview_cinfo{
+	    .subpassCount         = subpass_count,
+	    .pViewMasks           = view_masks.data(),
+	    .correlationMaskCount = 1,
+	    .pCorrelationMasks    = view_masks.data(),
+	};
+	vk::RenderPassCreateInfo render_pass_cinfo{
+	    .pNext           = group.view_count > 1 ? &multiview_cinfo : nullptr,
+	    .attachmentCount = to_u32(descriptions.size()),
+	    .pAttachments    = descriptions.data(),
+	    .subpassCount    = subpass_count,
+	    .pSubpasses      = subpasses.data(),
+	    .dependencyCount = to_u32(dependencies.size()),
+	    .pDependencies   = dependencies.data(),
+	};
+	group.p_render_pass     = std::make_unique<RenderPass>(device_, render_pass_cinfo);
+	group.attachments       = std::move(attachments);
+	group.attachment_ranges = std::move(attachment_ranges);
+	group.clear_values      = std::move(clear_values);
+}
+
+void RenderGraph::record_barriers(CommandBuffer &cmd_buf, BarrierBatch &batch)
+{
+	if (batch.barriers.empty())
+	{
+		return;
+	}
+	for (size_t i = 0; i < batch.barriers.size(); i++)
+	{
+		batch.barriers[i].image = images_[batch.images[i]].image;
+	}
+	cmd_buf.get_handle().pipelineBarrier(batch.src_stages, batch.dst_stages, {}, {}, {}, batch.barriers);
+}
+
+bool RenderGraph::is_whole_image(const ImageUse &use) const
+{
+	const ImageDesc &desc = images_[use.image].desc;
+	return use.range.baseMipLevel == 0 && use.range.levelCount == desc.levels && use.range.baseArrayLayer == 0 && use.range.layerCount == desc.layers;
+}
+
+vk::Framebuffer RenderGraph::get_framebuffer(PassGroup &group)
+{
+	std::vector<VkImageView>   key;
+	std::vector<vk::ImageView> views;
+	for (size_t a = 0; a < group.attachments.size(); a++)
+	{
+		vk::ImageView view = get_attachment_view(group.attachments[a], group.attachment_ranges[a]);
+		key.push_back(static_cast<VkImageView>(view));
+		views.push_back(view);
+	}
+
+	auto p_framebuffer = group.framebuffers.find(key);
+	if (p_framebuffer == group.framebuffers.end())
+	{
+		vk::FramebufferCreateInfo framebuffer_cinfo{
+		    .renderPass      = group.p_render_pass->get_handle(),
+		    .attachmentCount = to_u32(views.size()),
+		    .pAttachments    = views.data(),
+		    .width           = group.extent.width,
+		    .height          = group.extent.height,
+		    .layers          = 1,
+		};
+		p_framebuffer = group.framebuffers.emplace(key, std::make_unique<Framebuffer>(device_, framebuffer_cinfo)).first;
+	}
+	return p_framebuffer->second->get_handle();
+}
+
+vk::ImageView RenderGraph::get_attachment_view(ImageHandle image, const vk::ImageSubresourceRange &range)
+{
+	// AN IMAGE OF ONE LEVEL AND LAYER IS DRAWN TO THROUGH ITS OWN VIEW, ANY OTHER THROUGH A VIEW
+	// OF JUST THAT LEVEL AND THOSE LAYERS, MADE THE FIRST TIME IT'S NEEDED
+	GraphImage &graph_image = images_[image];
+	if (graph_image.desc.levels == 1 && graph_image.desc.layers == 1)
+	{
+		return graph_image.view;
+	}
+	RangeViewKey key    = {static_cast<VkImage>(graph_image.image), range.baseMipLevel, range.baseArrayLayer, range.layerCount};
+	auto         p_view = range_views_.find(key);
+	if (p_view == range_views_.end())
+	{
+		vk::ImageViewCreateInfo view_cinfo{
+		    .image            = graph_image.image,
+		    .viewType         = range.layerCount > 1 ? vk::ImageViewType::e2DArray : vk::ImageViewType::e2D,
+		    .format           = graph_image.desc.format,
+		    .subresourceRange = range,
+		};
+		p_view = range_views_.emplace(key, std::make_unique<ImageView>(device_, view_cinfo)).first;
+	}
+	return p_view->second->get_handle();
+}
+
+void RenderGraph::execute(CommandBuffer &cmd_buf)
+{
+	if (!is_compiled_)
+	{
+		LOGE("The render graph must be compiled before it's executed");
+		abort();
+	}
+
+	vk::CommandBuffer cmd_buf_h = cmd_buf.get_handle();
+	for (PassGroup &group : groups_)
+	{
+		record_barriers(cmd_buf, group.barriers);
+		if (!group.p_render_pass)
+		{
+			const Pass &pass = passes_[group.passes[0]];
+			if (pass.record)
+			{
+				pass.record(cmd_buf, PassContext{.extent = group.extent});
+			}
+			continue;
+		}
+
+		PassContext             context = get_context(group.passes[0]);
+		vk::RenderPassBeginInfo render_pass_binfo{
+		    .renderPass      = context.render_pass,
+		    .framebuffer     = context.framebuffer,
+		    .renderArea      = {.offset = {0, 0}, .extent = group.extent},
+		    .clearValueCount = to_u32(group.clear_values.size()),
+		    .pClearValues    = group.clear_values.data(),
+		};
+		for (uint32_t s = 0; s < to_u32(group.passes.size()); s++)
+		{
+			const Pass &pass = passes_[group.passes[s]];
+			if (s == 0)
+			{
+				cmd_buf_h.beginRenderPass(render_pass_binfo, pass.contents);
+			}
+			else
+			{
+				cmd_buf_h.nextSubpass(pass.contents);
+			}
+			context.subpass = s;
+			if (pass.record)
+			{
+				pass.record(cmd_buf, context);
+			}
+		}
+		cmd_buf_h.endRenderPass();
+	}
+	record_barriers(cmd_buf, final_barriers_);
+}
+
+bool RenderGraph::is_culled(PassHandle pass) const
+{
+	return passes_[pass].is_culled;
+}
+
+RenderPass &RenderGraph::get_render_pass(PassHandle pass)
+{
+	return *groups_[passes_[pass].group].p_render_pass;
+}
+
+uint32_t RenderGraph::get_subpass(PassHandle pass) const
+{
+	return passes_[pass].subpass;
+}
+
+RenderGraph::PassContext RenderGraph::get_context(PassHandle pass)
+{
+	if (passes_[pass].is_culled)
+	{
+		return PassContext{};
+	}
+	PassGroup  &group = groups_[passes_[pass].group];
+	PassContext context{.extent = group.extent};
+	if (group.p_render_pass)
+	{
+		context.render_pass = group.p_render_pass->get_handle();
+		context.subpass     = passes_[pass].subpass;
+		context.framebuffer = get_framebuffer(group);
+	}
+	return context;
+}
+
+vk::Image RenderGraph::get_image(ImageHandle image) const
+{
+	return images_[image].image;
+}
+
+vk::ImageView RenderGraph::get_view(ImageHandle image) const
+{
+	return images_[image].view;
+}
+
+}        // namespace W3D
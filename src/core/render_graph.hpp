@@ -0,0 +1,296 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "common/vk_common.hpp"
+#include "device_memory/allocator.hpp"
+
+namespace W3D
+{
+class CommandBuffer;
+class Device;
+class Framebuffer;
+class ImageResource;
+class ImageView;
+class RenderPass;
+
+/*
+* RenderGraph - a frame, or a bake, described as passes that say which images they read
+* and write, instead of as hand made render passes, framebuffers and layout transitions.
+* Once every pass has been added compile works out the rest:
+*	- PASSES WHOSE RESULTS NOTHING USES ARE CULLED, UNLESS THEY WERE MARKED AS HAVING SIDE EFFECTS
+*	- GRAPHICS PASSES NEXT TO EACH OTHER THAT DRAW TO THE SAME SIZE AND NUMBER OF LAYERS AND
+*	  DON'T SAMPLE WHAT ANOTHER OF THEM DRAWS BECOME THE SUBPASSES OF ONE RENDER PASS
+*	- A PASS THAT DRAWS TO SEVERAL LAYERS AT ONCE DRAWS THEM AS THE VIEWS OF A MULTIVIEW
+*	  RENDER PASS, e.g. ALL SIX FACES OF A CUBE
+*	- ATTACHMENTS ARE ONLY LOADED AND STORED WHEN SOMETHING BEFORE OR AFTER NEEDS THEM, AND
+*	  THEIR LAYOUTS CHANGE AS PART OF THE RENDER PASS
+*	- EVERY OTHER LAYOUT CHANGE AND HAZARD GETS AN IMAGE BARRIER, BATCHED INTO ONE
+*	  pipelineBarrier BEFORE EACH RENDER PASS OR OTHER PASS, AND ONLY WHEN ONE IS NEEDED
+*	- IMAGES THE GRAPH MAKES, ITS TRANSIENT IMAGES, THAT NEVER LEAVE ONE RENDER PASS LIVE IN
+*	  LAZILY ALLOCATED MEMORY WHEN THE DEVICE HAS SOME. THE OTHERS SHARE MEMORY WITH THE
+*	  ONES WHOSE LIFETIMES DON'T OVERLAP THEIRS
+* The images of a graph are either transient or imported, which are owned by someone else,
+* like the swapchain, and whose vk::Image can change between executions. A compiled graph
+* can be executed again and again, e.g. once per frame, until it is compiled again.
+*/
+class RenderGraph
+{
+  public:
+	using ImageHandle = uint32_t;
+	using PassHandle  = uint32_t;
+
+	// WHAT A PASS RECORDS, GRAPHICS PASSES ARE RECORDED INSIDE A RENDER PASS
+	enum class PassType
+	{
+		eGraphics,
+		eCompute,
+		eTransfer,
+	};
+
+	// WHAT A PASS DOES WITH AN IMAGE, eStorage IS READ AND WRITTEN BY SHADERS
+	enum class Access
+	{
+		eColorAttachment,
+		eDepthAttachment,
+		eSampled,
+		eStorage,
+		eTransferSrc,
+		eTransferDst,
+	};
+
+	// AN IMAGE'S FORMAT AND SIZE, ITS USAGE IS GATHERED FROM THE PASSES THAT USE IT
+	struct ImageDesc
+	{
+		vk::Format   format = vk::Format::eUndefined;
+		vk::Extent2D extent;
+		uint32_t     levels = 1;
+		uint32_t     layers = 1;
+	};
+
+	// WHAT A GRAPHICS PASS IS RECORDED INSIDE OF, WHICH ITS PIPELINES AND SECONDARY COMMAND
+	// BUFFERS HAVE TO KNOW. OTHER PASSES ONLY GET THE EXTENT OF THEIR FIRST IMAGE
+	struct PassContext
+	{
+		vk::RenderPass  render_pass;
+		uint32_t        subpass = 0;
+		vk::Framebuffer framebuffer;
+		vk::Extent2D    extent;
+	};
+
+	using RecordFunction = std::function<void(CommandBuffer &cmd_buf, const PassContext &context)>;
+
+	// THE WHOLE IMAGE, FOR PASSES THAT DON'T ONLY USE SOME OF ITS LEVELS OR LAYERS
+	static const vk::ImageSubresourceRange WHOLE_IMAGE;
+
+  private:
+	// WHERE AN IMAGE'S ACCESSES SO FAR HAVE LEFT IT, THE WRITES ARE THE ONES NOT YET MADE
+	// VISIBLE TO EVERY STAGE THAT READ THEM
+	struct ImageState
+	{
+		vk::ImageLayout                        layout = vk::ImageLayout::eUndefined;
+		vk::PipelineStageFlags                 write_stages;
+		vk::AccessFlags                        write_access;
+		vk::PipelineStageFlags                 read_stages;           // SINCE THE LAST WRITE
+		vk::PipelineStageFlags                 visible_stages;        // THAT THE LAST WRITE IS VISIBLE TO
+		std::vector<vk::ImageSubresourceRange> written_ranges;        // SINCE THE LAST BARRIER
+	};
+
+	struct GraphImage
+	{
+		std::string                    name;
+		ImageDesc                      desc;
+		vk::ImageAspectFlags           aspect;
+		bool                           is_imported = false;
+		vk::ImageLayout                initial_layout = vk::ImageLayout::eUndefined;        // IMPORTED ONLY
+		vk::PipelineStageFlags         initial_stages;                                     // THAT MUST BE DONE BEFORE ITS FIRST USE
+		vk::ImageLayout                final_layout = vk::ImageLayout::eUndefined;          // eUndefined MEANS WHATEVER IT WAS LAST
+		vk::Image                      image;
+		vk::ImageView                  view;
+		std::unique_ptr<ImageResource> p_resource;        // TRANSIENT ONLY
+		vk::ImageUsageFlags            usage;
+		bool                           is_lazy        = false;
+		uint32_t                       first_group    = 0;        // ITS LIFETIME, IN GROUPS
+		uint32_t                       last_group     = 0;
+		ImageHandle                    alias_previous = 0;        // WHICH IMAGE USED ITS MEMORY LAST, ITSELF IF NONE
+		ImageState                     state;
+	};
+
+	struct ImageUse
+	{
+		ImageHandle                   image;
+		Access                        access;
+		bool                          is_write;
+		vk::ImageSubresourceRange     range;
+		std::optional<vk::ClearValue> clear;        // ATTACHMENTS ONLY, WITHOUT ONE THEY ARE LOADED
+	};
+
+	struct Pass
+	{
+		std::string           name;
+		PassType              type;
+		RecordFunction        record;
+		vk::SubpassContents   contents;
+		std::vector<ImageUse> uses;
+		bool                  has_side_effects = false;
+		bool                  is_culled        = false;
+		uint32_t              group            = 0;
+		uint32_t              subpass          = 0;
+	};
+
+	// IMAGE BARRIERS RECORDED WITH ONE pipelineBarrier, THEIR IMAGES ARE FILLED IN WHEN
+	// THEY ARE RECORDED AS IMPORTED IMAGES CAN CHANGE
+	struct BarrierBatch
+	{
+		vk::PipelineStageFlags              src_stages;
+		vk::PipelineStageFlags              dst_stages;
+		std::vector<vk::ImageMemoryBarrier> barriers;
+		std::vector<ImageHandle>            images;
+	};
+
+	// PASSES RECORDED TOGETHER, EITHER THE SUBPASSES OF ONE RENDER PASS OR ONE OTHER PASS.
+	// THERE IS A FRAMEBUFFER FOR EVERY SET OF VIEWS ITS ATTACHMENTS HAVE BEEN GIVEN
+	struct PassGroup
+	{
+		std::vector<PassHandle>                                          passes;
+		BarrierBatch                                                     barriers;
+		std::unique_ptr<RenderPass>                                      p_render_pass;
+		std::vector<ImageHandle>                                         attachments;
+		std::vector<vk::ImageSubresourceRange>                           attachment_ranges;
+		std::vector<vk::ClearValue>                                      clear_values;
+		vk::Extent2D                                                     extent;
+		uint32_t                                                         view_count = 1;        // LAYERS EACH ATTACHMENT DRAWS
+		std::map<std::vector<VkImageView>, std::unique_ptr<Framebuffer>> framebuffers;
+	};
+
+	// AN IMAGE, LEVEL, FIRST LAYER AND LAYER COUNT THE GRAPH MADE AN ATTACHMENT VIEW FOR
+	using RangeViewKey = std::tuple<VkImage, uint32_t, uint32_t, uint32_t>;
+
+	Device                                            &device_;
+	std::vector<GraphImage>                            images_;
+	std::vector<Pass>                                  passes_;
+	std::vector<PassGroup>                             groups_;
+	std::vector<VmaAllocation>                         memory_blocks_;        // EACH SHARED BY TRANSIENT IMAGES THAT ARE NEVER ALIVE AT ONCE
+	std::map<RangeViewKey, std::unique_ptr<ImageView>> range_views_;          // OF ATTACHMENTS THAT ARE ONLY PART OF THEIR IMAGE
+	BarrierBatch                                       final_barriers_;       // INTO THE IMPORTED IMAGES' FINAL LAYOUTS
+	bool                                               is_compiled_ = false;
+
+	ImageHandle add_image(const std::string &name, const ImageDesc &desc);
+	void        add_use(PassHandle pass, ImageHandle image, Access access, bool is_write, const vk::ImageSubresourceRange &range, std::optional<vk::ClearValue> clear);
+	void        release();
+	void        cull_passes();
+	void        group_passes();
+	void        allocate_images();
+	void        derive_synchronization(bool is_recording);
+	void        begin_use(ImageHandle image);
+	void        synchronize_use(BarrierBatch &batch, ImageHandle image, const ImageUse &use, PassType type);
+	void        create_render_pass(PassGroup &group, uint32_t group_idx, bool is_recording);
+	void        record_barriers(CommandBuffer &cmd_buf, BarrierBatch &batch);
+	bool        is_whole_image(const ImageUse &use) const;
+
+	// THE FIRST USE OF image BY A PASS AFTER group_idx, AND THAT PASS'S TYPE
+	const ImageUse *find_next_use(ImageHandle image, uint32_t group_idx, PassType &type) const;
+	vk::Framebuffer get_framebuffer(PassGroup &group);
+	vk::ImageView   get_attachment_view(ImageHandle image, const vk::ImageSubresourceRange &range);
+
+  public:
+	/*
+	* The constructor makes an empty graph.
+	*/
+	RenderGraph(Device &device);
+
+	/*
+	* The destructor destroys the transient images, their memory, the render passes and
+	* the framebuffers. Executions of the graph must be done with them.
+	*/
+	~RenderGraph();
+
+	// THESE ARE DEACTIVATED, PASSES KEEP THE HANDLES OF THEIR GRAPH'S IMAGES
+	RenderGraph(const RenderGraph &)            = delete;
+	RenderGraph &operator=(const RenderGraph &) = delete;
+
+	/*
+	* Adds an image the graph makes, and destroys, when it's compiled. What it holds doesn't
+	* outlive an execution.
+	*/
+	ImageHandle create_image(const std::string &name, const ImageDesc &desc);
+
+	/*
+	* Adds an image someone else owns, which must be given to set_imported_image before the
+	* graph is executed. Every execution expects it in initial_layout, once the
+	* initial_stages of what came before are done, e.g. a swapchain image's acquire is waited
+	* for at eColorAttachmentOutput. It is left in final_layout when the graph is done, unless
+	* that's eUndefined.
+	*/
+	ImageHandle import_image(const std::string &name, const ImageDesc &desc, vk::ImageLayout final_layout = vk::ImageLayout::eUndefined,
+	                         vk::ImageLayout initial_layout = vk::ImageLayout::eUndefined, vk::PipelineStageFlags initial_stages = vk::PipelineStageFlagBits::eTopOfPipe);
+
+	/*
+	* Imports resource, which is described by its image and view, like the import_image above.
+	*/
+	ImageHandle import_image(const std::string &name, ImageResource &resource, vk::ImageLayout final_layout = vk::ImageLayout::eUndefined, vk::ImageLayout initial_layout = vk::ImageLayout::eUndefined);
+
+	/*
+	* Sets which image, and view of it for attachments, an imported image is this time.
+	*/
+	void set_imported_image(ImageHandle image, vk::Image image_h, vk::ImageView view);
+
+	/*
+	* Adds a pass that records with record. The commands of a graphics pass can be recorded
+	* inline or, if contents says so, executed from secondary command buffers.
+	*/
+	PassHandle add_pass(const std::string &name, PassType type, RecordFunction record, vk::SubpassContents contents = vk::SubpassContents::eInline);
+
+	/*
+	* The pass draws to range of image, which is cleared first if clear is given and otherwise
+	* keeps what was drawn to it before. range must be one level, if it has more than one layer
+	* the pass draws to all of them at once as the views of a multiview render pass, and its
+	* shaders tell them apart by gl_ViewIndex.
+	*/
+	void write_color(PassHandle pass, ImageHandle image, std::optional<vk::ClearValue> clear = std::nullopt, const vk::ImageSubresourceRange &range = WHOLE_IMAGE);
+	void write_depth(PassHandle pass, ImageHandle image, std::optional<vk::ClearValue> clear = std::nullopt, const vk::ImageSubresourceRange &range = WHOLE_IMAGE);
+
+	/*
+	* The pass reads or writes range of image the way access says, which can't be one of
+	* the attachment accesses.
+	*/
+	void read_image(PassHandle pass, ImageHandle image, Access access, const vk::ImageSubresourceRange &range = WHOLE_IMAGE);
+	void write_image(PassHandle pass, ImageHandle image, Access access, const vk::ImageSubresourceRange &range = WHOLE_IMAGE);
+
+	/*
+	* Keeps the pass even if no other pass uses what it writes, e.g. when it copies to a
+	* buffer the host reads.
+	*/
+	void set_side_effects(PassHandle pass);
+
+	/*
+	* Culls, merges and synchronizes the passes and makes the transient images, see above.
+	* It can be called again after passes are added, which remakes everything.
+	*/
+	void compile();
+
+	/*
+	* Records every pass that wasn't culled into cmd_buf, with the barriers between them.
+	*/
+	void execute(CommandBuffer &cmd_buf);
+
+	/*
+	* Accessor methods for a compiled graph. get_context is what a graphics pass will be
+	* recorded inside of with the imported images set now, so its secondary command buffers
+	* can be recorded before the graph is executed.
+	*/
+	bool          is_culled(PassHandle pass) const;
+	RenderPass   &get_render_pass(PassHandle pass);
+	uint32_t      get_subpass(PassHandle pass) const;
+	PassContext   get_context(PassHandle pass);
+	vk::Image     get_image(ImageHandle image) const;
+	vk::ImageView get_view(ImageHandle image) const;
+};
+
+}        // namespace W3D
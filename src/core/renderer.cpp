@@ -2,7 +2,10 @@
 #include "renderer.hpp"
 
 // C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cmath>
 #include <queue>
+#include <tuple>
 #include <iostream>
 
 // OUR OWN TYPES
@@ -10,17 +13,22 @@
 #include "common/error.hpp"
 #include "common/file_utils.hpp"
 #include "common/logging.hpp"
+#include "common/profiler.hpp"
+#include "common/thread_pool.hpp"
 #include "common/utils.hpp"
 #include "controller.hpp"
 #include "core/command_pool.hpp"
+#include "core/compute_pipeline.hpp"
 #include "core/descriptor_allocator.hpp"
 #include "core/device.hpp"
-#include "core/framebuffer.hpp"
+#include "core/geometry_arena.hpp"
 #include "core/graphics_pipeline.hpp"
 #include "core/image_resource.hpp"
 #include "core/image_view.hpp"
 #include "core/instance.hpp"
+#include "core/offscreen_target.hpp"
 #include "core/physical_device.hpp"
+#include "core/pipeline_builder.hpp"
 #include "core/render_pass.hpp"
 #include "core/swapchain.hpp"
 #include "core/window.hpp"
@@ -31,6 +39,7 @@
 #include "scene_graph/components/sampler.hpp"
 #include "scene_graph/components/submesh.hpp"
 #include "scene_graph/components/texture.hpp"
+#include "scene_graph/frustum.hpp"
 #include "scene_graph/scene.hpp"
 #include "scene_graph/script.hpp"
 #include "scene_graph/scripts/free_camera.hpp"
@@ -47,39 +56,84 @@ namespace W3D
 // THESE ARE THE LIGHTS WE WILL PUT INTO OUR SCENE, NOTE EACH
 // HAS A UNIQUE LOCATION IN THE SCENE. NOTE WE ARE USING glm
 // VECTORS TO REPRESENT POSITION
-const uint32_t Renderer::NUM_INFLIGHT_FRAMES  = 2;
-const uint32_t Renderer::IRRADIANCE_DIMENSION = 2;
-const int      NUM_LIGHTS                     = 4;
-glm::vec3      LIGHT_POSITIONS[NUM_LIGHTS]    = {
+const uint32_t Renderer::MIN_INFLIGHT_FRAMES   = 1;
+const uint32_t Renderer::MAX_INFLIGHT_FRAMES   = 4;
+const uint32_t Renderer::IRRADIANCE_DIMENSION  = 2;
+const uint32_t Renderer::MIN_INSTANCE_CAPACITY = 64;
+const uint32_t Renderer::MIN_DRAWS_PER_CHUNK   = 64;
+const uint32_t Renderer::CULL_GROUP_SIZE       = 64;
+const float    Renderer::LOD_SCREEN_SIZE       = 0.25f;
+const float    Renderer::LOD_HYSTERESIS        = 0.1f;
+const int      NUM_LIGHTS                      = 4;
+glm::vec3      LIGHT_POSITIONS[NUM_LIGHTS]     = {
     glm::vec3(6.0f, 0.0f, 6.0f),
     glm::vec3(-3.0f, 0.0f, 6.0f),
     glm::vec3(0.0f, -6.0f, -6.0f),
     glm::vec3(-6.0f, -6.0f, -6.0f),
 };
 
-Renderer::Renderer()
+// THE BOX EVERY LIGHT IS DRAWN AS, BEFORE IT'S SCALED AND MOVED TO ITS POSITION
+const sg::AABB LIGHT_BOUNDS(glm::vec3(-0.5f), glm::vec3(0.5f));
+
+Renderer::Renderer(const RendererSettings &settings) :
+    settings_(settings)
 {
-	// CREATE OUR WINDOW AND SETUP THE EVENT HANDLERS
-	p_window_ = std::make_unique<Window>("Wolfie3D");
-	p_window_->register_callbacks(*this);
+	W3D_PROFILE_SCOPE("Renderer::Renderer");
+
+	// MORE FRAMES IN FLIGHT LET THE CPU GET FURTHER AHEAD OF THE GPU, WHICH HIDES STALLS BUT
+	// ADDS LATENCY, AND EVERY ONE OF THEM NEEDS ITS OWN COPY OF THE PER FRAME RESOURCES
+	if (settings_.frames_in_flight < MIN_INFLIGHT_FRAMES || settings_.frames_in_flight > MAX_INFLIGHT_FRAMES)
+	{
+		uint32_t frames_in_flight = std::clamp(settings_.frames_in_flight, MIN_INFLIGHT_FRAMES, MAX_INFLIGHT_FRAMES);
+		LOGW("{} frames in flight isn't supported, using {}", settings_.frames_in_flight, frames_in_flight);
+		settings_.frames_in_flight = frames_in_flight;
+	}
+
+	if (settings_.headless)
+	{
+		// WITHOUT A WINDOW THERE IS NO SURFACE TO PRESENT TO
+		p_instance_ = std::make_unique<Instance>("Wolfie3D");
+	}
+	else
+	{
+		// CREATE OUR WINDOW AND SETUP THE EVENT HANDLERS
+		p_window_ = std::make_unique<Window>("Wolfie3D");
+		p_window_->register_callbacks(*this);
+		p_instance_ = std::make_unique<Instance>("Wolfie3D", *p_window_);
+	}
 
 	// SETUP RENDERING WITH VULKAN, WE'LL NEED A VULKAN INSTANCE AND THROUGH
 	// THAT WE CAN INITIALIZE OUR PHYSICAL DEVICE, i.e. THE GPU
-	p_instance_         = std::make_unique<Instance>("Wolfie3D", *p_window_);
 	p_physical_device_  = p_instance_->pick_physical_device();
-	p_device_           = std::make_unique<Device>(*p_instance_, *p_physical_device_);
+	p_device_           = std::make_unique<Device>(*p_instance_, *p_physical_device_, settings_.pipeline_cache);
 	p_descriptor_state_ = std::make_unique<DescriptorState>(*p_device_);
 	p_cmd_pool_         = std::make_unique<CommandPool>(*p_device_, p_device_->get_graphics_queue(), p_physical_device_->get_graphics_queue_family_index());
-	p_swapchain_        = std::make_unique<Swapchain>(*p_device_, p_window_->get_extent());
+	p_thread_pool_      = std::make_unique<ThreadPool>(settings_.record_threads);
+
+	// CULLING ON THE GPU NEEDS THE DRAW COUNT TO COME FROM A BUFFER THE GPU WROTE
+	is_gpu_culling_ = settings_.gpu_culling && p_device_->is_draw_indirect_count_supported();
+	if (settings_.gpu_culling && !is_gpu_culling_)
+	{
+		LOGW("The device doesn't support drawIndirectCount, culling on the CPU instead");
+	}
+
+	// HEADLESS FRAMES GO TO AN OFFSCREEN TARGET INSTEAD OF THE SWAPCHAIN
+	if (settings_.headless)
+	{
+		p_offscreen_target_ = std::make_unique<OffscreenTarget>(*p_device_, settings_.extent, settings_.frames_in_flight);
+	}
+	else
+	{
+		p_swapchain_ = std::make_unique<Swapchain>(*p_device_, p_window_->get_extent(), settings_.swapchain_images);
+	}
 
 	// OUR SCENE WILL USE THIS GLTF FILE, WHICH IS JUST A TEXTURED CUBE
 	load_scene("2.0/BoxTextured/glTF/HW.gltf");
 
 	// SETUP THE RENDERING RESOURCES
-	PBRBaker baker(*p_device_);
+	PBRBaker baker(*p_device_, settings_.bake_cache, settings_.cpu_bake ? p_thread_pool_.get() : nullptr, settings_.prefilter_samples);
 	baked_pbr_ = baker.bake();
 	create_rendering_resources();
-	p_sframe_buffer_ = std::make_unique<SwapchainFramebuffer>(*p_device_, *p_swapchain_, *p_render_pass_);
 	create_controller();
 }
 
@@ -88,37 +142,72 @@ Renderer::~Renderer(){};
 
 void Renderer::start()
 {
-	main_loop();
 	timer_.start();
+	main_loop();
 }
 
 void Renderer::main_loop()
 {
-	// RUN UNTIL THE USER CLOSES THE APPLICTION WINDOW
-	while (!p_window_->should_close())
+	// RUN UNTIL THE USER CLOSES THE APPLICTION WINDOW OR WE HIT THE FRAME LIMIT
+	while (is_running())
 	{
-		// INCREMENT THE TIMER
-		timer_.tick();
-		
+		W3D_PROFILE_SCOPE("frame");
+
+		// INCREMENT THE TIMER, THIS IS THE ONLY PLACE IT IS TICKED SO EACH FRAME
+		// GETS EXACTLY ONE DELTA
+		Timer  frame_timer;
+		double delta_time = timer_.tick();
+		if (settings_.fixed_delta_time > 0.0)
+		{
+			delta_time = settings_.fixed_delta_time;
+		}
+
 		// DRAW THE SCENE
 		render_frame();
 
 		// UPDATE SCENE OBJECTS
-		update();
+		Timer update_timer;
+		update(delta_time);
+		frame_timings_.update = update_timer.tick<Timer::Milliseconds>();
 
-		// RETRIEVE USER INPUT
-		p_window_->poll_events();
+		// RETRIEVE USER INPUT, HEADLESS THERE IS NONE
+		if (p_window_)
+		{
+			W3D_PROFILE_SCOPE("Window::poll_events");
+			p_window_->poll_events();
+		}
 
+		frame_timings_.frame = frame_timer.tick<Timer::Milliseconds>();
+		if (frame_callback_)
+		{
+			frame_callback_(frame_timings_);
+		}
 	}
 
 	// RELEASE GPU
+	W3D_PROFILE_SCOPE("Renderer::shutdown");
 	p_device_->get_handle().waitIdle();
+
+	// HAND OVER THE FRAMES THAT WERE STILL IN FLIGHT
+	flush_readbacks();
+	for (uint32_t i = 0; i < frame_resources_.size(); i++)
+	{
+		resolve_gpu_timings(frame_resources_[(frame_idx_ + i) % frame_resources_.size()]);
+	}
 }
 
-void Renderer::update()
+bool Renderer::is_running()
 {
-	// ADVANCE THE TIMER
-	double delta_time = timer_.tick();
+	if (settings_.max_frames && frame_count_ >= settings_.max_frames)
+	{
+		return false;
+	}
+	return !p_window_ || !p_window_->should_close();
+}
+
+void Renderer::update(double delta_time)
+{
+	W3D_PROFILE_SCOPE("Renderer::update");
 	//std::cout << delta_time << std::endl; 
 
 	const float TRANSLATION_MOVE_STEP = 5.0f;
@@ -152,6 +241,8 @@ void Renderer::update()
 		glm::quat orientation = glm::normalize(qy * transform_projectile.get_rotation());
 		transform_projectile.set_rotation(orientation);
 		
+		// THE PLAYERS MAY HAVE MOVED SINCE THE BVH WAS LAST REFIT
+		update_spatial_index();
 		std::string player_name = p_controller_->is_projectile_colliding();
 
 		
@@ -291,9 +382,10 @@ void Renderer::process_event(const Event &event)
 
 void Renderer::load_scene(const char *scene_name)
 {
-	GLTFLoader loader(*p_device_);
+	W3D_PROFILE_SCOPE("Renderer::load_scene");
+	GLTFLoader loader(*p_device_, settings_.optimize_meshes, settings_.mesh_lods);
 	p_scene_                   = loader.read_scene_from_file(scene_name);
-	vk::Extent2D window_extent = p_window_->get_extent();
+	vk::Extent2D window_extent = p_window_ ? p_window_->get_extent() : settings_.extent;
 	p_camera_node_             = add_free_camera_script(*p_scene_, "main_camera", window_extent.width, window_extent.height);
 	p_camera_node_->get_component<sg::Transform>().set_tranlsation(glm::vec3(0.0f, 0.0f, 5.0f));
 }
@@ -318,30 +410,63 @@ void Renderer::create_controller()
 	    *p_scene_->find_component<sg::Light>("light_2"),
 	    *p_scene_->find_component<sg::Light>("light_3"),
 	    *p_scene_->find_component<sg::Light>("light_4"));
+
+	// COLLISIONS AND MOUSE PICKING ARE BOTH ANSWERED BY THE BVH
+	p_controller_->set_spatial_index(bvh_);
+	if (sg::FreeCamera *p_free_camera = dynamic_cast<sg::FreeCamera *>(&p_camera_node_->get_component<sg::Script>()))
+	{
+		p_free_camera->set_picking_bvh(bvh_);
+	}
 }
 
 void Renderer::render_frame()
 {
-	uint32_t img_idx = sync_acquire_next_image();
+	W3D_PROFILE_SCOPE("Renderer::render_frame");
+	Timer phase_timer;
+
+	uint32_t img_idx       = sync_acquire_next_image();
+	frame_timings_.acquire = phase_timer.tick<Timer::Milliseconds>();
 	record_draw_commands(img_idx);
+	frame_timings_.record = phase_timer.tick<Timer::Milliseconds>();
 	sync_submit_commands();
+	frame_timings_.submit = phase_timer.tick<Timer::Milliseconds>();
 	sync_present(img_idx);
-	frame_idx_ = (frame_idx_ + 1) % NUM_INFLIGHT_FRAMES;
+	frame_timings_.present = phase_timer.tick<Timer::Milliseconds>();
+	frame_idx_ = (frame_idx_ + 1) % settings_.frames_in_flight;
+	frame_count_++;
 }
 
 uint32_t Renderer::sync_acquire_next_image()
 {
+	W3D_PROFILE_SCOPE("Renderer::sync_acquire_next_image");
 	FrameResource &frame    = get_current_frame_resource();
 	vk::Device     device_h = p_device_->get_handle();
 	uint32_t       img_idx;
 
+	// HOW LONG WE BLOCK ON THE FENCE IS HOW FAR THE CPU HAS GOTTEN AHEAD OF THE GPU
+	frame_timings_.fence_wait = 0.0;
 	while (true)
 	{
+		Timer fence_timer;
 		while (vk::Result::eTimeout ==
 		       device_h.waitForFences({frame.in_flight_fence.get_handle()}, true, UINT64_MAX))
 		{
 			;
 		}
+		frame_timings_.fence_wait += fence_timer.tick<Timer::Milliseconds>();
+
+		// THE LAST FRAME THAT USED THESE RESOURCES IS DONE SO ITS TIMESTAMPS CAN BE READ WITHOUT STALLING
+		resolve_gpu_timings(frame);
+		resolve_gpu_culling(frame);
+
+		// HEADLESS THERE IS NO SWAPCHAIN, EACH FRAME IN FLIGHT RENDERS TO ITS OWN OFFSCREEN IMAGE,
+		// AND NOW THAT ITS FENCE HAS SIGNALED, WHATEVER IT READ BACK IS READY FOR THE HOST
+		if (p_offscreen_target_)
+		{
+			deliver_readback(frame);
+			img_idx = frame_idx_;
+			break;
+		}
 
 		// Opted for plain vkAacquireNextImageKHR here because we want to deal with the error ourselves.
 		// Otherwise, vulkan.hpp would've thrown the error and we have to catch it (slow).
@@ -370,6 +495,7 @@ uint32_t Renderer::sync_acquire_next_image()
 
 void Renderer::sync_submit_commands()
 {
+	W3D_PROFILE_SCOPE("Renderer::sync_submit_commands");
 	FrameResource         &frame       = get_current_frame_resource();
 	vk::PipelineStageFlags wait_stages = vk::PipelineStageFlagBits::eColorAttachmentOutput;
 	vk::SubmitInfo         submit_info{
@@ -381,11 +507,24 @@ void Renderer::sync_submit_commands()
 	            .signalSemaphoreCount = 1,
 	            .pSignalSemaphores    = &frame.render_finished_semaphore.get_handle(),
     };
+
+	// HEADLESS NOTHING IS ACQUIRED OR PRESENTED, SO THERE ARE NO SEMAPHORES TO WAIT ON OR SIGNAL
+	if (p_offscreen_target_)
+	{
+		submit_info.waitSemaphoreCount   = 0;
+		submit_info.signalSemaphoreCount = 0;
+	}
 	p_device_->get_graphics_queue().submit(submit_info, frame.in_flight_fence.get_handle());
 }
 
 void Renderer::sync_present(uint32_t img_idx)
 {
+	W3D_PROFILE_SCOPE("Renderer::sync_present");
+	if (p_offscreen_target_)
+	{
+		return;
+	}
+
 	FrameResource     &frame = get_current_frame_resource();
 	vk::PresentInfoKHR present_info{
 	    .waitSemaphoreCount = 1,
@@ -414,28 +553,258 @@ void Renderer::sync_present(uint32_t img_idx)
 
 void Renderer::resize()
 {
+	// OFFSCREEN TARGETS KEEP THEIR SIZE
+	if (p_offscreen_target_)
+	{
+		return;
+	}
+
 	vk::Extent2D extent = p_window_->wait_for_non_zero_extent();
 	p_device_->get_handle().waitIdle();
 	p_camera_node_->get_component<sg::Script>().resize(extent.width, extent.height);
 	p_swapchain_->rebuild(extent);
-	p_sframe_buffer_->rebuild();
+
+	// THE PIPELINES ONLY NEED RENDER PASSES LIKE THE NEW ONES, SO THEY ARE KEPT
+	create_frame_graph();
 }
 
 void Renderer::record_draw_commands(uint32_t img_idx)
 {
-	CommandBuffer &cmd_buf = get_current_frame_resource().cmd_buf;
+	W3D_PROFILE_SCOPE("Renderer::record_draw_commands");
+	FrameResource &frame   = get_current_frame_resource();
+	CommandBuffer &cmd_buf = frame.cmd_buf;
 	cmd_buf.reset();
 	cmd_buf.begin();
+	update_frame_instances();
 	update_frame_ubo();
-	set_dynamic_states(cmd_buf);
-	begin_render_pass(cmd_buf, p_sframe_buffer_->get_handle(img_idx));
-	draw_skybox(cmd_buf);
-	draw_lights(cmd_buf);
-	draw_scene(cmd_buf);
-	cmd_buf.get_handle().endRenderPass();
+	if (!is_gpu_culling_)
+	{
+		gather_visible_draws();
+	}
+
+	// QUERIES MUST BE RESET OUTSIDE OF A RENDER PASS BEFORE THEY CAN BE WRITTEN AGAIN
+	if (frame.timestamp_pool.get_handle())
+	{
+		cmd_buf.get_handle().resetQueryPool(frame.timestamp_pool.get_handle(), 0, eTimestampCount);
+		frame.timestamp_frame      = frame_count_;
+		frame.is_timestamp_pending = true;
+	}
+
+	// THE SCENE'S DRAWS ARE BUILT ON THE GPU BEFORE THE PASS THAT DRAWS THEM
+	write_timestamp(cmd_buf, vk::PipelineStageFlagBits::eTopOfPipe, eCullBegin);
+	if (is_gpu_culling_)
+	{
+		record_gpu_culling(cmd_buf);
+	}
+
+	// THE FRAME GRAPH DRAWS TO THIS FRAME'S IMAGE
+	if (p_offscreen_target_)
+	{
+		ImageResource &color_resource = p_offscreen_target_->get_color_resource(img_idx);
+		p_frame_graph_->set_imported_image(backbuffer_, color_resource.get_image().get_handle(), color_resource.get_view().get_handle());
+	}
+	else
+	{
+		p_frame_graph_->set_imported_image(backbuffer_, p_swapchain_->get_frame_images()[img_idx], p_swapchain_->get_frame_image_views()[img_idx].get_handle());
+	}
+	RenderGraph::PassContext prepass_context = depth_prepass_.p_pl ? p_frame_graph_->get_context(depth_prepass_pass_) : RenderGraph::PassContext{};
+	RenderGraph::PassContext scene_context   = p_frame_graph_->get_context(scene_pass_);
+
+	// THE PASSES ARE RECORDED INTO SECONDARY COMMAND BUFFERS ON ALL THE RECORDING THREADS, WHICH
+	// ARE EXECUTED IN THIS ORDER: A CHUNK OF THE SCENE'S DEPTH PREPASS FOR EACH THREAD, THE
+	// LIGHTS, A CHUNK OF THE SCENE FOR EACH THREAD AND LAST THE SKYBOX, WHICH ONLY FILLS THE
+	// PIXELS NOTHING ELSE DID. A CHUNK IS BATCHES OF INDIRECT DRAWS WHEN CULLING ON THE GPU.
+	// THE PREPASS DRAWS NEAREST FIRST, WITHOUT IT THE SCENE DOES
+	size_t   draw_count      = is_gpu_culling_ ? draw_batches_.size() : visible_draws_.size();
+	uint32_t chunk_count     = std::min(to_u32((draw_count + MIN_DRAWS_PER_CHUNK - 1) / MIN_DRAWS_PER_CHUNK), p_thread_pool_->get_thread_count());
+	uint32_t prepass_count   = depth_prepass_.p_pl ? chunk_count : 0;
+	uint32_t secondary_count = prepass_count + chunk_count + 2;
+	for (uint32_t i = 0; i < secondary_count; i++)
+	{
+		frame.record_cmd_pools[i]->reset();
+	}
+	auto draw_chunk = [&](CommandBuffer &secondary, BoundState &bound, const PipelineResource &pipeline, const std::vector<uint32_t> &draws, uint32_t chunk) {
+		size_t first = draw_count * chunk / chunk_count;
+		size_t last  = draw_count * (chunk + 1) / chunk_count;
+		if (is_gpu_culling_)
+		{
+			draw_scene_indirect(secondary, bound, pipeline, first, last);
+		}
+		else
+		{
+			draw_scene(secondary, bound, pipeline, draws, first, last);
+		}
+	};
+	p_thread_pool_->parallel_for(secondary_count, [&](uint32_t idx) {
+		CommandBuffer &secondary = frame.secondary_cmd_bufs[idx];
+		BoundState     bound;
+		begin_secondary(secondary, idx < prepass_count ? prepass_context : scene_context);
+		if (idx < prepass_count)
+		{
+			W3D_PROFILE_SCOPE("Renderer::record_depth_prepass_chunk");
+			draw_chunk(secondary, bound, depth_prepass_, nearest_draws_, idx);
+		}
+		else if (idx == prepass_count)
+		{
+			write_timestamp(secondary, vk::PipelineStageFlagBits::eBottomOfPipe, eDepthPrepassEnd);
+			draw_lights(secondary, bound);
+			write_timestamp(secondary, vk::PipelineStageFlagBits::eBottomOfPipe, eLightsEnd);
+		}
+		else if (idx == secondary_count - 1)
+		{
+			write_timestamp(secondary, vk::PipelineStageFlagBits::eBottomOfPipe, eSceneEnd);
+			draw_skybox(secondary, bound);
+		}
+		else
+		{
+			W3D_PROFILE_SCOPE("Renderer::record_scene_chunk");
+			draw_chunk(secondary, bound, blinn_phong_, prepass_count ? visible_draws_ : nearest_draws_, idx - prepass_count - 1);
+		}
+		secondary.get_handle().end();
+	});
+
+	prepass_handles_.clear();
+	scene_handles_.clear();
+	for (uint32_t i = 0; i < secondary_count; i++)
+	{
+		(i < prepass_count ? prepass_handles_ : scene_handles_).push_back(frame.secondary_cmd_bufs[i].get_handle());
+	}
+
+	// ONLY SECONDARY COMMAND BUFFERS CAN BE RECORDED INSIDE THE RENDER PASS, SO THE SKYBOX'S END
+	// IS TIMED JUST AFTER IT, BY THE READBACK WHEN THERE IS ONE
+	write_timestamp(cmd_buf, vk::PipelineStageFlagBits::eTopOfPipe, eRenderPassBegin);
+	p_frame_graph_->execute(cmd_buf);
+	if (!p_offscreen_target_ || !settings_.readback)
+	{
+		write_timestamp(cmd_buf, vk::PipelineStageFlagBits::eBottomOfPipe, eSkyboxEnd);
+	}
 	cmd_buf.get_handle().end();
 }
 
+void Renderer::record_readback(CommandBuffer &cmd_buf, uint32_t img_idx)
+{
+	FrameResource &frame  = get_current_frame_resource();
+	vk::Extent2D   extent = p_offscreen_target_->get_extent();
+
+	// THE FRAME GRAPH LEAVES THE COLOR IMAGE READY TO BE COPIED FROM
+	vk::BufferImageCopy copy_region{
+	    .bufferOffset      = 0,
+	    .bufferRowLength   = 0,
+	    .bufferImageHeight = 0,
+	    .imageSubresource  = {
+	         .aspectMask     = vk::ImageAspectFlagBits::eColor,
+	         .mipLevel       = 0,
+	         .baseArrayLayer = 0,
+	         .layerCount     = 1,
+        },
+	    .imageOffset = {0, 0, 0},
+	    .imageExtent = {extent.width, extent.height, 1},
+	};
+	cmd_buf.get_handle().copyImageToBuffer(
+	    p_offscreen_target_->get_color_resource(img_idx).get_image().get_handle(),
+	    vk::ImageLayout::eTransferSrcOptimal,
+	    frame.readback_buf.get_handle(),
+	    copy_region);
+
+	// MAKE THE COPY VISIBLE TO THE HOST ONCE THE FRAME'S FENCE SIGNALS
+	vk::BufferMemoryBarrier host_barrier{
+	    .srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+	    .dstAccessMask       = vk::AccessFlagBits::eHostRead,
+	    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+	    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+	    .buffer              = frame.readback_buf.get_handle(),
+	    .offset              = 0,
+	    .size                = VK_WHOLE_SIZE,
+	};
+	cmd_buf.get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, {}, host_barrier, {});
+	frame.is_readback_pending = true;
+}
+
+void Renderer::deliver_readback(FrameResource &frame)
+{
+	if (!frame.is_readback_pending)
+	{
+		return;
+	}
+	frame.is_readback_pending = false;
+
+	if (readback_callback_)
+	{
+		frame.readback_buf.invalidate();
+		readback_callback_(frame.readback_buf.get_mapped_data(), p_offscreen_target_->get_extent(), p_offscreen_target_->get_color_format());
+	}
+}
+
+void Renderer::flush_readbacks()
+{
+	// OLDEST FRAME FIRST, WHICH IS THE ONE WE WOULD HAVE RENDERED NEXT
+	for (uint32_t i = 0; i < frame_resources_.size(); i++)
+	{
+		deliver_readback(frame_resources_[(frame_idx_ + i) % frame_resources_.size()]);
+	}
+}
+
+void Renderer::write_timestamp(CommandBuffer &cmd_buf, vk::PipelineStageFlagBits stage, TimestampAccessor query)
+{
+	FrameResource &frame = get_current_frame_resource();
+	if (frame.timestamp_pool.get_handle())
+	{
+		cmd_buf.get_handle().writeTimestamp(stage, frame.timestamp_pool.get_handle(), query);
+	}
+}
+
+void Renderer::resolve_gpu_timings(FrameResource &frame)
+{
+	if (!frame.is_timestamp_pending)
+	{
+		return;
+	}
+	frame.is_timestamp_pending = false;
+
+	// THE FRAME'S FENCE HAS SIGNALED SO WE DON'T ASK TO WAIT, IF THE RESULTS AREN'T
+	// THERE ANYWAY WE JUST SKIP THIS FRAME RATHER THAN STALL
+	std::array<uint64_t, eTimestampCount> timestamps;
+	vk::Result result = p_device_->get_handle().getQueryPoolResults(frame.timestamp_pool.get_handle(), 0, eTimestampCount,
+	                                                                 sizeof(timestamps), timestamps.data(), sizeof(uint64_t),
+	                                                                 vk::QueryResultFlagBits::e64);
+	if (result != vk::Result::eSuccess)
+	{
+		return;
+	}
+
+	// TICKS BETWEEN TWO TIMESTAMPS CONVERTED TO MILLISECONDS
+	auto to_ms = [&](TimestampAccessor from, TimestampAccessor to) {
+		return static_cast<double>((timestamps[to] - timestamps[from]) & timestamp_mask_) * timestamp_period_ / 1000000.0;
+	};
+	frame_timings_.gpu_cull          = to_ms(eCullBegin, eRenderPassBegin);
+	frame_timings_.gpu_depth_prepass = to_ms(eRenderPassBegin, eDepthPrepassEnd);
+	frame_timings_.gpu_lights        = to_ms(eDepthPrepassEnd, eLightsEnd);
+	frame_timings_.gpu_scene         = to_ms(eLightsEnd, eSceneEnd);
+	frame_timings_.gpu_skybox        = to_ms(eSceneEnd, eSkyboxEnd);
+	frame_timings_.gpu_total         = to_ms(eRenderPassBegin, eSkyboxEnd);
+	frame_timings_.gpu_frame         = frame.timestamp_frame;
+}
+
+bool Renderer::has_gpu_timings() const
+{
+	return timestamp_period_ > 0.0;
+}
+
+void Renderer::set_readback_callback(ReadbackCallback callback)
+{
+	readback_callback_ = std::move(callback);
+}
+
+void Renderer::set_frame_callback(FrameCallback callback)
+{
+	frame_callback_ = std::move(callback);
+}
+
+const FrameTimings &Renderer::get_last_frame_timings() const
+{
+	return frame_timings_;
+}
+
 void Renderer::update_frame_ubo()
 {
 	sg::Camera &camera    = p_camera_node_->get_component<sg::Camera>();
@@ -449,15 +818,451 @@ void Renderer::update_frame_ubo()
             glm::vec4(LIGHT_POSITIONS[2], 1.0f),
             glm::vec4(LIGHT_POSITIONS[3], 1.0f),
         },
+	    .cam_pos      = glm::vec4(p_camera_node_->get_component<sg::Transform>().get_translation(), 1.0f),
+	    .is_colliding = p_controller_->are_players_colliding(),
+	};
+	sg::Frustum frustum(proj_view);
+	std::copy(frustum.get_planes().begin(), frustum.get_planes().end(), ubo.frustum_planes);
+
+	// THE FRAME'S FENCE HAS SIGNALED SO NOTHING IS STILL READING ITS SLICE OF THE RING
+	ubo_ring_.p_buf->update(&ubo, sizeof(ubo), frame_idx_ * ubo_ring_.stride);
+}
+
+void Renderer::rebuild_draw_list()
+{
+	W3D_PROFILE_FUNCTION();
+	instance_groups_.clear();
+	instance_group_lookup_.clear();
+	draw_items_.clear();
+	draw_nodes_.clear();
+	object_table_.clear();
+	bvh_.clear();
+
+	// EVERY NODE WITH A MESH GOES IN THE GROUP FOR ITS MESH
+	std::queue<sg::Node *> p_nodes;
+	p_nodes.push(&p_scene_->get_root_node());
+	while (!p_nodes.empty())
+	{
+		sg::Node *p_node = p_nodes.front();
+		p_nodes.pop();
+
+		if (p_node->has_component<sg::Mesh>())
+		{
+			sg::Mesh *p_mesh = &p_node->get_component<sg::Mesh>();
+			auto      it     = instance_group_lookup_.find(p_mesh);
+			if (it == instance_group_lookup_.end())
+			{
+				it = instance_group_lookup_.emplace(p_mesh, instance_groups_.size()).first;
+				instance_groups_.push_back({.p_mesh = p_mesh});
+			}
+			instance_groups_[it->second].p_nodes.push_back(p_node);
+		}
+
+		for (sg::Node *p_child : p_node->get_children())
+		{
+			p_nodes.push(p_child);
+		}
+	}
+
+	// LAY THE GROUPS OUT ONE AFTER ANOTHER IN EACH SLICE OF THE INSTANCE RING, AFTER THE LIGHTS,
+	// WITH ROOM FOR ALL THEIR NODES AT EVERY LEVEL OF DETAIL THEIR SUBMESHES HAVE
+	uint32_t first_instance = NUM_LIGHTS;
+	lod_slot_count_         = 0;
+	for (size_t i = 0; i < instance_groups_.size(); i++)
+	{
+		InstanceGroup &group = instance_groups_[i];
+		for (sg::SubMesh *p_submesh : group.p_mesh->get_p_submeshs())
+		{
+			group.lod_count = std::max(group.lod_count, p_submesh->get_lod_count());
+		}
+		group.first_instance = first_instance;
+		group.first_slot     = lod_slot_count_;
+		first_instance += group.lod_count * to_u32(group.p_nodes.size());
+		lod_slot_count_ += group.lod_count;
+
+		for (sg::Node *p_node : group.p_nodes)
+		{
+			sg::Transform &transform = p_node->get_transform();
+			glm::mat4      world_M   = transform.get_world_M();
+			sg::AABB       bounds    = group.p_mesh->get_bounds().transform(world_M);
+			draw_nodes_.push_back({
+			    .p_node         = p_node,
+			    .group_idx      = to_u32(i),
+			    .proxy          = bvh_.insert(*p_node, bounds, to_u32(draw_nodes_.size())),
+			    .world_revision = transform.get_world_revision(),
+			});
+			object_table_.push_back({
+			    .instance = {
+			        .model  = world_M,
+			        .normal = glm::transpose(glm::inverse(world_M)),
+			    },
+			    .bounds_min     = glm::vec4(bounds.get_min(), 1.0f),
+			    .bounds_max     = glm::vec4(bounds.get_max(), 1.0f),
+			    .first_slot     = group.first_slot,
+			    .first_instance = group.first_instance,
+			    .lod            = 0,
+			    .lod_stride     = to_u32(group.p_nodes.size()),
+			});
+		}
+
+		for (sg::SubMesh *p_submesh : group.p_mesh->get_p_submeshs())
+		{
+			const sg::PBRMaterial *p_pbr_material = dynamic_cast<const sg::PBRMaterial *>(p_submesh->get_material());
+			draw_items_.push_back({
+			    .p_submesh    = p_submesh,
+			    .material_set = p_pbr_material->set,
+			    .group_idx    = to_u32(i),
+			});
+		}
+	}
+
+	// THE SCENE PASS ONLY CHANGES PIPELINE AND VERTEX BUFFER WITH THE VERTEX FORMAT, AND THE
+	// INDEX BUFFER'S BINDING WITH THE INDEX TYPE, SO SORTING BY THOSE AND THEN MATERIAL PUTS
+	// DRAWS THAT SHARE STATE NEXT TO EACH OTHER AND draw_scene SKIPS REBINDING IT. WITHIN A
+	// MATERIAL THEY GO IN THE ORDER THEIR INDICES ARE IN THE ARENA
+	std::sort(draw_items_.begin(), draw_items_.end(), [](const DrawItem &lhs, const DrawItem &rhs) {
+		const sg::SubMesh &l = *lhs.p_submesh;
+		const sg::SubMesh &r = *rhs.p_submesh;
+		return std::tie(l.vertex_format_, l.idx_type_, lhs.material_set, l.first_index_) < std::tie(r.vertex_format_, r.idx_type_, rhs.material_set, r.first_index_);
+	});
+
+	// WHICH ALSO MAKES EVERY RUN OF DRAWS THAT SHARE STATE ONE BATCH. EVERY LEVEL OF DETAIL OF
+	// ITS DRAWS IS A GpuDraw OF ITS OWN, AND THEY ARE WHERE build_draws.comp WRITES THE BATCH'S
+	// INDIRECT DRAWS
+	draw_batches_.clear();
+	gpu_draws_.clear();
+	for (uint32_t i = 0; i < to_u32(draw_items_.size()); i++)
+	{
+		const DrawItem &item    = draw_items_[i];
+		const DrawItem *p_first = draw_batches_.empty() ? nullptr : &draw_items_[draw_batches_.back().first_draw];
+		if (!p_first || p_first->material_set != item.material_set || p_first->p_submesh->vertex_format_ != item.p_submesh->vertex_format_ ||
+		    p_first->p_submesh->idx_type_ != item.p_submesh->idx_type_)
+		{
+			draw_batches_.push_back({
+			    .first_draw = i,
+			    .first_cmd  = to_u32(gpu_draws_.size()),
+			});
+		}
+		DrawBatch           &batch = draw_batches_.back();
+		const InstanceGroup &group = instance_groups_[item.group_idx];
+		batch.draw_count++;
+		for (uint32_t lod = 0; lod < group.lod_count; lod++)
+		{
+			sg::SubMeshLod submesh_lod = item.p_submesh->get_lod(lod);
+			gpu_draws_.push_back({
+			    .idx_count      = submesh_lod.idx_count,
+			    .first_index    = submesh_lod.first_index,
+			    .vertex_offset  = static_cast<int32_t>(item.p_submesh->vertex_offset_),
+			    .slot_idx       = group.first_slot + lod,
+			    .batch_idx      = to_u32(draw_batches_.size() - 1),
+			    .first_cmd      = batch.first_cmd,
+			    .first_instance = group.first_instance + lod * to_u32(group.p_nodes.size()),
+			});
+			batch.cmd_count++;
+		}
+	}
+
+	// THE COUNTS THE FRAMES IN FLIGHT ARE CULLING WERE MADE FOR THE OLD LIST
+	for (FrameResource &frame : frame_resources_)
+	{
+		frame.is_cull_pending = false;
+	}
+	gpu_visible_nodes_ = 0;
+
+	instances_.resize(first_instance);
+	draw_list_revision_ = sg::Node::get_structure_revision();
+}
+
+void Renderer::update_spatial_index()
+{
+	// THE DRAW LIST, AND THE BVH WITH IT, ONLY HAS TO BE REBUILT WHEN NODES OR THEIR
+	// COMPONENTS CHANGED
+	if (draw_list_revision_ != sg::Node::get_structure_revision())
+	{
+		rebuild_draw_list();
+		return;
+	}
+
+	// ONLY THE NODES THAT MOVED ARE REFIT, AND MOST OF THEM STAY INSIDE THEIR LEAVES. THEIR
+	// OBJECTS, AND THE NORMAL MATRICES IN THEM, ONLY CHANGE WITH THEM TOO
+	for (size_t i = 0; i < draw_nodes_.size(); i++)
+	{
+		DrawNode      &draw_node = draw_nodes_[i];
+		sg::Transform &transform = draw_node.p_node->get_transform();
+		if (draw_node.world_revision != transform.get_world_revision())
+		{
+			GpuObject &object        = object_table_[i];
+			glm::mat4  world_M       = transform.get_world_M();
+			sg::AABB   bounds        = instance_groups_[draw_node.group_idx].p_mesh->get_bounds().transform(world_M);
+			draw_node.world_revision = transform.get_world_revision();
+			object.instance.model    = world_M;
+			object.instance.normal   = glm::transpose(glm::inverse(world_M));
+			object.bounds_min        = glm::vec4(bounds.get_min(), 1.0f);
+			object.bounds_max        = glm::vec4(bounds.get_max(), 1.0f);
+			bvh_.move(draw_node.proxy, bounds);
+		}
+	}
+}
+
+void Renderer::update_lods()
+{
+	W3D_PROFILE_FUNCTION();
+
+	// A MESH SWITCHES TO LEVEL l WHEN IT FILLS LESS THAN LOD_SCREEN_SIZE / 2^(l - 1) OF THE
+	// SCREEN'S HEIGHT, BUT ONLY ONCE IT'S LOD_HYSTERESIS PAST THAT IN EITHER DIRECTION, SO A
+	// MESH RIGHT AT A SWITCH DOESN'T POP BACK AND FORTH EVERY FRAME
+	auto get_threshold = [](uint32_t lod) {
+		return LOD_SCREEN_SIZE / static_cast<float>(1u << (lod - 1));
 	};
+	sg::Camera &camera     = p_camera_node_->get_component<sg::Camera>();
+	glm::vec3   cam_pos    = p_camera_node_->get_component<sg::Transform>().get_translation();
+	float       proj_scale = std::abs(camera.get_projection()[1][1]);
+	for (size_t i = 0; i < draw_nodes_.size(); i++)
+	{
+		DrawNode            &draw_node = draw_nodes_[i];
+		const InstanceGroup &group     = instance_groups_[draw_node.group_idx];
+		if (group.lod_count == 1)
+		{
+			continue;
+		}
 
-	get_current_frame_resource().blinn_phong_uni_buf.update(&ubo, sizeof(ubo));
-	get_current_frame_resource().light_uni_buf.update(&proj_view, sizeof(proj_view));
+		// HOW MUCH OF THE SCREEN'S HEIGHT THE SPHERE AROUND THE NODE'S BOUNDS FILLS, ALL OF IT
+		// WHEN THE CAMERA IS INSIDE
+		GpuObject &object      = object_table_[i];
+		glm::vec3  bounds_min  = glm::vec3(object.bounds_min);
+		glm::vec3  bounds_max  = glm::vec3(object.bounds_max);
+		float      radius      = 0.5f * glm::length(bounds_max - bounds_min);
+		float      distance    = glm::length(0.5f * (bounds_min + bounds_max) - cam_pos);
+		float      screen_size = distance > radius ? radius * proj_scale / distance : 1.0f;
+
+		uint32_t lod = draw_node.lod;
+		while (lod + 1 < group.lod_count && screen_size < get_threshold(lod + 1) * (1.0f - LOD_HYSTERESIS))
+		{
+			lod++;
+		}
+		while (lod > 0 && screen_size > get_threshold(lod) * (1.0f + LOD_HYSTERESIS))
+		{
+			lod--;
+		}
+		draw_node.lod = lod;
+		object.lod    = lod;
+	}
+}
+
+void Renderer::gather_instances()
+{
+	update_spatial_index();
+	update_lods();
+
+	// ONLY WHAT'S AT LEAST PARTLY INSIDE THE CAMERA'S FRUSTUM GETS DRAWN
+	sg::Camera &camera = p_camera_node_->get_component<sg::Camera>();
+	sg::Frustum frustum(camera.get_projection() * camera.get_view());
+	uint32_t    visible_count = 0;
+
+	// THE LIGHTS COME FIRST, THEY ARE ALL THE SAME BOX
+	glm::mat4 scaled_m = glm::scale(glm::mat4(1.0f), glm::vec3(0.3f));
+	visible_lights_    = 0;
+	for (int i = 0; i < NUM_LIGHTS; i++)
+	{
+		glm::mat4 model = glm::translate(scaled_m, LIGHT_POSITIONS[i]);
+		if (!settings_.frustum_culling || frustum.intersects(LIGHT_BOUNDS.transform(model)))
+		{
+			instances_[visible_lights_++] = {
+			    .model  = model,
+			    .normal = glm::mat4(1.0f),
+			};
+		}
+	}
+	visible_count += visible_lights_;
+
+	// THE GPU CULLS THE NODES ITSELF, WE ONLY LEARN HOW MANY IT FOUND ONCE A FRAME IS DONE
+	if (is_gpu_culling_)
+	{
+		visible_count += gpu_visible_nodes_;
+		frame_timings_.visible = visible_count;
+		frame_timings_.culled  = to_u32(NUM_LIGHTS + draw_nodes_.size()) - visible_count;
+		return;
+	}
+
+	// THE BVH FINDS THE VISIBLE NODES WITHOUT LOOKING AT EVERY ONE
+	visible_nodes_.clear();
+	if (settings_.frustum_culling)
+	{
+		visible_proxies_.clear();
+		bvh_.query(frustum, visible_proxies_);
+		for (uint32_t proxy : visible_proxies_)
+		{
+			visible_nodes_.push_back({0.0f, bvh_.get_user_index(proxy)});
+		}
+	}
+	else
+	{
+		for (uint32_t i = 0; i < to_u32(draw_nodes_.size()); i++)
+		{
+			visible_nodes_.push_back({0.0f, i});
+		}
+	}
+	visible_count += to_u32(visible_nodes_.size());
+
+	// THEY ARE SORTED NEAREST FIRST BY THE VIEW DEPTH OF THEIR BOUNDS' CENTRES AND PACKED AT
+	// THE START OF THEIR LEVEL OF DETAIL'S PART OF THEIR GROUP'S RANGE, SO EACH LEVEL OF A
+	// GROUP IS STILL ONE INSTANCED DRAW, THAT DRAWS ITS NEAREST INSTANCES FIRST
+	glm::mat4 view = camera.get_view();
+	for (std::pair<float, uint32_t> &visible_node : visible_nodes_)
+	{
+		const GpuObject &object = object_table_[visible_node.second];
+		visible_node.first      = -(view * (0.5f * (object.bounds_min + object.bounds_max))).z;
+	}
+	std::sort(visible_nodes_.begin(), visible_nodes_.end());
+	for (InstanceGroup &group : instance_groups_)
+	{
+		group.visible_count = 0;
+		group.lod_visible_counts.fill(0);
+	}
+	for (const auto &[depth, node_idx] : visible_nodes_)
+	{
+		const DrawNode &draw_node = draw_nodes_[node_idx];
+		InstanceGroup  &group     = instance_groups_[draw_node.group_idx];
+		uint32_t        first     = group.first_instance + draw_node.lod * to_u32(group.p_nodes.size());
+		if (group.visible_count++ == 0)
+		{
+			group.nearest_depth = depth;
+		}
+		instances_[first + group.lod_visible_counts[draw_node.lod]++] = object_table_[node_idx].instance;
+	}
+
+	frame_timings_.visible = visible_count;
+	frame_timings_.culled  = to_u32(NUM_LIGHTS + draw_nodes_.size()) - visible_count;
+}
+
+void Renderer::update_frame_instances()
+{
+	gather_instances();
+	reserve_rings();
+
+	// WHEN CULLING ON THE GPU ONLY THE LIGHTS ARE WRITTEN HERE, cull_instances.comp WRITES THE
+	// NODES' INSTANCES FROM THE OBJECT TABLE. THE TABLES ARE SMALL NEXT TO THE INSTANCES, SO
+	// THEY'RE UPLOADED WHOLE RATHER THAN TRACKING WHAT EACH FRAME'S SLICE IS MISSING
+	if (is_gpu_culling_)
+	{
+		instance_ring_.p_buf->update(instances_.data(), visible_lights_ * sizeof(sg::Instance), frame_idx_ * instance_ring_.stride);
+		object_ring_.p_buf->update(object_table_.data(), object_table_.size() * sizeof(GpuObject), frame_idx_ * object_ring_.stride);
+		draw_ring_.p_buf->update(gpu_draws_.data(), gpu_draws_.size() * sizeof(GpuDraw), frame_idx_ * draw_ring_.stride);
+	}
+	else
+	{
+		instance_ring_.p_buf->update(instances_.data(), instances_.size() * sizeof(sg::Instance), frame_idx_ * instance_ring_.stride);
+	}
+}
+
+void Renderer::record_gpu_culling(CommandBuffer &cmd_buf)
+{
+	W3D_PROFILE_FUNCTION();
+	FrameResource    &frame      = get_current_frame_resource();
+	vk::CommandBuffer cmd_buf_h  = cmd_buf.get_handle();
+	uint32_t          count_size = to_u32((draw_batches_.size() + lod_slot_count_) * sizeof(uint32_t));
+	if (!count_size)
+	{
+		return;
+	}
+
+	// EVERY COUNT STARTS AT 0, THE SHADERS ADD TO THEM ATOMICALLY
+	cmd_buf_h.fillBuffer(count_ring_.p_buf->get_handle(), frame_idx_ * count_ring_.stride, count_size, 0);
+	vk::MemoryBarrier fill_barrier{
+	    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+	    .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+	};
+	cmd_buf_h.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader, {}, fill_barrier, {}, {});
+
+	CullPCO pco{
+	    .object_count        = to_u32(object_table_.size()),
+	    .draw_count          = to_u32(gpu_draws_.size()),
+	    .group_counts_offset = to_u32(draw_batches_.size()),
+	    .is_culling          = settings_.frustum_culling,
+	};
+	auto dispatch = [&](ComputePipeline &pipeline, uint32_t invocation_count) {
+		cmd_buf_h.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline.get_handle());
+		cmd_buf_h.bindDescriptorSets(vk::PipelineBindPoint::eCompute, pipeline.get_pipeline_layout(), 0, frame.cull_set, {});
+		cmd_buf_h.pushConstants<CullPCO>(pipeline.get_pipeline_layout(), vk::ShaderStageFlagBits::eCompute, 0, pco);
+		cmd_buf_h.dispatch((invocation_count + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+	};
+
+	// FIRST THE VISIBLE NODES' INSTANCES ARE WRITTEN AND COUNTED FOR THEIR GROUPS' LEVELS OF
+	// DETAIL, THEN EVERY LEVEL OF A SUBMESH WITH VISIBLE INSTANCES BECOMES AN INDIRECT DRAW
+	dispatch(*p_cull_instances_pl_, pco.object_count);
+	vk::MemoryBarrier cull_barrier{
+	    .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+	    .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+	};
+	cmd_buf_h.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, cull_barrier, {}, {});
+	dispatch(*p_build_draws_pl_, pco.draw_count);
+
+	// THE PASS DRAWS WHAT WAS BUILT, AND THE HOST READS THE COUNTS BACK ONCE THE FENCE SIGNALS
+	vk::MemoryBarrier draw_barrier{
+	    .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+	    .dstAccessMask = vk::AccessFlagBits::eIndirectCommandRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eHostRead,
+	};
+	cmd_buf_h.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader,
+	                          vk::PipelineStageFlagBits::eDrawIndirect | vk::PipelineStageFlagBits::eVertexShader | vk::PipelineStageFlagBits::eHost,
+	                          {}, draw_barrier, {}, {});
+	frame.is_cull_pending = true;
+}
+
+void Renderer::resolve_gpu_culling(FrameResource &frame)
+{
+	if (!frame.is_cull_pending)
+	{
+		return;
+	}
+	frame.is_cull_pending = false;
+
+	// THE INSTANCE COUNTS OF THE GROUPS' LEVELS ADD UP TO THE VISIBLE NODES, LIKE THE gpu_
+	// TIMES THEY ARE FROM A FRAME OR TWO AGO
+	count_ring_.p_buf->invalidate();
+	size_t          slice    = &frame - frame_resources_.data();
+	const uint32_t *p_counts = reinterpret_cast<const uint32_t *>(count_ring_.p_buf->get_mapped_data() + slice * count_ring_.stride);
+	gpu_visible_nodes_       = 0;
+	for (size_t i = 0; i < lod_slot_count_; i++)
+	{
+		gpu_visible_nodes_ += p_counts[draw_batches_.size() + i];
+	}
+}
+
+void Renderer::gather_visible_draws()
+{
+	visible_draws_.clear();
+	for (uint32_t i = 0; i < to_u32(draw_items_.size()); i++)
+	{
+		if (instance_groups_[draw_items_[i].group_idx].visible_count > 0)
+		{
+			visible_draws_.push_back(i);
+		}
+	}
+
+	// THE DRAWS THAT LAY DOWN THE DEPTH GO BY THEIR GROUP'S NEAREST NODE SO WHAT'S BEHIND FAILS
+	// THE DEPTH TEST, THE ORDER OF THE DRAW LIST IS KEPT BETWEEN DRAWS OF THE SAME GROUP
+	nearest_draws_ = visible_draws_;
+	std::stable_sort(nearest_draws_.begin(), nearest_draws_.end(), [&](uint32_t lhs, uint32_t rhs) {
+		return instance_groups_[draw_items_[lhs].group_idx].nearest_depth < instance_groups_[draw_items_[rhs].group_idx].nearest_depth;
+	});
+}
+
+void Renderer::begin_secondary(CommandBuffer &cmd_buf, const RenderGraph::PassContext &context)
+{
+	vk::CommandBufferInheritanceInfo inheritance_info{
+	    .renderPass  = context.render_pass,
+	    .subpass     = context.subpass,
+	    .framebuffer = context.framebuffer,
+	};
+	cmd_buf.begin(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue, &inheritance_info);
+
+	// NOTHING IS INHERITED FROM THE PRIMARY COMMAND BUFFER BUT THE PASS ITSELF
+	set_dynamic_states(cmd_buf);
 }
 
 void Renderer::set_dynamic_states(CommandBuffer &cmd_buf)
 {
-	vk::Extent2D swapchain_extent = p_swapchain_->get_swapchain_properties().extent;
+	vk::Extent2D swapchain_extent = get_render_extent();
 	vk::Viewport viewport{
 	    .x        = 0,
 	    .y        = 0,
@@ -478,31 +1283,7 @@ void Renderer::set_dynamic_states(CommandBuffer &cmd_buf)
 	cmd_buf.get_handle().setScissor(0, scissor);
 }
 
-void Renderer::begin_render_pass(CommandBuffer &cmd_buf, vk::Framebuffer framebuffer)
-{
-	std::array<vk::ClearValue, 2> clear_values{
-	    std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f},
-	};
-	clear_values[1].depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
-
-	vk::RenderPassBeginInfo render_pass_binfo{
-	    .renderPass  = p_render_pass_->get_handle(),
-	    .framebuffer = framebuffer,
-	    .renderArea  = {
-	         .offset = {
-	             .x = 0,
-	             .y = 0,
-            },
-	         .extent = p_swapchain_->get_swapchain_properties().extent,
-        },
-	    .clearValueCount = clear_values.size(),
-	    .pClearValues    = clear_values.data(),
-	};
-
-	cmd_buf.get_handle().beginRenderPass(render_pass_binfo, vk::SubpassContents::eInline);
-}
-
-void Renderer::draw_skybox(CommandBuffer &cmd_buf)
+void Renderer::draw_skybox(CommandBuffer &cmd_buf, BoundState &bound)
 {
 	sg::Camera    &camera = p_camera_node_->get_component<sg::Camera>();
 	FrameResource &frame  = get_current_frame_resource();
@@ -510,9 +1291,7 @@ void Renderer::draw_skybox(CommandBuffer &cmd_buf)
 	         .proj = camera.get_projection(),
 	         .view = camera.get_view(),
     };
-	cmd_buf.get_handle().bindPipeline(
-	    vk::PipelineBindPoint::eGraphics,
-	    skybox_.p_pl->get_handle());
+	bind_pipeline(cmd_buf, bound, skybox_);
 	cmd_buf.get_handle().bindDescriptorSets(
 	    vk::PipelineBindPoint::eGraphics,
 	    skybox_.p_pl->get_pipeline_layout(),
@@ -524,97 +1303,152 @@ void Renderer::draw_skybox(CommandBuffer &cmd_buf)
 	    vk::ShaderStageFlagBits::eVertex,
 	    0,
 	    pco);
-	draw_submesh(cmd_buf, *baked_pbr_.p_box);
+	draw_submesh(cmd_buf, bound, *baked_pbr_.p_box);
 }        // namespace W3D
 
-void Renderer::draw_lights(CommandBuffer &cmd_buf)
+void Renderer::draw_lights(CommandBuffer &cmd_buf, BoundState &bound)
 {
-	vk::PipelineLayout pl_layout = light_.p_pl->get_pipeline_layout();
-	cmd_buf.get_handle().bindPipeline(vk::PipelineBindPoint::eGraphics, light_.p_pl->get_handle());
-	cmd_buf.get_handle().bindDescriptorSets(
-	    vk::PipelineBindPoint::eGraphics,
-	    pl_layout,
-	    0,
-	    get_current_frame_resource().light_set,
-	    {});
+	bind_pipeline(cmd_buf, bound, light_);
+	bind_frame_set(cmd_buf, light_);
 
-	glm::mat4 scaled_m = glm::scale(glm::mat4(1.0f), glm::vec3(0.3f));
-	for (int i = 0; i < NUM_LIGHTS; i++)
+	// THE VISIBLE LIGHTS ARE THE FIRST INSTANCES, SEE gather_instances
+	if (visible_lights_ > 0)
 	{
-		glm::mat4 world_m = glm::translate(scaled_m, LIGHT_POSITIONS[i]);
-
-		cmd_buf.get_handle().pushConstants<glm::mat4>(pl_layout, vk::ShaderStageFlagBits::eVertex, 0, world_m);
-
-		draw_submesh(cmd_buf, *baked_pbr_.p_box);
+		draw_submesh(cmd_buf, bound, *baked_pbr_.p_box, visible_lights_, 0);
 	}
 }
 
-void Renderer::draw_scene(CommandBuffer &cmd_buf)
+void Renderer::draw_scene(CommandBuffer &cmd_buf, BoundState &bound, const PipelineResource &pipeline, const std::vector<uint32_t> &draws, size_t first_draw, size_t last_draw)
 {
-	vk::PipelineLayout pl_layout = blinn_phong_.p_pl->get_pipeline_layout();
-	cmd_buf.get_handle().bindPipeline(
-	    vk::PipelineBindPoint::eGraphics,
-	    blinn_phong_.p_pl->get_handle());
-	cmd_buf.get_handle().bindDescriptorSets(
-	    vk::PipelineBindPoint::eGraphics,
-	    pl_layout,
-	    0,
-	    get_current_frame_resource().blinn_phong_set,
-	    {});
+	// BOTH SCENE PIPELINES HAVE THE SAME LAYOUT, SO THE FRAME SET STAYS BOUND WHEN THEY SWITCH
+	bind_pipeline(cmd_buf, bound, pipeline);
+	bind_frame_set(cmd_buf, pipeline);
 
-	std::queue<sg::Node *> p_nodes;
-
-	p_nodes.push(&p_scene_->get_root_node());
-	while (!p_nodes.empty())
+	// ONE DRAW PER SUBMESH AND LEVEL OF DETAIL FOR ALL THE NODES THAT SHARE ITS MESH, IN THE
+	// ORDER OF draws
+	for (size_t i = first_draw; i < last_draw; i++)
 	{
-		sg::Node *p_node = p_nodes.front();
-		p_nodes.pop();
-
-		if (p_node->has_component<sg::Mesh>())
+		const DrawItem      &item  = draw_items_[draws[i]];
+		const InstanceGroup &group = instance_groups_[item.group_idx];
+		bind_pipeline(cmd_buf, bound, pipeline, item.p_submesh->vertex_format_);
+		if (!pipeline.is_position_only)
+		{
+			bind_material(cmd_buf, bound, item.material_set);
+		}
+		for (uint32_t lod = 0; lod < group.lod_count; lod++)
 		{
-			push_node_model_matrix(cmd_buf, p_node);
-			std::vector<sg::SubMesh *> p_submeshs = p_node->get_component<sg::Mesh>().get_p_submeshs();
-			for (sg::SubMesh *p_submesh : p_submeshs)
+			if (group.lod_visible_counts[lod] > 0)
 			{
-				const sg::PBRMaterial *p_pbr_material = dynamic_cast<const sg::PBRMaterial *>(p_submesh->get_material());
-				bind_material(cmd_buf, *p_pbr_material);
-				draw_submesh(cmd_buf, *p_submesh);
+				draw_submesh(cmd_buf, bound, *item.p_submesh, group.lod_visible_counts[lod], group.first_instance + lod * to_u32(group.p_nodes.size()), lod);
 			}
 		}
+	}
+}
+
+void Renderer::draw_scene_indirect(CommandBuffer &cmd_buf, BoundState &bound, const PipelineResource &pipeline, size_t first_batch, size_t last_batch)
+{
+	// BOTH SCENE PIPELINES HAVE THE SAME LAYOUT, SO THE FRAME SET STAYS BOUND WHEN THEY SWITCH
+	bind_pipeline(cmd_buf, bound, pipeline);
+	bind_frame_set(cmd_buf, pipeline);
 
-		std::vector<sg::Node *> p_children = p_node->get_children();
-		for (sg::Node *p_child : p_children)
+	// ONE INDIRECT DRAW CALL PER BATCH, THE GPU DECIDES HOW MANY OF ITS DRAWS ARE ACTUALLY MADE
+	const vk::DeviceSize cmd_size = sizeof(vk::DrawIndexedIndirectCommand);
+	for (size_t i = first_batch; i < last_batch; i++)
+	{
+		const DrawBatch &batch = draw_batches_[i];
+		const DrawItem  &item  = draw_items_[batch.first_draw];
+		bind_pipeline(cmd_buf, bound, pipeline, item.p_submesh->vertex_format_);
+		if (!pipeline.is_position_only)
 		{
-			p_nodes.push(p_child);
+			bind_material(cmd_buf, bound, item.material_set);
 		}
+		bind_geometry(cmd_buf, bound, *item.p_submesh);
+		cmd_buf.get_handle().drawIndexedIndirectCount(
+		    indirect_ring_.p_buf->get_handle(),
+		    frame_idx_ * indirect_ring_.stride + batch.first_cmd * cmd_size,
+		    count_ring_.p_buf->get_handle(),
+		    frame_idx_ * count_ring_.stride + i * sizeof(uint32_t),
+		    batch.cmd_count,
+		    to_u32(cmd_size));
 	}
 }
 
-void Renderer::push_node_model_matrix(CommandBuffer &cmd_buf, sg::Node *p_node)
+void Renderer::bind_frame_set(CommandBuffer &cmd_buf, const PipelineResource &pipeline)
 {
-	BlinnPhongPCO pco{
-	    .model        = p_node->get_component<sg::Transform>().get_world_M(),
-	    .cam_pos      = p_camera_node_->get_component<sg::Transform>().get_translation(),
-	    .is_colliding = p_controller_->are_players_colliding(),
+	// THE OFFSETS PICK THIS FRAME'S SLICES OF THE RINGS, IN THE ORDER OF THEIR BINDINGS
+	std::array<uint32_t, 2> dynamic_offsets = {
+	    to_u32(frame_idx_ * ubo_ring_.stride),
+	    to_u32(frame_idx_ * instance_ring_.stride),
 	};
-	cmd_buf.get_handle().pushConstants<BlinnPhongPCO>(blinn_phong_.p_pl->get_pipeline_layout(), vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, pco);
-}        // namespace W3D
+	cmd_buf.get_handle().bindDescriptorSets(
+	    vk::PipelineBindPoint::eGraphics,
+	    pipeline.p_pl->get_pipeline_layout(),
+	    0,
+	    frame_set_,
+	    dynamic_offsets);
+}
 
-void Renderer::bind_material(CommandBuffer &cmd_buf, const sg::PBRMaterial &material)
+void Renderer::bind_material(CommandBuffer &cmd_buf, BoundState &bound, vk::DescriptorSet material_set)
 {
+	if (bound.material_set == material_set)
+	{
+		return;
+	}
 	cmd_buf.get_handle().bindDescriptorSets(
 	    vk::PipelineBindPoint::eGraphics,
 	    blinn_phong_.p_pl->get_pipeline_layout(),
 	    1,
-	    material.set,
+	    material_set,
 	    {});
+	bound.material_set = material_set;
+}
+
+void Renderer::bind_pipeline(CommandBuffer &cmd_buf, BoundState &bound, const PipelineResource &pipeline, sg::VertexFormat vertex_format)
+{
+	const GraphicsPipeline &graphics_pl = vertex_format == sg::VertexFormat::eSkinned && pipeline.p_skinned_pl ? *pipeline.p_skinned_pl : *pipeline.p_pl;
+	if (bound.pipeline == graphics_pl.get_handle())
+	{
+		return;
+	}
+	bool is_same_resource = bound.pipeline == pipeline.p_pl->get_handle() || (pipeline.p_skinned_pl && bound.pipeline == pipeline.p_skinned_pl->get_handle());
+	cmd_buf.get_handle().bindPipeline(vk::PipelineBindPoint::eGraphics, graphics_pl.get_handle());
+	bound.pipeline         = graphics_pl.get_handle();
+	bound.is_position_only = pipeline.is_position_only;
+
+	// THE PIPELINES DON'T SHARE LAYOUTS, SO NO SET BOUND FOR THE OLD ONE CAN BE KEPT, UNLESS
+	// ONLY THE VERTEX FORMAT CHANGED
+	if (!is_same_resource)
+	{
+		bound.material_set = nullptr;
+	}
 }
 
-void Renderer::draw_submesh(CommandBuffer &cmd_buf, sg::SubMesh &submesh)
+void Renderer::draw_submesh(CommandBuffer &cmd_buf, BoundState &bound, sg::SubMesh &submesh, uint32_t instance_count, uint32_t first_instance, uint32_t lod)
 {
-	cmd_buf.get_handle().bindVertexBuffers(0, submesh.p_vertex_buf_->get_handle(), {0});
-	cmd_buf.get_handle().bindIndexBuffer(submesh.p_idx_buf_->get_handle(), 0, vk::IndexType::eUint32);
-	cmd_buf.get_handle().drawIndexed(submesh.idx_count_, 1, 0, 0, 0);
+	sg::SubMeshLod submesh_lod = submesh.get_lod(lod);
+	bind_geometry(cmd_buf, bound, submesh);
+	cmd_buf.get_handle().drawIndexed(submesh_lod.idx_count, instance_count, submesh_lod.first_index, submesh.vertex_offset_, first_instance);
+}
+
+void Renderer::bind_geometry(CommandBuffer &cmd_buf, BoundState &bound, const sg::SubMesh &submesh)
+{
+	// EVERY SUBMESH IS IN THE GEOMETRY ARENA, SO ITS BUFFERS ARE ONLY BOUND AGAIN WHEN THE
+	// VERTEX FORMAT OR INDEX TYPE CHANGES, OR THE PIPELINE SWITCHES BETWEEN READING WHOLE
+	// VERTICES AND ONLY THEIR POSITIONS
+	const GeometryArena &arena      = p_device_->get_geometry_arena();
+	const Buffer        &vertices   = bound.is_position_only ? arena.get_position_buffer(submesh.vertex_format_) : arena.get_vertex_buffer(submesh.vertex_format_);
+	vk::Buffer           vertex_buf = vertices.get_handle();
+	if (bound.vertex_buf != vertex_buf)
+	{
+		cmd_buf.get_handle().bindVertexBuffers(0, vertex_buf, {0});
+		bound.vertex_buf = vertex_buf;
+	}
+	if (bound.idx_buf != arena.get_index_buffer().get_handle() || bound.idx_type != submesh.idx_type_)
+	{
+		cmd_buf.get_handle().bindIndexBuffer(arena.get_index_buffer().get_handle(), 0, submesh.idx_type_);
+		bound.idx_buf  = arena.get_index_buffer().get_handle();
+		bound.idx_type = submesh.idx_type_;
+	}
 }
 
 Renderer::FrameResource &Renderer::get_current_frame_resource()
@@ -622,6 +1456,15 @@ Renderer::FrameResource &Renderer::get_current_frame_resource()
 	return frame_resources_[frame_idx_];
 };
 
+vk::Extent2D Renderer::get_render_extent() const
+{
+	if (p_offscreen_target_)
+	{
+		return p_offscreen_target_->get_extent();
+	}
+	return p_swapchain_->get_swapchain_properties().extent;
+}
+
 sg::Node &Renderer::add_player_script(const char *node_name)
 {
 	sg::Node *p_node = p_scene_->find_node(node_name);
@@ -647,87 +1490,231 @@ sg::Script &Renderer::add_light_script(glm::vec3& lightposition, std::string lig
 
 void Renderer::create_rendering_resources()
 {
+	W3D_PROFILE_SCOPE("Renderer::create_rendering_resources");
 	create_frame_resources();
 	create_descriptor_resources();
-	create_render_pass();
+	create_frame_graph();
 	create_pipeline_resources();
 }
 
 void Renderer::create_frame_resources()
 {
 	const DeviceMemoryAllocator &allocator = p_device_->get_device_memory_allocator();
-	for (uint32_t i = 0; i < NUM_INFLIGHT_FRAMES; i++)
+
+	// HEADLESS FRAMES CAN BE COPIED INTO A HOST BUFFER, 4 BYTES PER PIXEL FOR OUR RGBA8 TARGET
+	size_t readback_size = 0;
+	if (p_offscreen_target_ && settings_.readback)
+	{
+		vk::Extent2D extent = p_offscreen_target_->get_extent();
+		readback_size       = static_cast<size_t>(extent.width) * extent.height * 4;
+	}
+
+	// THE GPU CAN ONLY TIME ITSELF IF THE GRAPHICS QUEUE HAS VALID TIMESTAMP BITS
+	const vk::PhysicalDevice physical_device_h = p_physical_device_->get_handle();
+	uint32_t                 valid_bits        = physical_device_h.getQueueFamilyProperties()[p_physical_device_->get_graphics_queue_family_index()].timestampValidBits;
+	if (valid_bits)
+	{
+		timestamp_period_ = physical_device_h.getProperties().limits.timestampPeriod;
+		timestamp_mask_   = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+	}
+	else
+	{
+		LOGW("The graphics queue doesn't support timestamps, GPU timings are disabled");
+	}
+
+	for (uint32_t i = 0; i < settings_.frames_in_flight; i++)
 	{
 		frame_resources_.push_back({
 		    .cmd_buf                   = std::move(p_cmd_pool_->allocate_command_buffer()),
-		    .blinn_phong_uni_buf       = std::move(allocator.allocate_uniform_buffer(sizeof(UBO))),
-		    .light_uni_buf             = std::move(allocator.allocate_uniform_buffer(sizeof(glm::mat4))),
 		    .image_avaliable_semaphore = std::move(Semaphore(*p_device_)),
 		    .render_finished_semaphore = std::move(Semaphore(*p_device_)),
 		    .in_flight_fence           = std::move(Fence(*p_device_, vk::FenceCreateFlagBits::eSignaled)),
+		    .readback_buf              = readback_size ? allocator.allocate_readback_buffer(readback_size) : allocator.allocate_null_buffer(),
+		    .timestamp_pool            = valid_bits ? QueryPool(*p_device_, vk::QueryType::eTimestamp, eTimestampCount) : QueryPool(*p_device_, nullptr),
 		});
+
+		// THE SKYBOX AND LIGHTS GET A SECONDARY COMMAND BUFFER EACH, PLUS ONE FOR EACH CHUNK
+		// OF THE SCENE AND OF ITS DEPTH PREPASS, OF WHICH THERE ARE AT MOST AS MANY AS
+		// RECORDING THREADS. THEIR POOLS ARE RESET ALL AT ONCE EVERY FRAME
+		FrameResource &frame = frame_resources_.back();
+		for (uint32_t j = 0; j < 2 * p_thread_pool_->get_thread_count() + 2; j++)
+		{
+			frame.record_cmd_pools.push_back(std::make_unique<CommandPool>(*p_device_, p_device_->get_graphics_queue(), p_physical_device_->get_graphics_queue_family_index(), CommandPoolResetStrategy::ePool, vk::CommandPoolCreateFlagBits::eTransient));
+			frame.secondary_cmd_bufs.push_back(frame.record_cmd_pools.back()->allocate_command_buffer(vk::CommandBufferLevel::eSecondary));
+		}
+	}
+
+	// THE FRAMES' UNIFORMS AND INSTANCES, AND WHAT THE GPU CULLS AND DRAWS, LIVE IN RINGS WITH
+	// A SLICE PER FRAME IN FLIGHT. EACH SLICE HAS TO START WHERE A DESCRIPTOR'S OFFSET, DYNAMIC
+	// OR NOT, IS ALLOWED TO POINT
+	const vk::PhysicalDeviceLimits limits = physical_device_h.getProperties().limits;
+	create_ring(ubo_ring_, &DeviceMemoryAllocator::allocate_uniform_buffer, sizeof(UBO), limits.minUniformBufferOffsetAlignment, 1);
+	create_ring(instance_ring_, &DeviceMemoryAllocator::allocate_storage_buffer, sizeof(sg::Instance), limits.minStorageBufferOffsetAlignment, MIN_INSTANCE_CAPACITY);
+	if (is_gpu_culling_)
+	{
+		create_ring(object_ring_, &DeviceMemoryAllocator::allocate_storage_buffer, sizeof(GpuObject), limits.minStorageBufferOffsetAlignment, MIN_INSTANCE_CAPACITY);
+		create_ring(draw_ring_, &DeviceMemoryAllocator::allocate_storage_buffer, sizeof(GpuDraw), limits.minStorageBufferOffsetAlignment, MIN_INSTANCE_CAPACITY);
+		create_ring(indirect_ring_, &DeviceMemoryAllocator::allocate_indirect_buffer, sizeof(vk::DrawIndexedIndirectCommand), limits.minStorageBufferOffsetAlignment, MIN_INSTANCE_CAPACITY);
+		create_ring(count_ring_, &DeviceMemoryAllocator::allocate_counter_buffer, sizeof(uint32_t), limits.minStorageBufferOffsetAlignment, MIN_INSTANCE_CAPACITY);
 	}
 }
 
-void Renderer::create_descriptor_resources()
+void Renderer::create_ring(BufferRing &ring, Buffer (DeviceMemoryAllocator::*allocate)(size_t) const, vk::DeviceSize element_size, vk::DeviceSize alignment, uint32_t capacity)
 {
-	create_skybox_desc_resources();
-	create_blinn_phong_desc_resources();
-	create_light_desc_resources();
-	create_materials_desc_resources();
+	ring.allocate     = allocate;
+	ring.element_size = element_size;
+	ring.alignment    = alignment;
+	ring.capacity     = capacity;
+	ring.stride       = align_up<vk::DeviceSize>(capacity * element_size, alignment);
+	ring.p_buf        = std::make_unique<Buffer>((p_device_->get_device_memory_allocator().*allocate)(settings_.frames_in_flight * ring.stride));
 }
 
-void Renderer::create_blinn_phong_desc_resources()
+bool Renderer::reserve_ring(BufferRing &ring, uint32_t count)
 {
-	vk::DescriptorBufferInfo ubo_dinfo{
-	    .offset = 0,
-	    .range  = sizeof(UBO),
-	};
-	for (uint32_t i = 0; i < NUM_INFLIGHT_FRAMES; i++)
+	if (count <= ring.capacity)
 	{
-		ubo_dinfo.buffer = frame_resources_[i].blinn_phong_uni_buf.get_handle();
+		return false;
+	}
 
-		DescriptorAllocation desc_allocation = DescriptorBuilder::begin(p_descriptor_state_->cache, p_descriptor_state_->allocator).bind_buffer(0, ubo_dinfo, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment).build();
+	// EVERY SLICE OF THE RING GROWS AT ONCE AND THE OTHER FRAMES IN FLIGHT MAY STILL BE READING
+	// THEIRS, SO WE WAIT FOR THE GPU FIRST. THE CAPACITY DOUBLES SO THIS HARDLY EVER HAPPENS
+	p_device_->get_handle().waitIdle();
+	create_ring(ring, ring.allocate, ring.element_size, ring.alignment, std::max(count, 2 * ring.capacity));
+	return true;
+}
 
-		blinn_phong_.desc_layout_ring[DescriptorRingAccessor::eGlobal] = desc_allocation.set_layout;
-		frame_resources_[i].blinn_phong_set                            = desc_allocation.set;
+void Renderer::reserve_rings()
+{
+	bool has_grown = reserve_ring(instance_ring_, to_u32(instances_.size()));
+	if (is_gpu_culling_)
+	{
+		has_grown |= reserve_ring(object_ring_, to_u32(object_table_.size()));
+		has_grown |= reserve_ring(draw_ring_, to_u32(gpu_draws_.size()));
+		has_grown |= reserve_ring(indirect_ring_, to_u32(gpu_draws_.size()));
+		has_grown |= reserve_ring(count_ring_, to_u32(draw_batches_.size() + lod_slot_count_));
 	}
-};
+	if (has_grown)
+	{
+		write_ring_descriptors();
+	}
+}
 
-void Renderer::create_light_desc_resources()
+vk::DescriptorBufferInfo Renderer::get_slice_dinfo(const BufferRing &ring, uint32_t frame_idx) const
 {
-	vk::DescriptorBufferInfo ubo_dinfo{
-	    .offset = 0,
-	    .range  = sizeof(glm::mat4),
+	return vk::DescriptorBufferInfo{
+	    .buffer = ring.p_buf->get_handle(),
+	    .offset = frame_idx * ring.stride,
+	    .range  = ring.capacity * ring.element_size,
 	};
+}
 
-	for (uint32_t i = 0; i < NUM_INFLIGHT_FRAMES; i++)
+void Renderer::write_ring_descriptors()
+{
+	// THE SETS ARE POINTED AT THE NEW RINGS, NOTHING IS USING THEM AS WE WAITED FOR THE GPU
+	std::vector<vk::DescriptorBufferInfo> dinfos;
+	std::vector<vk::WriteDescriptorSet>   writes;
+	dinfos.reserve(1 + 6 * frame_resources_.size());
+	auto write = [&](vk::DescriptorSet set, uint32_t binding, vk::DescriptorType type, vk::DescriptorBufferInfo dinfo) {
+		dinfos.push_back(dinfo);
+		writes.push_back({
+		    .dstSet          = set,
+		    .dstBinding      = binding,
+		    .descriptorCount = 1,
+		    .descriptorType  = type,
+		    .pBufferInfo     = &dinfos.back(),
+		});
+	};
+
+	write(frame_set_, 1, vk::DescriptorType::eStorageBufferDynamic, get_slice_dinfo(instance_ring_, 0));
+	if (is_gpu_culling_)
 	{
-		ubo_dinfo.buffer = frame_resources_[i].light_uni_buf.get_handle();
+		for (uint32_t i = 0; i < to_u32(frame_resources_.size()); i++)
+		{
+			FrameResource &frame = frame_resources_[i];
+			write(frame.cull_set, 1, vk::DescriptorType::eStorageBuffer, get_slice_dinfo(instance_ring_, i));
+			write(frame.cull_set, 2, vk::DescriptorType::eStorageBuffer, get_slice_dinfo(object_ring_, i));
+			write(frame.cull_set, 3, vk::DescriptorType::eStorageBuffer, get_slice_dinfo(draw_ring_, i));
+			write(frame.cull_set, 4, vk::DescriptorType::eStorageBuffer, get_slice_dinfo(indirect_ring_, i));
+			write(frame.cull_set, 5, vk::DescriptorType::eStorageBuffer, get_slice_dinfo(count_ring_, i));
+
+			// THE COUNTS THAT WERE IN THE OLD RING ARE GONE
+			frame.is_cull_pending = false;
+		}
+	}
+	p_device_->get_handle().updateDescriptorSets(writes, {});
+}
 
-		DescriptorAllocation desc_allocation =
-		    DescriptorBuilder::begin(p_descriptor_state_->cache, p_descriptor_state_->allocator)
-		        .bind_buffer(0, ubo_dinfo, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eVertex)
-		        .build();
+void Renderer::create_descriptor_resources()
+{
+	create_skybox_desc_resources();
+	create_frame_desc_resources();
+	create_materials_desc_resources();
+	if (is_gpu_culling_)
+	{
+		create_cull_desc_resources();
+	}
+}
 
-		light_.desc_layout_ring[DescriptorRingAccessor::eGlobal] = desc_allocation.set_layout;
-		frame_resources_[i].light_set                            = desc_allocation.set;
+void Renderer::create_frame_desc_resources()
+{
+	// THE DYNAMIC OFFSETS PICK THE FRAME'S SLICES, SO EACH RANGE IS ONE SLICE LONG
+	vk::DescriptorBufferInfo ubo_dinfo      = get_slice_dinfo(ubo_ring_, 0);
+	vk::DescriptorBufferInfo instance_dinfo = get_slice_dinfo(instance_ring_, 0);
+
+	DescriptorAllocation desc_allocation =
+	    DescriptorBuilder::begin(p_descriptor_state_->cache, p_descriptor_state_->allocator)
+	        .bind_buffer(0, ubo_dinfo, vk::DescriptorType::eUniformBufferDynamic, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment)
+	        .bind_buffer(1, instance_dinfo, vk::DescriptorType::eStorageBufferDynamic, vk::ShaderStageFlagBits::eVertex)
+	        .build();
+
+	// THE SCENE, ITS DEPTH PREPASS AND THE LIGHTS SHARE IT
+	frame_set_                                                       = desc_allocation.set;
+	blinn_phong_.desc_layout_ring[DescriptorRingAccessor::eGlobal]   = desc_allocation.set_layout;
+	light_.desc_layout_ring[DescriptorRingAccessor::eGlobal]         = desc_allocation.set_layout;
+	depth_prepass_.desc_layout_ring[DescriptorRingAccessor::eGlobal] = desc_allocation.set_layout;
+}
+
+void Renderer::create_cull_desc_resources()
+{
+	// THE CULLING SHADERS USE MORE STORAGE BUFFERS THAN THE DYNAMIC ONES DEVICES HAVE TO ALLOW,
+	// SO EVERY FRAME GETS ITS OWN SET POINTING AT ITS SLICES INSTEAD
+	for (uint32_t i = 0; i < settings_.frames_in_flight; i++)
+	{
+		std::array<vk::DescriptorBufferInfo, 6> dinfos = {
+		    get_slice_dinfo(ubo_ring_, i),
+		    get_slice_dinfo(instance_ring_, i),
+		    get_slice_dinfo(object_ring_, i),
+		    get_slice_dinfo(draw_ring_, i),
+		    get_slice_dinfo(indirect_ring_, i),
+		    get_slice_dinfo(count_ring_, i),
+		};
+
+		DescriptorBuilder builder = DescriptorBuilder::begin(p_descriptor_state_->cache, p_descriptor_state_->allocator);
+		builder.bind_buffer(0, dinfos[0], vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eCompute);
+		for (uint32_t j = 1; j < dinfos.size(); j++)
+		{
+			builder.bind_buffer(j, dinfos[j], vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute);
+		}
+		DescriptorAllocation desc_allocation = builder.build();
+
+		frame_resources_[i].cull_set = desc_allocation.set;
+		cull_set_layout_             = desc_allocation.set_layout;
 	}
 }
 
 void Renderer::create_skybox_desc_resources()
 {
-	vk::DescriptorImageInfo background{
-	    .sampler     = baked_pbr_.p_irradiance->sampler.get_handle(),
-	    .imageView   = baked_pbr_.p_irradiance->resource.get_view().get_handle(),
-	    .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+	vk::DescriptorBufferInfo irradiance_sh{
+	    .buffer = baked_pbr_.p_irradiance_sh->get_handle(),
+	    .offset = 0,
+	    .range  = PBRBaker::IRRADIANCE_SH_SIZE,
 	};
 
-	for (uint32_t i = 0; i < NUM_INFLIGHT_FRAMES; i++)
+	for (uint32_t i = 0; i < settings_.frames_in_flight; i++)
 	{
 		DescriptorAllocation skybox_allocation =
 		    DescriptorBuilder::begin(p_descriptor_state_->cache, p_descriptor_state_->allocator)
-		        .bind_image(0, background, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eFragment)
+		        .bind_buffer(0, irradiance_sh, vk::DescriptorType::eUniformBuffer, vk::ShaderStageFlagBits::eFragment)
 		        .build();
 
 		frame_resources_[i].skybox_set                            = skybox_allocation.set;
@@ -779,104 +1766,118 @@ void Renderer::create_materials_desc_resources()
 	}
 }
 
-void Renderer::create_render_pass()
+void Renderer::create_frame_graph()
 {
-	std::array<vk::AttachmentDescription, 2> attachemnts;
-
-	attachemnts[0] = RenderPass::color_attachment(p_swapchain_->get_swapchain_properties().surface_format.format, vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR);
-	vk::AttachmentReference color_attachment_ref{
-	    .attachment = 0,
-	    .layout     = vk::ImageLayout::eColorAttachmentOptimal,
-	};
-
-	attachemnts[1] = RenderPass::depth_attachment(p_swapchain_->choose_depth_format(), vk::ImageLayout::eUndefined, vk::ImageLayout::eDepthStencilAttachmentOptimal);
-
-	vk::AttachmentReference depth_attachemnt_ref{
-	    .attachment = 1,
-	    .layout     = vk::ImageLayout::eDepthStencilAttachmentOptimal,
-	};
-
-	vk::SubpassDescription subpass{
-	    .pipelineBindPoint       = vk::PipelineBindPoint::eGraphics,
-	    .colorAttachmentCount    = 1,
-	    .pColorAttachments       = &color_attachment_ref,
-	    .pDepthStencilAttachment = &depth_attachemnt_ref,
-	};
-
-	vk::SubpassDependency dependency{
-	    .srcSubpass   = VK_SUBPASS_EXTERNAL,
-	    .dstSubpass   = 0,
-	    .srcStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput |
-	                    vk::PipelineStageFlagBits::eEarlyFragmentTests,
-	    .dstStageMask = vk::PipelineStageFlagBits::eColorAttachmentOutput |
-	                    vk::PipelineStageFlagBits::eEarlyFragmentTests,
-	    .srcAccessMask = {},
-	    .dstAccessMask = vk::AccessFlagBits::eColorAttachmentRead |
-	                     vk::AccessFlagBits::eColorAttachmentWrite |
-	                     vk::AccessFlagBits::eDepthStencilAttachmentWrite,
-	};
-
-	vk::RenderPassCreateInfo render_pass_cinfo{
-	    .attachmentCount = 2,
-	    .pAttachments    = attachemnts.data(),
-	    .subpassCount    = 1,
-	    .pSubpasses      = &subpass,
-	    .dependencyCount = 1,
-	    .pDependencies   = &dependency,
+	p_frame_graph_            = std::make_unique<RenderGraph>(*p_device_);
+	vk::Extent2D extent       = get_render_extent();
+	vk::Format   color_format = p_offscreen_target_ ? p_offscreen_target_->get_color_format() : p_swapchain_->get_swapchain_properties().surface_format.format;
+
+	// THE SWAPCHAIN'S IMAGE CAN ONLY BE DRAWN TO ONCE ITS ACQUIRE HAS BEEN WAITED FOR, AND IS
+	// PRESENTED AFTERWARDS. HEADLESS FRAMES ARE NEVER PRESENTED
+	backbuffer_ = p_frame_graph_->import_image("backbuffer", {.format = color_format, .extent = extent},
+	                                           p_offscreen_target_ ? vk::ImageLayout::eUndefined : vk::ImageLayout::ePresentSrcKHR,
+	                                           vk::ImageLayout::eUndefined, vk::PipelineStageFlagBits::eColorAttachmentOutput);
+	RenderGraph::ImageHandle depth = p_frame_graph_->create_image("depth", {.format = Swapchain::find_depth_format(*p_physical_device_), .extent = extent});
+
+	// THE DEPTH PREPASS AND THE SCENE END UP AS TWO SUBPASSES OF ONE RENDER PASS, THE DEPTH
+	// NEVER LEAVES IT SO IT NEEDN'T BE STORED, OR EVEN BE IN MEMORY ON TILED GPUS
+	vk::ClearValue color_clear{std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f}};
+	vk::ClearValue depth_clear;
+	depth_clear.depthStencil = vk::ClearDepthStencilValue{1.0f, 0};
+	auto execute             = [](std::vector<vk::CommandBuffer> &handles) {
+		// WITH NOTHING VISIBLE THE PREPASS RECORDS NO SECONDARY COMMAND BUFFERS, AND EXECUTING NONE ISN'T ALLOWED
+		return [&handles](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+			if (!handles.empty())
+			{
+				cmd_buf.get_handle().executeCommands(handles);
+			}
+		};
 	};
+	if (settings_.depth_prepass)
+	{
+		depth_prepass_pass_ = p_frame_graph_->add_pass("depth_prepass", RenderGraph::PassType::eGraphics, execute(prepass_handles_), vk::SubpassContents::eSecondaryCommandBuffers);
+		p_frame_graph_->write_depth(depth_prepass_pass_, depth, depth_clear);
+	}
+	scene_pass_ = p_frame_graph_->add_pass("scene", RenderGraph::PassType::eGraphics, execute(scene_handles_), vk::SubpassContents::eSecondaryCommandBuffers);
+	p_frame_graph_->write_color(scene_pass_, backbuffer_, color_clear);
+	p_frame_graph_->write_depth(scene_pass_, depth, settings_.depth_prepass ? std::nullopt : std::optional<vk::ClearValue>(depth_clear));
 
-	p_render_pass_ = std::make_unique<RenderPass>(*p_device_, render_pass_cinfo);
+	// HEADLESS FRAMES CAN BE COPIED BACK TO THE HOST, WHICH NO OTHER PASS USES
+	if (p_offscreen_target_ && settings_.readback)
+	{
+		RenderGraph::PassHandle readback = p_frame_graph_->add_pass("readback", RenderGraph::PassType::eTransfer, [this](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+			write_timestamp(cmd_buf, vk::PipelineStageFlagBits::eBottomOfPipe, eSkyboxEnd);
+			record_readback(cmd_buf, frame_idx_);
+		});
+		p_frame_graph_->read_image(readback, backbuffer_, RenderGraph::Access::eTransferSrc);
+		p_frame_graph_->set_side_effects(readback);
+	}
+	p_frame_graph_->compile();
 }
 
 void Renderer::create_pipeline_resources()
 {
-	std::array<vk::VertexInputBindingDescription, 1> binding_descriptions;
-	binding_descriptions[0] = vk::VertexInputBindingDescription{
-	    .binding   = 0,
-	    .stride    = sizeof(sg::Vertex),
-	    .inputRate = vk::VertexInputRate::eVertex,
-	};
+	W3D_PROFILE_SCOPE("Renderer::create_pipeline_resources");
+	RenderPass &scene_render_pass = p_frame_graph_->get_render_pass(scene_pass_);
+	uint32_t    scene_subpass     = p_frame_graph_->get_subpass(scene_pass_);
+
+	// THE PIPELINES ARE ONLY ADDED HERE AND ALL CREATED TOGETHER AT THE END, ON EVERY THREAD
+	// OF THE POOL. WHAT THEIR STATES POINT AT IS DECLARED OUT HERE SO IT LASTS UNTIL THEN
+	PipelineBuilder pl_builder(*p_device_);
+
+	// EVERY PIPELINE ONLY READS VERTICES, THE SCENE AND THE LIGHTS FIND THEIR INSTANCES IN
+	// THE STORAGE BUFFER OF THE FRAME SET INSTEAD
+	vk::VertexInputBindingDescription                binding_description          = sg::get_input_binding_description(sg::VertexFormat::eStatic);
+	std::vector<vk::VertexInputAttributeDescription> attr_descriptions            = sg::get_input_attr_descriptions(sg::VertexFormat::eStatic);
+	vk::VertexInputBindingDescription                position_binding_description = sg::get_position_binding_description();
+	vk::VertexInputAttributeDescription              position_attr_description    = sg::get_position_attr_description();
+
 	GraphicsPipelineState pl_state{
 	    .vert_shader_name   = "blinn_phong.vert.spv",
 	    .frag_shader_name   = "blinn_phong.frag.spv",
 	    .vertex_input_state = {
-	        .attribute_descriptions = sg::Vertex::get_input_attr_descriptions(),
-	        .binding_descriptions   = binding_descriptions,
+	        .attribute_descriptions = attr_descriptions,
+	        .binding_descriptions   = binding_description,
 	    },
 	};
 
-	vk::PushConstantRange blinn_phong_push_const_range{
-	    .stageFlags = vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
-	    .offset     = 0,
-	    .size       = sizeof(BlinnPhongPCO),
-	};
-
 	vk::PipelineLayoutCreateInfo blinn_phong_pl_layout_cinfo{
-	    .setLayoutCount         = 2,
-	    .pSetLayouts            = blinn_phong_.desc_layout_ring.data(),
-	    .pushConstantRangeCount = 1,
-	    .pPushConstantRanges    = &blinn_phong_push_const_range,
+	    .setLayoutCount = 2,
+	    .pSetLayouts    = blinn_phong_.desc_layout_ring.data(),
 	};
 
-	blinn_phong_.p_pl = std::make_unique<GraphicsPipeline>(*p_device_, *p_render_pass_, pl_state, blinn_phong_pl_layout_cinfo);
+	// AFTER A DEPTH PREPASS THE SCENE IS ONLY SHADED WHERE ITS DEPTH IS EXACTLY WHAT'S ALREADY
+	// THERE, WHICH IS ONLY ITS NEAREST SURFACE
+	if (settings_.depth_prepass)
+	{
+		pl_state.depth_stencil_state.depth_compare_op   = vk::CompareOp::eEqual;
+		pl_state.depth_stencil_state.depth_write_enable = false;
+	}
 
-	pl_state.vert_shader_name = "lights.vert.spv";
-	pl_state.frag_shader_name = "lights.frag.spv";
+	pl_builder.add_graphics_pipeline(blinn_phong_.p_pl, scene_render_pass, pl_state, blinn_phong_pl_layout_cinfo, scene_subpass);
 
-	vk::PushConstantRange light_push_const_range{
-	    .stageFlags = vk::ShaderStageFlagBits::eVertex,
-	    .offset     = 0,
-	    .size       = sizeof(glm::mat4),
-	};
+	// THE SKINNED VARIANT ONLY READS ITS VERTICES WITH A WIDER STRIDE FOR NOW, THE SHADERS DON'T
+	// USE THE JOINTS AND WEIGHTS YET
+	vk::VertexInputBindingDescription                skinned_binding_description = sg::get_input_binding_description(sg::VertexFormat::eSkinned);
+	std::vector<vk::VertexInputAttributeDescription> skinned_attr_descriptions   = sg::get_input_attr_descriptions(sg::VertexFormat::eSkinned);
+
+	pl_state.vertex_input_state.attribute_descriptions = skinned_attr_descriptions;
+	pl_state.vertex_input_state.binding_descriptions   = skinned_binding_description;
+	pl_builder.add_graphics_pipeline(blinn_phong_.p_skinned_pl, scene_render_pass, pl_state, blinn_phong_pl_layout_cinfo, scene_subpass);
+	pl_state.vertex_input_state.attribute_descriptions = attr_descriptions;
+	pl_state.vertex_input_state.binding_descriptions   = binding_description;
+
+	pl_state.vert_shader_name                       = "lights.vert.spv";
+	pl_state.frag_shader_name                       = "lights.frag.spv";
+	pl_state.depth_stencil_state.depth_compare_op   = vk::CompareOp::eLess;
+	pl_state.depth_stencil_state.depth_write_enable = true;
 
 	vk::PipelineLayoutCreateInfo light_pl_layout_cinfo{
-	    .setLayoutCount         = 1,
-	    .pSetLayouts            = light_.desc_layout_ring.data(),
-	    .pushConstantRangeCount = 1,
-	    .pPushConstantRanges    = &light_push_const_range,
+	    .setLayoutCount = 1,
+	    .pSetLayouts    = light_.desc_layout_ring.data(),
 	};
 
-	light_.p_pl = std::make_unique<GraphicsPipeline>(*p_device_, *p_render_pass_, pl_state, light_pl_layout_cinfo);
+	pl_builder.add_graphics_pipeline(light_.p_pl, scene_render_pass, pl_state, light_pl_layout_cinfo, scene_subpass);
 
 	vk::PushConstantRange skybox_push_const_range{
 	    .stageFlags = vk::ShaderStageFlagBits::eVertex,
@@ -889,12 +1890,55 @@ void Renderer::create_pipeline_resources()
 	    .pushConstantRangeCount = 1,
 	    .pPushConstantRanges    = &skybox_push_const_range,
 	};
+	// THE SKYBOX IS DRAWN LAST, ON THE FAR PLANE, SO IT'S ONLY SHADED WHERE THE DEPTH IS STILL
+	// WHAT IT WAS CLEARED TO
 	pl_state.vert_shader_name                       = "skybox.vert.spv";
 	pl_state.frag_shader_name                       = "skybox.frag.spv";
 	pl_state.rasterization_state.cull_mode          = vk::CullModeFlagBits::eFront;
-	pl_state.depth_stencil_state.depth_test_enable  = false;
+	pl_state.depth_stencil_state.depth_compare_op   = vk::CompareOp::eLessOrEqual;
 	pl_state.depth_stencil_state.depth_write_enable = false;
-	skybox_.p_pl                                    = std::make_unique<GraphicsPipeline>(*p_device_, *p_render_pass_, pl_state, skybox_pl_layout_cinfo);
+	pl_builder.add_graphics_pipeline(skybox_.p_pl, scene_render_pass, pl_state, skybox_pl_layout_cinfo, scene_subpass);
+
+	// THE DEPTH PREPASS ONLY READS POSITIONS AND ONLY WRITES DEPTH, SO IT HAS NO FRAGMENT
+	// SHADER. ITS ONE PIPELINE DRAWS EVERY VERTEX FORMAT, THE POSITION BUFFERS ALL LOOK ALIKE
+	if (settings_.depth_prepass)
+	{
+		vk::PipelineLayoutCreateInfo depth_prepass_pl_layout_cinfo{
+		    .setLayoutCount = 1,
+		    .pSetLayouts    = depth_prepass_.desc_layout_ring.data(),
+		};
+		pl_state.vert_shader_name                              = "depth_prepass.vert.spv";
+		pl_state.frag_shader_name                              = nullptr;
+		pl_state.vertex_input_state.attribute_descriptions     = position_attr_description;
+		pl_state.vertex_input_state.binding_descriptions       = position_binding_description;
+		pl_state.rasterization_state.cull_mode                 = vk::CullModeFlagBits::eBack;
+		pl_state.depth_stencil_state.depth_compare_op          = vk::CompareOp::eLess;
+		pl_state.depth_stencil_state.depth_write_enable        = true;
+		pl_state.color_blend_attachment_state.color_write_mask = {};
+		depth_prepass_.is_position_only                        = true;
+		pl_builder.add_graphics_pipeline(depth_prepass_.p_pl, p_frame_graph_->get_render_pass(depth_prepass_pass_), pl_state, depth_prepass_pl_layout_cinfo, p_frame_graph_->get_subpass(depth_prepass_pass_));
+	}
+
+	// BOTH CULLING SHADERS SEE THE SAME SET AND PUSH CONSTANTS
+	vk::PushConstantRange cull_push_const_range{
+	    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+	    .offset     = 0,
+	    .size       = sizeof(CullPCO),
+	};
+	if (is_gpu_culling_)
+	{
+		vk::PipelineLayoutCreateInfo cull_pl_layout_cinfo{
+		    .setLayoutCount         = 1,
+		    .pSetLayouts            = &cull_set_layout_,
+		    .pushConstantRangeCount = 1,
+		    .pPushConstantRanges    = &cull_push_const_range,
+		};
+		pl_builder.add_compute_pipeline(p_cull_instances_pl_, "cull_instances.comp.spv", cull_pl_layout_cinfo);
+		pl_builder.add_compute_pipeline(p_build_draws_pl_, "build_draws.comp.spv", cull_pl_layout_cinfo);
+	}
+
+	// THE FIRST FRAME NEEDS EVERY ONE OF THEM, SO THIS IS WHERE WE WAIT FOR THEM
+	pl_builder.build(*p_thread_pool_);
 }
 
 }        // namespace W3D
@@ -1,13 +1,25 @@
 #pragma once
 
+#include <functional>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+#include "common/frame_stats.hpp"
 #include "common/timer.hpp"
 #include "common/vk_common.hpp"
 #include "command_buffer.hpp"
 #include "core/image_resource.hpp"
 #include "core/sampler.hpp"
+#include "device_memory/allocator.hpp"
 #include "device_memory/buffer.hpp"
 #include "pbr_baker.hpp"
+#include "query_pool.hpp"
+#include "render_graph.hpp"
+#include "scene_graph/bvh.hpp"
+#include "scene_graph/components/submesh.hpp"
 #include "sync_objects.hpp"
+#include "window.hpp"
 
 
 /*
@@ -46,44 +58,101 @@ class Instance;
 class PhysicalDevice;
 class Device;
 class Swapchain;
-class RenderPass;
-class SwapchainFramebuffer;
+class OffscreenTarget;
 class PipelineResource;
+class ComputePipeline;
+class ThreadPool;
 class Controller;
 
 struct DescriptorState;
 struct Event;
 
+/*
+* These settings are used when constructing a Renderer. By default the renderer opens a
+* window and presents to its swapchain, but it can also run headless, rendering into an
+* offscreen target, which lets it run on machines without a display or a GPU (like a
+* build farm using a software Vulkan driver).
+*/
+struct RendererSettings
+{
+	bool         headless          = false;                                 // RENDER OFFSCREEN, NO WINDOW OR SWAPCHAIN
+	bool         readback          = false;                                 // COPY EACH HEADLESS FRAME BACK TO THE HOST
+	uint32_t     max_frames        = 0;                                     // STOP AFTER THIS MANY FRAMES, 0 MEANS NEVER
+	vk::Extent2D extent            = {DEFAULT_WIDTH, DEFAULT_HEIGHT};       // SIZE OF THE HEADLESS FRAMES
+	double       fixed_delta_time  = 0.0;                                   // SECONDS TO ADVANCE THE SCENE EACH FRAME, 0 MEANS REAL TIME
+	uint32_t     record_threads    = 0;                                     // THREADS RECORDING COMMANDS, 0 MEANS ONE PER HARDWARE THREAD
+	bool         frustum_culling   = true;                                  // SKIP DRAWING OBJECTS THAT ARE OFF-SCREEN
+	bool         gpu_culling       = true;                                  // CULL AND BUILD THE SCENE'S DRAWS ON THE GPU, WHEN IT CAN
+	uint32_t     frames_in_flight  = 2;                                     // FRAMES THE CPU MAY RUN AHEAD OF THE GPU, 1 TO 4
+	uint32_t     swapchain_images  = 0;                                     // MINIMUM SWAPCHAIN IMAGES, 0 MEANS ONE MORE THAN THE DRIVER NEEDS
+	bool         optimize_meshes   = true;                                  // REORDER THE SCENE'S MESHES FOR THE VERTEX CACHE WHEN LOADING THEM
+	bool         mesh_lods         = true;                                  // DRAW COARSER LEVELS OF DETAIL OF MESHES FAR AWAY
+	bool         depth_prepass     = true;                                  // DRAW THE SCENE'S DEPTH FIRST SO EACH PIXEL IS ONLY SHADED ONCE
+	std::string  pipeline_cache    = "pipeline_cache.bin";                  // WHERE COMPILED PIPELINES ARE KEPT BETWEEN RUNS, EMPTY MEANS NOWHERE
+	std::string  bake_cache        = "bake_cache";                          // DIRECTORY THE BAKED LIGHTING IS KEPT IN BETWEEN RUNS, EMPTY MEANS NOWHERE
+	bool         cpu_bake          = false;                                 // BAKE THE LIGHTING ON THE CPU'S THREADS RATHER THAN ON THE GPU
+	uint32_t     prefilter_samples = PBRBaker::DEFAULT_PREFILTER_SAMPLES;   // SAMPLES PER TEXEL OF THE ROUGHEST REFLECTIONS, SMOOTHER ONES TAKE FEWER
+};
+
+/*
+* Called with the pixels of a frame once it has been read back from the GPU.
+*/
+using ReadbackCallback = std::function<void(const uint8_t *p_pixels, vk::Extent2D extent, vk::Format format)>;
+
+/*
+* Called at the end of every iteration of the main loop with how long that frame took.
+*/
+using FrameCallback = std::function<void(const FrameTimings &timings)>;
+
 class Renderer
 {
   private:
 
-	bool qKeyPressed;
-	bool rKeyPressed;
-	float timeElapsed;
+	bool qKeyPressed = false;
+	bool rKeyPressed = false;
+	float timeElapsed = 0.0f;
 
 	// LIGHTING PROPERTIES
-	static const uint32_t NUM_INFLIGHT_FRAMES;
+	static const uint32_t MIN_INFLIGHT_FRAMES;
+	static const uint32_t MAX_INFLIGHT_FRAMES;
 	static const uint32_t IRRADIANCE_DIMENSION;
+	static const uint32_t MIN_INSTANCE_CAPACITY;
+	static const uint32_t MIN_DRAWS_PER_CHUNK;        // FEWER DRAWS THAN THIS AREN'T WORTH ANOTHER THREAD
+	static const uint32_t CULL_GROUP_SIZE;            // THE local_size_x OF THE CULLING COMPUTE SHADERS
+	static const float    LOD_SCREEN_SIZE;            // HOW MUCH OF THE SCREEN'S HEIGHT A MESH FILLS WHEN IT SWITCHES TO LEVEL 1
+	static const float    LOD_HYSTERESIS;             // HOW FAR PAST A SWITCH A MESH MUST GET BEFORE ITS LEVEL CHANGES
 
 	// EVERYTHING NEEDED TO RENDER A FRAME
 	struct FrameResource
 	{
-		CommandBuffer     cmd_buf;
-		Buffer            blinn_phong_uni_buf;
-		Buffer            light_uni_buf;
-		Semaphore         image_avaliable_semaphore;
-		Semaphore         render_finished_semaphore;
-		Fence             in_flight_fence;
-		vk::DescriptorSet blinn_phong_set;
-		vk::DescriptorSet light_set;
-		vk::DescriptorSet skybox_set;
+		CommandBuffer           cmd_buf;
+		Semaphore               image_avaliable_semaphore;
+		Semaphore               render_finished_semaphore;
+		Fence                   in_flight_fence;
+		Buffer                  readback_buf;
+		bool                    is_readback_pending = false;
+		QueryPool               timestamp_pool;
+		uint64_t                timestamp_frame      = 0;
+		bool                    is_timestamp_pending = false;
+		vk::DescriptorSet       skybox_set;
+		vk::DescriptorSet       cull_set;                    // THE FRAME'S SLICES OF THE RINGS, FOR THE CULLING COMPUTE SHADERS
+		bool                    is_cull_pending = false;     // WHETHER ITS SLICE OF count_ring_ HAS COUNTS TO READ BACK
+
+		// ONE POOL AND SECONDARY COMMAND BUFFER FOR EACH PIECE OF THE PASS THAT CAN BE
+		// RECORDED AT THE SAME TIME, POOLS CAN'T BE USED BY TWO THREADS AT ONCE
+		std::vector<std::unique_ptr<CommandPool>> record_cmd_pools;
+		std::vector<CommandBuffer>                secondary_cmd_bufs;
 	};
 
+	// p_skinned_pl IS THE SAME PIPELINE READING sg::SkinnedVertex, ONLY THE SCENE NEEDS ONE.
+	// A PIPELINE THAT IS POSITION ONLY READS THE GEOMETRY ARENA'S POSITION BUFFERS INSTEAD OF
+	// ITS VERTEX BUFFERS, AND USES NO MATERIAL
 	struct PipelineResource
 	{
 		std::unique_ptr<GraphicsPipeline>      p_pl;
+		std::unique_ptr<GraphicsPipeline>      p_skinned_pl;
 		std::array<vk::DescriptorSetLayout, 4> desc_layout_ring;
+		bool                                   is_position_only = false;
 	};
 
 	enum DescriptorRingAccessor
@@ -92,17 +161,131 @@ class Renderer
 		eMaterial = 1,
 	};
 
+	// WHERE EACH GPU TIMESTAMP OF A FRAME GOES IN ITS QUERY POOL, IN THE ORDER THE PASS DRAWS
+	enum TimestampAccessor
+	{
+		eCullBegin       = 0,
+		eRenderPassBegin = 1,
+		eDepthPrepassEnd = 2,
+		eLightsEnd       = 3,
+		eSceneEnd        = 4,
+		eSkyboxEnd       = 5,
+		eTimestampCount  = 6,
+	};
+
+	// WHAT THE SHADERS NEED TO KNOW ABOUT THE WHOLE FRAME
 	struct UBO
 	{
-		glm::mat4 proj_view;
-		glm::vec4 lights[4];
+		glm::mat4             proj_view;
+		glm::vec4             lights[4];
+		glm::vec4             cam_pos;
+		int                   is_colliding;
+		alignas(16) glm::vec4 frustum_planes[6];
+	};
+
+	// A BUFFER SPLIT INTO A SLICE FOR EACH FRAME IN FLIGHT, EVERY FRAME ONLY EVER TOUCHES ITS
+	// OWN SLICE. allocate IS WHICH DeviceMemoryAllocator FUNCTION MAKES THE BUFFER
+	struct BufferRing
+	{
+		std::unique_ptr<Buffer> p_buf;
+		Buffer (DeviceMemoryAllocator::*allocate)(size_t) const = nullptr;
+		vk::DeviceSize element_size = 0;
+		vk::DeviceSize alignment    = 1;        // WHERE A SLICE MAY START, e.g. FOR DYNAMIC OFFSETS
+		vk::DeviceSize stride       = 0;        // BYTES FROM ONE FRAME'S SLICE TO THE NEXT
+		uint32_t       capacity     = 0;        // ELEMENTS ONE SLICE HOLDS
 	};
 
-	struct BlinnPhongPCO
+	// NODES THAT SHARE A MESH, THE VISIBLE ONES AT EACH LEVEL OF DETAIL ARE ALL DRAWN WITH ONE
+	// INSTANCED DRAW PER SUBMESH. THE GROUP'S RANGE HAS ROOM FOR ALL ITS NODES AT EVERY LEVEL,
+	// ONE AFTER ANOTHER, AND EVERY FRAME THE INSTANCES OF A LEVEL ARE PACKED AT ITS START
+	struct InstanceGroup
 	{
-		glm::mat4 model;
-		alignas(16) glm::vec3 cam_pos;
-		alignas(16) int is_colliding;
+		sg::Mesh                                   *p_mesh             = nullptr;
+		std::vector<sg::Node *>                     p_nodes;
+		uint32_t                                    first_instance     = 0;
+		uint32_t                                    visible_count      = 0;         // AT ALL LEVELS
+		uint32_t                                    lod_count          = 1;         // THE MOST ANY OF ITS SUBMESHES HAVE
+		uint32_t                                    first_slot         = 0;         // WHERE ITS LEVELS' INSTANCE COUNTS START, SEE CullPCO
+		std::array<uint32_t, sg::SubMesh::MAX_LODS> lod_visible_counts = {};          // WHEN CULLING ON THE CPU
+		float                                       nearest_depth      = 0.0f;        // VIEW DEPTH OF ITS NEAREST VISIBLE NODE, WHEN CULLING ON THE CPU
+	};
+
+	// ONE SUBMESH DRAW OF THE SCENE PASS, THE MATERIAL'S SET IS LOOKED UP WHEN THE DRAW LIST IS
+	// BUILT SO RECORDING DOESN'T HAVE TO CAST EVERY MATERIAL EVERY FRAME
+	struct DrawItem
+	{
+		sg::SubMesh      *p_submesh = nullptr;
+		vk::DescriptorSet material_set;
+		uint32_t          group_idx = 0;
+	};
+
+	// draw_items_ NEXT TO EACH OTHER THAT SHARE THEIR VERTEX FORMAT, INDEX TYPE AND MATERIAL, ALL
+	// GEOMETRY OF A FORMAT IS IN ONE OF THE ARENA'S BUFFERS SO NOTHING ELSE CHANGES BETWEEN
+	// THEM. WHEN CULLING ON THE GPU EACH BATCH IS ONE drawIndexedIndirectCount, OF UP TO ONE
+	// INDIRECT DRAW FOR EVERY LEVEL OF DETAIL OF ITS DRAWS
+	struct DrawBatch
+	{
+		uint32_t first_draw = 0;
+		uint32_t draw_count = 0;
+		uint32_t first_cmd  = 0;        // WHERE ITS gpu_draws_, AND INDIRECT DRAWS, START
+		uint32_t cmd_count  = 0;
+	};
+
+	// A NODE WITH A MESH, AS THE BVH KNOWS IT
+	struct DrawNode
+	{
+		sg::Node *p_node         = nullptr;
+		uint32_t  group_idx      = 0;
+		uint32_t  proxy          = 0;        // THE NODE'S LEAF IN bvh_
+		uint64_t  world_revision = 0;        // THE TRANSFORM REVISION ITS LEAF AND OBJECT WERE LAST UPDATED FOR
+		uint32_t  lod            = 0;        // THE LEVEL OF DETAIL IT WAS LAST DRAWN AT, SEE update_lods
+	};
+
+	// A NODE WITH A MESH AS cull_instances.comp SEES IT, THE OBJECT TABLE HAS ONE FOR EVERY
+	// DrawNode AND THE CPU CULLING COPIES ITS INSTANCE FROM THERE TOO. ITS LEVEL OF DETAIL IS
+	// PICKED ON THE CPU, WHICH REMEMBERS THE LAST ONE, BEFORE THE TABLE IS UPLOADED
+	struct GpuObject
+	{
+		sg::Instance instance;
+		glm::vec4    bounds_min;        // WORLD SPACE, w IS UNUSED
+		glm::vec4    bounds_max;
+		uint32_t     first_slot;        // ITS GROUP'S first_slot
+		uint32_t     first_instance;    // WHERE ITS GROUP STARTS IN THE INSTANCES
+		uint32_t     lod;
+		uint32_t     lod_stride;        // INSTANCES FROM ONE OF ITS GROUP'S LEVELS TO THE NEXT
+	};
+
+	// ONE LEVEL OF DETAIL OF A DrawItem AS build_draws.comp SEES IT
+	struct GpuDraw
+	{
+		uint32_t idx_count;
+		uint32_t first_index;
+		int32_t  vertex_offset;
+		uint32_t slot_idx;              // WHICH INSTANCE COUNT IT DRAWS
+		uint32_t batch_idx;
+		uint32_t first_cmd;             // WHERE ITS BATCH STARTS IN THE INDIRECT DRAWS
+		uint32_t first_instance;
+	};
+
+	// WHAT THE CULLING COMPUTE SHADERS ARE TOLD, count_ring_ HOLDS THE BATCHES' DRAW COUNTS
+	// FIRST AND THEN THE INSTANCE COUNTS OF EVERY GROUP'S LEVELS OF DETAIL
+	struct CullPCO
+	{
+		uint32_t object_count;
+		uint32_t draw_count;
+		uint32_t group_counts_offset;
+		uint32_t is_culling;
+	};
+
+	// WHAT IS BOUND TO THE COMMAND BUFFER BEING RECORDED, SO BINDING IT AGAIN CAN BE SKIPPED
+	struct BoundState
+	{
+		vk::Pipeline      pipeline;
+		vk::DescriptorSet material_set;
+		vk::Buffer        vertex_buf;
+		vk::Buffer        idx_buf;
+		vk::IndexType     idx_type         = vk::IndexType::eUint32;
+		bool              is_position_only = false;        // WHETHER THE PIPELINE READS THE POSITION BUFFERS
 	};
 
 	struct SkyboxPCO
@@ -117,29 +300,82 @@ class Renderer
 	std::unique_ptr<PhysicalDevice>       p_physical_device_;
 	std::unique_ptr<Device>               p_device_;
 	std::unique_ptr<Swapchain>            p_swapchain_;
-	std::unique_ptr<RenderPass>           p_render_pass_;
-	std::unique_ptr<SwapchainFramebuffer> p_sframe_buffer_;
+	std::unique_ptr<OffscreenTarget>      p_offscreen_target_;
+	std::unique_ptr<RenderGraph>          p_frame_graph_;
 	std::unique_ptr<DescriptorState>      p_descriptor_state_;
 	std::unique_ptr<CommandPool>          p_cmd_pool_;
 	std::unique_ptr<sg::Scene>            p_scene_;
 	sg::Node                             *p_camera_node_ = nullptr;
 	std::unique_ptr<Controller>           p_controller_;
 
+	RendererSettings           settings_;
+	ReadbackCallback           readback_callback_;
+	FrameCallback              frame_callback_;
+	FrameTimings               frame_timings_;
 	Timer                      timer_;
-	uint32_t                   frame_idx_ = 0;
+	uint32_t                   frame_idx_   = 0;
+	uint64_t                   frame_count_ = 0;
 	std::vector<FrameResource> frame_resources_;
+	std::vector<sg::Instance>  instances_;
+	std::vector<InstanceGroup> instance_groups_;
+	std::vector<DrawItem>      draw_items_;
+	std::vector<DrawNode>      draw_nodes_;
+	std::vector<uint32_t>      visible_proxies_;
+	sg::BVH                    bvh_;
+	std::vector<uint32_t>      visible_draws_;        // draw_items_ THAT HAVE VISIBLE INSTANCES THIS FRAME
+	std::vector<uint32_t>      nearest_draws_;        // THE SAME, NEAREST FIRST
+	std::vector<GpuObject>     object_table_;         // ONE FOR EACH OF draw_nodes_
+	std::vector<GpuDraw>       gpu_draws_;            // ONE FOR EACH LEVEL OF DETAIL OF EACH OF draw_items_
+	std::vector<DrawBatch>     draw_batches_;
 	PipelineResource           skybox_;
 	PipelineResource           blinn_phong_;
 	PipelineResource           light_;
+	PipelineResource           depth_prepass_;
 	PBR                        baked_pbr_;
 	bool                       is_window_resized_ = false;
+	uint32_t                   visible_lights_    = 0;
+	uint32_t                   lod_slot_count_    = 0;          // INSTANCE COUNTS ALL THE GROUPS' LEVELS OF DETAIL TAKE, SEE CullPCO
+	double                     timestamp_period_  = 0.0;        // NANOSECONDS PER TIMESTAMP TICK, 0 IF UNSUPPORTED
+	uint64_t                   timestamp_mask_    = 0;          // THE BITS OF A TIMESTAMP THAT ARE VALID
+
+	std::unordered_map<sg::Mesh *, size_t>  instance_group_lookup_;                                            // WHERE EACH MESH'S GROUP IS IN instance_groups_
+	std::vector<std::pair<float, uint32_t>> visible_nodes_;                                                    // VIEW DEPTH AND draw_nodes_ INDEX OF THE NODES DRAWN
+	uint64_t                                draw_list_revision_ = std::numeric_limits<uint64_t>::max();        // THE SCENE GRAPH REVISION draw_items_ WAS BUILT FROM
+	std::unique_ptr<ThreadPool>             p_thread_pool_;                                                    // RECORDS THE PASS ON SEVERAL THREADS
+	std::vector<vk::CommandBuffer>          prepass_handles_;                                                  // WHAT THE DEPTH PREPASS EXECUTES
+	std::vector<vk::CommandBuffer>          scene_handles_;                                                    // WHAT THE SCENE PASS EXECUTES
+
+	// THE FRAME IS A RENDER GRAPH THAT DRAWS TO ITS BACKBUFFER, THE SWAPCHAIN IMAGE OR THE
+	// OFFSCREEN TARGET'S COLOR IMAGE, WHICH IS SET EVERY FRAME
+	RenderGraph::ImageHandle backbuffer_;
+	RenderGraph::PassHandle  depth_prepass_pass_;
+	RenderGraph::PassHandle  scene_pass_;
+
+	// THE SCENE AND LIGHT SHADERS PICK THE FRAME'S SLICES OF THE FIRST TWO RINGS WITH DYNAMIC
+	// OFFSETS, SO THE ONE frame_set_ SERVES ALL THE FRAMES AND ALL THE OBJECTS IN THEM. THE
+	// OTHERS ARE ONLY USED WHEN CULLING ON THE GPU
+	BufferRing        ubo_ring_;
+	BufferRing        instance_ring_;
+	BufferRing        object_ring_;          // object_table_
+	BufferRing        draw_ring_;            // gpu_draws_
+	BufferRing        indirect_ring_;        // THE DRAWS build_draws.comp WRITES
+	BufferRing        count_ring_;           // SEE CullPCO
+	vk::DescriptorSet frame_set_;
+
+	// CULLING ON THE GPU
+	bool                             is_gpu_culling_ = false;
+	std::unique_ptr<ComputePipeline> p_cull_instances_pl_;
+	std::unique_ptr<ComputePipeline> p_build_draws_pl_;
+	vk::DescriptorSetLayout          cull_set_layout_;
+	uint32_t                         gpu_visible_nodes_ = 0;        // WHAT THE LAST FRAME READ BACK FOUND VISIBLE
 
   public:
 	/*
 	 * This constructor initializes everything needed for rendering and running the demo
-	 * including Vulkan as well as our scene.
+	 * including Vulkan as well as our scene. When settings ask for headless rendering no
+	 * window or swapchain is made, we render into an offscreen target instead.
 	 */
-	Renderer();
+	Renderer(const RendererSettings &settings = {});
 
 	/*
 	* The destructor has nothing to clean up.
@@ -159,15 +395,22 @@ class Renderer
 	 */
 	void main_loop();
 
+	/*
+	* Tests whether the main loop should keep going, which it does until the window is
+	* closed or, if a frame limit was set, until that many frames have been rendered.
+	*/
+	bool is_running();
+
 	/*
 	* This responds to event input, which it forwards to the appropriate scene scripts.
 	*/
 	void process_event(const Event &event);
 
 	/*
-	* Called once per frame, it updates all scene objects.
+	* Called once per frame, it updates all scene objects, advancing them by delta_time
+	* seconds.
 	*/
-	void update();
+	void update(double delta_time);
 
 	/*
 	* Called once per frame, it is the source of all scene rendering, note it 
@@ -179,19 +422,59 @@ class Renderer
 	void     sync_submit_commands();
 	void     sync_present(uint32_t img_idx);
 	void     record_draw_commands(uint32_t img_idx);
+	void     record_readback(CommandBuffer &cmd_buf, uint32_t img_idx);
+	void     deliver_readback(FrameResource &frame);
+	void     flush_readbacks();
+	void     write_timestamp(CommandBuffer &cmd_buf, vk::PipelineStageFlagBits stage, TimestampAccessor query);
+	void     resolve_gpu_timings(FrameResource &frame);
+
+	/*
+	* Sets the function that receives each frame read back from the GPU, note frames are
+	* only read back when rendering headless with readback turned on in the settings.
+	*/
+	void set_readback_callback(ReadbackCallback callback);
+
+	/*
+	* Sets the function that is told how long each frame took, which is how the benchmark
+	* records its timings.
+	*/
+	void set_frame_callback(FrameCallback callback);
+
+	/*
+	* Accessor method for getting the timings of the most recently completed frame.
+	*/
+	const FrameTimings &get_last_frame_timings() const;
+
+	/*
+	* Tests whether the GPU can time the passes of a frame, if it can't the gpu_ times of
+	* the frame timings stay 0.
+	*/
+	bool has_gpu_timings() const;
 
 	void update_frame_ubo();
+	void rebuild_draw_list();
+	void update_spatial_index();
+	void update_lods();
+	void gather_instances();
+	void gather_visible_draws();
+	void update_frame_instances();
+	void begin_secondary(CommandBuffer &cmd_buf, const RenderGraph::PassContext &context);
 	void set_dynamic_states(CommandBuffer &cmd_buf);
-	void begin_render_pass(CommandBuffer &cmd_buf, vk::Framebuffer framebuffer);
-	void draw_skybox(CommandBuffer &cmd_buf);
-	void draw_lights(CommandBuffer &cmd_buf);
-	void draw_scene(CommandBuffer &cmd_buf);
-	void draw_submesh(CommandBuffer &cmd_buf, sg::SubMesh &submesh);
-	void bind_material(CommandBuffer &cmd_buf, const sg::PBRMaterial &material);
-	void push_node_model_matrix(CommandBuffer &cmd_buf, sg::Node *p_node);
+	void draw_skybox(CommandBuffer &cmd_buf, BoundState &bound);
+	void draw_lights(CommandBuffer &cmd_buf, BoundState &bound);
+	void draw_scene(CommandBuffer &cmd_buf, BoundState &bound, const PipelineResource &pipeline, const std::vector<uint32_t> &draws, size_t first_draw, size_t last_draw);
+	void draw_scene_indirect(CommandBuffer &cmd_buf, BoundState &bound, const PipelineResource &pipeline, size_t first_batch, size_t last_batch);
+	void record_gpu_culling(CommandBuffer &cmd_buf);
+	void resolve_gpu_culling(FrameResource &frame);
+	void draw_submesh(CommandBuffer &cmd_buf, BoundState &bound, sg::SubMesh &submesh, uint32_t instance_count = 1, uint32_t first_instance = 0, uint32_t lod = 0);
+	void bind_pipeline(CommandBuffer &cmd_buf, BoundState &bound, const PipelineResource &pipeline, sg::VertexFormat vertex_format = sg::VertexFormat::eStatic);
+	void bind_material(CommandBuffer &cmd_buf, BoundState &bound, vk::DescriptorSet material_set);
+	void bind_geometry(CommandBuffer &cmd_buf, BoundState &bound, const sg::SubMesh &submesh);
+	void bind_frame_set(CommandBuffer &cmd_buf, const PipelineResource &pipeline);
 
 	void           resize();
 	FrameResource &get_current_frame_resource();
+	vk::Extent2D   get_render_extent() const;
 
 	void load_scene(const char *scene_name);
 	void create_controller();
@@ -199,10 +482,15 @@ class Renderer
 	void create_frame_resources();
 	void create_descriptor_resources();
 	void create_skybox_desc_resources();
-	void create_blinn_phong_desc_resources();
-	void create_light_desc_resources();
+	void create_ring(BufferRing &ring, Buffer (DeviceMemoryAllocator::*allocate)(size_t) const, vk::DeviceSize element_size, vk::DeviceSize alignment, uint32_t capacity);
+	bool reserve_ring(BufferRing &ring, uint32_t count);
+	void reserve_rings();
+	void write_ring_descriptors();
+	vk::DescriptorBufferInfo get_slice_dinfo(const BufferRing &ring, uint32_t frame_idx) const;
+	void create_frame_desc_resources();
+	void create_cull_desc_resources();
 	void create_materials_desc_resources();
-	void create_render_pass();
+	void create_frame_graph();
 	void create_pipeline_resources();
 
 	sg::Node &add_player_script(const char *node_name);
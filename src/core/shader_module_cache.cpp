@@ -0,0 +1,58 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "shader_module_cache.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <vector>
+
+// OUR OWN TYPES
+#include "common/file_utils.hpp"
+#include "common/utils.hpp"
+#include "device.hpp"
+
+namespace W3D
+{
+
+ShaderModuleCache::ShaderModuleCache(Device &device) :
+    device_(device)
+{
+}
+
+ShaderModuleCache::~ShaderModuleCache()
+{
+	for (auto &[name, shader_module] : shader_modules_)
+	{
+		device_.get_handle().destroyShaderModule(shader_module);
+	}
+}
+
+vk::ShaderModule ShaderModuleCache::get_shader_module(const std::string &name)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto                        it = shader_modules_.find(name);
+		if (it != shader_modules_.end())
+		{
+			return it->second;
+		}
+	}
+
+	// LOAD ALL BYTES FROM THE SHADER FILE, WHICH SHOULD BE COMPILED BYTECODE. THIS IS DONE
+	// WITHOUT THE LOCK SO OTHER THREADS CAN LOAD OTHER SHADERS MEANWHILE
+	std::vector<uint8_t>       binary = fu::read_shader_binary(name);
+	vk::ShaderModuleCreateInfo shader_module_cinfo{
+	    .codeSize = to_u32(binary.size()),
+	    .pCode    = reinterpret_cast<const uint32_t *>(binary.data()),
+	};
+	vk::ShaderModule shader_module = device_.get_handle().createShaderModule(shader_module_cinfo);
+
+	// IF ANOTHER THREAD LOADED THE SAME SHADER FIRST, WE USE ITS MODULE AND THROW OURS AWAY
+	std::lock_guard<std::mutex> lock(mutex_);
+	auto [it, is_inserted] = shader_modules_.try_emplace(name, shader_module);
+	if (!is_inserted)
+	{
+		device_.get_handle().destroyShaderModule(shader_module);
+	}
+	return it->second;
+}
+
+}        // namespace W3D
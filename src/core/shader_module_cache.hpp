@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "common/vk_common.hpp"
+
+namespace W3D
+{
+class Device;
+
+/*
+* ShaderModuleCache - the shader modules of a device, keyed by the name of the compiled
+* shader they were made from, so each .spv file is only read and turned into a module
+* once however many pipelines use it. Modules are kept until the cache is destroyed. Note
+* pipelines are built on several threads at once, so getting a module is thread safe.
+*/
+class ShaderModuleCache
+{
+  private:
+	Device                                            &device_;
+	std::mutex                                         mutex_;
+	std::unordered_map<std::string, vk::ShaderModule> shader_modules_;
+
+  public:
+	/*
+	* The constructor makes an empty cache, modules are made the first time they're asked for.
+	*/
+	ShaderModuleCache(Device &device);
+
+	/*
+	* The destructor destroys every module, no pipeline may still be being created.
+	*/
+	~ShaderModuleCache();
+
+	// THESE ARE DEACTIVATED
+	ShaderModuleCache(const ShaderModuleCache &)            = delete;
+	ShaderModuleCache &operator=(const ShaderModuleCache &) = delete;
+
+	/*
+	* Gets the module of the compiled shader named name, loading it if this is the first time.
+	*/
+	vk::ShaderModule get_shader_module(const std::string &name);
+};
+
+}        // namespace W3D
@@ -1,19 +1,22 @@
 // IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
 #include "swapchain.hpp"
 
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+
 // OUR OWN TYPES
-#include "core/device_memory/image.hpp"
+#include "common/logging.hpp"
 #include "core/instance.hpp"
 #include "device.hpp"
-#include "image_resource.hpp"
 #include "image_view.hpp"
 #include "physical_device.hpp"
 
 namespace W3D
 {
 
-Swapchain::Swapchain(Device &device, vk::Extent2D window_extent) :
-    device_(device)
+Swapchain::Swapchain(Device &device, vk::Extent2D window_extent, uint32_t requested_image_count) :
+    device_(device),
+    requested_image_count_(requested_image_count)
 {
 	build(window_extent);
 }
@@ -25,7 +28,6 @@ Swapchain::~Swapchain()
 
 void Swapchain::cleanup()
 {
-	p_depth_resource_.reset();
 	frame_image_views_.clear();
 	device_.get_handle().destroySwapchainKHR(handle_);
 }
@@ -70,6 +72,10 @@ void Swapchain::build(vk::Extent2D window_extent)
 
 	handle_ = device_.get_handle().createSwapchainKHR(swapchain_cinfo);
 	create_frame_resources();
+	if (requested_image_count_ > 0)
+	{
+		LOGI("Asked for at least {} swapchain images, got {}", requested_image_count_, frame_images_.size());
+	}
 }
 
 void Swapchain::create_frame_resources()
@@ -93,36 +99,19 @@ void Swapchain::create_frame_resources()
 		swapchain_image_view_cinfo.image = image;
 		frame_image_views_.emplace_back(ImageView(device_, swapchain_image_view_cinfo));
 	}
-
-	vk::ImageCreateInfo depth_image_cinfo{
-
-	    .imageType = vk::ImageType::e2D,
-	    .format    = choose_depth_format(),
-	    .extent    = vk::Extent3D{
-	           .width  = properties_.extent.width,
-	           .height = properties_.extent.height,
-	           .depth  = 1,
-        },
-	    .mipLevels     = 1,
-	    .arrayLayers   = 1,
-	    .samples       = vk::SampleCountFlagBits::e1,
-	    .tiling        = vk::ImageTiling::eOptimal,
-	    .usage         = vk::ImageUsageFlagBits::eDepthStencilAttachment,
-	    .sharingMode   = vk::SharingMode::eExclusive,
-	    .initialLayout = vk::ImageLayout::eUndefined,
-	};
-	Image img = device_.get_device_memory_allocator().allocate_device_only_image(depth_image_cinfo);
-
-	vk::ImageViewCreateInfo depth_image_view_cinfo = ImageView::two_dim_view_cinfo(img.get_handle(), depth_image_cinfo.format, vk::ImageAspectFlagBits::eDepth, 1);
-	p_depth_resource_                              = std::make_unique<ImageResource>(std::move(img), ImageView(device_, depth_image_view_cinfo));
 }
 
 vk::Format Swapchain::choose_depth_format()
+{
+	return find_depth_format(device_.get_physical_device());
+}
+
+vk::Format Swapchain::find_depth_format(const PhysicalDevice &physical_device)
 {
 	std::array<vk::Format, 3> candidate_formats = {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint};
 	for (vk::Format candidate : candidate_formats)
 	{
-		vk::FormatProperties candidate_properties = device_.get_physical_device().get_handle().getFormatProperties(candidate);
+		vk::FormatProperties candidate_properties = physical_device.get_handle().getFormatProperties(candidate);
 		if (candidate_properties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eDepthStencilAttachment)
 		{
 			return candidate;
@@ -171,9 +160,10 @@ void Swapchain::choose_extent(const vk::SurfaceCapabilitiesKHR &capabilities, vk
 	};
 }
 
-uint32_t Swapchain::calc_min_image_count(uint32_t min_image_count, uint32_t max_image_count)
+uint32_t Swapchain::calc_min_image_count(uint32_t min_image_count, uint32_t max_image_count) const
 {
-	uint32_t image_count = min_image_count + 1;
+	// ONE MORE THAN THE DRIVER NEEDS, UNLESS WE WERE ASKED FOR A COUNT, e.g. 3 FOR TRIPLE BUFFERING
+	uint32_t image_count = requested_image_count_ > 0 ? std::max(requested_image_count_, min_image_count) : min_image_count + 1;
 	// max_image_count == 0 means there is no limit
 	if (max_image_count > 0 && image_count > max_image_count)
 	{
@@ -192,9 +182,9 @@ const std::vector<ImageView> &Swapchain::get_frame_image_views() const
 	return frame_image_views_;
 }
 
-const ImageResource &Swapchain::get_depth_resource() const
+const std::vector<vk::Image> &Swapchain::get_frame_images() const
 {
-	return *p_depth_resource_;
+	return frame_images_;
 }
 
 // Swapchain::Swapchain(Instance* pInstance, Device* pDevice, Window* pWindow,
@@ -9,7 +9,7 @@ namespace W3D
 class Device;
 class Instance;
 class ImageView;
-class ImageResource;
+class PhysicalDevice;
 
 struct SwapchainProperties
 {
@@ -21,7 +21,9 @@ struct SwapchainProperties
 class Swapchain : public VulkanObject<vk::SwapchainKHR>
 {
   public:
-	Swapchain(Device &device, vk::Extent2D window_extent);
+	static vk::Format find_depth_format(const PhysicalDevice &physical_device);
+
+	Swapchain(Device &device, vk::Extent2D window_extent, uint32_t requested_image_count = 0);
 	~Swapchain() override;
 
 	void       cleanup();
@@ -30,22 +32,22 @@ class Swapchain : public VulkanObject<vk::SwapchainKHR>
 	vk::Format choose_depth_format();
 
 	const SwapchainProperties    &get_swapchain_properties() const;
+	const std::vector<vk::Image> &get_frame_images() const;
 	const std::vector<ImageView> &get_frame_image_views() const;
-	const ImageResource          &get_depth_resource() const;
 
   private:
 	void     choose_features();
 	void     choose_format(const std::vector<vk::SurfaceFormatKHR> &formats);
 	void     choose_present_mode(const std::vector<vk::PresentModeKHR> &present_modes);
 	void     choose_extent(const vk::SurfaceCapabilitiesKHR &capabilities, vk::Extent2D window_extent);
-	uint32_t calc_min_image_count(uint32_t min_image_count, uint32_t max_image_count);
+	uint32_t calc_min_image_count(uint32_t min_image_count, uint32_t max_image_count) const;
 
 	void create_frame_resources();
 
 	Device                        &device_;
+	uint32_t                       requested_image_count_;        // 0 MEANS LET calc_min_image_count DECIDE
 	SwapchainProperties            properties_;
 	std::vector<vk::Image>         frame_images_;        // Special images owned by vulkan
 	std::vector<ImageView>         frame_image_views_;
-	std::unique_ptr<ImageResource> p_depth_resource_;
 };
 }        // namespace W3D
\ No newline at end of file
@@ -0,0 +1,518 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "cpu_baker.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+// OUR OWN TYPES
+#include "common/logging.hpp"
+#include "common/thread_pool.hpp"
+
+namespace W3D
+{
+
+const uint32_t CPUBaker::VERSION          = 2;
+const uint32_t CPUBaker::BRDF_LUT_SAMPLES = 1024;        // brdf_lut.frag's NUM_SAMPLES
+
+// HOW MANY TEXELS OR SAMPLES EACH LOOP WORKS ON AT ONCE, SO WHAT THEY SHARE IS ONLY WORKED OUT ONCE
+static const uint32_t LANES = 8;
+
+// THE FIRST THREE BANDS OF SPHERICAL HARMONICS, AND HOW CONVOLVING WITH THE CLAMPED COSINE
+// SCALES EACH OF THEM OVER PI, AS IN irradiance_sh_reduce.comp
+static const uint32_t SH_COUNT         = 9;
+static const float    SH_BAND_SCALES[] = {1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f};
+static const float    PI               = 3.1415926536f;
+
+// THE SHADERS' random, GLSL'S mod AND fract FLOOR RATHER THAN TRUNCATE
+static float random(float x, float y)
+{
+	float dt = x * 12.9898f + y * 78.233f;
+	float sn = dt - 3.14f * std::floor(dt / 3.14f);
+	float r  = std::sin(sn) * 43758.5453f;
+	return r - std::floor(r);
+}
+
+static glm::vec2 hammersley2d(uint32_t i, uint32_t n)
+{
+	uint32_t bits = (i << 16u) | (i >> 16u);
+	bits          = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+	bits          = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+	bits          = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+	bits          = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+	return glm::vec2(static_cast<float>(i) / static_cast<float>(n), static_cast<float>(bits) * 2.3283064365386963e-10f);
+}
+
+// THE SHADERS' importance_sample_GGX, FOR ONE NORMAL
+static glm::vec3 importance_sample_ggx(glm::vec2 xi, float roughness, const glm::vec3 &normal)
+{
+	float     a         = roughness * roughness;
+	float     phi       = 2.0f * PI * xi.x + random(normal.x, normal.z) * 0.1f;
+	float     cos_theta = std::sqrt((1.0f - xi.y) / (1.0f + (a * a - 1.0f) * xi.y));
+	float     sin_theta = std::sqrt(1.0f - cos_theta * cos_theta);
+	glm::vec3 h(sin_theta * std::cos(phi), sin_theta * std::sin(phi), cos_theta);
+
+	glm::vec3 up        = std::abs(normal.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+	glm::vec3 tangent_x = glm::normalize(glm::cross(up, normal));
+	glm::vec3 tangent_y = glm::normalize(glm::cross(normal, tangent_x));
+	return glm::normalize(tangent_x * h.x + tangent_y * h.y + normal * h.z);
+}
+
+// THE DIRECTION A CUBE'S FACE LOOKS UP AT s AND t, WHICH GO FROM -1 TO 1 ACROSS IT, AS IN
+// irradiance_sh.comp
+static glm::vec3 get_face_direction(uint32_t face, float s, float t)
+{
+	switch (face)
+	{
+		case 0:
+			return glm::vec3(1.0f, -t, -s);
+		case 1:
+			return glm::vec3(-1.0f, -t, s);
+		case 2:
+			return glm::vec3(s, 1.0f, t);
+		case 3:
+			return glm::vec3(s, -1.0f, -t);
+		case 4:
+			return glm::vec3(s, -t, 1.0f);
+		default:
+			return glm::vec3(-s, -t, -1.0f);
+	}
+}
+
+// WHICH FACE direction LOOKS AT AND WHERE ON IT, u AND v GOING FROM 0 TO 1, THE OTHER WAY
+// AROUND FROM get_face_direction
+static uint32_t get_face_coords(const glm::vec3 &direction, float &u, float &v)
+{
+	glm::vec3 a = glm::abs(direction);
+	uint32_t  face;
+	float     major, s, t;
+	if (a.x >= a.y && a.x >= a.z)
+	{
+		face  = direction.x >= 0.0f ? 0 : 1;
+		major = a.x;
+		s     = direction.x >= 0.0f ? -direction.z : direction.z;
+		t     = -direction.y;
+	}
+	else if (a.y >= a.z)
+	{
+		face  = direction.y >= 0.0f ? 2 : 3;
+		major = a.y;
+		s     = direction.x;
+		t     = direction.y >= 0.0f ? direction.z : -direction.z;
+	}
+	else
+	{
+		face  = direction.z >= 0.0f ? 4 : 5;
+		major = a.z;
+		s     = direction.z >= 0.0f ? direction.x : -direction.x;
+		t     = -direction.y;
+	}
+	u = 0.5f * (s / major + 1.0f);
+	v = 0.5f * (t / major + 1.0f);
+	return face;
+}
+
+static float d_ggx(float dot_nh, float roughness)
+{
+	float alpha2 = roughness * roughness * roughness * roughness;
+	float denom  = dot_nh * dot_nh * (alpha2 - 1.0f) + 1.0f;
+	return alpha2 / (PI * denom * denom);
+}
+
+static void require_format(const ImageMetaInfo &meta, vk::Format format, const char *name)
+{
+	if (meta.format != format)
+	{
+		LOGE("The CPU can only bake the {} as {}", name, vk::to_string(format));
+		abort();
+	}
+}
+
+CPUBaker::CPUBaker(ThreadPool &thread_pool) :
+    thread_pool_(thread_pool)
+{
+}
+
+void CPUBaker::set_environment(const ImageTransferInfo &img_tinfo)
+{
+	const ImageMetaInfo &meta = img_tinfo.meta;
+	if (meta.format != vk::Format::eR32G32B32A32Sfloat && meta.format != vk::Format::eR16G16B16A16Sfloat)
+	{
+		LOGE("The CPU can't bake from a {} environment", vk::to_string(meta.format));
+		abort();
+	}
+
+	env_dimension_ = meta.extent.width;
+	env_levels_.assign(meta.levels, {});
+	for (uint32_t m = 0; m < meta.levels; m++)
+	{
+		uint32_t dimension = std::max(env_dimension_ >> m, 1u);
+		env_levels_[m].resize(6 * static_cast<size_t>(dimension) * dimension);
+	}
+
+	// THE FILE HAS EVERY LEVEL OF A FACE BEFORE THE NEXT FACE
+	const uint8_t *p_texel    = img_tinfo.binary.data();
+	uint8_t        pixel_size = ImageResource::format_to_bytes_per_pixel(meta.format);
+	for (uint32_t face = 0; face < 6; face++)
+	{
+		for (uint32_t m = 0; m < meta.levels; m++)
+		{
+			uint32_t   dimension   = std::max(env_dimension_ >> m, 1u);
+			size_t     texel_count = static_cast<size_t>(dimension) * dimension;
+			glm::vec4 *p_dst       = env_levels_[m].data() + face * texel_count;
+			for (size_t i = 0; i < texel_count; i++, p_texel += pixel_size)
+			{
+				if (meta.format == vk::Format::eR32G32B32A32Sfloat)
+				{
+					std::memcpy(&p_dst[i], p_texel, sizeof(glm::vec4));
+				}
+				else
+				{
+					uint16_t halfs[4];
+					std::memcpy(halfs, p_texel, sizeof(halfs));
+					p_dst[i] = glm::vec4(glm::unpackHalf1x16(halfs[0]), glm::unpackHalf1x16(halfs[1]), glm::unpackHalf1x16(halfs[2]), glm::unpackHalf1x16(halfs[3]));
+				}
+			}
+		}
+	}
+}
+
+bool CPUBaker::has_environment() const
+{
+	return !env_levels_.empty();
+}
+
+std::vector<uint8_t> CPUBaker::bake_brdf_lut(const ImageMetaInfo &meta) const
+{
+	require_format(meta, vk::Format::eR16G16Sfloat, "BRDF LUT");
+	uint32_t             width  = meta.extent.width;
+	uint32_t             height = meta.extent.height;
+	std::vector<uint8_t> binary(static_cast<size_t>(width) * height * 2 * sizeof(uint16_t));
+	uint16_t            *p_texels = reinterpret_cast<uint16_t *>(binary.data());
+
+	// THE TEXELS OF A ROW SHARE THEIR ROUGHNESS, SO THEY ALL TAKE THE SAME HALF VECTORS AROUND
+	// THE NORMAL (0, 0, 1). V IS IN THE XZ PLANE, SO ONLY THE HALF VECTORS' x AND z MATTER
+	thread_pool_.parallel_for(height, [&](uint32_t y) {
+		float              roughness = (y + 0.5f) / height;
+		float              k         = roughness * roughness / 2.0f;
+		std::vector<float> hx(BRDF_LUT_SAMPLES);
+		std::vector<float> hz(BRDF_LUT_SAMPLES);
+		for (uint32_t i = 0; i < BRDF_LUT_SAMPLES; i++)
+		{
+			glm::vec3 h = importance_sample_ggx(hammersley2d(i, BRDF_LUT_SAMPLES), roughness, glm::vec3(0.0f, 0.0f, 1.0f));
+			hx[i]       = h.x;
+			hz[i]       = h.z;
+		}
+
+		for (uint32_t x = 0; x < width; x++)
+		{
+			float dot_nv = (x + 0.5f) / width;
+			float vx     = std::sqrt(1.0f - dot_nv * dot_nv);
+
+			// EVERY LANE SUMS ITS OWN SAMPLES AND THE LANES ARE ADDED UP AFTERWARDS
+			float sums_a[LANES] = {};
+			float sums_b[LANES] = {};
+			for (uint32_t i = 0; i < BRDF_LUT_SAMPLES; i += LANES)
+			{
+				for (uint32_t l = 0; l < LANES; l++)
+				{
+					float dot_vh = vx * hx[i + l] + dot_nv * hz[i + l];
+					float dot_nl = std::max(2.0f * dot_vh * hz[i + l] - dot_nv, 0.0f);
+					float dot_nh = std::max(hz[i + l], 0.0f);
+					dot_vh       = std::max(dot_vh, 0.0f);
+
+					float g     = dot_nl / (dot_nl * (1.0f - k) + k) * (dot_nv / (dot_nv * (1.0f - k) + k));
+					float g_vis = dot_nl > 0.0f ? g * dot_vh / (dot_nh * dot_nv) : 0.0f;
+					float f     = 1.0f - dot_vh;
+					float fc    = f * f * f * f * f;
+					sums_a[l] += (1.0f - fc) * g_vis;
+					sums_b[l] += fc * g_vis;
+				}
+			}
+
+			float a = 0.0f;
+			float b = 0.0f;
+			for (uint32_t l = 0; l < LANES; l++)
+			{
+				a += sums_a[l];
+				b += sums_b[l];
+			}
+			size_t idx        = (static_cast<size_t>(y) * width + x) * 2;
+			p_texels[idx]     = glm::packHalf1x16(a / BRDF_LUT_SAMPLES);
+			p_texels[idx + 1] = glm::packHalf1x16(b / BRDF_LUT_SAMPLES);
+		}
+	});
+	return binary;
+}
+
+std::vector<uint8_t> CPUBaker::bake_irradiance_sh(uint32_t source_dimension) const
+{
+	if (!has_environment())
+	{
+		LOGE("The irradiance can't be baked without an environment");
+		abort();
+	}
+
+	// EVERY ROW OF EVERY FACE IS SUMMED ON ITS OWN, AND THOSE ARE ADDED UP AFTERWARDS
+	uint32_t                                     row_count = 6 * source_dimension;
+	std::vector<std::array<glm::vec4, SH_COUNT>> row_sums(row_count);
+	float                                        lod = std::max(0.0f, std::log2(static_cast<float>(env_dimension_) / source_dimension));
+	thread_pool_.parallel_for(row_count, [&](uint32_t row) {
+		uint32_t                         face = row / source_dimension;
+		float                            t    = (row % source_dimension + 0.5f) / source_dimension * 2.0f - 1.0f;
+		std::array<glm::vec4, SH_COUNT> &sums = row_sums[row];
+		sums.fill(glm::vec4(0.0f));
+		for (uint32_t x0 = 0; x0 < source_dimension; x0 += LANES)
+		{
+			// THE LANES PAST THE END OF THE ROW COVER NO SOLID ANGLE
+			float nx[LANES], ny[LANES], nz[LANES], solid_angles[LANES];
+			for (uint32_t l = 0; l < LANES; l++)
+			{
+				float     s  = (std::min(x0 + l, source_dimension - 1) + 0.5f) / source_dimension * 2.0f - 1.0f;
+				glm::vec3 n  = glm::normalize(get_face_direction(face, s, t));
+				float     r2 = 1.0f + s * s + t * t;
+				nx[l]           = n.x;
+				ny[l]           = n.y;
+				nz[l]           = n.z;
+				solid_angles[l] = x0 + l < source_dimension ? 4.0f / (source_dimension * source_dimension * r2 * std::sqrt(r2)) : 0.0f;
+			}
+
+			float basis[SH_COUNT][LANES];
+			for (uint32_t l = 0; l < LANES; l++)
+			{
+				basis[0][l] = 0.282095f;
+				basis[1][l] = 0.488603f * ny[l];
+				basis[2][l] = 0.488603f * nz[l];
+				basis[3][l] = 0.488603f * nx[l];
+				basis[4][l] = 1.092548f * nx[l] * ny[l];
+				basis[5][l] = 1.092548f * ny[l] * nz[l];
+				basis[6][l] = 0.315392f * (3.0f * nz[l] * nz[l] - 1.0f);
+				basis[7][l] = 1.092548f * nx[l] * nz[l];
+				basis[8][l] = 0.546274f * (nx[l] * nx[l] - ny[l] * ny[l]);
+			}
+
+			for (uint32_t l = 0; l < LANES; l++)
+			{
+				glm::vec3 radiance = sample_environment(glm::vec3(nx[l], ny[l], nz[l]), lod) * solid_angles[l];
+				for (uint32_t i = 0; i < SH_COUNT; i++)
+				{
+					sums[i] += glm::vec4(radiance * basis[i][l], solid_angles[l]);
+				}
+			}
+		}
+	});
+
+	std::array<glm::dvec4, SH_COUNT> totals;
+	totals.fill(glm::dvec4(0.0));
+	for (const std::array<glm::vec4, SH_COUNT> &sums : row_sums)
+	{
+		for (uint32_t i = 0; i < SH_COUNT; i++)
+		{
+			totals[i] += glm::dvec4(sums[i]);
+		}
+	}
+
+	// THE TEXELS' SOLID ANGLES ONLY ROUGHLY ADD UP TO THE WHOLE SPHERE, SO THEY'RE SCALED TO IT
+	double    scale = 4.0 * PI / totals[0].w;
+	glm::vec4 coefficients[SH_COUNT];
+	for (uint32_t i = 0; i < SH_COUNT; i++)
+	{
+		coefficients[i] = glm::vec4(glm::vec3(glm::dvec3(totals[i]) * scale) * SH_BAND_SCALES[i], 0.0f);
+	}
+	const uint8_t *p_coefficients = reinterpret_cast<const uint8_t *>(coefficients);
+	return std::vector<uint8_t>(p_coefficients, p_coefficients + sizeof(coefficients));
+}
+
+std::vector<uint8_t> CPUBaker::bake_prefilter(const ImageMetaInfo &cube_meta, const std::vector<uint32_t> &sample_counts) const
+{
+	require_format(cube_meta, vk::Format::eR16G16B16A16Sfloat, "prefiltered cube");
+	if (!has_environment())
+	{
+		LOGE("The prefiltered cube can't be baked without an environment");
+		abort();
+	}
+
+	// WHERE EVERY LEVEL STARTS IN A FACE, AND HOW BIG A FACE IS
+	const size_t        PIXEL_SIZE = 4 * sizeof(uint16_t);
+	std::vector<size_t> level_offsets(cube_meta.levels);
+	size_t              face_size = 0;
+	for (uint32_t m = 0; m < cube_meta.levels; m++)
+	{
+		uint32_t dimension = std::max(cube_meta.extent.width >> m, 1u);
+		level_offsets[m]   = face_size;
+		face_size += static_cast<size_t>(dimension) * dimension * PIXEL_SIZE;
+	}
+	std::vector<uint8_t> binary(6 * face_size);
+
+	// THE SOLID ANGLE OF ONE TEXEL OF THE ENVIRONMENT, WHICH WITH EACH SAMPLE'S SAYS WHICH LEVEL
+	// OF IT THE SAMPLE READS
+	float omega_p = 4.0f * PI / (6.0f * env_dimension_ * env_dimension_);
+
+	for (uint32_t m = 0; m < cube_meta.levels; m++)
+	{
+		uint32_t dimension    = std::max(cube_meta.extent.width >> m, 1u);
+		float    roughness    = cube_meta.levels > 1 ? m / static_cast<float>(cube_meta.levels - 1) : 0.0f;
+		uint32_t sample_count = sample_counts[m];
+
+		// EVERY TEXEL OF A LEVEL TAKES THE SAME SAMPLES, ONLY TURNED TO ITS NORMAL AND BY ITS OWN
+		// random ANGLE, WHICH IS DONE WITH THE SUMS OF ANGLES SO NO TEXEL HAS TO CALL cos OR sin
+		float              a = roughness * roughness;
+		std::vector<float> cos_thetas(sample_count);
+		std::vector<float> sin_thetas(sample_count);
+		std::vector<float> cos_phis(sample_count);
+		std::vector<float> sin_phis(sample_count);
+		for (uint32_t i = 0; i < sample_count; i++)
+		{
+			glm::vec2 xi  = hammersley2d(i, sample_count);
+			cos_thetas[i] = std::sqrt((1.0f - xi.y) / (1.0f + (a * a - 1.0f) * xi.y));
+			sin_thetas[i] = std::sqrt(1.0f - cos_thetas[i] * cos_thetas[i]);
+			cos_phis[i]   = std::cos(2.0f * PI * xi.x);
+			sin_phis[i]   = std::sin(2.0f * PI * xi.x);
+		}
+
+		thread_pool_.parallel_for(6 * dimension, [&](uint32_t row) {
+			uint32_t  face  = row / dimension;
+			uint32_t  y     = row % dimension;
+			float     t     = (y + 0.5f) / dimension * 2.0f - 1.0f;
+			uint16_t *p_row = reinterpret_cast<uint16_t *>(binary.data() + face * face_size + level_offsets[m]) + static_cast<size_t>(y) * dimension * 4;
+			for (uint32_t x0 = 0; x0 < dimension; x0 += LANES)
+			{
+				// EVERY LANE'S NORMAL, WHICH IS ALSO ITS VIEW DIRECTION, ITS TANGENTS AND ITS ANGLE
+				float     nx[LANES], ny[LANES], nz[LANES];
+				float     tx_x[LANES], tx_y[LANES], tx_z[LANES], ty_x[LANES], ty_y[LANES], ty_z[LANES];
+				float     cos_jitters[LANES], sin_jitters[LANES];
+				glm::vec3 colors[LANES];
+				float     total_weights[LANES];
+				for (uint32_t l = 0; l < LANES; l++)
+				{
+					float     s         = (std::min(x0 + l, dimension - 1) + 0.5f) / dimension * 2.0f - 1.0f;
+					glm::vec3 n         = glm::normalize(get_face_direction(face, s, t));
+					glm::vec3 up        = std::abs(n.z) < 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+					glm::vec3 tangent_x = glm::normalize(glm::cross(up, n));
+					glm::vec3 tangent_y = glm::normalize(glm::cross(n, tangent_x));
+					float     jitter    = random(n.x, n.z) * 0.1f;
+					colors[l]           = glm::vec3(0.0f);
+					total_weights[l]    = 0.0f;
+					nx[l]               = n.x;
+					ny[l]               = n.y;
+					nz[l]               = n.z;
+					tx_x[l]             = tangent_x.x;
+					tx_y[l]             = tangent_x.y;
+					tx_z[l]             = tangent_x.z;
+					ty_x[l]             = tangent_y.x;
+					ty_y[l]             = tangent_y.y;
+					ty_z[l]             = tangent_y.z;
+					cos_jitters[l]      = std::cos(jitter);
+					sin_jitters[l]      = std::sin(jitter);
+				}
+
+				if (roughness == 0.0f)
+				{
+					// EVERY SAMPLE OF A MIRROR IS THE NORMAL ITSELF
+					for (uint32_t l = 0; l < LANES; l++)
+					{
+						colors[l]        = sample_environment(glm::vec3(nx[l], ny[l], nz[l]), 0.0f);
+						total_weights[l] = 1.0f;
+					}
+				}
+				else
+				{
+					for (uint32_t i = 0; i < sample_count; i++)
+					{
+						float lx[LANES], ly[LANES], lz[LANES], weights[LANES], lods[LANES];
+						for (uint32_t l = 0; l < LANES; l++)
+						{
+							float cos_phi = cos_phis[i] * cos_jitters[l] - sin_phis[i] * sin_jitters[l];
+							float sin_phi = sin_phis[i] * cos_jitters[l] + cos_phis[i] * sin_jitters[l];
+							float h_x     = sin_thetas[i] * cos_phi;
+							float h_y     = sin_thetas[i] * sin_phi;
+							float hx      = tx_x[l] * h_x + ty_x[l] * h_y + nx[l] * cos_thetas[i];
+							float hy      = tx_y[l] * h_x + ty_y[l] * h_y + ny[l] * cos_thetas[i];
+							float hz      = tx_z[l] * h_x + ty_z[l] * h_y + nz[l] * cos_thetas[i];
+							float inv_len = 1.0f / std::sqrt(hx * hx + hy * hy + hz * hz);
+							hx *= inv_len;
+							hy *= inv_len;
+							hz *= inv_len;
+
+							// N AND V ARE THE SAME, SO N.H IS V.H
+							float dot_vh = nx[l] * hx + ny[l] * hy + nz[l] * hz;
+							lx[l]        = 2.0f * dot_vh * hx - nx[l];
+							ly[l]        = 2.0f * dot_vh * hy - ny[l];
+							lz[l]        = 2.0f * dot_vh * hz - nz[l];
+							weights[l]   = std::clamp(nx[l] * lx[l] + ny[l] * ly[l] + nz[l] * lz[l], 0.0f, 1.0f);
+
+							dot_vh        = std::clamp(dot_vh, 0.0f, 1.0f);
+							float pdf     = d_ggx(dot_vh, roughness) / 4.0f + 0.0001f;
+							float omega_s = 1.0f / (sample_count * pdf);
+							lods[l]       = std::max(0.5f * std::log2(omega_s / omega_p) + 1.0f, 0.0f);
+						}
+
+						for (uint32_t l = 0; l < LANES; l++)
+						{
+							if (weights[l] > 0.0f)
+							{
+								colors[l] += sample_environment(glm::vec3(lx[l], ly[l], lz[l]), lods[l]) * weights[l];
+								total_weights[l] += weights[l];
+							}
+						}
+					}
+				}
+
+				for (uint32_t l = 0; l < LANES && x0 + l < dimension; l++)
+				{
+					glm::vec3 color   = colors[l] / total_weights[l];
+					uint16_t *p_texel = p_row + static_cast<size_t>(x0 + l) * 4;
+					p_texel[0]        = glm::packHalf1x16(color.r);
+					p_texel[1]        = glm::packHalf1x16(color.g);
+					p_texel[2]        = glm::packHalf1x16(color.b);
+					p_texel[3]        = glm::packHalf1x16(1.0f);
+				}
+			}
+		});
+	}
+	return binary;
+}
+
+glm::vec3 CPUBaker::sample_environment(const glm::vec3 &direction, float lod) const
+{
+	float    u;
+	float    v;
+	uint32_t face = get_face_coords(direction, u, v);
+
+	lod             = std::clamp(lod, 0.0f, static_cast<float>(env_levels_.size() - 1));
+	uint32_t  level = static_cast<uint32_t>(lod);
+	float     blend = lod - level;
+	glm::vec3 color = sample_level(level, face, u, v);
+	if (blend > 0.0f)
+	{
+		color = glm::mix(color, sample_level(level + 1, face, u, v), blend);
+	}
+	return color;
+}
+
+glm::vec3 CPUBaker::sample_level(uint32_t level, uint32_t face, float u, float v) const
+{
+	int              dimension = static_cast<int>(std::max(env_dimension_ >> level, 1u));
+	const glm::vec4 *p_face    = env_levels_[level].data() + static_cast<size_t>(face) * dimension * dimension;
+
+	// THE FOUR TEXELS AROUND u, v, THE ONES OFF THE FACE ARE CLAMPED BACK ONTO IT
+	float x      = u * dimension - 0.5f;
+	float y      = v * dimension - 0.5f;
+	float x_base = std::floor(x);
+	float y_base = std::floor(y);
+	float fx     = x - x_base;
+	float fy     = y - y_base;
+	int   x0     = std::clamp(static_cast<int>(x_base), 0, dimension - 1);
+	int   x1     = std::clamp(static_cast<int>(x_base) + 1, 0, dimension - 1);
+	int   y0     = std::clamp(static_cast<int>(y_base), 0, dimension - 1);
+	int   y1     = std::clamp(static_cast<int>(y_base) + 1, 0, dimension - 1);
+
+	glm::vec4 top    = glm::mix(p_face[y0 * dimension + x0], p_face[y0 * dimension + x1], fx);
+	glm::vec4 bottom = glm::mix(p_face[y1 * dimension + x0], p_face[y1 * dimension + x1], fx);
+	return glm::vec3(glm::mix(top, bottom, fy));
+}
+
+}        // namespace W3D
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/glm_common.hpp"
+
+#include "core/image_resource.hpp"
+
+namespace W3D
+{
+class ThreadPool;
+
+/*
+* CPUBaker - bakes on the CPU what PBRBaker otherwise bakes on the GPU, which is quicker when
+* the GPU is a software rasterizer and leaves a real one free to do other work. It does the
+* same math as brdf_lut.frag, irradiance_sh.comp and prefilter.frag and hands back the results
+* in the same formats, images with every level of every face one after the other the way
+* CommandBuffer::update_image reads them, so PBRBaker uploads and caches them the same way.
+* It's plain scalar code, its speed comes from spreading the rows of texels over the threads of
+* a ThreadPool and from working on a few texels or samples at a time, so what they share, like
+* a sample's direction, is only worked out once for all of them.
+*/
+class CPUBaker
+{
+  public:
+	static const uint32_t VERSION;        // CHANGES WHENEVER WHAT IT BAKES DOES, SO THE BAKE CACHE DOESN'T KEEP THE OLD ONES
+	static const uint32_t BRDF_LUT_SAMPLES;
+
+	/*
+	* The constructor only keeps thread_pool, which every bake runs on.
+	*/
+	CPUBaker(ThreadPool &thread_pool);
+
+	/*
+	* Converts the environment the irradiance and the prefiltered cube are baked from, a cube
+	* as gli_load loads it, to floats. It must be R32G32B32A32Sfloat or R16G16B16A16Sfloat.
+	*/
+	void set_environment(const ImageTransferInfo &img_tinfo);
+	bool has_environment() const;
+
+	/*
+	* Bakes the BRDF LUT meta describes, which must be R16G16Sfloat with one level.
+	*/
+	std::vector<uint8_t> bake_brdf_lut(const ImageMetaInfo &meta) const;
+
+	/*
+	* Projects the environment onto the irradiance's spherical harmonics from faces
+	* source_dimension texels a side, returning them as PBRBaker::bake_irradiance_sh does.
+	*/
+	std::vector<uint8_t> bake_irradiance_sh(uint32_t source_dimension) const;
+
+	/*
+	* Bakes every level of the prefiltered cube cube_meta describes, which must be
+	* R16G16B16A16Sfloat, each texel of a level taking the level's sample_counts samples.
+	*/
+	std::vector<uint8_t> bake_prefilter(const ImageMetaInfo &cube_meta, const std::vector<uint32_t> &sample_counts) const;
+
+  private:
+	/*
+	* The environment in direction at lod, filtered trilinearly like textureLod does with the
+	* bakes' samplers, except the faces are clamped at their edges rather than blended.
+	*/
+	glm::vec3 sample_environment(const glm::vec3 &direction, float lod) const;
+	glm::vec3 sample_level(uint32_t level, uint32_t face, float u, float v) const;
+
+	ThreadPool                         &thread_pool_;
+	uint32_t                            env_dimension_ = 0;
+	std::vector<std::vector<glm::vec4>> env_levels_;        // EVERY FACE OF A LEVEL ONE AFTER THE OTHER
+};
+
+}        // namespace W3D
@@ -2,8 +2,14 @@
 #include "gltf_loader.hpp"
 
 // C/C++ LANGUAGE API TYPES
+#include <algorithm>
 #include <queue>
 
+#include <cstring>
+#include <limits>
+#include <numeric>
+
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
 // OUR OWN TYPES
@@ -13,6 +19,7 @@
 #include "core/command_buffer.hpp"
 #include "core/device.hpp"
 #include "core/device_memory/buffer.hpp"
+#include "core/geometry_arena.hpp"
 #include "core/image_view.hpp"
 #include "core/instance.hpp"
 #include "core/physical_device.hpp"
@@ -39,11 +46,12 @@ inline vk::SamplerAddressMode to_vk_wrap_mode(int wrap_mode);
 inline vk::Format             get_attr_format(const tinygltf::Model &model, uint32_t accessor_id);
 inline std::vector<uint8_t>   get_attr_data(const tinygltf::Model &model, uint32_t accessor_id);
 inline std::vector<uint8_t>   convert_data_stride(const std::vector<uint8_t> &src, uint32_t src_stride, uint32_t dst_stride);
+inline std::vector<float>     get_attr_floats(const tinygltf::Model &model, uint32_t accessor_id);
 
-const glm::vec3 DEFAULT_NORMAL = glm::vec3(0.0f);
-const glm::vec2 DEFAULT_UV     = glm::vec2(0.0f);
-const glm::vec4 DEFAULT_JOINT  = glm::vec4(0.0f);
-const glm::vec4 DEFAULT_WEIGHT = glm::vec4(0.0f);
+// HOW FAR THE FIRST COARSER LEVEL OF DETAIL MAY MOVE THE SURFACE, RELATIVE TO THE SUBMESH'S
+// SIZE, AND THE MOST OF THE LEVEL BEFORE'S INDICES A LEVEL CAN KEEP TO BE WORTH HAVING
+const float LOD_BASE_ERROR    = 0.01f;
+const float LOD_MIN_REDUCTION = 0.8f;
 
 template <class T, class Y>
 struct TypeCast
@@ -54,8 +62,10 @@ struct TypeCast
 	}
 };
 
-GLTFLoader::GLTFLoader(Device const &device) :
-    device_(device)
+GLTFLoader::GLTFLoader(Device const &device, bool is_optimizing_meshes, bool is_generating_lods) :
+    device_(device),
+    is_optimizing_meshes_(is_optimizing_meshes),
+    is_generating_lods_(is_generating_lods)
 {
 }
 
@@ -532,6 +542,16 @@ void GLTFLoader::load_meshes()
 
 		p_scene_->add_component(std::move(p_mesh));
 	}
+
+	if (cache_stats_after_.triangle_count)
+	{
+		LOGI("Optimized {} triangles for the vertex cache, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+		     cache_stats_after_.triangle_count,
+		     cache_stats_before_.get_acmr(),
+		     cache_stats_after_.get_acmr(),
+		     cache_stats_before_.get_atvr(),
+		     cache_stats_after_.get_atvr());
+	}
 }
 
 std::unique_ptr<sg::Mesh> GLTFLoader::parse_mesh(const tinygltf::Mesh &gltf_mesh) const
@@ -539,53 +559,70 @@ std::unique_ptr<sg::Mesh> GLTFLoader::parse_mesh(const tinygltf::Mesh &gltf_mesh
 	return std::make_unique<sg::Mesh>(gltf_mesh.name);
 }
 
-std::unique_ptr<sg::SubMesh> GLTFLoader::parse_submesh(sg::Mesh *p_mesh, const tinygltf::Primitive &gltf_submesh) const
+std::unique_ptr<sg::SubMesh> GLTFLoader::parse_submesh(sg::Mesh *p_mesh, const tinygltf::Primitive &gltf_submesh)
 {
-	std::vector<Buffer>          transient_bufs;
 	std::unique_ptr<sg::SubMesh> p_submesh = std::make_unique<sg::SubMesh>();
 	// pos_accessor is guranteed to exist
 	const tinygltf::Accessor pos_accessor = gltf_model_.accessors[gltf_submesh.attributes.find("POSITION")->second];
 	p_submesh->vertex_count_              = pos_accessor.count;
-	if (p_mesh)
-	{
-		p_mesh->get_mut_bounds().update(
-		    glm::vec3(pos_accessor.minValues[0], pos_accessor.minValues[1], pos_accessor.minValues[2]),
-		    glm::vec3(pos_accessor.maxValues[0], pos_accessor.maxValues[1], pos_accessor.maxValues[2]));
-	}
-
-	std::vector<sg::Vertex> vertexs;
-	vertexs.reserve(p_submesh->vertex_count_);
-
-	// NOTE A MESH CAN BE MADE UP OF SUBMESHES, WHICH CAN BE ANIMATED. HERE
-	// WE ARE SPECIFYING THE ATTRIBUTE DATA IN OUR VERTEX BUFFER
-	const float    *p_pos    = get_attr_data_ptr<float>(gltf_submesh, "POSITION");
-	const float    *p_norm   = get_attr_data_ptr<float>(gltf_submesh, "NORMAL");
-	const float    *p_uv     = get_attr_data_ptr<float>(gltf_submesh, "TEXCOORD_0");
-	const uint16_t *p_joint  = get_attr_data_ptr<uint16_t>(gltf_submesh, "JOINTS_0");
-	const float    *p_weight = get_attr_data_ptr<float>(gltf_submesh, "WEIGHTS_0");
-
-	bool is_skinned = p_joint && p_weight;
 
+	// NOTE A MESH CAN BE MADE UP OF SUBMESHES, WHICH CAN BE ANIMATED. EVERY ATTRIBUTE IS
+	// DECODED TO FLOATS FIRST, SO KHR_mesh_quantization's BYTES AND SHORTS ARE READ THE SAME
+	// WAY AS FLOATS, AND THEN PACKED INTO THE SUBMESH'S VERTEX FORMAT
+	auto read_attr = [&](const char *name) {
+		auto it = gltf_submesh.attributes.find(name);
+		return it == gltf_submesh.attributes.end() ? std::vector<float>() : get_attr_floats(gltf_model_, it->second);
+	};
+	std::vector<float> positions = read_attr("POSITION");
+	std::vector<float> normals   = read_attr("NORMAL");
+	std::vector<float> uvs       = read_attr("TEXCOORD_0");
+	std::vector<float> joints    = read_attr("JOINTS_0");
+	std::vector<float> weights   = read_attr("WEIGHTS_0");
+
+	// ONLY MESHES THAT ARE ACTUALLY SKINNED PAY FOR JOINTS AND WEIGHTS
+	bool is_skinned           = !joints.empty() && !weights.empty();
+	p_submesh->vertex_format_ = is_skinned ? sg::VertexFormat::eSkinned : sg::VertexFormat::eStatic;
+	uint32_t stride           = sg::get_vertex_stride(p_submesh->vertex_format_);
+
+	// QUANTIZED ACCESSORS' min AND max ARE IN THE RAW INTEGERS, SO THE BOUNDS COME FROM WHAT WE DECODED
+	glm::vec3 bounds_min(std::numeric_limits<float>::max());
+	glm::vec3 bounds_max(std::numeric_limits<float>::lowest());
+
+	std::vector<uint8_t> vertexs(p_submesh->vertex_count_ * stride);
 	for (size_t i = 0; i < p_submesh->vertex_count_; i++)
 	{
-		vertexs.emplace_back(sg::Vertex{
-		    .pos    = glm::make_vec3(&p_pos[i * 3]),
-		    .norm   = p_norm ? glm::normalize(glm::make_vec3(&p_norm[i * 3])) : glm::vec3(0.0f),
-		    .uv     = p_uv ? glm::make_vec2(&p_uv[i * 2]) : glm::vec2(0.0f),
-		    .joint  = is_skinned ? glm::vec4(glm::make_vec4(&p_joint[i * 4])) : glm::vec4(0.0f),
-		    .weight = is_skinned ? glm::make_vec4(&p_weight[i * 4]) : glm::vec4(0.0f),
-		});
+		glm::vec3 pos  = glm::make_vec3(&positions[i * 3]);
+		glm::vec3 norm = normals.empty() ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::make_vec3(&normals[i * 3]);
+		glm::vec2 uv   = uvs.empty() ? glm::vec2(0.0f) : glm::make_vec2(&uvs[i * 2]);
+		bounds_min     = glm::min(bounds_min, pos);
+		bounds_max     = glm::max(bounds_max, pos);
+
+		sg::Vertex vertex{
+		    .pos  = pos,
+		    .norm = sg::Vertex::encode_octahedral(glm::length(norm) > 0.0f ? glm::normalize(norm) : glm::vec3(0.0f, 0.0f, 1.0f)),
+		    .uv   = glm::packHalf2x16(uv),
+		};
+		if (is_skinned)
+		{
+			sg::SkinnedVertex skinned_vertex{.base = vertex};
+			for (size_t j = 0; j < 4; j++)
+			{
+				skinned_vertex.joint[j]  = static_cast<uint16_t>(joints[i * 4 + j]);
+				skinned_vertex.weight[j] = static_cast<uint16_t>(std::round(glm::clamp(weights[i * 4 + j], 0.0f, 1.0f) * 65535.0f));
+			}
+			std::memcpy(&vertexs[i * stride], &skinned_vertex, stride);
+		}
+		else
+		{
+			std::memcpy(&vertexs[i * stride], &vertex, stride);
+		}
+	}
+	if (p_mesh && p_submesh->vertex_count_)
+	{
+		p_mesh->get_mut_bounds().update(bounds_min, bounds_max);
 	}
 
-	size_t vertex_buf_size    = vertexs.size() * sizeof(sg::Vertex);
-	Buffer vertex_staging_buf = device_.get_device_memory_allocator().allocate_staging_buffer(vertex_buf_size);
-	Buffer vertex_buf         = device_.get_device_memory_allocator().allocate_vertex_buffer(vertex_buf_size);
-	vertex_staging_buf.update(vertexs.data(), vertex_buf_size);
-	CommandBuffer cmd_buf = device_.begin_one_time_buf();
-	cmd_buf.copy_buffer(vertex_staging_buf, vertex_buf, vertex_buf_size);
-	p_submesh->p_vertex_buf_ = std::make_unique<Buffer>(std::move(vertex_buf));
-	transient_bufs.push_back(std::move(vertex_staging_buf));
-
+	std::vector<uint32_t> indices;
 	if (gltf_submesh.indices >= 0)
 	{
 		const tinygltf::Accessor &accessor = gltf_model_.accessors[gltf_submesh.indices];
@@ -612,19 +649,94 @@ std::unique_ptr<sg::SubMesh> GLTFLoader::parse_submesh(sg::Mesh *p_mesh, const t
 				// unreachable;
 				break;
 		}
+		indices.resize(p_submesh->idx_count_);
+		std::memcpy(indices.data(), indexs.data(), indices.size() * sizeof(uint32_t));
+	}
+	else
+	{
+		// A PRIMITIVE WITHOUT INDICES USES EVERY VERTEX ONCE, IN ORDER
+		p_submesh->idx_count_ = p_submesh->vertex_count_;
+		indices.resize(p_submesh->idx_count_);
+		std::iota(indices.begin(), indices.end(), 0u);
+	}
 
-		Buffer idx_staging_buf = device_.get_device_memory_allocator().allocate_staging_buffer(indexs.size());
-		Buffer idx_buf         = device_.get_device_memory_allocator().allocate_index_buffer(indexs.size());
-		idx_staging_buf.update(indexs);
-		cmd_buf.copy_buffer(idx_staging_buf, idx_buf, indexs.size());
-		transient_bufs.push_back(std::move(idx_staging_buf));
-		p_submesh->p_idx_buf_ = std::make_unique<Buffer>(std::move(idx_buf));
+	bool is_triangle_list = gltf_submesh.mode == TINYGLTF_MODE_TRIANGLES && indices.size() % 3 == 0;
+	if (is_optimizing_meshes_ && is_triangle_list)
+	{
+		optimize_submesh(*p_submesh, vertexs, indices);
+	}
+	if (is_generating_lods_ && is_triangle_list)
+	{
+		generate_submesh_lods(*p_submesh, vertexs, indices);
 	}
 
-	device_.end_one_time_buf(cmd_buf);
+	// THE INDICES ARE RELATIVE TO THE SUBMESH'S FIRST VERTEX, SO HALF AS MANY BYTES DO WHEN
+	// THERE ARE FEW ENOUGH VERTICES
+	GeometryArena        &arena     = device_.get_geometry_arena();
+	const void           *p_indices = indices.data();
+	std::vector<uint16_t> short_indices;
+	if (p_submesh->vertex_count_ <= std::numeric_limits<uint16_t>::max())
+	{
+		short_indices.assign(indices.begin(), indices.end());
+		p_indices            = short_indices.data();
+		p_submesh->idx_type_ = vk::IndexType::eUint16;
+	}
+
+	// THE VERTICES AND INDICES, OF EVERY LEVEL OF DETAIL, GO INTO THE DEVICE'S GEOMETRY ARENA
+	// AND THE SUBMESH ONLY REMEMBERS WHERE
+	GeometryArena::Allocation allocation = arena.allocate(p_submesh->vertex_format_, vertexs.data(), p_submesh->vertex_count_, p_indices, to_u32(indices.size()), p_submesh->idx_type_);
+	p_submesh->vertex_offset_            = allocation.vertex_offset;
+	p_submesh->first_index_              = allocation.first_index;
+	p_submesh->p_geometry_arena_         = &arena;
+	for (sg::SubMeshLod &lod : p_submesh->lods_)
+	{
+		lod.first_index += allocation.first_index;
+	}
 	return std::move(p_submesh);
 }
 
+void GLTFLoader::optimize_submesh(sg::SubMesh &submesh, std::vector<uint8_t> &vertices, std::vector<uint32_t> &indices)
+{
+	uint32_t         stride = sg::get_vertex_stride(submesh.vertex_format_);
+	VertexCacheStats before = mesh_optimizer::analyze_vertex_cache(indices, submesh.vertex_count_);
+
+	uint32_t vertex_count = mesh_optimizer::weld_vertices(vertices, stride, indices);
+	mesh_optimizer::optimize_vertex_cache(indices, vertex_count);
+	mesh_optimizer::optimize_overdraw(indices, vertices, stride);
+	submesh.vertex_count_ = mesh_optimizer::optimize_vertex_fetch(vertices, stride, indices);
+
+	VertexCacheStats after = mesh_optimizer::analyze_vertex_cache(indices, submesh.vertex_count_);
+	LOGD("Optimized a submesh of {} triangles, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", after.triangle_count, before.get_acmr(), after.get_acmr(), before.get_atvr(), after.get_atvr());
+	cache_stats_before_ += before;
+	cache_stats_after_ += after;
+}
+
+void GLTFLoader::generate_submesh_lods(sg::SubMesh &submesh, const std::vector<uint8_t> &vertices, std::vector<uint32_t> &indices) const
+{
+	uint32_t              stride = sg::get_vertex_stride(submesh.vertex_format_);
+	std::vector<uint32_t> lod_indices(indices.begin(), indices.begin() + submesh.idx_count_);
+	for (uint32_t level = 1; level < sg::SubMesh::MAX_LODS; level++)
+	{
+		// EVERY LEVEL MAY MOVE THE SURFACE TWICE AS FAR AS THE ONE BEFORE, AS IT'S PICKED WHEN
+		// THE MESH IS HALF AS BIG ON SCREEN
+		float                 max_error  = LOD_BASE_ERROR * static_cast<float>(1u << (level - 1));
+		std::vector<uint32_t> simplified = mesh_optimizer::simplify(lod_indices, vertices, stride, lod_indices.size() / 2, max_error);
+
+		// A LEVEL THAT BARELY SAVES ANYTHING ISN'T WORTH SWITCHING TO, AND NEITHER ARE THE ONES AFTER IT
+		if (simplified.empty() || simplified.size() > lod_indices.size() * LOD_MIN_REDUCTION)
+		{
+			break;
+		}
+		mesh_optimizer::optimize_vertex_cache(simplified, submesh.vertex_count_);
+		submesh.lods_.push_back({
+		    .first_index = to_u32(indices.size()),
+		    .idx_count   = to_u32(simplified.size()),
+		});
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+		lod_indices = std::move(simplified);
+	}
+}
+
 size_t GLTFLoader::get_submesh_vertex_count(const tinygltf::Primitive &submesh) const
 {
 	// GLTF gurantees that a vertex will always have position attribute
@@ -747,6 +859,7 @@ std::vector<std::unique_ptr<sg::Node>> GLTFLoader::parse_nodes()
 	std::vector<sg::Camera *>              p_cameras = p_scene_->get_components<sg::Camera>();
 	std::vector<sg::Mesh *>                p_meshs   = p_scene_->get_components<sg::Mesh>();
 	std::vector<std::unique_ptr<sg::Node>> p_nodes;
+	std::vector<std::unique_ptr<sg::Node>> p_instance_nodes;
 	p_nodes.reserve(gltf_model_.nodes.size());
 
 	for (size_t i = 0; i < gltf_model_.nodes.size(); i++)
@@ -761,8 +874,21 @@ std::vector<std::unique_ptr<sg::Node>> GLTFLoader::parse_nodes()
 			sg::Mesh *p_mesh = p_meshs[gltf_node.mesh];
 			//p_mesh->get_name();
 			// std::cout << p_mesh->get_name() << std::endl; each mesh called mesh hopefully can resuse them
-			p_node->set_component(*p_mesh);
-			p_mesh->add_node(*p_node);
+
+			// A GPU INSTANCED NODE ISN'T DRAWN ITSELF, EACH OF ITS INSTANCES IS, SO THE MESH GOES ON
+			// THE INSTANCES WHERE THE RENDERER WILL DRAW THEM ALL WITH ONE INSTANCED DRAW
+			std::vector<std::unique_ptr<sg::Node>> p_instances = parse_gpu_instances(gltf_node, *p_node, gltf_model_.nodes.size() + p_instance_nodes.size());
+			if (p_instances.empty())
+			{
+				p_node->set_component(*p_mesh);
+				p_mesh->add_node(*p_node);
+			}
+			for (std::unique_ptr<sg::Node> &p_instance : p_instances)
+			{
+				p_instance->set_component(*p_mesh);
+				p_mesh->add_node(*p_instance);
+				p_instance_nodes.push_back(std::move(p_instance));
+			}
 		}
 
 		if (gltf_node.camera >= 0)
@@ -775,9 +901,86 @@ std::vector<std::unique_ptr<sg::Node>> GLTFLoader::parse_nodes()
 
 		p_nodes.push_back(std::move(p_node));
 	};
+
+	// THE INSTANCES GO AFTER ALL THE GLTF NODES SO THOSE KEEP THEIR INDICES
+	for (std::unique_ptr<sg::Node> &p_instance_node : p_instance_nodes)
+	{
+		p_nodes.push_back(std::move(p_instance_node));
+	}
 	return p_nodes;
 }
 
+std::vector<std::unique_ptr<sg::Node>> GLTFLoader::parse_gpu_instances(const tinygltf::Node &gltf_node, sg::Node &parent, size_t first_id) const
+{
+	std::vector<std::unique_ptr<sg::Node>> p_instances;
+
+	auto ext_it = gltf_node.extensions.find("EXT_mesh_gpu_instancing");
+	if (ext_it == gltf_node.extensions.end() || !ext_it->second.Has("attributes"))
+	{
+		return p_instances;
+	}
+	const tinygltf::Value &attributes = ext_it->second.Get("attributes");
+
+	// EVERY ATTRIBUTE IS OPTIONAL BUT THE ONES THAT ARE THERE ALL HAVE ONE ELEMENT PER INSTANCE
+	std::vector<float>  translations;
+	std::vector<float>  rotations;
+	std::vector<float>  scales;
+	std::vector<size_t> counts;        // OF EACH ATTRIBUTE THAT'S THERE
+	if (attributes.Has("TRANSLATION"))
+	{
+		translations = get_attr_floats(gltf_model_, attributes.Get("TRANSLATION").GetNumberAsInt());
+		counts.push_back(translations.size() / 3);
+	}
+	if (attributes.Has("ROTATION"))
+	{
+		rotations = get_attr_floats(gltf_model_, attributes.Get("ROTATION").GetNumberAsInt());
+		counts.push_back(rotations.size() / 4);
+	}
+	if (attributes.Has("SCALE"))
+	{
+		scales = get_attr_floats(gltf_model_, attributes.Get("SCALE").GetNumberAsInt());
+		counts.push_back(scales.size() / 3);
+	}
+	if (counts.empty())
+	{
+		return p_instances;
+	}
+
+	// ATTRIBUTES THAT DISAGREE ON HOW MANY INSTANCES THERE ARE AREN'T VALID, SO RATHER THAN READ
+	// PAST THE END OF THE SHORTER ONES THE NODE DRAWS ITS MESH ONCE AS IF THERE WERE NO EXTENSION
+	size_t count = counts[0];
+	if (std::any_of(counts.begin(), counts.end(), [&](size_t other) { return other != count; }))
+	{
+		LOGW("Ignoring EXT_mesh_gpu_instancing on node {}, its attributes have different counts", gltf_node.name);
+		return p_instances;
+	}
+
+	p_instances.reserve(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		std::unique_ptr<sg::Node> p_instance = std::make_unique<sg::Node>(first_id + i, gltf_node.name + "_instance_" + std::to_string(i));
+		sg::Transform            &transform  = p_instance->get_component<sg::Transform>();
+		if (!translations.empty())
+		{
+			transform.set_tranlsation(glm::make_vec3(&translations[i * 3]));
+		}
+		if (!rotations.empty())
+		{
+			// GLTF STORES QUATERNIONS AS x, y, z, w BUT glm::quat TAKES w FIRST
+			transform.set_rotation(glm::quat(rotations[i * 4 + 3], rotations[i * 4], rotations[i * 4 + 1], rotations[i * 4 + 2]));
+		}
+		if (!scales.empty())
+		{
+			transform.set_scale(glm::make_vec3(&scales[i * 3]));
+		}
+
+		parent.add_child(*p_instance);
+		p_instance->set_parent(parent);
+		p_instances.push_back(std::move(p_instance));
+	}
+	return p_instances;
+}
+
 std::unique_ptr<sg::Node> GLTFLoader::parse_node(const tinygltf::Node &gltf_node,
                                                  size_t                index) const
 {
@@ -1073,6 +1276,63 @@ std::vector<uint8_t> get_attr_data(const tinygltf::Model &model, uint32_t access
 	return {buffer.data.begin() + start_byte, buffer.data.begin() + end_byte};
 }
 
+std::vector<float> get_attr_floats(const tinygltf::Model &model, uint32_t accessor_id)
+{
+	assert(accessor_id < model.accessors.size());
+	auto &accessor = model.accessors[accessor_id];
+	assert(accessor.bufferView < model.bufferViews.size());
+	auto &buffer_view = model.bufferViews[accessor.bufferView];
+	assert(buffer_view.buffer < model.buffers.size());
+	auto &buffer = model.buffers[buffer_view.buffer];
+
+	size_t         num_components = tinygltf::GetNumComponentsInType(accessor.type);
+	size_t         stride         = accessor.ByteStride(buffer_view);
+	const uint8_t *p_data         = &buffer.data[accessor.byteOffset + buffer_view.byteOffset];
+
+	// FLOATS ARE COPIED, NORMALIZED INTEGERS ARE MAPPED TO [0, 1] OR [-1, 1] AS THE SPEC SAYS AND
+	// THE REST, LIKE KHR_mesh_quantization's POSITIONS OR JOINT INDICES, ARE TAKEN AS THEY ARE
+	std::vector<float> floats;
+	floats.reserve(accessor.count * num_components);
+	for (size_t i = 0; i < accessor.count; i++)
+	{
+		const uint8_t *p_element = p_data + i * stride;
+		for (size_t c = 0; c < num_components; c++)
+		{
+			float value = 0.0f;
+			switch (accessor.componentType)
+			{
+				case TINYGLTF_COMPONENT_TYPE_FLOAT:
+					value = reinterpret_cast<const float *>(p_element)[c];
+					break;
+				case TINYGLTF_COMPONENT_TYPE_BYTE:
+					value = reinterpret_cast<const int8_t *>(p_element)[c];
+					value = accessor.normalized ? std::max(value / 127.0f, -1.0f) : value;
+					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+					value = reinterpret_cast<const uint8_t *>(p_element)[c];
+					value = accessor.normalized ? value / 255.0f : value;
+					break;
+				case TINYGLTF_COMPONENT_TYPE_SHORT:
+					value = reinterpret_cast<const int16_t *>(p_element)[c];
+					value = accessor.normalized ? std::max(value / 32767.0f, -1.0f) : value;
+					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+					value = reinterpret_cast<const uint16_t *>(p_element)[c];
+					value = accessor.normalized ? value / 65535.0f : value;
+					break;
+				case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+					value = static_cast<float>(reinterpret_cast<const uint32_t *>(p_element)[c]);
+					break;
+				default:
+					LOGE("Unsupported component type {} for accessor {}", accessor.componentType, accessor_id);
+					abort();
+			}
+			floats.push_back(value);
+		}
+	}
+	return floats;
+}
+
 std::vector<uint8_t> convert_data_stride(const std::vector<uint8_t> &src,
                                          uint32_t                    src_stride,
                                          uint32_t                    dst_stride)
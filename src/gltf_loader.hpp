@@ -3,6 +3,7 @@
 #include <tiny_gltf.h>
 #include <memory>
 #include "common/glm_common.hpp"
+#include "common/mesh_optimizer.hpp"
 
 namespace W3D
 {
@@ -42,12 +43,19 @@ class GLTFLoader
 	tinygltf::Model                gltf_model_;
 	std::string                    model_path_;
 	std::vector<ImageTransferInfo> img_tinfos_;
+	bool                           is_optimizing_meshes_;
+	bool                           is_generating_lods_;
+	VertexCacheStats               cache_stats_before_;        // OF EVERY SUBMESH OPTIMIZED SO FAR, AS AUTHORED
+	VertexCacheStats               cache_stats_after_;         // AND AS UPLOADED
 
   public:
 	/*
-	* Constructor just sets the device, nothing gets loaded at this time.
+	* Constructor just sets the device, nothing gets loaded at this time. Unless
+	* is_optimizing_meshes is false every submesh is run through the mesh_optimizer helpers
+	* before it's uploaded, and unless is_generating_lods is false it's given coarser levels
+	* of detail too.
 	*/
-	GLTFLoader(Device const &device);
+	GLTFLoader(Device const &device, bool is_optimizing_meshes = true, bool is_generating_lods = true);
 
 	/*
 	* This class is not responsible for the device or the scene, it is just for loading
@@ -140,7 +148,20 @@ class GLTFLoader
 	/*
 	* This helper method extracts submesh data and uses to to create a SubMesh object, which it returns.
 	*/
-	std::unique_ptr<sg::SubMesh> parse_submesh(sg::Mesh *p_mesh, const tinygltf::Primitive &gltf_submesh) const;
+	std::unique_ptr<sg::SubMesh> parse_submesh(sg::Mesh *p_mesh, const tinygltf::Primitive &gltf_submesh);
+
+	/*
+	* This helper method welds the vertices of a triangle list and reorders its triangles and
+	* vertices for the vertex cache, overdraw and vertex fetches, in that order.
+	*/
+	void optimize_submesh(sg::SubMesh &submesh, std::vector<uint8_t> &vertices, std::vector<uint32_t> &indices);
+
+	/*
+	* This helper method simplifies a triangle list into coarser levels of detail, each with
+	* about half the triangles of the one before, and appends their indices to indices.
+	* The levels' first_index is where they start in indices until they are uploaded.
+	*/
+	void generate_submesh_lods(sg::SubMesh &submesh, const std::vector<uint8_t> &vertices, std::vector<uint32_t> &indices) const;
 
 	/*
 	 * This helper method extracts submesh data and uses to to create a SubMesh object, which it returns.
@@ -180,6 +201,14 @@ class GLTFLoader
 	*/
 	std::vector<std::unique_ptr<sg::Node>> parse_nodes();
 
+	/*
+	* This helper function reads the EXT_mesh_gpu_instancing extension of gltf_node and makes
+	* a child of parent for every instance it lists, with the instance's transform. The
+	* children are returned, or nothing if the node doesn't use the extension. Note the
+	* children get ids counting up from first_id.
+	*/
+	std::vector<std::unique_ptr<sg::Node>> parse_gpu_instances(const tinygltf::Node &gltf_node, sg::Node &parent, size_t first_id) const;
+
 	/*
 	* This helper function creates a default material used for loading things
 	* like meshes where a material is not specified.
@@ -240,29 +269,6 @@ class GLTFLoader
 	* game objects in such an arrangement.
 	*/
 	void             init_node_hierarchy(tinygltf::Scene *p_gltf_scene, std::vector<std::unique_ptr<sg::Node>> &p_nodes, sg::Node &root);
-
-	/*
-	* This function gets a pointer to attribute data for a submesh.
-	*/
-	template <typename T>
-	const T *get_attr_data_ptr(const tinygltf::Primitive &submesh, const char *name) const
-	{
-		auto it = submesh.attributes.find(name);
-		if (it == submesh.attributes.end())
-		{
-			return nullptr;
-		}
-
-		uint32_t accessor_id = it->second;
-		assert(accessor_id < gltf_model_.accessors.size());
-		const tinygltf::Accessor &accessor = gltf_model_.accessors[accessor_id];
-		assert(accessor.bufferView < gltf_model_.bufferViews.size());
-		const tinygltf::BufferView &buffer_view = gltf_model_.bufferViews[accessor.bufferView];
-		assert(buffer_view.buffer < gltf_model_.buffers.size());
-		const tinygltf::Buffer &buffer = gltf_model_.buffers[buffer_view.buffer];
-
-		return reinterpret_cast<const T *>(&buffer.data[accessor.byteOffset + buffer_view.byteOffset]);
-	}
 };
 
 }        // namespace W3D
@@ -1,9 +1,14 @@
 // C/C++ LANGUAGE API TYPES
 #include <stdlib.h>
+#include <cstring>
 #include <exception>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 
 // OUR OWN TYPES
+#include "common/profiler.hpp"
 #include "core/renderer.hpp"
 
 /*
@@ -12,11 +17,99 @@
 * simply loads a cube model as a GLTF cube and then renders cubes using that model. The
 * demo lets the user use W-A-S-D to navigate the camera as well as to select objects via
 * 1-2-3, which then lets one move models around the scene.
+*
+* The demo can also be run without a window, which is what we do on machines without a
+* display, and how far the CPU runs ahead of the GPU can be tuned, using these command
+* line options:
+*	--headless				RENDER OFFSCREEN INSTEAD OF TO A WINDOW
+*	--frames <count>		STOP AFTER RENDERING count FRAMES
+*	--size <w> <h>			SIZE OF THE OFFSCREEN FRAMES
+*	--readback <file.ppm>	READ FRAMES BACK FROM THE GPU AND SAVE THE LAST ONE
+*	--frames-in-flight <n>	FRAMES THE CPU MAY RUN AHEAD OF THE GPU, 1 TO 4, 2 BY DEFAULT
+*	--swapchain-images <n>	MINIMUM SWAPCHAIN IMAGES, e.g. 3 FOR TRIPLE BUFFERING
+*	--cpu-bake				BAKE THE LIGHTING ON THE CPU, QUICKER WITH A SOFTWARE VULKAN DRIVER
+*	--trace <file.json>		SAVE THE PROFILED SCOPES AS A CHROME TRACE WHEN DONE
 */
-int main()
+
+/*
+* write_ppm - saves RGBA8 pixels to path as a binary PPM image, which drops the alpha.
+*/
+bool write_ppm(const std::string &path, const std::vector<uint8_t> &pixels, vk::Extent2D extent)
 {
+	std::ofstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	file << "P6\n"
+	     << extent.width << " " << extent.height << "\n255\n";
+	for (size_t i = 0; i < pixels.size(); i += 4)
+	{
+		file.write(reinterpret_cast<const char *>(&pixels[i]), 3);
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	// READ THE COMMAND LINE OPTIONS
+	W3D::RendererSettings settings;
+	std::string           readback_path;
+	std::string           trace_path;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--headless"))
+		{
+			settings.headless = true;
+		}
+		else if (!strcmp(argv[i], "--frames") && i + 1 < argc)
+		{
+			settings.max_frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--size") && i + 2 < argc)
+		{
+			settings.extent.width  = static_cast<uint32_t>(std::stoul(argv[++i]));
+			settings.extent.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--readback") && i + 1 < argc)
+		{
+			settings.readback = true;
+			readback_path     = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--frames-in-flight") && i + 1 < argc)
+		{
+			settings.frames_in_flight = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--swapchain-images") && i + 1 < argc)
+		{
+			settings.swapchain_images = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (!strcmp(argv[i], "--cpu-bake"))
+		{
+			settings.cpu_bake = true;
+		}
+		else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+		{
+			trace_path = argv[++i];
+		}
+		else
+		{
+			std::cerr << "Unknown option " << argv[i] << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
 	// DECLARE AND CONSTRUCT A LOCAL Renderer OBJECT
-	W3D::Renderer renderer;
+	W3D::Renderer renderer(settings);
+
+	// KEEP THE MOST RECENT FRAME THAT WAS READ BACK
+	std::vector<uint8_t> last_frame;
+	vk::Extent2D         last_extent{};
+	renderer.set_readback_callback([&](const uint8_t *p_pixels, vk::Extent2D extent, vk::Format format) {
+		last_frame.assign(p_pixels, p_pixels + static_cast<size_t>(extent.width) * extent.height * 4);
+		last_extent = extent;
+	});
+
 	try
 	{
 		// START THE DEMO
@@ -28,5 +121,17 @@ int main()
 		return EXIT_FAILURE;
 	}
 
+	if (settings.readback && !last_frame.empty() && !write_ppm(readback_path, last_frame, last_extent))
+	{
+		std::cerr << "Unable to write " << readback_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!trace_path.empty() && !W3D::Profiler::write_chrome_trace(trace_path))
+	{
+		std::cerr << "Unable to write " << trace_path << std::endl;
+		return EXIT_FAILURE;
+	}
+
 	return EXIT_SUCCESS;
-};
\ No newline at end of file
+};
@@ -1,18 +1,31 @@
 // IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
 #include "pbr_baker.hpp"
 
+#include "cpu_baker.hpp"
 #include "gltf_loader.hpp"
 
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+
 // OUR OWN TYPES
 #include "common/error.hpp"
 #include "common/file_utils.hpp"
+#include "common/logging.hpp"
+#include "common/profiler.hpp"
+#include "common/utils.hpp"
 #include "core/command_buffer.hpp"
+#include "core/compute_pipeline.hpp"
 #include "core/device.hpp"
 #include "core/device_memory/buffer.hpp"
-#include "core/framebuffer.hpp"
+#include "core/geometry_arena.hpp"
 #include "core/graphics_pipeline.hpp"
 #include "core/image_view.hpp"
 #include "core/pipeline_layout.hpp"
+#include "core/render_graph.hpp"
 #include "core/render_pass.hpp"
 #include "scene_graph/components/submesh.hpp"
 
@@ -23,39 +36,71 @@ PBR::PBR(){};
 
 PBR::~PBR(){};
 
-const uint32_t PBRBaker::IRRADIANCE_DIMENSION = 64;
-const uint32_t PBRBaker::PREFILTER_DIMENSION  = 512;
-const uint32_t PBRBaker::BRDF_LUT_DIMENSION   = 512;
-
-const std::vector<glm::mat4> PBRBaker::CUBE_FACE_MATRIXS = {
-    // POSITIVE_X
-    glm::rotate(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
-                glm::radians(180.0f),
-                glm::vec3(1.0f, 0.0f, 0.0f)),
-    // NEGATIVE_X
-    glm::rotate(glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
-                glm::radians(180.0f),
-                glm::vec3(1.0f, 0.0f, 0.0f)),
-    // POSITIVE_Y
-    glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-    // NEGATIVE_Y
-    glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-    // POSITIVE_Z
-    glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(1.0f, 0.0f, 0.0f)),
-    // NEGATIVE_Z
-    glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
-};
-
-PBRBaker::PBRBaker(Device &device) :
+const uint32_t PBRBaker::IRRADIANCE_SH_COUNT       = 9;
+const uint32_t PBRBaker::IRRADIANCE_SH_SIZE        = IRRADIANCE_SH_COUNT * sizeof(glm::vec4);
+const uint32_t PBRBaker::SH_SOURCE_DIMENSION       = 64;
+const uint32_t PBRBaker::SH_GROUP_SIZE             = 8;
+const uint32_t PBRBaker::PREFILTER_DIMENSION       = 512;
+const uint32_t PBRBaker::DEFAULT_PREFILTER_SAMPLES = 64;
+const uint32_t PBRBaker::BRDF_LUT_DIMENSION        = 512;
+const char    *PBRBaker::BACKGROUND_NAME           = "papermill.dds";
+
+// EVERY FACE OF A CUBE IS DRAWN WITH THE SAME PROJECTION, THE VERTEX SHADER TURNS THE BOX
+static glm::mat4 get_face_projection()
+{
+	return glm::perspective(glm::pi<float>() / 2.0f, 1.0f, 0.1f, 512.0f);
+}
+
+// THE BAKES' PIPELINES DRAW TO ALL OF WHATEVER SIZE THEIR PASS IS
+static void set_dynamic_states(CommandBuffer &cmd_buf, vk::Extent2D extent)
+{
+	vk::Viewport viewport{
+	    .x        = 0,
+	    .y        = 0,
+	    .width    = static_cast<float>(extent.width),
+	    .height   = static_cast<float>(extent.height),
+	    .minDepth = 0.0f,
+	    .maxDepth = 1.0f,
+	};
+	vk::Rect2D scissor{
+	    .offset = {
+	        .x = 0,
+	        .y = 0,
+	    },
+	    .extent = extent,
+	};
+	cmd_buf.get_handle().setViewport(0, viewport);
+	cmd_buf.get_handle().setScissor(0, scissor);
+}
+
+PBRBaker::PBRBaker(Device &device, const std::string &cache_directory, ThreadPool *p_cpu_thread_pool, uint32_t prefilter_samples) :
     device_(device),
-    desc_state_(device)
+    desc_state_(device),
+    cache_directory_(cache_directory),
+    prefilter_samples_(std::max(prefilter_samples, 1u))
 {
+	W3D_PROFILE_SCOPE("PBRBaker::PBRBaker");
 	load_cube_model();
-	load_background();
+	if (p_cpu_thread_pool)
+	{
+		p_cpu_baker_ = std::make_unique<CPUBaker>(*p_cpu_thread_pool);
+	}
+
+	// HASHING THE BACKGROUND'S FILE IS A LOT CHEAPER THAN LOADING IT, WHICH A FULL CACHE AVOIDS
+	if (!cache_directory_.empty())
+	{
+		std::vector<uint8_t> binary = fu::read_binary(fu::compute_abs_path(fu::FileType::eImage, BACKGROUND_NAME));
+		background_hash_            = fnv1a_64(binary.data(), binary.size());
+	}
+}
+
+PBRBaker::~PBRBaker()
+{
 }
 
 PBR PBRBaker::bake()
 {
+	W3D_PROFILE_SCOPE("PBRBaker::bake");
 	prepare_irradiance();
 	prepare_prefilter();
 	prepare_brdf_lut();
@@ -70,153 +115,184 @@ void PBRBaker::load_cube_model()
 
 void PBRBaker::load_background()
 {
-	std::string       path      = fu::compute_abs_path(fu::FileType::eImage, "papermill.dds");
+	W3D_PROFILE_SCOPE("PBRBaker::load_background");
+	std::string       path      = fu::compute_abs_path(fu::FileType::eImage, BACKGROUND_NAME);
 	ImageTransferInfo img_tinfo = ImageResource::load_cubic_image(path);
 	ImageResource     resource  = ImageResource::create_empty_cubic_img_resrc(device_, img_tinfo.meta);
-
-	CommandBuffer cmd_buf     = device_.begin_one_time_buf();
-	Buffer        staging_buf = device_.get_device_memory_allocator().allocate_staging_buffer(img_tinfo.binary.size());
-	staging_buf.update(img_tinfo.binary);
-
-	cmd_buf.set_image_layout(resource, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eHost, vk::PipelineStageFlagBits::eTransfer);
-
-	cmd_buf.update_image(resource, staging_buf);
-
-	cmd_buf.set_image_layout(resource, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader);
-
-	device_.end_one_time_buf(cmd_buf);
+	upload(resource, img_tinfo.binary);
 
 	vk::SamplerCreateInfo sampler_cinfo = Sampler::linear_clamp_cinfo(device_.get_physical_device(), img_tinfo.meta.levels);
 
 	result_.p_background = std::make_unique<Texture>(std::move(resource), Sampler(device_, sampler_cinfo));
 }
 
+Texture &PBRBaker::get_background()
+{
+	if (!result_.p_background)
+	{
+		load_background();
+	}
+	return *result_.p_background;
+}
+
+CPUBaker &PBRBaker::get_cpu_baker()
+{
+	if (!p_cpu_baker_->has_environment())
+	{
+		W3D_PROFILE_SCOPE("PBRBaker::load_background");
+		p_cpu_baker_->set_environment(ImageResource::load_cubic_image(fu::compute_abs_path(fu::FileType::eImage, BACKGROUND_NAME)));
+	}
+	return *p_cpu_baker_;
+}
+
 void PBRBaker::prepare_irradiance()
 {
-	ImageMetaInfo cube_meta{
+	W3D_PROFILE_SCOPE("PBRBaker::prepare_irradiance");
+
+	// THE COEFFICIENTS ARE PROJECTED FROM THE BACKGROUND AT THIS SIZE, WHICH IS PART OF THE KEY
+	ImageMetaInfo source_meta{
 	    .extent = {
-	        .width  = IRRADIANCE_DIMENSION,
-	        .height = IRRADIANCE_DIMENSION,
+	        .width  = SH_SOURCE_DIMENSION,
+	        .height = SH_SOURCE_DIMENSION,
 	        .depth  = 1,
 	    },
 	    .format = vk::Format::eR32G32B32A32Sfloat,
-	    .levels = max_mip_levels(IRRADIANCE_DIMENSION, IRRADIANCE_DIMENSION),
+	    .levels = 1,
 	};
-	result_.p_irradiance = create_empty_cube_texture(cube_meta);
-	bake_irradiance(cube_meta);
-};
+	uint64_t             key = hash_bake_inputs(source_meta, {"irradiance_sh.comp.spv", "irradiance_sh_reduce.comp.spv"}, true);
+	std::vector<uint8_t> sh  = load_or_bake_binary("irradiance_sh", key, IRRADIANCE_SH_SIZE, [&]() {
+		return p_cpu_baker_ ? get_cpu_baker().bake_irradiance_sh(SH_SOURCE_DIMENSION) : bake_irradiance_sh();
+	});
 
-void PBRBaker::bake_irradiance(ImageMetaInfo &cube_meta)
-{
-	RenderPass           render_pass        = create_color_only_renderpass(cube_meta.format);
-	ImageResource        transfer_src_resrc = create_transfer_src(cube_meta.extent, cube_meta.format);
-	Framebuffer          framebuffer        = create_square_framebuffer(render_pass, transfer_src_resrc.get_view(), cube_meta.extent.width);
-	DescriptorAllocation desc_allocation    = allocate_texture_descriptor(*result_.p_background);
+	result_.p_irradiance_sh = std::make_unique<Buffer>(device_.get_device_memory_allocator().allocate_uniform_buffer(IRRADIANCE_SH_SIZE));
+	result_.p_irradiance_sh->update(sh);
+}
 
-	vk::PushConstantRange push_constant_range{
-	    .stageFlags = vk::ShaderStageFlagBits::eVertex,
+std::vector<uint8_t> PBRBaker::bake_irradiance_sh()
+{
+	Texture &background = get_background();
+
+	// EVERY GROUP SUMS 8x8 TEXELS OF A FACE AND THE LAST ONE ADDS UP ALL THOSE SUMS, THE HOST
+	// READS WHAT IT ADDED UP THEM TO FROM THE END OF THE SAME BUFFER
+	uint32_t       face_groups = SH_SOURCE_DIMENSION / SH_GROUP_SIZE;
+	uint32_t       group_count = 6 * face_groups * face_groups;
+	vk::DeviceSize sums_offset = static_cast<vk::DeviceSize>(group_count) * IRRADIANCE_SH_SIZE;
+
+	vk::BufferCreateInfo buffer_cinfo{};
+	buffer_cinfo.size  = sums_offset + IRRADIANCE_SH_SIZE;
+	buffer_cinfo.usage = vk::BufferUsageFlagBits::eStorageBuffer;
+	VmaAllocationCreateInfo allocation_cinfo{};
+	allocation_cinfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+	allocation_cinfo.usage = VMA_MEMORY_USAGE_AUTO;
+	Buffer sums_buf        = device_.get_device_memory_allocator().allocate_buffer(buffer_cinfo, allocation_cinfo);
+
+	vk::DescriptorImageInfo background_iinfo{
+	    .sampler     = background.sampler.get_handle(),
+	    .imageView   = background.resource.get_view().get_handle(),
+	    .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+	};
+	vk::DescriptorBufferInfo sums_dinfo{
+	    .buffer = sums_buf.get_handle(),
+	    .offset = 0,
+	    .range  = VK_WHOLE_SIZE,
+	};
+	DescriptorAllocation project_allocation = DescriptorBuilder::begin(desc_state_.cache, desc_state_.allocator)
+	                                              .bind_image(0, background_iinfo, vk::DescriptorType::eCombinedImageSampler, vk::ShaderStageFlagBits::eCompute)
+	                                              .bind_buffer(1, sums_dinfo, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+	                                              .build();
+	DescriptorAllocation reduce_allocation = DescriptorBuilder::begin(desc_state_.cache, desc_state_.allocator)
+	                                             .bind_buffer(0, sums_dinfo, vk::DescriptorType::eStorageBuffer, vk::ShaderStageFlagBits::eCompute)
+	                                             .build();
+
+	struct ProjectPCO
+	{
+		uint32_t dimension;
+		float    lod;
+	};
+	vk::PushConstantRange project_push_constant_range{
+	    .stageFlags = vk::ShaderStageFlagBits::eCompute,
 	    .offset     = 0,
-	    .size       = sizeof(glm::mat4),
+	    .size       = sizeof(ProjectPCO),
 	};
-
-	vk::PipelineLayoutCreateInfo pl_layout_cinfo{
+	vk::PipelineLayoutCreateInfo project_pl_layout_cinfo{
 	    .setLayoutCount         = 1,
-	    .pSetLayouts            = &desc_allocation.set_layout,
+	    .pSetLayouts            = &project_allocation.set_layout,
 	    .pushConstantRangeCount = 1,
-	    .pPushConstantRanges    = &push_constant_range,
+	    .pPushConstantRanges    = &project_push_constant_range,
 	};
-
-	GraphicsPipeline pl = create_graphics_pipeline(render_pass, pl_layout_cinfo, "irradiance.vert.spv", "irradiance.frag.spv");
-
-	std::array<vk::ClearValue, 1> clear_values = {
-	    std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f},
+	vk::PushConstantRange reduce_push_constant_range{
+	    .stageFlags = vk::ShaderStageFlagBits::eCompute,
+	    .offset     = 0,
+	    .size       = sizeof(uint32_t),
 	};
-	vk::RenderPassBeginInfo pass_begin_info{
-	    .renderPass  = render_pass.get_handle(),
-	    .framebuffer = framebuffer.get_handle(),
-	    .renderArea  = {
-	         .extent = {
-	             .width  = cube_meta.extent.width,
-	             .height = cube_meta.extent.height,
-            }},
-	    .clearValueCount = to_u32(clear_values.size()),
-	    .pClearValues    = clear_values.data(),
+	vk::PipelineLayoutCreateInfo reduce_pl_layout_cinfo{
+	    .setLayoutCount         = 1,
+	    .pSetLayouts            = &reduce_allocation.set_layout,
+	    .pushConstantRangeCount = 1,
+	    .pPushConstantRanges    = &reduce_push_constant_range,
 	};
-
-	CommandBuffer     bake_buf        = device_.begin_one_time_buf();
-	vk::CommandBuffer bake_buf_handle = bake_buf.get_handle();
-	vk::Viewport      viewport{
-	         .x = 0,
-	         .y = 0,
-    };
-	vk::Rect2D scissor{
-	    .offset = {
-	        .x = 0,
-	        .y = 0,
-	    },
-	    .extent = {
-	        .width  = cube_meta.extent.width,
-	        .height = cube_meta.extent.height,
-	    },
+	ComputePipeline project_pl(device_, "irradiance_sh.comp.spv", project_pl_layout_cinfo);
+	ComputePipeline reduce_pl(device_, "irradiance_sh_reduce.comp.spv", reduce_pl_layout_cinfo);
+
+	// THE BACKGROUND IS READ FROM THE LEVEL CLOSEST TO THE SIZE THE COEFFICIENTS ARE PROJECTED AT
+	uint32_t   background_dimension = background.resource.get_image().get_base_extent().width;
+	ProjectPCO project_pco{
+	    .dimension = SH_SOURCE_DIMENSION,
+	    .lod       = std::max(0.0f, std::log2(static_cast<float>(background_dimension) / SH_SOURCE_DIMENSION)),
 	};
 
-	bake_buf.set_image_layout(result_.p_irradiance->resource, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eHost, vk::PipelineStageFlagBits::eTransfer);
-
-	uint32_t  img_width  = cube_meta.extent.width;
-	uint32_t  img_height = cube_meta.extent.height;
-	glm::mat4 pco        = glm::mat4(1.0f);
+	RenderGraph              graph(device_);
+	RenderGraph::ImageHandle env     = graph.import_image("background", background.resource, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+	RenderGraph::PassHandle  project = graph.add_pass("project_irradiance_sh", RenderGraph::PassType::eCompute, [&](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+		vk::CommandBuffer cmd_buf_h = cmd_buf.get_handle();
+		cmd_buf_h.bindPipeline(vk::PipelineBindPoint::eCompute, project_pl.get_handle());
+		cmd_buf_h.bindDescriptorSets(vk::PipelineBindPoint::eCompute, project_pl.get_pipeline_layout(), 0, project_allocation.set, {});
+		cmd_buf_h.pushConstants<ProjectPCO>(project_pl.get_pipeline_layout(), vk::ShaderStageFlagBits::eCompute, 0, project_pco);
+		cmd_buf_h.dispatch(face_groups, face_groups, 6);
+
+		vk::BufferMemoryBarrier sums_barrier{
+		    .srcAccessMask       = vk::AccessFlagBits::eShaderWrite,
+		    .dstAccessMask       = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite,
+		    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .buffer              = sums_buf.get_handle(),
+		    .offset              = 0,
+		    .size                = VK_WHOLE_SIZE,
+		};
+		cmd_buf_h.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader, {}, {}, sums_barrier, {});
+
+		cmd_buf_h.bindPipeline(vk::PipelineBindPoint::eCompute, reduce_pl.get_handle());
+		cmd_buf_h.bindDescriptorSets(vk::PipelineBindPoint::eCompute, reduce_pl.get_pipeline_layout(), 0, reduce_allocation.set, {});
+		cmd_buf_h.pushConstants<uint32_t>(reduce_pl.get_pipeline_layout(), vk::ShaderStageFlagBits::eCompute, 0, group_count);
+		cmd_buf_h.dispatch(1, 1, 1);
+
+		vk::BufferMemoryBarrier host_barrier{
+		    .srcAccessMask       = vk::AccessFlagBits::eShaderWrite,
+		    .dstAccessMask       = vk::AccessFlagBits::eHostRead,
+		    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .buffer              = sums_buf.get_handle(),
+		    .offset              = sums_offset,
+		    .size                = IRRADIANCE_SH_SIZE,
+		};
+		cmd_buf_h.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost, {}, {}, host_barrier, {});
+	});
+	graph.read_image(project, env, RenderGraph::Access::eSampled);
+	graph.set_side_effects(project);
+	graph.compile();
 
-	for (uint32_t m = 0; m < cube_meta.levels; m++)
-	{
-		img_width  = std::max(1u, cube_meta.extent.width >> m);
-		img_height = std::max(1u, cube_meta.extent.height >> m);
-		for (uint32_t f = 0; f < 6; f++)
-		{
-			viewport.width  = img_width;
-			viewport.height = img_height;
-			pco             = glm::perspective(glm::pi<float>() / 2.0f, 1.0f, 0.1f, 512.0f) * CUBE_FACE_MATRIXS[f];
-			bake_buf_handle.setViewport(0, viewport);
-			bake_buf_handle.setScissor(0, scissor);
-			bake_buf_handle.beginRenderPass(pass_begin_info, vk::SubpassContents::eInline);
-			bake_buf_handle.pushConstants<glm::mat4>(pl.get_pipeline_layout(), vk::ShaderStageFlagBits::eVertex, 0, pco);
-			bake_buf_handle.bindPipeline(vk::PipelineBindPoint::eGraphics, pl.get_handle());
-			bake_buf_handle.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pl.get_pipeline_layout(), 0, desc_allocation.set, {});
-			draw_box(bake_buf);
-			bake_buf_handle.endRenderPass();
-			bake_buf.set_image_layout(transfer_src_resrc, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal);
-
-			vk::ImageCopy copy_region = {
-			    .srcSubresource = {
-			        .aspectMask     = vk::ImageAspectFlagBits::eColor,
-			        .mipLevel       = 0,
-			        .baseArrayLayer = 0,
-			        .layerCount     = 1,
-			    },
-			    .dstSubresource{
-			        .aspectMask     = vk::ImageAspectFlagBits::eColor,
-			        .mipLevel       = m,
-			        .baseArrayLayer = f,
-			        .layerCount     = 1,
-			    },
-			    .extent = {
-			        .width  = img_width,
-			        .height = img_height,
-			        .depth  = 1,
-			    },
-			};
-
-			bake_buf_handle.copyImage(transfer_src_resrc.get_image().get_handle(), vk::ImageLayout::eTransferSrcOptimal, result_.p_irradiance->resource.get_image().get_handle(), vk::ImageLayout::eTransferDstOptimal, copy_region);
-			bake_buf.set_image_layout(transfer_src_resrc, vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eColorAttachmentOptimal);
-		}
-	}
-
-	bake_buf.set_image_layout(result_.p_irradiance->resource, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+	CommandBuffer cmd_buf = device_.begin_one_time_buf();
+	graph.execute(cmd_buf);
+	device_.end_one_time_buf(cmd_buf);
 
-	device_.end_one_time_buf(bake_buf);
+	sums_buf.invalidate();
+	const uint8_t *p_sh = sums_buf.get_mapped_data() + sums_offset;
+	return std::vector<uint8_t>(p_sh, p_sh + IRRADIANCE_SH_SIZE);
 }
 
 void PBRBaker::prepare_prefilter()
 {
+	W3D_PROFILE_SCOPE("PBRBaker::prepare_prefilter");
 	ImageMetaInfo cube_meta{
 	    .extent = {
 	        .width  = PREFILTER_DIMENSION,
@@ -227,24 +303,34 @@ void PBRBaker::prepare_prefilter()
 	    .levels = max_mip_levels(PREFILTER_DIMENSION, PREFILTER_DIMENSION),
 	};
 	result_.p_prefilter = create_empty_cube_texture(cube_meta);
+
+	// HOW MANY SAMPLES IT TAKES CHANGES WHAT'S BAKED, SO IT'S PART OF THE KEY TOO
+	uint64_t key = hash_bake_inputs(cube_meta, {"cube_face.vert.spv", "prefilter.frag.spv"}, true);
+	key          = fnv1a_64(&prefilter_samples_, sizeof(prefilter_samples_), key);
+	load_or_bake(*result_.p_prefilter, cube_meta, "prefilter", key, [&]() {
+		if (p_cpu_baker_)
+		{
+			return get_cpu_baker().bake_prefilter(cube_meta, get_prefilter_sample_counts(cube_meta));
+		}
+		bake_prefilter(cube_meta);
+		return std::vector<uint8_t>();
+	});
 }
 
 void PBRBaker::bake_prefilter(ImageMetaInfo &cube_meta)
 {
-	RenderPass           render_pass        = create_color_only_renderpass(cube_meta.format);
-	ImageResource        transfer_src_resrc = create_transfer_src(cube_meta.extent, cube_meta.format);
-	Framebuffer          framebuffer        = create_square_framebuffer(render_pass, transfer_src_resrc.get_view(), cube_meta.extent.width);
-	DescriptorAllocation desc_allocation    = allocate_texture_descriptor(*result_.p_background);
+	DescriptorAllocation desc_allocation = allocate_texture_descriptor(get_background());
 
 	struct PCO
 	{
 		glm::mat4 proj;
 		float     roughness;
-	} pco;
+		uint32_t  sample_count;
+	};
 	vk::PushConstantRange push_constant_range{
 	    vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment,
 	    0,
-	    sizeof(pco),
+	    sizeof(PCO),
 	};
 
 	vk::PipelineLayoutCreateInfo pl_layout_cinfo{
@@ -254,124 +340,76 @@ void PBRBaker::bake_prefilter(ImageMetaInfo &cube_meta)
 	    .pPushConstantRanges    = &push_constant_range,
 	};
 
-	GraphicsPipeline pl = create_graphics_pipeline(render_pass, pl_layout_cinfo, "prefilter.vert.spv", "prefilter.frag.spv");
-
-	std::array<vk::ClearValue, 1> clear_values = {
-	    std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f},
-	};
-	vk::RenderPassBeginInfo pass_begin_info{
-	    .renderPass  = render_pass.get_handle(),
-	    .framebuffer = framebuffer.get_handle(),
-	    .renderArea  = {
-	         .extent = {
-	             .width  = cube_meta.extent.width,
-	             .height = cube_meta.extent.height,
-            },
-        },
-	    .clearValueCount = to_u32(clear_values.size()),
-	    .pClearValues    = clear_values.data(),
-	};
-
-	CommandBuffer     bake_buf        = device_.begin_one_time_buf();
-	vk::CommandBuffer bake_buf_handle = bake_buf.get_handle();
-	vk::Viewport      viewport{
-	         .x = 0,
-	         .y = 0,
-    };
-	vk::Rect2D scissor{
-	    .offset = {
-	        .x = 0,
-	        .y = 0,
-	    },
-	    .extent = {
-	        .width  = cube_meta.extent.width,
-	        .height = cube_meta.extent.height,
-	    },
-	};
-
-	bake_buf.set_image_layout(result_.p_prefilter->resource, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eHost, vk::PipelineStageFlagBits::eTransfer);
-
-	uint32_t img_width  = cube_meta.extent.width;
-	uint32_t img_height = cube_meta.extent.height;
-	uint32_t div        = 1u;
+	std::vector<uint32_t> sample_counts = get_prefilter_sample_counts(cube_meta);
+	bake_cube(*result_.p_prefilter, cube_meta, pl_layout_cinfo, "cube_face.vert.spv", "prefilter.frag.spv", [&](CommandBuffer &cmd_buf, GraphicsPipeline &pl, uint32_t level) {
+		PCO pco{
+		    .proj         = get_face_projection(),
+		    .roughness    = level / static_cast<float>(cube_meta.levels - 1),
+		    .sample_count = sample_counts[level],
+		};
+		cmd_buf.get_handle().pushConstants<PCO>(pl.get_pipeline_layout(), vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, pco);
+		cmd_buf.get_handle().bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pl.get_pipeline_layout(), 0, desc_allocation.set, {});
+		draw_box(cmd_buf);
+	});
+}
 
+std::vector<uint32_t> PBRBaker::get_prefilter_sample_counts(const ImageMetaInfo &cube_meta) const
+{
+	// THE SAMPLES GROW WITH THE ROUGHNESS, THE ROUGHEST LEVEL TAKES ALL OF prefilter_samples_
+	std::vector<uint32_t> sample_counts(cube_meta.levels);
 	for (uint32_t m = 0; m < cube_meta.levels; m++)
 	{
-		img_width     = std::max(1u, cube_meta.extent.width >> m);
-		img_height    = std::max(1u, cube_meta.extent.height >> m);
-		pco.roughness = m / static_cast<float>(cube_meta.levels - 1);
-		for (uint32_t f = 0; f < 6; f++)
-		{
-			viewport.width  = img_width;
-			viewport.height = img_height;
-			pco.proj        = glm::perspective(glm::pi<float>() / 2.0f, 1.0f, 0.1f, 512.0f) * CUBE_FACE_MATRIXS[f];
-
-			bake_buf_handle.pushConstants<PCO>(pl.get_pipeline_layout(), vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment, 0, pco);
-			bake_buf_handle.setViewport(0, viewport);
-			bake_buf_handle.setScissor(0, scissor);
-			bake_buf_handle.beginRenderPass(pass_begin_info, vk::SubpassContents::eInline);
-			bake_buf_handle.bindPipeline(vk::PipelineBindPoint::eGraphics, pl.get_handle());
-			bake_buf_handle.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pl.get_pipeline_layout(), 0, desc_allocation.set, {});
-			draw_box(bake_buf);
-			bake_buf_handle.endRenderPass();
-
-			vk::ImageCopy copy_region = {
-			    .srcSubresource = {
-			        .aspectMask     = vk::ImageAspectFlagBits::eColor,
-			        .mipLevel       = 0,
-			        .baseArrayLayer = 0,
-			        .layerCount     = 1,
-			    },
-			    .dstSubresource{
-			        .aspectMask     = vk::ImageAspectFlagBits::eColor,
-			        .mipLevel       = m,
-			        .baseArrayLayer = f,
-			        .layerCount     = 1,
-			    },
-			    .extent = {
-			        .width  = img_width,
-			        .height = img_height,
-			        .depth  = 1,
-			    },
-			};
-			transfer_from_src_to_texture(bake_buf, transfer_src_resrc, *result_.p_prefilter, copy_region);
-		}
+		float roughness  = cube_meta.levels > 1 ? m / static_cast<float>(cube_meta.levels - 1) : 0.0f;
+		sample_counts[m] = std::max(static_cast<uint32_t>(std::ceil(prefilter_samples_ * roughness)), 1u);
 	}
-
-	bake_buf.set_image_layout(result_.p_prefilter->resource, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-
-	device_.end_one_time_buf(bake_buf);
+	return sample_counts;
 }
 
 void PBRBaker::prepare_brdf_lut()
 {
-	create_brdf_lut_texture();
+	W3D_PROFILE_SCOPE("PBRBaker::prepare_brdf_lut");
+	ImageMetaInfo meta{
+	    .extent = {
+	        .width  = BRDF_LUT_DIMENSION,
+	        .height = BRDF_LUT_DIMENSION,
+	        .depth  = 1,
+	    },
+	    .format = vk::Format::eR16G16Sfloat,
+	    .levels = 1,
+	};
+	create_brdf_lut_texture(meta);
+
+	// THE LUT ONLY DEPENDS ON THE BRDF, SO ONE BAKE OF IT SERVES EVERY BACKGROUND
+	load_or_bake(*result_.p_brdf_lut, meta, "brdf_lut", hash_bake_inputs(meta, {"brdf_lut.vert.spv", "brdf_lut.frag.spv"}, false), [&]() {
+		if (p_cpu_baker_)
+		{
+			return p_cpu_baker_->bake_brdf_lut(meta);
+		}
+		bake_brdf_lut();
+		return std::vector<uint8_t>();
+	});
 }
 
-void PBRBaker::create_brdf_lut_texture()
+void PBRBaker::create_brdf_lut_texture(const ImageMetaInfo &meta)
 {
 	vk::ImageCreateInfo image_cinfo{
-	    .imageType = vk::ImageType::e2D,
-	    .format    = vk::Format::eR16G16Sfloat,
-	    .extent    = {
-	           .width  = BRDF_LUT_DIMENSION,
-	           .height = BRDF_LUT_DIMENSION,
-	           .depth  = 1,
-        },
-	    .mipLevels   = 1,
+	    .imageType   = vk::ImageType::e2D,
+	    .format      = meta.format,
+	    .extent      = meta.extent,
+	    .mipLevels   = meta.levels,
 	    .arrayLayers = 1,
 	    .samples     = vk::SampleCountFlagBits::e1,
 	    .tiling      = vk::ImageTiling::eOptimal,
-	    .usage       = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled,
+	    .usage       = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst,
 	};
 
 	Image img = device_.get_device_memory_allocator().allocate_device_only_image(image_cinfo);
 
-	vk::ImageViewCreateInfo view_cinfo = ImageView::two_dim_view_cinfo(img.get_handle(), vk::Format::eR16G16Sfloat, vk::ImageAspectFlagBits::eColor, 1);
+	vk::ImageViewCreateInfo view_cinfo = ImageView::two_dim_view_cinfo(img.get_handle(), meta.format, vk::ImageAspectFlagBits::eColor, meta.levels);
 
 	ImageView view = ImageView(device_, view_cinfo);
 
-	vk::SamplerCreateInfo sample_cinfo = Sampler::linear_clamp_cinfo(device_.get_physical_device(), 1);
+	vk::SamplerCreateInfo sample_cinfo = Sampler::linear_clamp_cinfo(device_.get_physical_device(), meta.levels);
 
 	result_.p_brdf_lut = std::make_unique<Texture>(
 	    ImageResource(std::move(img), std::move(view)),
@@ -380,8 +418,19 @@ void PBRBaker::create_brdf_lut_texture()
 
 void PBRBaker::bake_brdf_lut()
 {
-	RenderPass                   render_pass = create_color_only_renderpass(vk::Format::eR16G16Sfloat, vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal);
-	Framebuffer                  framebuffer = create_square_framebuffer(render_pass, result_.p_brdf_lut->resource.get_view(), BRDF_LUT_DIMENSION);
+	RenderGraph                       graph(device_);
+	RenderGraph::ImageHandle          brdf_lut = graph.import_image("brdf_lut", result_.p_brdf_lut->resource, vk::ImageLayout::eShaderReadOnlyOptimal);
+	std::unique_ptr<GraphicsPipeline> p_pl;
+	RenderGraph::PassHandle           draw = graph.add_pass("draw_brdf_lut", RenderGraph::PassType::eGraphics, [&](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+		set_dynamic_states(cmd_buf, context.extent);
+		cmd_buf.get_handle().bindPipeline(vk::PipelineBindPoint::eGraphics, p_pl->get_handle());
+		cmd_buf.get_handle().draw(3, 1, 0, 0);
+	});
+	vk::ClearValue clear_value{std::array<float, 4>{0.54f, 0.81f, 0.94f, 1.0f}};
+	graph.write_color(draw, brdf_lut, clear_value);
+	graph.compile();
+
+	// THE PIPELINE IS MADE FOR THE RENDER PASS THE GRAPH MADE
 	vk::PipelineLayoutCreateInfo pl_layout_cinfo;
 
 	GraphicsPipelineState pl_state{
@@ -396,55 +445,41 @@ void PBRBaker::bake_brdf_lut()
 	        .depth_compare_op   = vk::CompareOp::eLessOrEqual,
 	    },
 	};
-	GraphicsPipeline pl = GraphicsPipeline(device_, render_pass, pl_state, pl_layout_cinfo);
+	p_pl = std::make_unique<GraphicsPipeline>(device_, graph.get_render_pass(draw), pl_state, pl_layout_cinfo, graph.get_subpass(draw));
 
-	vk::ClearValue clear_value = {
-	    .color = {
-	        std::array<float, 4>{0.54f, 0.81f, 0.94f, 1.0f},
-	    },
-	};
+	CommandBuffer bake_buf = device_.begin_one_time_buf();
+	graph.execute(bake_buf);
+	device_.end_one_time_buf(bake_buf);
+}
 
-	vk::RenderPassBeginInfo pass_begin_info{
-	    .renderPass  = render_pass.get_handle(),
-	    .framebuffer = framebuffer.get_handle(),
-	    .renderArea  = {
-	         .extent = {
-	             .width  = BRDF_LUT_DIMENSION,
-	             .height = BRDF_LUT_DIMENSION,
-            },
-        },
-	    .clearValueCount = 1,
-	    .pClearValues    = &clear_value,
-	};
+void PBRBaker::bake_cube(Texture &texture, ImageMetaInfo &cube_meta, vk::PipelineLayoutCreateInfo &pl_layout_cinfo, const char *vert_shader_name, const char *frag_shader_name, DrawLevelFunction draw_level)
+{
+	RenderGraph                          graph(device_);
+	RenderGraph::ImageHandle             cube = graph.import_image("cube", texture.resource, vk::ImageLayout::eShaderReadOnlyOptimal);
+	std::unique_ptr<GraphicsPipeline>    p_pl;
+	std::vector<RenderGraph::PassHandle> draws;
+	vk::ClearValue                       clear_value{std::array<float, 4>{0.0f, 0.0f, 0.0f, 0.0f}};
+
+	// EVERY LEVEL IS DRAWN STRAIGHT INTO THE CUBE, ALL SIX FACES AT ONCE. THE WHOLE CUBE MOVES TO
+	// eColorAttachmentOptimal BEFORE THE FIRST LEVEL AND TO eShaderReadOnlyOptimal AFTER THE
+	// LAST, THE LEVELS DON'T HAVE TO WAIT FOR EACH OTHER
+	for (uint32_t m = 0; m < cube_meta.levels; m++)
+	{
+		RenderGraph::PassHandle draw = graph.add_pass("draw_level", RenderGraph::PassType::eGraphics, [&, m](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+			set_dynamic_states(cmd_buf, context.extent);
+			cmd_buf.get_handle().bindPipeline(vk::PipelineBindPoint::eGraphics, p_pl->get_handle());
+			draw_level(cmd_buf, *p_pl, m);
+		});
+		graph.write_color(draw, cube, clear_value, {vk::ImageAspectFlagBits::eColor, m, 1, 0, 6});
+		draws.push_back(draw);
+	}
+	graph.compile();
 
-	CommandBuffer     bake_buf        = device_.begin_one_time_buf();
-	vk::CommandBuffer bake_buf_handle = bake_buf.get_handle();
-	vk::Viewport      viewport{
-	         .x        = 0,
-	         .y        = 0,
-	         .width    = BRDF_LUT_DIMENSION,
-	         .height   = BRDF_LUT_DIMENSION,
-	         .minDepth = 0,
-	         .maxDepth = 1,
-    };
-	vk::Rect2D scissor{
-	    .offset = {
-	        .x = 0,
-	        .y = 0,
-	    },
-	    .extent = {
-	        .width  = BRDF_LUT_DIMENSION,
-	        .height = BRDF_LUT_DIMENSION,
-	    },
-	};
+	// EVERY LEVEL'S RENDER PASS IS COMPATIBLE WITH THE FIRST ONE'S
+	p_pl = std::make_unique<GraphicsPipeline>(create_graphics_pipeline(graph.get_render_pass(draws[0]), pl_layout_cinfo, vert_shader_name, frag_shader_name));
 
-	bake_buf_handle.beginRenderPass(pass_begin_info, vk::SubpassContents::eInline);
-	bake_buf_handle.setViewport(0, viewport);
-	bake_buf_handle.setScissor(0, scissor);
-	bake_buf_handle.bindPipeline(vk::PipelineBindPoint::eGraphics, pl.get_handle());
-	bake_buf_handle.draw(3, 1, 0, 0);
-	bake_buf_handle.endRenderPass();
-	device_.get_graphics_queue().waitIdle();
+	CommandBuffer bake_buf = device_.begin_one_time_buf();
+	graph.execute(bake_buf);
 	device_.end_one_time_buf(bake_buf);
 }
 
@@ -466,7 +501,7 @@ ImageResource PBRBaker::create_empty_cubic_img_resource(ImageMetaInfo &meta)
 	    .arrayLayers = 6,
 	    .samples     = vk::SampleCountFlagBits::e1,
 	    .tiling      = vk::ImageTiling::eOptimal,
-	    .usage       = vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst,
+	    .usage       = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
 	    .sharingMode = vk::SharingMode::eExclusive,
 	};
 
@@ -477,117 +512,192 @@ ImageResource PBRBaker::create_empty_cubic_img_resource(ImageMetaInfo &meta)
 	return ImageResource(std::move(img), ImageView(device_, view_cinfo));
 }
 
-RenderPass PBRBaker::create_color_only_renderpass(vk::Format format, vk::ImageLayout initial_layout, vk::ImageLayout final_layout)
+GraphicsPipeline PBRBaker::create_graphics_pipeline(RenderPass &render_pass, vk::PipelineLayoutCreateInfo &pl_layout_cinfo, const char *vert_shader_name, const char *frag_shader_name)
 {
-	vk::AttachmentDescription color_attachment = RenderPass::color_attachment(format, initial_layout, final_layout);
-	vk::AttachmentReference   color_ref{
-	      .attachment = 0,
-	      .layout     = vk::ImageLayout::eColorAttachmentOptimal,
-    };
-
-	vk::SubpassDescription subpass_description{
-	    .pipelineBindPoint    = vk::PipelineBindPoint::eGraphics,
-	    .colorAttachmentCount = 1,
-	    .pColorAttachments    = &color_ref,
-	};
+	// THE BOX IS A STATIC MESH, THE DESCRIPTIONS ARE KEPT HERE SO THEY OUTLIVE THE PIPELINE'S CREATION
+	vk::VertexInputBindingDescription                binding_description = sg::get_input_binding_description(sg::VertexFormat::eStatic);
+	std::vector<vk::VertexInputAttributeDescription> attr_descriptions   = sg::get_input_attr_descriptions(sg::VertexFormat::eStatic);
 
-	std::array<vk::SubpassDependency, 2> dependencys;
-	dependencys[0] = vk::SubpassDependency{
-	    .srcSubpass      = VK_SUBPASS_EXTERNAL,
-	    .dstSubpass      = 0,
-	    .srcStageMask    = vk::PipelineStageFlagBits::eBottomOfPipe,
-	    .dstStageMask    = vk::PipelineStageFlagBits::eColorAttachmentOutput,
-	    .srcAccessMask   = vk::AccessFlagBits::eMemoryRead,
-	    .dstAccessMask   = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
-	    .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-	};
-	dependencys[1] = vk::SubpassDependency{
-	    .srcSubpass      = 0,
-	    .dstSubpass      = VK_SUBPASS_EXTERNAL,
-	    .srcStageMask    = vk::PipelineStageFlagBits::eColorAttachmentOutput,
-	    .dstStageMask    = vk::PipelineStageFlagBits::eBottomOfPipe,
-	    .srcAccessMask   = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
-	    .dstAccessMask   = vk::AccessFlagBits::eMemoryRead,
-	    .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-	};
-
-	vk::RenderPassCreateInfo render_pass_cinfo{
-	    .attachmentCount = 1,
-	    .pAttachments    = &color_attachment,
-	    .subpassCount    = 1,
-	    .pSubpasses      = &subpass_description,
-	    .dependencyCount = 2,
-	    .pDependencies   = dependencys.data(),
+	GraphicsPipelineState state{
+	    .vert_shader_name   = vert_shader_name,
+	    .frag_shader_name   = frag_shader_name,
+	    .vertex_input_state = {
+	        .attribute_descriptions = attr_descriptions,
+	        .binding_descriptions   = binding_description,
+	    },
+	    .depth_stencil_state = {
+	        .depth_test_enable  = false,
+	        .depth_write_enable = false,
+	        .depth_compare_op   = vk::CompareOp::eLessOrEqual,
+	    },
 	};
+	return GraphicsPipeline(device_, render_pass, state, pl_layout_cinfo);
+}
 
-	return RenderPass(device_, render_pass_cinfo);
+uint64_t PBRBaker::hash_bake_inputs(const ImageMetaInfo &meta, std::initializer_list<const char *> shader_names, bool uses_background) const
+{
+	uint64_t hash = uses_background ? background_hash_ : fnv1a_64(nullptr, 0);
+	if (cache_directory_.empty())
+	{
+		return hash;
+	}
+	if (p_cpu_baker_)
+	{
+		hash = fnv1a_64(&CPUBaker::VERSION, sizeof(CPUBaker::VERSION), hash);
+	}
+	else
+	{
+		for (const char *shader_name : shader_names)
+		{
+			std::vector<uint8_t> binary = fu::read_shader_binary(shader_name);
+			hash                        = fnv1a_64(binary.data(), binary.size(), hash);
+		}
+	}
+	uint32_t description[] = {meta.extent.width, meta.extent.height, static_cast<uint32_t>(meta.format), meta.levels};
+	return fnv1a_64(description, sizeof(description), hash);
 }
 
-ImageResource PBRBaker::create_transfer_src(vk::Extent3D extent, vk::Format format)
+void PBRBaker::load_or_bake(Texture &texture, const ImageMetaInfo &meta, const char *name, uint64_t key, const std::function<std::vector<uint8_t>()> &bake)
 {
-	vk::ImageCreateInfo transfer_src_cinfo{
-	    .imageType     = vk::ImageType::e2D,
-	    .format        = format,
-	    .extent        = extent,
-	    .mipLevels     = 1,
-	    .arrayLayers   = 1,
-	    .samples       = vk::SampleCountFlagBits::e1,
-	    .tiling        = vk::ImageTiling::eOptimal,
-	    .usage         = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
-	    .sharingMode   = vk::SharingMode::eExclusive,
-	    .initialLayout = vk::ImageLayout::eUndefined,
-	};
+	if (cache_directory_.empty())
+	{
+		std::vector<uint8_t> binary = bake();
+		if (!binary.empty())
+		{
+			upload(texture.resource, binary);
+		}
+		return;
+	}
 
-	Image img = device_.get_device_memory_allocator().allocate_device_only_image(transfer_src_cinfo);
+	std::string          path   = get_cache_path(name, key, ".dds");
+	uint32_t             layers = texture.resource.get_view().get_subresource_range().layerCount;
+	std::vector<uint8_t> binary;
+	if (std::filesystem::exists(path) && gli_load_matching(path, meta, layers, binary))
+	{
+		LOGI("Loaded {} from the bake cache", path);
+		upload(texture.resource, binary);
+		return;
+	}
 
-	vk::ImageViewCreateInfo view_cinfo = ImageView::two_dim_view_cinfo(img.get_handle(), format, vk::ImageAspectFlagBits::eColor, 1);
+	// WHAT WAS BAKED ON THE HOST IS SAVED AS IT IS, WHAT WAS BAKED ON THE GPU IS READ BACK
+	binary = bake();
+	if (binary.empty())
+	{
+		binary = read_back(texture.resource, meta);
+	}
+	else
+	{
+		upload(texture.resource, binary);
+	}
 
-	ImageResource resrc = ImageResource(std::move(img), ImageView(device_, view_cinfo));
+	// A CACHE THAT CAN'T BE WRITTEN ONLY MEANS BAKING AGAIN NEXT TIME
+	std::error_code error;
+	std::filesystem::create_directories(cache_directory_, error);
+	ImageTransferInfo img_tinfo{
+	    .binary = std::move(binary),
+	    .meta   = meta,
+	};
+	if (!gli_save(path, img_tinfo, layers))
+	{
+		LOGW("Unable to save {} to the bake cache", path);
+	}
+}
 
-	CommandBuffer cmd_buf = device_.begin_one_time_buf();
-	cmd_buf.set_image_layout(resrc, vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal);
-	device_.end_one_time_buf(cmd_buf);
+std::vector<uint8_t> PBRBaker::load_or_bake_binary(const char *name, uint64_t key, size_t size, const std::function<std::vector<uint8_t>()> &bake)
+{
+	if (cache_directory_.empty())
+	{
+		return bake();
+	}
 
-	return resrc;
+	std::string path = get_cache_path(name, key, ".bin");
+	if (std::filesystem::exists(path))
+	{
+		std::vector<uint8_t> binary = fu::read_binary(path);
+		if (binary.size() == size)
+		{
+			LOGI("Loaded {} from the bake cache", path);
+			return binary;
+		}
+	}
+
+	std::vector<uint8_t> binary = bake();
+	std::error_code      error;
+	std::filesystem::create_directories(cache_directory_, error);
+	if (!fu::write_binary(path, binary))
+	{
+		LOGW("Unable to save {} to the bake cache", path);
+	}
+	return binary;
 }
 
-Framebuffer PBRBaker::create_square_framebuffer(const RenderPass &render_pass, const ImageView &view, uint32_t dimension)
+std::string PBRBaker::get_cache_path(const char *name, uint64_t key, const char *extension) const
 {
-	vk::ImageView             view_handle = view.get_handle();
-	vk::FramebufferCreateInfo framebuffer_cinfo{
-	    .renderPass      = render_pass.get_handle(),
-	    .attachmentCount = 1,
-	    .pAttachments    = &view_handle,
-	    .width           = dimension,
-	    .height          = dimension,
-	    .layers          = 1,
-	};
-	return Framebuffer(device_, framebuffer_cinfo);
+	std::stringstream path;
+	path << cache_directory_ << "/" << name << "_" << std::hex << std::setw(16) << std::setfill('0') << key << extension;
+	return path.str();
 }
 
-GraphicsPipeline PBRBaker::create_graphics_pipeline(RenderPass &render_pass, vk::PipelineLayoutCreateInfo &pl_layout_cinfo, const char *vert_shader_name, const char *frag_shader_name)
+void PBRBaker::upload(ImageResource &resource, const std::vector<uint8_t> &binary)
 {
-	std::array<vk::VertexInputBindingDescription, 1> binding_descriptions;
-	binding_descriptions[0] = vk::VertexInputBindingDescription{
-	    .binding   = 0,
-	    .stride    = sizeof(sg::Vertex),
-	    .inputRate = vk::VertexInputRate::eVertex,
-	};
+	Buffer staging_buf = device_.get_device_memory_allocator().allocate_staging_buffer(binary.size());
+	staging_buf.update(binary);
 
-	GraphicsPipelineState state{
-	    .vert_shader_name   = vert_shader_name,
-	    .frag_shader_name   = frag_shader_name,
-	    .vertex_input_state = {
-	        .attribute_descriptions = sg::Vertex::get_input_attr_descriptions(),
-	        .binding_descriptions   = binding_descriptions,
-	    },
-	    .depth_stencil_state = {
-	        .depth_test_enable  = false,
-	        .depth_write_enable = false,
-	        .depth_compare_op   = vk::CompareOp::eLessOrEqual,
-	    },
-	};
-	return GraphicsPipeline(device_, render_pass, state, pl_layout_cinfo);
+	RenderGraph              graph(device_);
+	RenderGraph::ImageHandle image  = graph.import_image("image", resource, vk::ImageLayout::eShaderReadOnlyOptimal);
+	RenderGraph::PassHandle  upload = graph.add_pass("upload", RenderGraph::PassType::eTransfer, [&](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+		cmd_buf.update_image(resource, staging_buf);
+	});
+	graph.write_image(upload, image, RenderGraph::Access::eTransferDst);
+	graph.compile();
+
+	CommandBuffer cmd_buf = device_.begin_one_time_buf();
+	graph.execute(cmd_buf);
+	device_.end_one_time_buf(cmd_buf);
+}
+
+std::vector<uint8_t> PBRBaker::read_back(ImageResource &resource, const ImageMetaInfo &meta)
+{
+	// EVERY LEVEL OF EVERY LAYER ONE AFTER THE OTHER, THE WAY update_image READS THEM
+	const vk::ImageSubresourceRange &range      = resource.get_view().get_subresource_range();
+	uint8_t                          pixel_size = ImageResource::format_to_bytes_per_pixel(meta.format);
+	size_t                           size       = 0;
+	for (uint32_t m = 0; m < meta.levels; m++)
+	{
+		size += static_cast<size_t>(meta.extent.width >> m) * (meta.extent.height >> m) * pixel_size;
+	}
+	size *= range.layerCount;
+	Buffer readback_buf = device_.get_device_memory_allocator().allocate_readback_buffer(size);
+
+	// THE IMAGE WAS JUST BAKED, SO WHAT'S IN IT HAS TO BE KEPT
+	RenderGraph              graph(device_);
+	RenderGraph::ImageHandle baked = graph.import_image("baked", resource, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
+	RenderGraph::PassHandle  copy  = graph.add_pass("read_back", RenderGraph::PassType::eTransfer, [&](CommandBuffer &cmd_buf, const RenderGraph::PassContext &context) {
+		std::vector<vk::BufferImageCopy> copy_regions = cmd_buf.full_copy_regions(range, resource.get_image().get_base_extent(), pixel_size);
+		cmd_buf.get_handle().copyImageToBuffer(graph.get_image(baked), vk::ImageLayout::eTransferSrcOptimal, readback_buf.get_handle(), copy_regions);
+
+		vk::BufferMemoryBarrier host_barrier{
+		    .srcAccessMask       = vk::AccessFlagBits::eTransferWrite,
+		    .dstAccessMask       = vk::AccessFlagBits::eHostRead,
+		    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		    .buffer              = readback_buf.get_handle(),
+		    .offset              = 0,
+		    .size                = VK_WHOLE_SIZE,
+		};
+		cmd_buf.get_handle().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, {}, host_barrier, {});
+	});
+	graph.read_image(copy, baked, RenderGraph::Access::eTransferSrc);
+	graph.set_side_effects(copy);
+	graph.compile();
+
+	CommandBuffer cmd_buf = device_.begin_one_time_buf();
+	graph.execute(cmd_buf);
+	device_.end_one_time_buf(cmd_buf);
+
+	readback_buf.invalidate();
+	const uint8_t *p_data = readback_buf.get_mapped_data();
+	return std::vector<uint8_t>(p_data, p_data + size);
 }
 
 DescriptorAllocation PBRBaker::allocate_texture_descriptor(Texture &texture)
@@ -602,17 +712,12 @@ DescriptorAllocation PBRBaker::allocate_texture_descriptor(Texture &texture)
 
 void PBRBaker::draw_box(CommandBuffer &cmd_buf)
 {
-	vk::CommandBuffer cmd_buf_handle = cmd_buf.get_handle();
-	cmd_buf_handle.bindVertexBuffers(0, result_.p_box->p_vertex_buf_->get_handle(), {0});
-	cmd_buf_handle.bindIndexBuffer(result_.p_box->p_idx_buf_->get_handle(), 0, vk::IndexType::eUint32);
-	cmd_buf_handle.drawIndexed(result_.p_box->idx_count_, 1, 0, 0, 0);
-}
-
-void PBRBaker::transfer_from_src_to_texture(CommandBuffer &cmd_buf, ImageResource &src, Texture &texture, vk::ImageCopy copy_region)
-{
-	cmd_buf.set_image_layout(src, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal);
-	cmd_buf.get_handle().copyImage(src.get_image().get_handle(), vk::ImageLayout::eTransferSrcOptimal, texture.resource.get_image().get_handle(), vk::ImageLayout::eTransferDstOptimal, copy_region);
-	cmd_buf.set_image_layout(src, vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eColorAttachmentOptimal);
+	vk::CommandBuffer    cmd_buf_handle = cmd_buf.get_handle();
+	const GeometryArena &arena          = device_.get_geometry_arena();
+	const sg::SubMesh   &box            = *result_.p_box;
+	cmd_buf_handle.bindVertexBuffers(0, arena.get_vertex_buffer(box.vertex_format_).get_handle(), {0});
+	cmd_buf_handle.bindIndexBuffer(arena.get_index_buffer().get_handle(), 0, box.idx_type_);
+	cmd_buf_handle.drawIndexed(box.idx_count_, 1, box.first_index_, box.vertex_offset_, 0);
 }
 
 }        // namespace W3D
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "common/glm_common.hpp"
 
@@ -15,10 +20,12 @@ namespace sg
 class SubMesh;
 }
 class Device;
+class ThreadPool;
+class CPUBaker;
 
+class Buffer;
 class GraphicsPipeline;
 class RenderPass;
-class Framebuffer;
 class PipelineLayout;
 class CommandBuffer;
 
@@ -31,6 +38,13 @@ struct Texture
 	Sampler       sampler;
 };
 
+/*
+* What PBRBaker bakes. Note p_background is only loaded when something had to be baked
+* from it, when everything came from the bake cache it's nullptr. The irradiance isn't a
+* cube but PBRBaker::IRRADIANCE_SH_COUNT spherical harmonics coefficients in a uniform
+* buffer, each a vec4 whose rgb is used, which shaders evaluate for a direction the way
+* skybox.frag does.
+*/
 struct PBR
 {
 	PBR();
@@ -40,7 +54,7 @@ struct PBR
 	PBR &operator=(PBR &&rhs) = default;
 
 	std::unique_ptr<Texture>     p_background;
-	std::unique_ptr<Texture>     p_irradiance;
+	std::unique_ptr<Buffer>      p_irradiance_sh;
 	std::unique_ptr<Texture>     p_prefilter;
 	std::unique_ptr<Texture>     p_brdf_lut;
 	std::unique_ptr<sg::SubMesh> p_box;
@@ -49,40 +63,91 @@ struct PBR
 class PBRBaker
 {
   public:
-	static const uint32_t IRRADIANCE_DIMENSION;
+	static const uint32_t IRRADIANCE_SH_COUNT;        // THE FIRST THREE BANDS
+	static const uint32_t IRRADIANCE_SH_SIZE;         // BYTES OF ALL OF THEM
+	static const uint32_t SH_SOURCE_DIMENSION;        // THE SIZE OF THE BACKGROUND'S FACES THEY'RE PROJECTED FROM
+	static const uint32_t SH_GROUP_SIZE;              // THE local_size_x AND local_size_y OF irradiance_sh.comp
 	static const uint32_t PREFILTER_DIMENSION;
+	static const uint32_t DEFAULT_PREFILTER_SAMPLES;        // PER TEXEL OF THE PREFILTERED CUBE'S ROUGHEST LEVEL
 	static const uint32_t BRDF_LUT_DIMENSION;
-
-	PBRBaker(Device &device);
+	static const char    *BACKGROUND_NAME;        // THE ENVIRONMENT EVERYTHING BUT THE BRDF LUT IS BAKED FROM
+
+	/*
+	* The constructor loads the box the cubes are drawn with. Baked images are loaded from
+	* cache_directory when it has them and saved there when they had to be baked, unless
+	* cache_directory is empty. When p_cpu_thread_pool is given everything is baked on the CPU
+	* by a CPUBaker running on its threads instead of on the GPU, into the same formats.
+	* prefilter_samples is how many samples each texel of the prefiltered cube's roughest level
+	* takes, the smoother levels take fewer, see get_prefilter_sample_counts.
+	*/
+	PBRBaker(Device &device, const std::string &cache_directory = "", ThreadPool *p_cpu_thread_pool = nullptr, uint32_t prefilter_samples = DEFAULT_PREFILTER_SAMPLES);
+	~PBRBaker();
 
 	PBR bake();
 
   private:
-	static const std::vector<glm::mat4> CUBE_FACE_MATRIXS;
-
-	void load_background();
-	void load_cube_model();
-	void prepare_prefilter();
-	void prepare_irradiance();
-	void prepare_brdf_lut();
-	void bake_irradiance(ImageMetaInfo &cube_meta);
-	void bake_prefilter(ImageMetaInfo &cube_meta);
-	void bake_brdf_lut();
+	void                  load_background();
+	void                  load_cube_model();
+	void                  prepare_prefilter();
+	void                  prepare_irradiance();
+	void                  prepare_brdf_lut();
+	std::vector<uint8_t>  bake_irradiance_sh();        // THE COEFFICIENTS AS THEY GO IN p_irradiance_sh
+	void                  bake_prefilter(ImageMetaInfo &cube_meta);
+	void                  bake_brdf_lut();
+
+	/*
+	* How many samples each level of the prefiltered cube takes per texel. The rougher a level,
+	* the wider its lobe and the more samples it takes to cover it. Filtered importance sampling
+	* reads each sample from a level of the background as blurry as the solid angle it stands
+	* for, so the narrow lobes of the smooth levels need only a few, and a mirror only one.
+	*/
+	std::vector<uint32_t> get_prefilter_sample_counts(const ImageMetaInfo &cube_meta) const;
+
+	/*
+	* The bake cache keeps every baked image in a .dds file whose name holds a hash of
+	* everything the image was baked from, its shaders and its size and format, and the
+	* background unless it's the BRDF LUT, which doesn't depend on it. So when any of them
+	* changes the image is baked again, and otherwise it is only uploaded. load_or_bake calls
+	* bake when texture, described by meta, isn't in the cache and then saves it there. bake
+	* either renders into texture and returns nothing, or returns the texels it baked on the
+	* host for load_or_bake to upload. What the CPU bakes is keyed by CPUBaker::VERSION rather
+	* than by the shaders. load_or_bake_binary does the same for what's baked to the host,
+	* size bytes kept as they are in a .bin file.
+	*/
+	uint64_t             hash_bake_inputs(const ImageMetaInfo &meta, std::initializer_list<const char *> shader_names, bool uses_background) const;
+	void                 load_or_bake(Texture &texture, const ImageMetaInfo &meta, const char *name, uint64_t key, const std::function<std::vector<uint8_t>()> &bake);
+	std::vector<uint8_t> load_or_bake_binary(const char *name, uint64_t key, size_t size, const std::function<std::vector<uint8_t>()> &bake);
+	std::string          get_cache_path(const char *name, uint64_t key, const char *extension) const;
+	void                 upload(ImageResource &resource, const std::vector<uint8_t> &binary);
+	std::vector<uint8_t> read_back(ImageResource &resource, const ImageMetaInfo &meta);
+
+	// WHAT DRAWS ALL SIX FACES OF ONE MIP LEVEL OF A CUBE, WITH THE PIPELINE ALREADY BOUND
+	using DrawLevelFunction = std::function<void(CommandBuffer &cmd_buf, GraphicsPipeline &pl, uint32_t level)>;
 
 	void draw_box(CommandBuffer &cmd_buf);
-	void transfer_from_src_to_texture(CommandBuffer &cmd_buf, ImageResource &src, Texture &texture, vk::ImageCopy copy_region);
 
-	RenderPass               create_color_only_renderpass(vk::Format format, vk::ImageLayout initial_layout = vk::ImageLayout::eUndefined, vk::ImageLayout final_layout = vk::ImageLayout::eColorAttachmentOptimal);
-	ImageResource            create_transfer_src(vk::Extent3D extent, vk::Format format);
-	Framebuffer              create_square_framebuffer(const RenderPass &render_pass, const ImageView &view, uint32_t dimension);
+	/*
+	* Renders every mip level of texture, a cube described by cube_meta, with a RenderGraph
+	* that draws each level straight into the cube with one multiview pass, one view per face,
+	* all recorded into one command buffer. The vertex shader must turn the box to the face
+	* gl_ViewIndex says.
+	*/
+	void bake_cube(Texture &texture, ImageMetaInfo &cube_meta, vk::PipelineLayoutCreateInfo &pl_layout_cinfo, const char *vert_shader_name, const char *frag_shader_name, DrawLevelFunction draw_level);
+
 	GraphicsPipeline         create_graphics_pipeline(RenderPass &render_pass, vk::PipelineLayoutCreateInfo &ppl_layout_cinfo, const char *vert_shader_name, const char *frag_shader_name);
+	Texture                 &get_background();        // LOADS THE BACKGROUND THE FIRST TIME IT'S NEEDED
+	CPUBaker                &get_cpu_baker();         // LOADS THE BACKGROUND INTO IT THE FIRST TIME IT'S NEEDED
 	DescriptorAllocation     allocate_texture_descriptor(Texture &texture);
 	std::unique_ptr<Texture> create_empty_cube_texture(ImageMetaInfo &cube_meta);
 	ImageResource            create_empty_cubic_img_resource(ImageMetaInfo &img_tinfo);
-	void                     create_brdf_lut_texture();
-
-	Device         &device_;
-	PBR             result_;
-	DescriptorState desc_state_;
+	void                     create_brdf_lut_texture(const ImageMetaInfo &meta);
+
+	Device                   &device_;
+	PBR                       result_;
+	DescriptorState           desc_state_;
+	std::string               cache_directory_;
+	uint64_t                  background_hash_ = 0;        // OF THE BACKGROUND'S FILE
+	std::unique_ptr<CPUBaker> p_cpu_baker_;                // nullptr WHEN BAKING ON THE GPU
+	uint32_t                  prefilter_samples_;
 };
 }        // namespace W3D
@@ -0,0 +1,421 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "bvh.hpp"
+
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cassert>
+
+// OUR OWN TYPES
+#include "components/aabb.hpp"
+#include "frustum.hpp"
+
+namespace W3D::sg
+{
+
+const uint32_t BVH::NULL_PROXY = std::numeric_limits<uint32_t>::max();
+const float    BVH::FAT_MARGIN = 0.1f;
+
+// THE COST OF A BOX IN THE TREE, BIGGER BOXES GET VISITED BY MORE QUERIES
+static float surface_area(const glm::vec3 &min, const glm::vec3 &max)
+{
+	glm::vec3 d = max - min;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static bool overlaps(const glm::vec3 &a_min, const glm::vec3 &a_max, const glm::vec3 &b_min, const glm::vec3 &b_max)
+{
+	return glm::all(glm::lessThanEqual(a_min, b_max)) && glm::all(glm::lessThanEqual(b_min, a_max));
+}
+
+// SLAB TEST, SETS t TO WHERE THE RAY ENTERS THE BOX, OR 0 IF IT STARTS INSIDE IT
+static bool ray_hits(const glm::vec3 &origin, const glm::vec3 &inv_direction, float max_t, const glm::vec3 &min, const glm::vec3 &max, float &t)
+{
+	glm::vec3 t_0   = (min - origin) * inv_direction;
+	glm::vec3 t_1   = (max - origin) * inv_direction;
+	glm::vec3 t_min = glm::min(t_0, t_1);
+	glm::vec3 t_max = glm::max(t_0, t_1);
+	float     enter = std::max({t_min.x, t_min.y, t_min.z, 0.0f});
+	float     exit  = std::min({t_max.x, t_max.y, t_max.z, max_t});
+	t               = enter;
+	return enter <= exit;
+}
+
+uint32_t BVH::allocate_node()
+{
+	uint32_t idx;
+	if (free_list_ != NULL_PROXY)
+	{
+		idx        = free_list_;
+		free_list_ = nodes_[idx].parent;
+	}
+	else
+	{
+		idx = static_cast<uint32_t>(nodes_.size());
+		nodes_.emplace_back();
+	}
+	nodes_[idx] = TreeNode{.height = 0};
+	return idx;
+}
+
+void BVH::free_node(uint32_t idx)
+{
+	nodes_[idx].parent = free_list_;
+	nodes_[idx].height = -1;
+	free_list_         = idx;
+}
+
+void BVH::insert_leaf(uint32_t leaf)
+{
+	if (root_ == NULL_PROXY)
+	{
+		root_               = leaf;
+		nodes_[leaf].parent = NULL_PROXY;
+		return;
+	}
+
+	// FIND THE CHEAPEST NODE TO PAIR THE LEAF WITH BY WALKING DOWN THE TREE, AT EACH STEP
+	// EITHER STOPPING HERE OR GOING INTO THE CHILD THAT GROWS THE LEAST
+	glm::vec3 leaf_min = nodes_[leaf].fat_min;
+	glm::vec3 leaf_max = nodes_[leaf].fat_max;
+	uint32_t  idx      = root_;
+	while (!nodes_[idx].is_leaf())
+	{
+		const TreeNode &node          = nodes_[idx];
+		float           area          = surface_area(node.fat_min, node.fat_max);
+		float           combined_area = surface_area(glm::min(node.fat_min, leaf_min), glm::max(node.fat_max, leaf_max));
+
+		// PAIRING HERE MAKES A NEW PARENT, AND EVERY ANCESTOR GROWS BY THE SAME AMOUNT
+		// WHEREVER BELOW HERE THE LEAF ENDS UP
+		float cost        = 2.0f * combined_area;
+		float inheritance = 2.0f * (combined_area - area);
+
+		auto child_cost = [&](uint32_t child) {
+			const TreeNode &c        = nodes_[child];
+			float           new_area = surface_area(glm::min(c.fat_min, leaf_min), glm::max(c.fat_max, leaf_max));
+			float           old_area = c.is_leaf() ? 0.0f : surface_area(c.fat_min, c.fat_max);
+			return new_area - old_area + inheritance;
+		};
+		float left_cost  = child_cost(node.left);
+		float right_cost = child_cost(node.right);
+
+		if (cost < left_cost && cost < right_cost)
+		{
+			break;
+		}
+		idx = left_cost < right_cost ? node.left : node.right;
+	}
+
+	// MAKE A NEW PARENT FOR THE LEAF AND ITS SIBLING WHERE THE SIBLING WAS
+	uint32_t sibling           = idx;
+	uint32_t old_parent        = nodes_[sibling].parent;
+	uint32_t new_parent        = allocate_node();
+	nodes_[new_parent].parent  = old_parent;
+	nodes_[new_parent].left    = sibling;
+	nodes_[new_parent].right   = leaf;
+	nodes_[new_parent].fat_min = glm::min(nodes_[sibling].fat_min, leaf_min);
+	nodes_[new_parent].fat_max = glm::max(nodes_[sibling].fat_max, leaf_max);
+	nodes_[new_parent].height  = nodes_[sibling].height + 1;
+	nodes_[sibling].parent     = new_parent;
+	nodes_[leaf].parent        = new_parent;
+
+	if (old_parent == NULL_PROXY)
+	{
+		root_ = new_parent;
+	}
+	else if (nodes_[old_parent].left == sibling)
+	{
+		nodes_[old_parent].left = new_parent;
+	}
+	else
+	{
+		nodes_[old_parent].right = new_parent;
+	}
+
+	refit_ancestors(new_parent);
+}
+
+void BVH::remove_leaf(uint32_t leaf)
+{
+	if (leaf == root_)
+	{
+		root_ = NULL_PROXY;
+		return;
+	}
+
+	// THE LEAF'S PARENT GOES AWAY AND ITS SIBLING TAKES THE PARENT'S PLACE
+	uint32_t parent       = nodes_[leaf].parent;
+	uint32_t grand_parent = nodes_[parent].parent;
+	uint32_t sibling      = nodes_[parent].left == leaf ? nodes_[parent].right : nodes_[parent].left;
+	free_node(parent);
+
+	nodes_[sibling].parent = grand_parent;
+	if (grand_parent == NULL_PROXY)
+	{
+		root_ = sibling;
+		return;
+	}
+
+	if (nodes_[grand_parent].left == parent)
+	{
+		nodes_[grand_parent].left = sibling;
+	}
+	else
+	{
+		nodes_[grand_parent].right = sibling;
+	}
+	refit_ancestors(grand_parent);
+}
+
+void BVH::refit_ancestors(uint32_t idx)
+{
+	while (idx != NULL_PROXY)
+	{
+		idx = balance(idx);
+
+		TreeNode       &node  = nodes_[idx];
+		const TreeNode &left  = nodes_[node.left];
+		const TreeNode &right = nodes_[node.right];
+		node.fat_min          = glm::min(left.fat_min, right.fat_min);
+		node.fat_max          = glm::max(left.fat_max, right.fat_max);
+		node.height           = 1 + std::max(left.height, right.height);
+
+		idx = node.parent;
+	}
+}
+
+uint32_t BVH::balance(uint32_t a)
+{
+	// IF ONE CHILD OF a IS MORE THAN ONE LEVEL TALLER THAN THE OTHER WE ROTATE IT UP INTO
+	// a'S PLACE, AND a TAKES THE PLACE OF ITS SHORTER GRANDCHILD
+	TreeNode &node_a = nodes_[a];
+	if (node_a.is_leaf() || node_a.height < 2)
+	{
+		return a;
+	}
+
+	int32_t imbalance = nodes_[node_a.right].height - nodes_[node_a.left].height;
+	if (imbalance >= -1 && imbalance <= 1)
+	{
+		return a;
+	}
+
+	uint32_t  b      = imbalance > 1 ? node_a.left : node_a.right;        // THE CHILD THAT STAYS
+	uint32_t  c      = imbalance > 1 ? node_a.right : node_a.left;        // THE CHILD THAT ROTATES UP
+	TreeNode &node_c = nodes_[c];
+	uint32_t  f      = node_c.left;
+	uint32_t  g      = node_c.right;
+
+	// c TAKES a'S PLACE
+	node_c.parent = node_a.parent;
+	node_a.parent = c;
+	if (node_c.parent == NULL_PROXY)
+	{
+		root_ = c;
+	}
+	else if (nodes_[node_c.parent].left == a)
+	{
+		nodes_[node_c.parent].left = c;
+	}
+	else
+	{
+		nodes_[node_c.parent].right = c;
+	}
+
+	// a BECOMES A CHILD OF c, KEEPING b AND TAKING c'S SHORTER CHILD, c KEEPS THE TALLER ONE
+	uint32_t taller        = nodes_[f].height > nodes_[g].height ? f : g;
+	uint32_t shorter       = taller == f ? g : f;
+	node_c.left            = a;
+	node_c.right           = taller;
+	node_a.left            = b;
+	node_a.right           = shorter;
+	nodes_[shorter].parent = a;
+
+	node_a.fat_min = glm::min(nodes_[b].fat_min, nodes_[shorter].fat_min);
+	node_a.fat_max = glm::max(nodes_[b].fat_max, nodes_[shorter].fat_max);
+	node_a.height  = 1 + std::max(nodes_[b].height, nodes_[shorter].height);
+	node_c.fat_min = glm::min(node_a.fat_min, nodes_[taller].fat_min);
+	node_c.fat_max = glm::max(node_a.fat_max, nodes_[taller].fat_max);
+	node_c.height  = 1 + std::max(node_a.height, nodes_[taller].height);
+
+	return c;
+}
+
+uint32_t BVH::insert(Node &node, const AABB &bounds, uint32_t user_index)
+{
+	uint32_t  leaf       = allocate_node();
+	TreeNode &tree_node  = nodes_[leaf];
+	tree_node.min        = bounds.get_min();
+	tree_node.max        = bounds.get_max();
+	tree_node.fat_min    = tree_node.min - glm::vec3(FAT_MARGIN);
+	tree_node.fat_max    = tree_node.max + glm::vec3(FAT_MARGIN);
+	tree_node.p_node     = &node;
+	tree_node.user_index = user_index;
+	insert_leaf(leaf);
+	leaf_count_++;
+	return leaf;
+}
+
+void BVH::remove(uint32_t proxy)
+{
+	assert(proxy < nodes_.size() && nodes_[proxy].is_leaf());
+	remove_leaf(proxy);
+	free_node(proxy);
+	leaf_count_--;
+}
+
+bool BVH::move(uint32_t proxy, const AABB &bounds)
+{
+	assert(proxy < nodes_.size() && nodes_[proxy].is_leaf());
+	TreeNode &leaf = nodes_[proxy];
+	leaf.min       = bounds.get_min();
+	leaf.max       = bounds.get_max();
+	if (glm::all(glm::lessThanEqual(leaf.fat_min, leaf.min)) && glm::all(glm::lessThanEqual(leaf.max, leaf.fat_max)))
+	{
+		return false;
+	}
+
+	remove_leaf(proxy);
+	nodes_[proxy].fat_min = nodes_[proxy].min - glm::vec3(FAT_MARGIN);
+	nodes_[proxy].fat_max = nodes_[proxy].max + glm::vec3(FAT_MARGIN);
+	insert_leaf(proxy);
+	return true;
+}
+
+void BVH::clear()
+{
+	nodes_.clear();
+	root_       = NULL_PROXY;
+	free_list_  = NULL_PROXY;
+	leaf_count_ = 0;
+}
+
+size_t BVH::size() const
+{
+	return leaf_count_;
+}
+
+Node *BVH::get_node(uint32_t proxy) const
+{
+	return nodes_[proxy].p_node;
+}
+
+uint32_t BVH::get_user_index(uint32_t proxy) const
+{
+	return nodes_[proxy].user_index;
+}
+
+void BVH::query(const Frustum &frustum, std::vector<uint32_t> &proxies) const
+{
+	if (root_ == NULL_PROXY)
+	{
+		return;
+	}
+
+	uint32_t stack[MAX_DEPTH];
+	uint32_t stack_size = 0;
+	stack[stack_size++] = root_;
+	while (stack_size > 0)
+	{
+		const TreeNode &node = nodes_[stack[--stack_size]];
+		if (!frustum.intersects(node.fat_min, node.fat_max))
+		{
+			continue;
+		}
+
+		if (node.is_leaf())
+		{
+			if (frustum.intersects(node.min, node.max))
+			{
+				proxies.push_back(static_cast<uint32_t>(&node - nodes_.data()));
+			}
+		}
+		else
+		{
+			assert(stack_size + 2 <= MAX_DEPTH);
+			stack[stack_size++] = node.left;
+			stack[stack_size++] = node.right;
+		}
+	}
+}
+
+void BVH::query(const AABB &box, std::vector<uint32_t> &proxies) const
+{
+	if (root_ == NULL_PROXY)
+	{
+		return;
+	}
+
+	glm::vec3 box_min = box.get_min();
+	glm::vec3 box_max = box.get_max();
+	uint32_t  stack[MAX_DEPTH];
+	uint32_t  stack_size = 0;
+	stack[stack_size++]  = root_;
+	while (stack_size > 0)
+	{
+		const TreeNode &node = nodes_[stack[--stack_size]];
+		if (!overlaps(node.fat_min, node.fat_max, box_min, box_max))
+		{
+			continue;
+		}
+
+		if (node.is_leaf())
+		{
+			if (overlaps(node.min, node.max, box_min, box_max))
+			{
+				proxies.push_back(static_cast<uint32_t>(&node - nodes_.data()));
+			}
+		}
+		else
+		{
+			assert(stack_size + 2 <= MAX_DEPTH);
+			stack[stack_size++] = node.left;
+			stack[stack_size++] = node.right;
+		}
+	}
+}
+
+BVH::RayHit BVH::ray_cast(const glm::vec3 &origin, const glm::vec3 &direction, float max_t) const
+{
+	RayHit hit;
+	if (root_ == NULL_PROXY)
+	{
+		return hit;
+	}
+
+	// DIVIDING BY A 0 COMPONENT GIVES INFINITY, WHICH THE SLAB TEST HANDLES
+	glm::vec3 inv_direction = 1.0f / direction;
+	float     closest_t     = max_t;
+	uint32_t  stack[MAX_DEPTH];
+	uint32_t  stack_size = 0;
+	stack[stack_size++]  = root_;
+	while (stack_size > 0)
+	{
+		const TreeNode &node = nodes_[stack[--stack_size]];
+		float           t;
+		if (!ray_hits(origin, inv_direction, closest_t, node.fat_min, node.fat_max, t))
+		{
+			continue;
+		}
+
+		if (node.is_leaf())
+		{
+			// EVERY HIT SHRINKS closest_t, SO BOXES FURTHER AWAY THAN IT ARE SKIPPED
+			if (ray_hits(origin, inv_direction, closest_t, node.min, node.max, t))
+			{
+				closest_t      = t;
+				hit.p_node     = node.p_node;
+				hit.user_index = node.user_index;
+				hit.t          = t;
+			}
+		}
+		else
+		{
+			assert(stack_size + 2 <= MAX_DEPTH);
+			stack[stack_size++] = node.left;
+			stack[stack_size++] = node.right;
+		}
+	}
+	return hit;
+}
+
+}	// namespace W3D::sg
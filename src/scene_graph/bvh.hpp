@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common/glm_common.hpp"
+
+namespace W3D::sg
+{
+
+class AABB;
+class Frustum;
+class Node;
+
+/*
+* BVH - a bounding volume hierarchy, which is a binary tree of boxes where every box
+* encloses the boxes below it and each leaf holds the world space box of one scene node.
+* Queries only descend into boxes they touch, so they take O(log n) time instead of having
+* to test every node. The tree is dynamic: nodes can be inserted, removed and moved one at
+* a time while it is kept balanced, the same way Box2D's b2DynamicTree does it.
+*
+* Every leaf is given a box a little bigger than its node, so a node that only moves a
+* little stays inside it and doesn't have to be moved in the tree, queries still test the
+* node's exact box before reporting it though.
+*/
+class BVH
+{
+  public:
+	// RETURNED BY insert, AND STORED IN PLACE OF A CHILD OR PARENT, WHEN THERE IS NONE
+	static const uint32_t NULL_PROXY;
+
+	// HOW MUCH BIGGER THAN ITS NODE, ON EVERY SIDE, A LEAF'S BOX IS MADE
+	static const float FAT_MARGIN;
+
+	// THE CLOSEST NODE A RAY HIT, p_node IS nullptr IF IT HIT NOTHING
+	struct RayHit
+	{
+		Node    *p_node     = nullptr;
+		uint32_t user_index = 0;
+		float    t          = 0.0f;        // HOW FAR ALONG THE RAY'S DIRECTION THE HIT IS
+	};
+
+  private:
+	struct TreeNode
+	{
+		glm::vec3 fat_min;                    // THE BOX QUERIES DESCEND INTO
+		glm::vec3 fat_max;
+		glm::vec3 min;                        // THE NODE'S EXACT BOX, LEAVES ONLY
+		glm::vec3 max;
+		Node     *p_node     = nullptr;        // THE SCENE NODE, LEAVES ONLY
+		uint32_t  user_index = 0;             // WHATEVER THE OWNER WANTS TO REMEMBER, LEAVES ONLY
+		uint32_t  parent     = NULL_PROXY;    // ALSO THE NEXT FREE NODE WHILE ON THE FREE LIST
+		uint32_t  left       = NULL_PROXY;
+		uint32_t  right      = NULL_PROXY;
+		int32_t   height     = -1;            // 0 FOR LEAVES, -1 WHILE ON THE FREE LIST
+
+		bool is_leaf() const
+		{
+			return left == NULL_PROXY;
+		}
+	};
+
+	// NO TREE WE COULD EVER BUILD IS DEEPER THAN THIS, AS IT'S KEPT BALANCED
+	static const uint32_t MAX_DEPTH = 128;
+
+	std::vector<TreeNode> nodes_;
+	uint32_t              root_      = NULL_PROXY;
+	uint32_t              free_list_ = NULL_PROXY;
+	size_t                leaf_count_ = 0;
+
+	uint32_t allocate_node();
+	void     free_node(uint32_t idx);
+	void     insert_leaf(uint32_t leaf);
+	void     remove_leaf(uint32_t leaf);
+	void     refit_ancestors(uint32_t idx);
+	uint32_t balance(uint32_t idx);
+
+  public:
+	/*
+	* Adds node, whose world space box is bounds, to the tree. user_index is handed back
+	* with the node by queries, which is handy for finding what the caller keeps about it.
+	* Returns the proxy needed to move or remove the node later.
+	*/
+	uint32_t insert(Node &node, const AABB &bounds, uint32_t user_index = 0);
+
+	/*
+	* Takes the node with proxy out of the tree, proxy is not valid afterwards.
+	*/
+	void remove(uint32_t proxy);
+
+	/*
+	* Tells the tree the node with proxy now has the world space box bounds. If it's still
+	* inside its leaf's box only the leaf is updated, otherwise it is removed and inserted
+	* again. Returns true if it had to be moved in the tree.
+	*/
+	bool move(uint32_t proxy, const AABB &bounds);
+
+	/*
+	* Takes every node out of the tree.
+	*/
+	void clear();
+
+	/*
+	* Accessor method for getting the number of nodes in the tree.
+	*/
+	size_t size() const;
+
+	/*
+	* Accessor methods for getting what was given to insert for proxy.
+	*/
+	Node    *get_node(uint32_t proxy) const;
+	uint32_t get_user_index(uint32_t proxy) const;
+
+	/*
+	* Appends to proxies the proxy of every node whose box is at least partly inside
+	* frustum. Note proxies isn't cleared first.
+	*/
+	void query(const Frustum &frustum, std::vector<uint32_t> &proxies) const;
+
+	/*
+	* Appends to proxies the proxy of every node whose box overlaps box. Note proxies isn't
+	* cleared first.
+	*/
+	void query(const AABB &box, std::vector<uint32_t> &proxies) const;
+
+	/*
+	* Finds the closest node whose box the ray starting at origin and heading along
+	* direction hits within max_t, for example to pick what's under the mouse.
+	*/
+	RayHit ray_cast(const glm::vec3 &origin, const glm::vec3 &direction, float max_t = std::numeric_limits<float>::max()) const;
+
+};	// class BVH
+
+}	// namespace W3D::sg
@@ -37,7 +37,7 @@ void AABB::update(const AABB &other)
 	max_ = glm::max(other.max_, max_);
 }
 
-AABB AABB::transform(glm::mat4 &T) const
+AABB AABB::transform(const glm::mat4 &T) const
 {
 	float     a, b;
 	glm::vec3 new_min, new_max;
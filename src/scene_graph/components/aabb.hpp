@@ -62,7 +62,7 @@ class AABB : public Component
 		
 		Returns a new AABB that encloses the transformed AABB
 	*/
-	AABB      transform(glm::mat4 &T) const;
+	AABB      transform(const glm::mat4 &T) const;
 
 	/*
 	 * This function tests to see if other overlaps with
@@ -1,49 +1,106 @@
 // IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
 #include "submesh.hpp"
 
+// C/C++ LANGUAGE API TYPES
+#include <algorithm>
+#include <cstddef>
+
+#include <glm/gtc/packing.hpp>
+
 // OUR OWN TYPES
 #include "common/vk_common.hpp"
-#include "core/device_memory/buffer.hpp"
+#include "core/geometry_arena.hpp"
 #include "material.hpp"
 
 namespace W3D::sg
 {
 
-std::array<vk::VertexInputAttributeDescription, 5> Vertex::get_input_attr_descriptions()
+uint32_t Vertex::encode_octahedral(const glm::vec3 &normal)
 {
-	std::array<vk::VertexInputAttributeDescription, 5> descriptions;
-	descriptions[0] = {
-	    .location = 0,
-	    .binding  = 0,
-	    .format   = vk::Format::eR32G32B32Sfloat,
-	    .offset   = offsetof(Vertex, pos),
-	};
-	descriptions[1] = {
-	    .location = 1,
-	    .binding  = 0,
-	    .format   = vk::Format::eR32G32B32Sfloat,
-	    .offset   = offsetof(Vertex, norm),
+	// PROJECT ONTO THE OCTAHEDRON |x| + |y| + |z| = 1, THEN FOLD ITS LOWER HALF OVER THE UPPER ONE
+	glm::vec3 n       = normal / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+	glm::vec2 encoded = glm::vec2(n);
+	if (n.z < 0.0f)
+	{
+		glm::vec2 signs(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+		encoded = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * signs;
+	}
+	return glm::packSnorm2x16(encoded);
+}
+
+uint32_t get_vertex_stride(VertexFormat format)
+{
+	return format == VertexFormat::eSkinned ? sizeof(SkinnedVertex) : sizeof(Vertex);
+}
+
+std::vector<vk::VertexInputAttributeDescription> get_input_attr_descriptions(VertexFormat format)
+{
+	// SKINNED VERTICES START WITH A STATIC ONE, SO THE FIRST THREE ATTRIBUTES ARE THE SAME
+	std::vector<vk::VertexInputAttributeDescription> descriptions = {
+	    {
+	        .location = 0,
+	        .binding  = 0,
+	        .format   = vk::Format::eR32G32B32Sfloat,
+	        .offset   = offsetof(Vertex, pos),
+	    },
+	    {
+	        .location = 1,
+	        .binding  = 0,
+	        .format   = vk::Format::eR16G16Snorm,
+	        .offset   = offsetof(Vertex, norm),
+	    },
+	    {
+	        .location = 2,
+	        .binding  = 0,
+	        .format   = vk::Format::eR16G16Sfloat,
+	        .offset   = offsetof(Vertex, uv),
+	    },
 	};
-	descriptions[2] = {
-	    .location = 2,
-	    .binding  = 0,
-	    .format   = vk::Format::eR32G32Sfloat,
-	    .offset   = offsetof(Vertex, uv),
+	if (format == VertexFormat::eSkinned)
+	{
+		descriptions.push_back({
+		    .location = 3,
+		    .binding  = 0,
+		    .format   = vk::Format::eR16G16B16A16Uint,
+		    .offset   = offsetof(SkinnedVertex, joint),
+		});
+		descriptions.push_back({
+		    .location = 4,
+		    .binding  = 0,
+		    .format   = vk::Format::eR16G16B16A16Unorm,
+		    .offset   = offsetof(SkinnedVertex, weight),
+		});
+	}
+	return descriptions;
+}
+
+vk::VertexInputBindingDescription get_input_binding_description(VertexFormat format)
+{
+	return vk::VertexInputBindingDescription{
+	    .binding   = 0,
+	    .stride    = get_vertex_stride(format),
+	    .inputRate = vk::VertexInputRate::eVertex,
 	};
-	descriptions[3] = {
-	    .location = 3,
+}
+
+vk::VertexInputAttributeDescription get_position_attr_description()
+{
+	return vk::VertexInputAttributeDescription{
+	    .location = 0,
 	    .binding  = 0,
-	    .format   = vk::Format::eR32G32B32A32Sfloat,
-	    .offset   = offsetof(Vertex, joint),
+	    .format   = vk::Format::eR32G32B32Sfloat,
+	    .offset   = 0,
 	};
-	descriptions[4] = {
-	    .location = 4,
-	    .binding  = 0,
-	    .format   = vk::Format::eR32G32B32A32Sfloat,
-	    .offset   = offsetof(Vertex, weight),
+}
+
+vk::VertexInputBindingDescription get_position_binding_description()
+{
+	return vk::VertexInputBindingDescription{
+	    .binding   = 0,
+	    .stride    = sizeof(glm::vec3),
+	    .inputRate = vk::VertexInputRate::eVertex,
 	};
-	return descriptions;
-};
+}
 
 SubMesh::SubMesh(const std::string &name) :
     Component(name)
@@ -51,7 +108,24 @@ SubMesh::SubMesh(const std::string &name) :
 }
 
 SubMesh::~SubMesh()
-{}
+{
+	if (p_geometry_arena_)
+	{
+		uint32_t idx_count = idx_count_;
+		for (const SubMeshLod &lod : lods_)
+		{
+			idx_count += lod.idx_count;
+		}
+		p_geometry_arena_->free({
+		    .vertex_format = vertex_format_,
+		    .vertex_offset = vertex_offset_,
+		    .vertex_count  = vertex_count_,
+		    .first_index   = first_index_,
+		    .idx_count     = idx_count,
+		    .idx_type      = idx_type_,
+		});
+	}
+}
 
 std::type_index SubMesh::get_type()
 {
@@ -68,4 +142,18 @@ const Material *SubMesh::get_material() const
 	return p_material_;
 }
 
+uint32_t SubMesh::get_lod_count() const
+{
+	return static_cast<uint32_t>(lods_.size()) + 1;
+}
+
+SubMeshLod SubMesh::get_lod(uint32_t level) const
+{
+	if (level == 0 || lods_.empty())
+	{
+		return {first_index_, idx_count_};
+	}
+	return lods_[std::min<size_t>(level, lods_.size()) - 1];
+}
+
 }        // namespace W3D::sg
\ No newline at end of file
@@ -1,36 +1,104 @@
 #pragma once
 
 #include "common/glm_common.hpp"
+#include "common/vk_common.hpp"
 #include "scene_graph/component.hpp"
 #include <memory>
-
-namespace vk
-{
-struct VertexInputAttributeDescription;
-}
+#include <vector>
 
 namespace W3D
 {
 class Device;
-class Buffer;
+class GeometryArena;
 namespace sg
 {
 
+/*
+* The vertex layouts a SubMesh can have. Every layout starts with the same attributes in the
+* same formats, so the same vertex shaders read them all, and only meshes that are actually
+* skinned pay for joints and weights.
+*/
+enum class VertexFormat : uint32_t
+{
+	eStatic  = 0,
+	eSkinned = 1,
+	eCount   = 2,
+};
+
+/*
+* The vertex of a static mesh, 20 bytes. The normal is octahedral encoded into two 16 bit
+* snorms, which the vertex shaders decode, and the uv is two half floats.
+*/
 struct Vertex
 {
 	glm::vec3 pos;
-	glm::vec3 norm;
-	glm::vec2 uv;
-	glm::vec4 joint;
-	glm::vec4 weight;
+	uint32_t  norm;        // SEE encode_octahedral
+	uint32_t  uv;          // glm::packHalf2x16
 
-	static std::array<vk::VertexInputAttributeDescription, 5> get_input_attr_descriptions();
+	/*
+	* Packs the unit vector normal into two snorms, the octahedron it's projected onto is
+	* folded flat so the whole sphere fits in the square.
+	*/
+	static uint32_t encode_octahedral(const glm::vec3 &normal);
+};
+
+/*
+* The vertex of a skinned mesh, 36 bytes, the joints are indices and the weights unorms.
+*/
+struct SkinnedVertex
+{
+	Vertex   base;
+	uint16_t joint[4];
+	uint16_t weight[4];
+};
+
+/*
+* The size of one vertex with format.
+*/
+uint32_t get_vertex_stride(VertexFormat format);
+
+/*
+* What a pipeline drawing vertices with format needs to know to read them from binding 0.
+*/
+std::vector<vk::VertexInputAttributeDescription> get_input_attr_descriptions(VertexFormat format);
+vk::VertexInputBindingDescription                get_input_binding_description(VertexFormat format);
+
+/*
+* The same for a pipeline that only reads positions, from binding 0 of one of the geometry
+* arena's position buffers, which look the same for every vertex format.
+*/
+vk::VertexInputAttributeDescription get_position_attr_description();
+vk::VertexInputBindingDescription   get_position_binding_description();
+
+/*
+* The per instance data of an instanced draw. Every frame all of it is written to one storage
+* buffer that the vertex shaders index with gl_InstanceIndex, so one draw can place the same
+* SubMesh many times. The normal matrix, the inverse transpose of model, is worked out here
+* once per object instead of once per vertex.
+*/
+struct Instance
+{
+	glm::mat4 model;
+	glm::mat4 normal;        // ONLY THE UPPER 3x3 IS USED, A mat4 KEEPS THE std430 LAYOUT SIMPLE
+};
+
+/*
+* Where one level of detail's indices are in the arena's index buffer. Every level draws
+* the same vertices, only with fewer triangles.
+*/
+struct SubMeshLod
+{
+	std::uint32_t first_index = 0;
+	std::uint32_t idx_count   = 0;
 };
 
 class Material;
 class SubMesh : public Component
 {
   public:
+	// THE MOST LEVELS OF DETAIL A SUBMESH HAS, INCLUDING THE FULL ONE
+	static const uint32_t MAX_LODS = 4;
+
 	SubMesh(const std::string &name = "");
 
 	virtual ~SubMesh();
@@ -40,12 +108,24 @@ class SubMesh : public Component
 
 	const Material *get_material() const;
 
-	std::uint32_t index_offset_ = 0;
-	std::uint32_t vertex_count_ = 0;
-	std::uint32_t idx_count_    = 0;
+	/*
+	* The number of levels of detail, and where level's indices are. Level 0 is the full
+	* detail and levels past the coarsest give the coarsest.
+	*/
+	uint32_t   get_lod_count() const;
+	SubMeshLod get_lod(uint32_t level) const;
+
+	// WHERE THE GEOMETRY IS IN THE ARENA'S BUFFERS, WHICH IS ALL A DRAW NEEDS TO FIND IT
+	std::uint32_t  vertex_offset_    = 0;
+	std::uint32_t  first_index_      = 0;
+	std::uint32_t  vertex_count_     = 0;
+	std::uint32_t  idx_count_        = 0;
+	vk::IndexType  idx_type_         = vk::IndexType::eUint32;        // eUint16 WHEN IT HAS FEWER THAN 65536 VERTICES, first_index_ IS IN THESE
+	VertexFormat   vertex_format_    = VertexFormat::eStatic;         // WHICH OF THE ARENA'S VERTEX BUFFERS IT'S IN
+	GeometryArena *p_geometry_arena_ = nullptr;                       // THE GEOMETRY IS GIVEN BACK TO IT WHEN THE SUBMESH GOES
 
-	std::unique_ptr<Buffer> p_vertex_buf_;
-	std::unique_ptr<Buffer> p_idx_buf_;
+	// THE COARSER LEVELS OF DETAIL, THEIR INDICES ARE IN THE SAME ALLOCATION RIGHT AFTER idx_count_
+	std::vector<SubMeshLod> lods_;
 
   private:
 	const Material *p_material_ = nullptr;
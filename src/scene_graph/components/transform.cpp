@@ -86,6 +86,18 @@ void Transform::set_world_M(const glm::mat4 &world_M)
 void Transform::invalidate_local_M()
 {
 	need_update_ = true;
+	world_revision_++;
+
+	// THE CHILDREN'S WORLD MATRICES ARE BUILT ON TOP OF OURS
+	for (Node *p_child : node_.get_children())
+	{
+		p_child->get_transform().invalidate_local_M();
+	}
+}
+
+uint64_t Transform::get_world_revision() const
+{
+	return world_revision_;
 }
 
 }        // namespace W3D::sg
\ No newline at end of file
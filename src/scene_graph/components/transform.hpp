@@ -31,8 +31,13 @@ class Transform : public Component
 	void set_rotation(const glm::quat &rotation);
 	void set_scale(const glm::vec3 &scale);
 	void set_world_M(const glm::mat4 &world_M);
+
+	// marks this node's, and all its descendants', world matrices as out of date
 	void invalidate_local_M();
 
+	// changes whenever the world matrix does, so callers can tell when it moved
+	uint64_t get_world_revision() const;
+
   private:
 	void update_world_M();
 
@@ -43,6 +48,7 @@ class Transform : public Component
 
 	glm::mat4 local_M_ = glm::mat4(1.0);
 
-	bool need_update_ = false;
+	bool     need_update_    = false;
+	uint64_t world_revision_ = 0;
 };
 }        // namespace W3D::sg
\ No newline at end of file
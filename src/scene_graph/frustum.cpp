@@ -0,0 +1,56 @@
+// IN THIS FILE WE'LL BE DECLARING METHODS DECLARED INSIDE THIS HEADER FILE
+#include "frustum.hpp"
+
+// OUR OWN TYPES
+#include "components/aabb.hpp"
+
+namespace W3D::sg
+{
+
+Frustum::Frustum(const glm::mat4 &proj_view)
+{
+	// GLM MATRICES ARE COLUMN MAJOR SO WE HAVE TO PULL OUT THE ROWS OURSELVES
+	glm::mat4 rows = glm::transpose(proj_view);
+	planes_[0]     = rows[3] + rows[0];
+	planes_[1]     = rows[3] - rows[0];
+	planes_[2]     = rows[3] + rows[1];
+	planes_[3]     = rows[3] - rows[1];
+	planes_[4]     = rows[2];
+	planes_[5]     = rows[3] - rows[2];
+
+	for (glm::vec4 &plane : planes_)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+}
+
+bool Frustum::intersects(const AABB &box) const
+{
+	return intersects(box.get_min(), box.get_max());
+}
+
+bool Frustum::intersects(const glm::vec3 &box_min, const glm::vec3 &box_max) const
+{
+	for (const glm::vec4 &plane : planes_)
+	{
+		// THE CORNER FURTHEST ALONG THE PLANE'S NORMAL, IF EVEN IT IS BEHIND THE PLANE SO IS
+		// THE WHOLE BOX
+		glm::vec3 corner{
+		    plane.x >= 0.0f ? box_max.x : box_min.x,
+		    plane.y >= 0.0f ? box_max.y : box_min.y,
+		    plane.z >= 0.0f ? box_max.z : box_min.z,
+		};
+		if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+const std::array<glm::vec4, 6> &Frustum::get_planes() const
+{
+	return planes_;
+}
+
+}	// namespace W3D::sg
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+
+#include "common/glm_common.hpp"
+
+namespace W3D::sg
+{
+
+class AABB;
+
+/*
+* Frustum - the six planes bounding what a camera can see, in world space. We use it to
+* skip drawing objects that are entirely off-screen, which is called frustum culling.
+*/
+class Frustum
+{
+  private:
+	// LEFT, RIGHT, BOTTOM, TOP, NEAR AND FAR, EACH AS (normal, distance) WITH THE NORMAL
+	// POINTING INTO THE FRUSTUM
+	std::array<glm::vec4, 6> planes_;
+
+  public:
+	/*
+	* This constructor extracts the planes from the rows of the camera's combined
+	* projection and view matrix, see "Fast Extraction of Viewing Frustum Planes from the
+	* World-View-Projection Matrix" by Gil Gribb and Klaus Hartmann. Note our projections
+	* map depth to [0, 1], which changes where the near plane is.
+	*/
+	Frustum(const glm::mat4 &proj_view);
+
+	/*
+	* Tests whether any part of box, which must be in world space, might be inside this
+	* frustum. Boxes near the corners of the frustum can pass without actually being
+	* visible, but a box that fails is definitely off-screen.
+	*/
+	bool intersects(const AABB &box) const;
+
+	/*
+	* Same as above for the box from box_min to box_max, which saves making an AABB for
+	* boxes that aren't stored as one, like the ones inside a BVH.
+	*/
+	bool intersects(const glm::vec3 &box_min, const glm::vec3 &box_max) const;
+
+	/*
+	* Accessor method for getting the planes, for example to cull on the GPU with them.
+	*/
+	const std::array<glm::vec4, 6> &get_planes() const;
+
+};	// class Frustum
+
+}	// namespace W3D::sg
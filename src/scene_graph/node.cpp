@@ -3,6 +3,8 @@
 
 namespace W3D::sg
 {
+uint64_t Node::structure_revision_ = 0;
+
 Node::Node(const size_t id, const std::string &name) :
     id_(id),
     name_(name),
@@ -14,12 +16,14 @@ Node::Node(const size_t id, const std::string &name) :
 void Node::add_child(Node &child)
 {
 	children_.push_back(&child);
+	structure_revision_++;
 }
 
 void Node::set_parent(Node &parent)
 {
 	parent_ = &parent;
 	T_.invalidate_local_M();
+	structure_revision_++;
 }
 
 void Node::set_component(Component &component)
@@ -33,6 +37,12 @@ void Node::set_component(Component &component)
 	{
 		components_.insert(std::make_pair(component.get_type(), &component));
 	}
+	structure_revision_++;
+}
+
+uint64_t Node::get_structure_revision()
+{
+	return structure_revision_;
 }
 
 const size_t Node::get_id() const
@@ -26,6 +26,9 @@ class Node
 	std::vector<Node *>                              children_;			// CHILD NODES FOR THIS NODE
 	std::unordered_map<std::type_index, Component *> components_;		// COMPONENT ASSOCIATED WITH THIS NODE
 
+	// BUMPED WHENEVER ANY NODE GAINS A PARENT, CHILD OR COMPONENT
+	static uint64_t structure_revision_;
+
   public:
 	/*
 	* Constructor initializes its id and name.
@@ -100,6 +103,13 @@ class Node
 	*/
 	void add_child(Node &child);
 
+	/*
+	* Accessor method for getting a number that changes whenever the hierarchy of any node
+	* or the components attached to them change, which lets things cached from the scene
+	* graph, like the renderer's draw list, tell when they have to be rebuilt.
+	*/
+	static uint64_t get_structure_revision();
+
 };	// class Node
 
 }	// namespace W3D::sg
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "glm/gtx/string_cast.hpp"
 
 // OUR OWN TYPES
+#include "common/logging.hpp"
+#include "scene_graph/bvh.hpp"
 #include "scene_graph/components/camera.hpp"
 #include "scene_graph/components/perspective_camera.hpp"
 
@@ -110,6 +112,22 @@ void FreeCamera::process_event(const Event &event)
 		{
 			case MouseAction::eDown:
 				mouse_button_pressed_[mouse_event.button] = true;
+				if (mouse_event.button == MouseButton::eRight && p_bvh_ && viewport_size_.x > 0.0f && viewport_size_.y > 0.0f)
+				{
+					// UNPROJECT THE CURSOR ONTO THE NEAR AND FAR PLANES, THE RAY RUNS BETWEEN THEM
+					Camera   &camera    = get_node().get_component<Camera>();
+					glm::mat4 inv_PV    = glm::inverse(camera.get_projection() * camera.get_view());
+					glm::vec2 ndc       = 2.0f * glm::vec2(mouse_event.xpos, mouse_event.ypos) / viewport_size_ - 1.0f;
+					glm::vec4 near_pt   = inv_PV * glm::vec4(ndc, 0.0f, 1.0f);
+					glm::vec4 far_pt    = inv_PV * glm::vec4(ndc, 1.0f, 1.0f);
+					glm::vec3 origin    = glm::vec3(near_pt) / near_pt.w;
+					glm::vec3 direction = glm::normalize(glm::vec3(far_pt) / far_pt.w - origin);
+					p_picked_node_      = p_bvh_->ray_cast(origin, direction).p_node;
+					if (p_picked_node_)
+					{
+						LOGI("Picked {}", p_picked_node_->get_name());
+					}
+				}
 				break;
 			case MouseAction::eUp:
 				mouse_button_pressed_[mouse_event.button] = false;
@@ -126,6 +144,7 @@ void FreeCamera::process_event(const Event &event)
 
 void FreeCamera::resize(uint32_t width, uint32_t height)
 {
+	viewport_size_    = glm::vec2(width, height);
 	auto &camera_node = get_node();
 	if (camera_node.has_component<Camera>())
 	{
@@ -137,6 +156,16 @@ void FreeCamera::resize(uint32_t width, uint32_t height)
 		}
 	}
 }
+void FreeCamera::set_picking_bvh(const BVH &bvh)
+{
+	p_bvh_ = &bvh;
+}
+
+Node *FreeCamera::get_picked_node() const
+{
+	return p_picked_node_;
+}
+
 //void FreeCamera::camera_reset(){
 //	auto &camera_node = get_node();
 //	if (camera_node.has_component<Camera>())
@@ -5,6 +5,8 @@
 
 namespace W3D::sg
 {
+class BVH;
+
 /*
 * This class is a NodeScript that provides a programmed application response for
 * events associated with the camera, like camera movement.
@@ -17,6 +19,9 @@ class FreeCamera : public NodeScript
 	glm::vec2 mouse_last_pos_{0.0f};	// THE LAST KNOWN MOUSE POSITION
 	std::unordered_map<KeyCode, bool>     key_pressed_;				// KEEPS TRACK OF WHICH KEYS WERE PRESSED
 	std::unordered_map<MouseButton, bool> mouse_button_pressed_;	// KEEPS TRACK OF WHICH MOUSE BUTTONS WERE PRESSED
+	glm::vec2 viewport_size_{0.0f};		// SIZE OF THE RENDERING SURFACE, FOR TURNING THE CURSOR INTO A RAY
+	const BVH *p_bvh_         = nullptr;	// WHAT WE PICK FROM, NOTHING IS PICKED WITHOUT IT
+	Node      *p_picked_node_ = nullptr;	// THE NODE THAT WAS LAST RIGHT CLICKED
 
   public:
 	// THESE LET US CONTROL CAMERA ROTATION AND MOVEMENT INCREMENTS
@@ -53,6 +58,18 @@ class FreeCamera : public NodeScript
 	*/
 	void resize(uint32_t width, uint32_t height) override;
 
+	/*
+	* Mutator method for setting the BVH right clicks pick nodes from, by casting a ray from
+	* the camera through the cursor and taking the closest node it hits.
+	*/
+	void set_picking_bvh(const BVH &bvh);
+
+	/*
+	* Accessor method for getting the node picked by the last right click, nullptr if that
+	* click missed everything.
+	*/
+	Node *get_picked_node() const;
+
 	// void camera_reset();
 
 };	// class FreeCamera